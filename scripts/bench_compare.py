@@ -0,0 +1,125 @@
+"""Checks microbenchmark results (src/Bench.h) against a stored baseline.
+
+Input is the JSON written by the native test ($BENCH_JSON), or any log
+with a "BENCH {...}" line: pio test output, or a serial capture of the
+lolin_d32_bench firmware. The baseline defaults to
+bench/baseline-<target>.json.
+
+A case regresses when its ns/op grows by more than the tolerance, or
+when it allocates more per operation than the baseline. Cases missing
+from the results fail; new cases are listed so the baseline gets them.
+
+    python scripts/bench_compare.py results.json [--tolerance 0.25]
+    pio test -e native -f native/test_bench -v | python scripts/bench_compare.py -
+    python scripts/bench_compare.py results.json --update   # accept as baseline
+"""
+
+import argparse
+import json
+import os
+import sys
+
+BASELINE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "bench")
+DEFAULT_TOLERANCE = 0.25
+
+
+def parse_results(text):
+    """Results dict from a JSON document or the last BENCH line of a log."""
+    text = text.strip()
+    if text.startswith("{"):
+        return json.loads(text)
+    found = None
+    for line in text.splitlines():
+        at = line.find("BENCH {")
+        if at >= 0:
+            found = line[at + len("BENCH "):]
+    if found is None:
+        raise ValueError("no BENCH line or JSON document in the input")
+    return json.loads(found)
+
+
+def baseline_path(target):
+    return os.path.normpath(os.path.join(BASELINE_DIR, "baseline-%s.json" % target))
+
+
+def compare(results, baseline, tolerance=DEFAULT_TOLERANCE):
+    """One row per case: (name, status, base ns, current ns, ratio)."""
+    current = {c["name"]: c for c in results["cases"]}
+    rows = []
+    for base in baseline["cases"]:
+        name = base["name"]
+        cur = current.pop(name, None)
+        if cur is None:
+            rows.append((name, "missing", base["nsPerOp"], None, None))
+            continue
+        ratio = cur["nsPerOp"] / base["nsPerOp"] if base["nsPerOp"] > 0 else 1.0
+        if cur["allocsPerOp"] > base["allocsPerOp"]:
+            status = "allocates"
+        elif ratio > 1.0 + tolerance:
+            status = "slower"
+        elif ratio < 1.0 - tolerance:
+            status = "faster"
+        else:
+            status = "ok"
+        rows.append((name, status, base["nsPerOp"], cur["nsPerOp"], ratio))
+    for name, cur in current.items():
+        rows.append((name, "new", None, cur["nsPerOp"], None))
+    return rows
+
+
+def failed(rows):
+    return [r for r in rows if r[1] in ("missing", "slower", "allocates")]
+
+
+def format_rows(rows):
+    def ns(v):
+        return "-" if v is None else "%.1f" % v
+
+    lines = ["%-28s %10s %10s %7s  %s" % ("case", "base ns", "ns/op", "ratio", "status")]
+    for name, status, base, cur, ratio in rows:
+        r = "-" if ratio is None else "%.2f" % ratio
+        lines.append("%-28s %10s %10s %7s  %s" % (name, ns(base), ns(cur), r, status))
+    return "\n".join(lines)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("results", help="results JSON or log file, - for stdin")
+    parser.add_argument("--baseline", help="baseline file (default bench/baseline-<target>.json)")
+    parser.add_argument("--tolerance", type=float, default=DEFAULT_TOLERANCE,
+                        help="allowed ns/op growth as a fraction (default %(default)s)")
+    parser.add_argument("--update", action="store_true", help="write the results as the baseline")
+    args = parser.parse_args(argv)
+
+    if args.results == "-":
+        text = sys.stdin.read()
+    else:
+        with open(args.results) as f:
+            text = f.read()
+    results = parse_results(text)
+    path = args.baseline or baseline_path(results["target"])
+
+    if args.update:
+        with open(path, "w") as f:
+            json.dump(results, f, indent=2)
+            f.write("\n")
+        print("baseline written to %s" % path)
+        return 0
+
+    if not os.path.exists(path):
+        print("no baseline at %s; run with --update to create it" % path)
+        return 1
+    with open(path) as f:
+        baseline = json.load(f)
+
+    rows = compare(results, baseline, args.tolerance)
+    print(format_rows(rows))
+    bad = failed(rows)
+    if bad:
+        print("\n%d regression(s) against %s" % (len(bad), path))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,147 @@
+"""Compresses the web UI in web/ into a flash-resident asset table.
+
+Every file in web/ becomes a gzip blob in src/WebAssets.h together with
+its URL path, content type and a strong ETag derived from the compressed
+bytes. Output is deterministic (no gzip timestamp, files in sorted
+order), so an unchanged UI produces an unchanged header and no rebuild.
+
+Runs automatically as a PlatformIO pre-build script, or by hand:
+
+    python scripts/build_web_assets.py [web_dir] [output_header]
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".js": "application/javascript",
+    ".css": "text/css",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+    ".png": "image/png",
+}
+
+# Extra URL paths that serve the same asset
+ALIASES = {"index.html": ["/"]}
+
+BYTES_PER_LINE = 16
+
+
+def content_type(name):
+    return CONTENT_TYPES.get(os.path.splitext(name)[1].lower(), "application/octet-stream")
+
+
+def compress(data):
+    gz = gzip.compress(data, compresslevel=9, mtime=0)
+    return gz[:9] + b"\xff" + gz[10:]  # OS byte varies by Python build
+
+
+def etag(gz):
+    return '"%s"' % hashlib.sha256(gz).hexdigest()[:16]
+
+
+def c_identifier(name):
+    return "WEB_ASSET_" + "".join(c.upper() if c.isalnum() else "_" for c in name)
+
+
+def collect_assets(web_dir):
+    """Returns one dict per file in web_dir, sorted by name."""
+    assets = []
+    for root, _, files in os.walk(web_dir):
+        for name in files:
+            full = os.path.join(root, name)
+            rel = os.path.relpath(full, web_dir).replace(os.sep, "/")
+            with open(full, "rb") as f:
+                raw = f.read()
+            gz = compress(raw)
+            assets.append({
+                "name": rel,
+                "paths": ["/" + rel] + ALIASES.get(rel, []),
+                "type": content_type(rel),
+                "raw_size": len(raw),
+                "gz": gz,
+                "etag": etag(gz),
+            })
+    assets.sort(key=lambda a: a["name"])
+    return assets
+
+
+def render_header(assets):
+    out = [
+        "// Generated by scripts/build_web_assets.py from web/ - do not edit",
+        "#pragma once",
+        "#include <stddef.h>",
+        "#include <stdint.h>",
+        "",
+        "struct WebAsset {",
+        "    const char* path;",
+        "    const char* contentType;",
+        "    const uint8_t* data;     // gzip",
+        "    size_t length;",
+        "    const char* etag;",
+        "};",
+        "",
+    ]
+    for a in assets:
+        ident = c_identifier(a["name"])
+        out.append("// %s: %d bytes, %d gzipped" % (a["name"], a["raw_size"], len(a["gz"])))
+        out.append("static const uint8_t %s[] = {" % ident)
+        gz = a["gz"]
+        for i in range(0, len(gz), BYTES_PER_LINE):
+            out.append("    " + ", ".join("0x%02x" % b for b in gz[i:i + BYTES_PER_LINE]) + ",")
+        out.append("};")
+        out.append("")
+
+    out.append("static const WebAsset WEB_ASSETS[] = {")
+    for a in assets:
+        ident = c_identifier(a["name"])
+        escaped_etag = a["etag"].replace('"', '\\"')
+        for path in a["paths"]:
+            out.append('    {"%s", "%s", %s, sizeof(%s), "%s"},'
+                       % (path, a["type"], ident, ident, escaped_etag))
+    out.append("};")
+    out.append("static const size_t WEB_ASSET_COUNT = sizeof(WEB_ASSETS) / sizeof(WEB_ASSETS[0]);")
+    out.append("")
+    return "\n".join(out)
+
+
+def write_if_changed(path, text):
+    """Leaves the file (and its mtime) alone when the content is the same."""
+    if os.path.exists(path):
+        with open(path, "r") as f:
+            if f.read() == text:
+                return False
+    with open(path, "w") as f:
+        f.write(text)
+    return True
+
+
+def build(web_dir, output):
+    assets = collect_assets(web_dir)
+    changed = write_if_changed(output, render_header(assets))
+    raw = sum(a["raw_size"] for a in assets)
+    gz = sum(len(a["gz"]) for a in assets)
+    print("web assets: %d files, %d -> %d bytes%s"
+          % (len(assets), raw, gz, "" if changed else " (unchanged)"))
+    return assets
+
+
+def main(argv):
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    web_dir = argv[1] if len(argv) > 1 else os.path.join(root, "web")
+    output = argv[2] if len(argv) > 2 else os.path.join(root, "src", "WebAssets.h")
+    build(web_dir, output)
+    return 0
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+    _project = env.subst("$PROJECT_DIR")  # noqa: F821
+    build(os.path.join(_project, "web"), os.path.join(_project, "src", "WebAssets.h"))
+except NameError:
+    if __name__ == "__main__":
+        sys.exit(main(sys.argv))
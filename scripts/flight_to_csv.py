@@ -0,0 +1,148 @@
+"""Decodes a flight recorder capture (src/FlightRecorder.h) to CSV.
+
+The capture is columnar: a header, a table of column descriptors, then
+every column's values. Rows come out oldest first with the scaled
+values, the time relative to the trigger and the flag bits as 0/1
+columns; a summary of the trigger goes to stderr.
+
+    curl -o flight.bin http://rotator.local/flight/capture
+    python scripts/flight_to_csv.py flight.bin > flight.csv
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+MAGIC = 0x52544C46
+VERSION = 1
+HEADER = struct.Struct("<IHHIIHBBII")
+COLUMN = struct.Struct("<12scBxxf")
+NO_TRIGGER = 0xFFFFFFFF
+
+TRIGGERS = ["none", "manual", "estop", "limit", "stepLoss", "homingFailed"]
+FLAG_BITS = ["az_limit", "el_limit", "lsm_fresh", "az_homed", "el_homed",
+             "az_running", "el_running", "homing"]
+INT_FORMATS = {("i", 1): "b", ("i", 2): "h", ("i", 4): "i",
+               ("u", 1): "B", ("u", 2): "H", ("u", 4): "I",
+               ("x", 1): "B", ("x", 2): "H", ("x", 4): "I"}
+
+
+class Capture:
+    def __init__(self, header, columns):
+        self.count = header["count"]
+        self.rate_hz = header["rateHz"]
+        self.overwritten = header["overwritten"]
+        self.frozen = bool(header["frozen"])
+        self.trigger = TRIGGERS[header["trigger"]] if header["trigger"] < len(TRIGGERS) else "unknown"
+        self.trigger_index = None if header["triggerIndex"] == NO_TRIGGER else header["triggerIndex"]
+        self.trigger_ms = header["triggerMs"]
+        self.columns = columns      # list of (name, type, scale, values)
+
+    def column(self, name):
+        for col in self.columns:
+            if col[0] == name:
+                return col[3]
+        raise KeyError(name)
+
+
+def parse_capture(data):
+    """Capture from the bytes of a capture file."""
+    if len(data) < HEADER.size:
+        raise ValueError("truncated header")
+    fields = HEADER.unpack_from(data, 0)
+    header = dict(zip(["magic", "version", "columns", "count", "overwritten", "rateHz",
+                       "trigger", "frozen", "triggerIndex", "triggerMs"], fields))
+    if header["magic"] != MAGIC:
+        raise ValueError("not a flight recorder capture")
+    if header["version"] != VERSION:
+        raise ValueError("unsupported capture version %d" % header["version"])
+
+    at = HEADER.size
+    descs = []
+    for _ in range(header["columns"]):
+        if at + COLUMN.size > len(data):
+            raise ValueError("truncated column table")
+        name, kind, size, scale = COLUMN.unpack_from(data, at)
+        descs.append((name.split(b"\0", 1)[0].decode("ascii"), kind.decode("ascii"), size, scale))
+        at += COLUMN.size
+
+    n = header["count"]
+    columns = []
+    for name, kind, size, scale in descs:
+        fmt = INT_FORMATS.get((kind, size))
+        if fmt is None:
+            raise ValueError("column %s: unsupported type %s%d" % (name, kind, size))
+        if at + n * size > len(data):
+            raise ValueError("truncated column %s" % name)
+        values = list(struct.unpack_from("<%d%s" % (n, fmt), data, at))
+        if kind != "x" and scale != 1.0:
+            values = [v * scale for v in values]
+        columns.append((name, kind, scale, values))
+        at += n * size
+    return Capture(header, columns)
+
+
+def write_csv(capture, out):
+    names = []
+    for name, kind, _, _ in capture.columns:
+        names.extend(FLAG_BITS if kind == "x" else [name])
+    writer = csv.writer(out, lineterminator="\n")
+    t = capture.column("t_ms")
+    t0 = t[capture.trigger_index] if capture.trigger_index is not None else None
+    writer.writerow(["t_rel_s"] + names)
+    for i in range(capture.count):
+        row = ["%.3f" % ((t[i] - t0) / 1000.0) if t0 is not None else ""]
+        for _, kind, scale, values in capture.columns:
+            v = values[i]
+            if kind == "x":
+                row.extend((v >> bit) & 1 for bit in range(len(FLAG_BITS)))
+            elif isinstance(v, float):
+                row.append("%.6g" % v)
+            else:
+                row.append(v)
+        writer.writerow(row)
+
+
+def summary(capture):
+    t = capture.column("t_ms")
+    span = (t[-1] - t[0]) / 1000.0 if capture.count else 0.0
+    text = "%d samples over %.1f s at %d Hz, %d older overwritten" % (
+        capture.count, span, capture.rate_hz, capture.overwritten)
+    if capture.trigger_index is not None:
+        text += "; trigger %s at %d ms (row %d, %.1f s before, %.1f s after)" % (
+            capture.trigger, capture.trigger_ms, capture.trigger_index,
+            (t[capture.trigger_index] - t[0]) / 1000.0, (t[-1] - t[capture.trigger_index]) / 1000.0)
+    else:
+        text += "; no trigger (%s)" % ("frozen" if capture.frozen else "recording")
+    return text
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", help="capture file from GET /flight/capture, - for stdin")
+    parser.add_argument("-o", "--output", help="CSV file (default stdout)")
+    args = parser.parse_args(argv)
+
+    if args.capture == "-":
+        data = sys.stdin.buffer.read()
+    else:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+    try:
+        capture = parse_capture(data)
+    except ValueError as e:
+        print("flight_to_csv: %s" % e, file=sys.stderr)
+        return 1
+
+    if args.output:
+        with open(args.output, "w", newline="") as out:
+            write_csv(capture, out)
+    else:
+        write_csv(capture, sys.stdout)
+    print(summary(capture), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
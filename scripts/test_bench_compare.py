@@ -0,0 +1,69 @@
+"""Host tests for the benchmark baseline check: python -m unittest discover scripts"""
+
+import io
+import json
+import os
+import shutil
+import tempfile
+import unittest
+from contextlib import redirect_stdout
+
+import bench_compare
+
+
+def results(**cases):
+    return {
+        "target": "native",
+        "cyclesPerUs": 240,
+        "cases": [{"name": n, "iterations": 1024, "nsPerOp": ns, "cyclesPerOp": ns * 0.24,
+                   "allocsPerOp": allocs} for n, (ns, allocs) in cases.items()],
+    }
+
+
+class BenchCompareTest(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.mkdtemp()
+
+    def tearDown(self):
+        shutil.rmtree(self.tmp)
+
+    def status(self, rows):
+        return {r[0]: r[1] for r in rows}
+
+    def test_parses_json_and_logs(self):
+        doc = results(a=(10.0, 0.0))
+        self.assertEqual(bench_compare.parse_results(json.dumps(doc)), doc)
+        log = "Testing...\nBENCH %s\ntest_report [PASSED]\n" % json.dumps(doc)
+        self.assertEqual(bench_compare.parse_results(log), doc)
+        serial = "Setup complete.\n12:00:01 > BENCH %s\n" % json.dumps(doc)
+        self.assertEqual(bench_compare.parse_results(serial), doc)
+        with self.assertRaises(ValueError):
+            bench_compare.parse_results("no results here")
+
+    def test_classifies_cases(self):
+        base = results(same=(100.0, 0.0), slow=(100.0, 0.0), fast=(100.0, 0.0),
+                       heap=(100.0, 0.0), gone=(100.0, 0.0))
+        cur = results(same=(110.0, 0.0), slow=(130.0, 0.0), fast=(50.0, 0.0),
+                      heap=(100.0, 0.5), added=(5.0, 0.0))
+        rows = bench_compare.compare(cur, base, tolerance=0.25)
+        self.assertEqual(self.status(rows), {
+            "same": "ok", "slow": "slower", "fast": "faster",
+            "heap": "allocates", "gone": "missing", "added": "new"})
+        self.assertEqual(sorted(r[0] for r in bench_compare.failed(rows)), ["gone", "heap", "slow"])
+
+    def test_update_then_check(self):
+        res = os.path.join(self.tmp, "results.json")
+        baseline = os.path.join(self.tmp, "baseline.json")
+        with open(res, "w") as f:
+            json.dump(results(a=(10.0, 0.0)), f)
+        with redirect_stdout(io.StringIO()):
+            self.assertEqual(bench_compare.main([res, "--baseline", baseline, "--update"]), 0)
+            self.assertEqual(bench_compare.main([res, "--baseline", baseline]), 0)
+            with open(res, "w") as f:
+                json.dump(results(a=(20.0, 0.0)), f)
+            self.assertEqual(bench_compare.main([res, "--baseline", baseline]), 1)
+            self.assertEqual(bench_compare.main([res, "--baseline", baseline, "--tolerance", "1.5"]), 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,84 @@
+"""Host tests for the web asset generator: python -m unittest discover scripts"""
+
+import gzip
+import os
+import re
+import shutil
+import subprocess
+import tempfile
+import unittest
+
+import build_web_assets as assets
+
+
+class BuildWebAssetsTest(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.mkdtemp()
+        self.web = os.path.join(self.tmp, "web")
+        os.makedirs(os.path.join(self.web, "img"))
+        self.write("index.html", "<!doctype html><script src=\"/app.js\"></script>")
+        self.write("app.js", "console.log('rotator');\n" * 50)
+        self.write("img/logo.svg", "<svg/>")
+        self.out = os.path.join(self.tmp, "WebAssets.h")
+
+    def tearDown(self):
+        shutil.rmtree(self.tmp)
+
+    def write(self, name, text):
+        with open(os.path.join(self.web, name), "w") as f:
+            f.write(text)
+
+    def test_round_trip_and_metadata(self):
+        table = assets.build(self.web, self.out)
+        self.assertEqual([a["name"] for a in table], ["app.js", "img/logo.svg", "index.html"])
+        for a in table:
+            with open(os.path.join(self.web, a["name"]), "rb") as f:
+                self.assertEqual(gzip.decompress(a["gz"]), f.read())
+        by_name = {a["name"]: a for a in table}
+        self.assertEqual(by_name["index.html"]["paths"], ["/index.html", "/"])
+        self.assertEqual(by_name["app.js"]["type"], "application/javascript")
+        self.assertEqual(by_name["img/logo.svg"]["type"], "image/svg+xml")
+        self.assertLess(len(by_name["app.js"]["gz"]), by_name["app.js"]["raw_size"])
+
+    def test_output_is_deterministic(self):
+        assets.build(self.web, self.out)
+        mtime = os.path.getmtime(self.out)
+        with open(self.out) as f:
+            first = f.read()
+        os.utime(self.out, (mtime - 100, mtime - 100))
+        assets.build(self.web, self.out)
+        with open(self.out) as f:
+            self.assertEqual(f.read(), first)
+        self.assertEqual(os.path.getmtime(self.out), mtime - 100)  # not rewritten
+
+    def test_etag_tracks_content(self):
+        before = {a["name"]: a["etag"] for a in assets.build(self.web, self.out)}
+        self.write("app.js", "console.log('changed');\n")
+        after = {a["name"]: a["etag"] for a in assets.build(self.web, self.out)}
+        self.assertNotEqual(before["app.js"], after["app.js"])
+        self.assertEqual(before["index.html"], after["index.html"])
+        self.assertRegex(after["app.js"], r'^"[0-9a-f]{16}"$')
+
+    def test_header_bytes_match_and_compile(self):
+        table = assets.build(self.web, self.out)
+        with open(self.out) as f:
+            header = f.read()
+        for a in table:
+            ident = assets.c_identifier(a["name"])
+            body = re.search(r"%s\[\] = \{(.*?)\};" % ident, header, re.S).group(1)
+            data = bytes(int(b, 16) for b in re.findall(r"0x([0-9a-f]{2})", body))
+            self.assertEqual(data, a["gz"])
+        self.assertEqual(header.count('{"/'), 4)  # three files plus the "/" alias
+
+        cxx = shutil.which("g++") or shutil.which("c++")
+        if cxx:
+            src = os.path.join(self.tmp, "check.cpp")
+            with open(src, "w") as f:
+                f.write('#include "WebAssets.h"\nint main() { return WEB_ASSET_COUNT == 4 ? 0 : 1; }\n')
+            exe = os.path.join(self.tmp, "check")
+            subprocess.check_call([cxx, "-std=gnu++17", "-I", self.tmp, src, "-o", exe])
+            self.assertEqual(subprocess.call([exe]), 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
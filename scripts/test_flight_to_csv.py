@@ -0,0 +1,94 @@
+"""Host tests for the flight recorder decoder: python -m unittest discover scripts"""
+
+import csv
+import io
+import os
+import shutil
+import struct
+import tempfile
+import unittest
+from contextlib import redirect_stderr
+
+import flight_to_csv
+
+COLUMNS = [("t_ms", "u", 4, 1.0, "I"), ("az_steps", "i", 4, 1.0, "i"),
+           ("az_rate", "i", 4, 0.001, "i"), ("lsm_el", "i", 2, 0.01, "h"),
+           ("flags", "x", 1, 1.0, "B")]
+
+
+def capture(rows, trigger=2, trigger_index=1, rate=50):
+    data = flight_to_csv.HEADER.pack(flight_to_csv.MAGIC, flight_to_csv.VERSION, len(COLUMNS),
+                                     len(rows), 7, rate, trigger, 1, trigger_index, 1020)
+    for name, kind, size, scale, _ in COLUMNS:
+        data += flight_to_csv.COLUMN.pack(name.encode(), kind.encode(), size, scale)
+    for c, (_, _, _, _, fmt) in enumerate(COLUMNS):
+        data += struct.pack("<%d%s" % (len(rows), fmt), *[r[c] for r in rows])
+    return data
+
+
+ROWS = [(1000, 100, 1500000, -250, 0b00101000),
+        (1020, 130, 1500000, -249, 0b00101000),
+        (1040, 150, 0, 4500, 0b00000001)]
+
+
+class FlightToCsvTest(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.mkdtemp()
+
+    def tearDown(self):
+        shutil.rmtree(self.tmp)
+
+    def test_decodes_columns_with_scale(self):
+        cap = flight_to_csv.parse_capture(capture(ROWS))
+        self.assertEqual(cap.count, 3)
+        self.assertEqual(cap.trigger, "estop")
+        self.assertEqual(cap.trigger_index, 1)
+        self.assertEqual(cap.overwritten, 7)
+        self.assertEqual(cap.column("az_steps"), [100, 130, 150])
+        self.assertAlmostEqual(cap.column("az_rate")[0], 1500.0, places=3)
+        self.assertAlmostEqual(cap.column("lsm_el")[0], -2.5, places=4)
+        self.assertEqual(cap.column("flags"), [40, 40, 1])
+
+    def test_csv_rows_relative_to_trigger(self):
+        out = io.StringIO()
+        flight_to_csv.write_csv(flight_to_csv.parse_capture(capture(ROWS)), out)
+        rows = list(csv.DictReader(io.StringIO(out.getvalue())))
+        self.assertEqual([r["t_rel_s"] for r in rows], ["-0.020", "0.000", "0.020"])
+        self.assertEqual(rows[2]["lsm_el"], "45")
+        self.assertEqual((rows[0]["az_homed"], rows[0]["az_running"], rows[0]["az_limit"]), ("1", "1", "0"))
+        self.assertEqual(rows[2]["az_limit"], "1")
+        self.assertNotIn("flags", rows[0])
+
+    def test_without_trigger(self):
+        cap = flight_to_csv.parse_capture(capture(ROWS, trigger=0, trigger_index=0xFFFFFFFF))
+        self.assertIsNone(cap.trigger_index)
+        out = io.StringIO()
+        flight_to_csv.write_csv(cap, out)
+        self.assertTrue(out.getvalue().splitlines()[1].startswith(",1000,"))
+        self.assertIn("no trigger (frozen)", flight_to_csv.summary(cap))
+
+    def test_rejects_bad_files(self):
+        data = capture(ROWS)
+        with self.assertRaises(ValueError):
+            flight_to_csv.parse_capture(b"LSMR" + data[4:])
+        with self.assertRaises(ValueError):
+            flight_to_csv.parse_capture(data[:-1])
+        with self.assertRaises(ValueError):
+            flight_to_csv.parse_capture(data[:10])
+
+    def test_command_line(self):
+        path = os.path.join(self.tmp, "flight.bin")
+        out = os.path.join(self.tmp, "flight.csv")
+        with open(path, "wb") as f:
+            f.write(capture(ROWS))
+        err = io.StringIO()
+        with redirect_stderr(err):
+            self.assertEqual(flight_to_csv.main([path, "-o", out]), 0)
+        self.assertIn("3 samples over 0.0 s at 50 Hz", err.getvalue())
+        self.assertIn("trigger estop at 1020 ms (row 1", err.getvalue())
+        with open(out) as f:
+            self.assertEqual(len(f.read().splitlines()), 4)
+
+
+if __name__ == "__main__":
+    unittest.main()
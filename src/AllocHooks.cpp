@@ -0,0 +1,44 @@
+// AllocHooks.cpp - libc allocator wrappers feeding AllocTracker
+//
+// Linked in with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free
+// (platformio.ini), which redirects every reference to those symbols,
+// including the ones inside the framework and library archives.
+#include "AllocTracker.h"
+
+AllocTracker allocTracker;
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size) {
+    void* p = __real_malloc(size);
+    if (p) allocTracker.noteAlloc(size);
+    return p;
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    void* p = __real_calloc(n, size);
+    if (p) allocTracker.noteAlloc(n * size);
+    return p;
+}
+
+// Growing a String is exactly the churn we want to see, so every realloc
+// that returns memory counts as an allocation
+void* __wrap_realloc(void* ptr, size_t size) {
+    void* p = __real_realloc(ptr, size);
+    if (size == 0) {
+        if (ptr) allocTracker.noteFree();
+    } else if (p) {
+        allocTracker.noteAlloc(size);
+    }
+    return p;
+}
+
+void __wrap_free(void* ptr) {
+    if (ptr) allocTracker.noteFree();
+    __real_free(ptr);
+}
+}
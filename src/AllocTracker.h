@@ -0,0 +1,154 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// --- Heap allocation tracking ---
+// Every malloc/calloc/realloc/free after arm() (end of setup()) is counted
+// against the subsystem the calling task is in. ALLOC_SCOPE(sub) sets the
+// subsystem for the rest of the block and restores the outer one on exit;
+// anything outside a scope counts as ALLOC_OTHER. On the ESP32 the libc
+// calls are routed here by -Wl,--wrap (AllocHooks.cpp); host tests call
+// noteAlloc/noteFree from their own malloc overrides.
+//
+// ALLOC_FORBID() marks a hot path that must not touch the heap. With
+// -D ALLOC_GUARD=1 an allocation inside it calls the violation handler,
+// which aborts by default so the panic backtrace names the caller.
+#ifndef ALLOC_TRACKING
+#define ALLOC_TRACKING 1
+#endif
+#ifndef ALLOC_GUARD
+#define ALLOC_GUARD 0
+#endif
+
+enum AllocSubsystem : uint8_t {
+    ALLOC_OTHER,        // untagged, including Wi-Fi/lwIP tasks
+    ALLOC_LOOP,
+    ALLOC_ROTCTL,
+    ALLOC_WEB,
+    ALLOC_TELEMETRY,
+    ALLOC_LOGGER,
+    ALLOC_SENSOR,
+    ALLOC_BENCH,        // microbenchmark bodies (Bench.h)
+    ALLOC_SUBSYSTEMS
+};
+
+inline constexpr const char* ALLOC_SUBSYSTEM_NAMES[ALLOC_SUBSYSTEMS] = {
+    "other", "loop", "rotctl", "web", "telemetry", "logger", "sensor", "bench",
+};
+
+struct AllocCounts {
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t bytes;     // requested, not net
+};
+
+class AllocTracker {
+public:
+    typedef void (*ViolationHandler)(AllocSubsystem sub, size_t size);
+
+    // Starts counting; allocations made during setup() are not reported
+    void arm() { _armed.store(true, std::memory_order_release); }
+    void disarm() { _armed.store(false, std::memory_order_release); }
+    bool armed() const { return _armed.load(std::memory_order_relaxed); }
+
+    // Called from the allocator; must not allocate or block
+    void noteAlloc(size_t size) {
+        if (!armed()) return;
+        Counters& c = _counters[_current];
+        c.allocs.fetch_add(1, std::memory_order_relaxed);
+        c.bytes.fetch_add((uint32_t)size, std::memory_order_relaxed);
+        if (ALLOC_GUARD && _forbidDepth > 0) {
+            _violations.fetch_add(1, std::memory_order_relaxed);
+            if (_handler) _handler(_current, size);
+            else abort();
+        }
+    }
+    void noteFree() {
+        if (!armed()) return;
+        _counters[_current].frees.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    AllocCounts counts(AllocSubsystem sub) const {
+        const Counters& c = _counters[sub];
+        return {c.allocs.load(std::memory_order_relaxed),
+                c.frees.load(std::memory_order_relaxed),
+                c.bytes.load(std::memory_order_relaxed)};
+    }
+    uint32_t totalAllocs() const {
+        uint32_t n = 0;
+        for (const Counters& c : _counters) n += c.allocs.load(std::memory_order_relaxed);
+        return n;
+    }
+    uint32_t violations() const { return _violations.load(std::memory_order_relaxed); }
+
+    void reset() {
+        for (Counters& c : _counters) {
+            c.allocs.store(0, std::memory_order_relaxed);
+            c.frees.store(0, std::memory_order_relaxed);
+            c.bytes.store(0, std::memory_order_relaxed);
+        }
+        _violations.store(0, std::memory_order_relaxed);
+    }
+
+    void setViolationHandler(ViolationHandler handler) { _handler = handler; }
+
+    // Per-task state behind the scope macros
+    static AllocSubsystem enter(AllocSubsystem sub) {
+        AllocSubsystem outer = _current;
+        _current = sub;
+        return outer;
+    }
+    static void leave(AllocSubsystem outer) { _current = outer; }
+    static void forbid() { _forbidDepth++; }
+    static void allow() { _forbidDepth--; }
+
+private:
+    struct Counters {
+        std::atomic<uint32_t> allocs{0};
+        std::atomic<uint32_t> frees{0};
+        std::atomic<uint32_t> bytes{0};
+    };
+
+    Counters _counters[ALLOC_SUBSYSTEMS];
+    std::atomic<uint32_t> _violations{0};
+    std::atomic<bool> _armed{false};
+    ViolationHandler _handler = nullptr;
+
+    static inline thread_local AllocSubsystem _current = ALLOC_OTHER;
+    static inline thread_local uint8_t _forbidDepth = 0;
+};
+
+extern AllocTracker allocTracker;
+
+class AllocScope {
+public:
+    explicit AllocScope(AllocSubsystem sub) : _outer(AllocTracker::enter(sub)) {}
+    ~AllocScope() { AllocTracker::leave(_outer); }
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    AllocSubsystem _outer;
+};
+
+class AllocForbid {
+public:
+    AllocForbid() { AllocTracker::forbid(); }
+    ~AllocForbid() { AllocTracker::allow(); }
+    AllocForbid(const AllocForbid&) = delete;
+    AllocForbid& operator=(const AllocForbid&) = delete;
+};
+
+#if ALLOC_TRACKING
+#define ALLOC_SCOPE(sub) AllocScope _allocScope(sub)
+#else
+#define ALLOC_SCOPE(sub) do {} while (0)
+#endif
+
+#if ALLOC_TRACKING && ALLOC_GUARD
+#define ALLOC_FORBID() AllocForbid _allocForbid
+#else
+#define ALLOC_FORBID() do {} while (0)
+#endif
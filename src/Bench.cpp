@@ -0,0 +1,75 @@
+// Bench.cpp - microbenchmark runner
+#include "Bench.h"
+#include "hal/Hal.h"
+#include "AllocTracker.h"
+#include "JsonWriter.h"
+
+static BenchResult results[BENCH_MAX_CASES];
+static size_t resultCount = 0;
+
+// One timed run of `iterations`, in cycles
+static uint32_t timeRun(const BenchCase& c, uint32_t iterations) {
+    uint32_t start = hal::cycleCount();
+    c.body(iterations);
+    return hal::cycleCount() - start;
+}
+
+BenchResult runBench(const BenchCase& c) {
+    ALLOC_SCOPE(ALLOC_BENCH);
+    bool wasArmed = allocTracker.armed();
+    allocTracker.arm();
+
+    // Warm up caches and first-use state, then size the batch
+    c.body(1);
+    uint32_t iterations = 1;
+    while (iterations < (1u << 24) && timeRun(c, iterations) < BENCH_MIN_RUN_US * BENCH_CYCLES_PER_US) {
+        iterations *= 2;
+    }
+
+    uint32_t allocsBefore = allocTracker.counts(ALLOC_BENCH).allocs;
+    uint32_t best = UINT32_MAX;
+    for (uint8_t r = 0; r < BENCH_RUNS; r++) {
+        uint32_t cycles = timeRun(c, iterations);
+        if (cycles < best) best = cycles;
+    }
+    uint32_t allocs = allocTracker.counts(ALLOC_BENCH).allocs - allocsBefore;
+    if (!wasArmed) allocTracker.disarm();
+
+    BenchResult res;
+    res.name = c.name;
+    res.iterations = iterations;
+    res.cyclesPerOp = (float)best / iterations;
+    res.nsPerOp = res.cyclesPerOp * 1000.0f / BENCH_CYCLES_PER_US;
+    res.allocsPerOp = (float)allocs / ((uint32_t)BENCH_RUNS * iterations);
+    return res;
+}
+
+size_t runBenchSuite() {
+    resultCount = 0;
+    for (size_t i = 0; i < BENCH_CASE_COUNT && resultCount < BENCH_MAX_CASES; i++) {
+        results[resultCount++] = runBench(BENCH_CASES[i]);
+    }
+    return resultCount;
+}
+
+size_t benchResultCount() { return resultCount; }
+const BenchResult& benchResult(size_t i) { return results[i]; }
+
+void writeBenchJSON(JsonWriter& json) {
+    json.beginObject();
+    json.kv("target", hal::TARGET_NAME);
+    json.kv("cyclesPerUs", BENCH_CYCLES_PER_US);
+    json.key("cases").beginArray();
+    for (size_t i = 0; i < resultCount; i++) {
+        const BenchResult& r = results[i];
+        json.beginObject();
+        json.kv("name", r.name);
+        json.kv("iterations", r.iterations);
+        json.kv("nsPerOp", r.nsPerOp, 1);
+        json.kv("cyclesPerOp", r.cyclesPerOp, 1);
+        json.kv("allocsPerOp", r.allocsPerOp, 3);
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+class JsonWriter;
+
+// --- Microbenchmarks for the firmware hot paths ---
+// A case body runs its operation `iterations` times. The runner doubles
+// the batch until one run lasts BENCH_MIN_RUN_US, times BENCH_RUNS runs of
+// that size and keeps the fastest, which is the one least disturbed by
+// interrupts and other tasks. Time comes from hal::cycleCount(): CPU
+// cycles on the ESP32, the wall clock scaled to 240 per us on Linux.
+// Heap calls inside the bodies are counted under ALLOC_BENCH.
+//
+// Host: pio test -e native -f native/test_bench
+// Target: env:lolin_d32_bench runs the suite in setup(), prints a
+// "BENCH {...}" line on Serial and serves the same JSON on GET /bench.
+// scripts/bench_compare.py checks either against bench/baseline-<target>.json.
+inline constexpr uint32_t BENCH_MIN_RUN_US = 20000;
+inline constexpr uint8_t BENCH_RUNS = 5;
+inline constexpr uint32_t BENCH_CYCLES_PER_US = 240;
+inline constexpr size_t BENCH_MAX_CASES = 16;
+
+typedef void (*BenchBody)(uint32_t iterations);
+
+struct BenchCase {
+    const char* name;
+    BenchBody body;
+};
+
+struct BenchResult {
+    const char* name;
+    uint32_t iterations;    // per run
+    float nsPerOp;          // fastest run
+    float cyclesPerOp;
+    float allocsPerOp;
+};
+
+// Defined in BenchCases.cpp
+extern const BenchCase BENCH_CASES[];
+extern const size_t BENCH_CASE_COUNT;
+
+// Keeps v (and the work that produced it) from being optimized away
+template <typename T>
+inline void benchKeep(const T& v) {
+    asm volatile("" : : "m"(v) : "memory");
+}
+
+BenchResult runBench(const BenchCase& c);
+
+// Runs every case and keeps the results for writeBenchJSON()
+size_t runBenchSuite();
+size_t benchResultCount();
+const BenchResult& benchResult(size_t i);
+
+// {"target":..,"cyclesPerUs":..,"cases":[{"name":..,"nsPerOp":..},..]}
+void writeBenchJSON(JsonWriter& json);
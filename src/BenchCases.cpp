@@ -0,0 +1,122 @@
+// BenchCases.cpp - the hot paths under benchmark
+//
+// Inputs come through volatiles and vary with the iteration so the
+// compiler can neither fold nor hoist the work; results go to benchKeep().
+#include "Bench.h"
+#include "JsonWriter.h"
+#include "LSM303Receiver.h"
+#include "MathUtils.h"
+#include "MotorControl.h"
+#include "RotctlProtocol.h"
+#include "StatusJson.h"
+#include "WebLogger.h"
+
+static volatile float benchAngle = 123.45f;
+
+// Counts the bytes a JsonWriter produces without keeping them
+static void countSink(void* ctx, const char*, size_t len) {
+    *(size_t*)ctx += len;
+}
+
+// One sensor packet: sscanf, tilt compensation, calibration and smoothing
+static void benchLsmPacket(uint32_t n) {
+    static LSM303Receiver receiver(0);
+    static const char packet[] = "MAG:0.31250,-0.12500,0.45000;ACC:0.01000,-0.02000,0.99000";
+    for (uint32_t i = 0; i < n; i++) {
+        receiver.processPacket(packet, sizeof(packet) - 1);
+    }
+    benchKeep(receiver.getAzimuth());
+}
+
+static void benchRotctlSet(uint32_t n) {
+    static const char line[] = "P 123.45 67.89\n";
+    for (uint32_t i = 0; i < n; i++) {
+        RotctlRequest req = parseRotctlCommand(line, sizeof(line) - 1);
+        benchKeep(req);
+    }
+}
+
+// "p" and the two-line position reply
+static void benchRotctlGet(uint32_t n) {
+    char reply[ROTCTL_REPLY_LEN];
+    for (uint32_t i = 0; i < n; i++) {
+        RotctlRequest req = parseRotctlCommand("p\n", 2);
+        benchKeep(req);
+        size_t len = formatRotctlPosition(reply, sizeof(reply), benchAngle + i, 45.0f);
+        benchKeep(len);
+        benchKeep(reply);
+    }
+}
+
+static void benchStepConversion(uint32_t n) {
+    float deg = benchAngle;
+    for (uint32_t i = 0; i < n; i++) {
+        long steps = azToSteps(deg + (i & 255));
+        float back = stepsToAz(steps);
+        benchKeep(back);
+    }
+}
+
+static void benchHeadingMath(uint32_t n) {
+    float deg = benchAngle;
+    for (uint32_t i = 0; i < n; i++) {
+        float t = magneticToTrue(normalizeDeg(deg - 720.0f + i));
+        benchKeep(t);
+    }
+}
+
+// Full /logs body: 100 entries formatted and escaped
+static void benchLogsJSON(uint32_t n) {
+    static WebLogger logger;
+    static bool filled = false;
+    if (!filled) {
+        uint8_t source = logger.intern("[bench]");
+        for (size_t i = 0; i < WEB_LOG_CAPACITY; i++) {
+            logger.logf(LOG_INFO, source, "Moved to az=%.2f el=%.2f after %lu ms (\"%s\")",
+                        i * 3.6f, i * 0.9f, (unsigned long)i * 40, "rotctl");
+        }
+        filled = true;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        size_t bytes = 0;
+        {
+            JsonWriter json(countSink, &bytes);
+            logger.writeLogsJSON(json);
+        }
+        benchKeep(bytes);
+    }
+}
+
+static void benchStatusJSON(uint32_t n) {
+    TelemetrySnapshot snap = {};
+    snap.azDeg = benchAngle;
+    snap.elDeg = 45.0f;
+    snap.lsmAz = 124.1f;
+    snap.lsmAzTrue = 126.3f;
+    snap.lsmEl = 44.8f;
+    snap.lsmElCorr = 45.1f;
+    snap.azLimit = HIGH;
+    snap.elLimit = HIGH;
+    snap.azHomed = true;
+    for (uint32_t i = 0; i < n; i++) {
+        size_t bytes = 0;
+        {
+            JsonWriter json(countSink, &bytes);
+            json.beginObject();
+            writeStatusFields(json, snap, i);
+            json.endObject();
+        }
+        benchKeep(bytes);
+    }
+}
+
+const BenchCase BENCH_CASES[] = {
+    {"lsm.processPacket", benchLsmPacket},
+    {"rotctl.parseSet", benchRotctlSet},
+    {"rotctl.getReply", benchRotctlGet},
+    {"motor.azStepsRoundTrip", benchStepConversion},
+    {"math.magneticToTrue", benchHeadingMath},
+    {"web.logsJSON", benchLogsJSON},
+    {"web.statusJSON", benchStatusJSON},
+};
+const size_t BENCH_CASE_COUNT = sizeof(BENCH_CASES) / sizeof(BENCH_CASES[0]);
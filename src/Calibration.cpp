@@ -1,7 +1,9 @@
 #include "Calibration.h"
 #include "MotorControl.h"   // for moveAzimuthDeg / moveElevationDeg
-#include <Arduino.h>
 #include "Config.h"
+#include "PositionStore.h"
+#include "MathUtils.h"
+#include "Latency.h"
 Calibration::Calibration(LSM303Receiver* lsm) : _lsm(lsm) {}
 
 //float elOffset = 0.0f;
@@ -11,26 +13,36 @@ void Calibration::begin() {
     elMin = 180; elMax = 0;
     calStage = CAL_IDLE;
     running = false;
-    step = 0;
+    _sampleCount = 0;
+    _totalSamples = 0;
+    memset(_azBins, 0, sizeof(_azBins));
+    memset(_elBins, 0, sizeof(_elBins));
+    _sweepMs = 0;
+    _azStoppedEarly = false;
+    _elStoppedEarly = false;
 }
 
-void Calibration::start() {
+void Calibration::start(CalMode mode) {
     Serial.println("[CAL] Starting calibration");
-    WEB_LOG_INFO("[CAL]", "Starting Calibration");
+    WEB_LOG_INFOF("[CAL]", "Starting Calibration (%s)",
+                  mode == CAL_MODE_CONCURRENT ? "concurrent" : "sequential");
+    positionStore.markDirty();
     if (_lsm) _lsm->startCalibration();
     begin();
+    _mode = mode;
     running = true;
-    calStage = CAL_AZ_SWEEP;
-    //move El to Zero
-    moveElevationDeg(0);
-    // Move to start of AZ sweep
-    moveAzimuthDeg(MAX_AZ);
+    scheduler.start(this, "calibration");
 }
 
 void Calibration::stop() {
     running = false;
     calStage = CAL_IDLE;
-    if (_lsm) _lsm->stopCalibration();
+    scheduler.stop(this);
+    if (_lsm) {
+        _lsm->setSampleHook(nullptr, nullptr);
+        _lsm->stopCalibration();
+    }
+    setSweepSpeed(MOTOR_SPEED_HZ);
     Serial.println("[CAL] Stopped calibration");
     WEB_LOG_INFO("[CAL]", "Stopped Calibration");
 }
@@ -40,94 +52,189 @@ bool Calibration::isRunning() const {
 }
 
 void Calibration::reset() {
+    running = false;
     calStage = CAL_IDLE;
+    scheduler.stop(this);
+    if (_lsm) _lsm->setSampleHook(nullptr, nullptr);
+    setSweepSpeed(MOTOR_SPEED_HZ);
     Serial.println("[CAL] Reset to IDLE (emergency stop)");
     WEB_LOG_INFO("[CAL]", "Reset to IDLE (emergency stop)");
 }
 
+// ----------------------
+// Sample capture: called by the receiver for every packet, so each raw
+// reading is paired with the step counts at the moment it was read
+// instead of the EMA output at whatever time the task ran.
+// ----------------------
+void Calibration::onSample(float rawAz, float rawEl, void* ctx) {
+    static_cast<Calibration*>(ctx)->addSample(rawAz, rawEl);
+}
 
+void Calibration::addSample(float rawAz, float rawEl) {
+    if (_sampleCount < CAL_MAX_SAMPLES) {
+        CalSample& s = _samples[_sampleCount++];
+        s.tMs = millis();
+        s.azSteps = azMotor ? azMotor->getCurrentPosition() : 0;
+        s.elSteps = elMotor1 ? elMotor1->getCurrentPosition() : 0;
+        s.rawAz = rawAz;
+        s.rawEl = rawEl;
+    }
+    _totalSamples++;
 
+    if (rawAz < azMin) azMin = rawAz;
+    if (rawAz > azMax) azMax = rawAz;
+    if (rawEl < elMin) elMin = rawEl;
+    if (rawEl > elMax) elMax = rawEl;
 
-void Calibration::update() {
-    if (!running) return;  // Only act if calibration is running
+    int azBin = constrain((int)(normalizeDeg(rawAz) / (360.0f / CAL_AZ_BINS)), 0, CAL_AZ_BINS - 1);
+    int elBin = constrain((int)((rawEl + 90.0f) / (180.0f / CAL_EL_BINS)), 0, CAL_EL_BINS - 1);
+    if (_azBins[azBin] < 255) _azBins[azBin]++;
+    if (_elBins[elBin] < 255) _elBins[elBin]++;
+}
 
-    // --- Record LSM303 min/max safely ---
-    if (_lsm) {
-        float currentAz = _lsm->getAzimuth();    // raw readings
-        float currentEl = _lsm->getElevation();
+uint8_t Calibration::getAzBinsCovered() const {
+    uint8_t n = 0;
+    for (uint8_t c : _azBins) if (c >= CAL_MIN_SAMPLES_PER_BIN) n++;
+    return n;
+}
 
-        if (currentAz < azMin) azMin = currentAz;
-        if (currentAz > azMax) azMax = currentAz;
-        if (currentEl < elMin) elMin = currentEl;
-        if (currentEl > elMax) elMax = currentEl;
+uint8_t Calibration::getElBinsCovered() const {
+    uint8_t n = 0;
+    for (uint8_t c : _elBins) if (c >= CAL_MIN_SAMPLES_PER_BIN) n++;
+    return n;
+}
+
+// Full heading circle seen
+bool Calibration::azCovered() const {
+    return getAzBinsCovered() == CAL_AZ_BINS;
+}
+
+// Raw EL span reached and no gaps inside it
+bool Calibration::elCovered() const {
+    if (_totalSamples == 0 || elMax - elMin < CAL_EL_MIN_SPAN_DEG) return false;
+    int first = constrain((int)((elMin + 90.0f) / (180.0f / CAL_EL_BINS)), 0, CAL_EL_BINS - 1);
+    int last = constrain((int)((elMax + 90.0f) / (180.0f / CAL_EL_BINS)), 0, CAL_EL_BINS - 1);
+    for (int i = first; i <= last; i++) {
+        if (_elBins[i] < CAL_MIN_SAMPLES_PER_BIN) return false;
     }
+    return true;
+}
+
+static bool elRunning() {
+    return elMotor1->isRunning() || (elGangedDrive && elMotor2 && elMotor2->isRunning());
+}
+
+// Stops each axis early once its coverage is sufficient; true when both are idle
+bool Calibration::sweepFinished() {
+    if (!_azStoppedEarly && azMotor->isRunning() && azCovered()) {
+        _azStoppedEarly = true;
+        azMotor->stopMove();
+        WEB_LOG_INFO("[CAL]", "AZ coverage complete, stopping sweep early");
+    }
+    if (!_elStoppedEarly && elRunning() && elCovered()) {
+        _elStoppedEarly = true;
+        elMotor1->stopMove();
+        if (elGangedDrive && elMotor2) elMotor2->stopMove();
+        WEB_LOG_INFO("[CAL]", "EL coverage complete, stopping sweep early");
+    }
+    return !azMotor->isRunning() && !elRunning();
+}
+
+void Calibration::setSweepSpeed(uint32_t hz) {
+    if (azMotor) azMotor->setSpeedInHz(hz);
+    if (elMotor1) elMotor1->setSpeedInHz(hz);
+    if (elMotor2) elMotor2->setSpeedInHz(hz);
+}
+
+void Calibration::reportSweep() {
+    float seconds = _sweepMs / 1000.0f;
+    float azSwept = fabsf(stepsToAz(azMotor->getCurrentPosition()) - _azSweepStartDeg);
+    Serial.printf("[CAL] Sweep done in %lu ms: %lu samples (%.1f/s, %.2f per AZ deg), AZ bins %u/%u, EL bins %u/%u\n",
+                  _sweepMs, (unsigned long)_totalSamples,
+                  seconds > 0 ? _totalSamples / seconds : 0.0f,
+                  azSwept > 0 ? _totalSamples / azSwept : 0.0f,
+                  getAzBinsCovered(), CAL_AZ_BINS, getElBinsCovered(), CAL_EL_BINS);
+    WEB_LOG_INFOF("[CAL]", "Sweep done in %lu ms: %lu samples (%.1f/s, %.2f per AZ deg), AZ bins %u/%u, EL bins %u/%u",
+                  _sweepMs, (unsigned long)_totalSamples,
+                  seconds > 0 ? _totalSamples / seconds : 0.0f,
+                  azSwept > 0 ? _totalSamples / azSwept : 0.0f,
+                  getAzBinsCovered(), CAL_AZ_BINS, getElBinsCovered(), CAL_EL_BINS);
+}
+
+bool Calibration::step() {
+    LATENCY_SCOPE("calibration.step");
+    if (!running) return false;  // Only act if calibration is running
 
     // --- Stepper-controlled sweep ---
-    switch (calStage) {
-        case CAL_AZ_SWEEP:
-            if (!azMotor->isRunning()) {
-                Serial.println("[CAL] AZ sweep complete");
-                WEB_LOG_INFO("[CAL]", "AZ Sweep Complete");
-                calStage = CAL_EL_SWEEP;
-                moveElevationDeg(MAX_EL);
-            }
-            break;
-
-        case CAL_EL_SWEEP:
-            if (!elMotor1->isRunning() && (!elGangedDrive || !elMotor2->isRunning())) {
-                Serial.println("[CAL] EL sweep complete");
-                WEB_LOG_INFO("[CAL]", "EL Sweep Complete");
-                if (_lsm) _lsm->stopCalibration();
-                // Compute offset to zero EL at horizontal
-                float measuredZeroEl = elMin;  // the lowest EL measured during calibration
-                _lsm->setElHomeOffset(-measuredZeroEl);
-
-                Serial.printf("[CAL] EL offset applied: %.2f (raw=%.2f → corrected=%.2f)\n",
-                                -measuredZeroEl,
-                                _lsm->getElevation(),
-                                _lsm->getElCorrected());
-
-                WEB_LOG_INFOF("[CAL]", "EL offset applied: %.2f (raw=%.2f → corrected=%.2f)", 
-                                -measuredZeroEl, 
-                                _lsm->getElevation(), 
-                                _lsm->getElCorrected());
-
-                calStage = CAL_DONE;
-              
-                Serial.printf("[CAL] Done. AZ: %.2f–%.2f  EL: %.2f–%.2f  EL offset: %.2f\n",
-                              azMin, azMax, elMin, elMax, _lsm->getElCorrected() - _lsm->getElevation());
-                WEB_LOG_INFOF("[CAL]", "Done.  AZ: %.2f–%.2f  EL: %.2f–%.2f  EL offset: %.2f", 
-                                azMin, azMax, elMin, elMax, _lsm->getElCorrected() - _lsm->getElevation());
-
-            }
-            break;
-
-          case CAL_DONE:
-              Serial.println("[CAL] Calibration complete, moving AZ off endstop for homing...");
-              WEB_LOG_INFO("[CAL]", "Calibration complete, moving AZ off endstop for homing...");
-          
-            if (azMotor) {
-                long backoffSteps = -180 * stepsPerDegree;  // relative CCW move
-                azMotor->move(backoffSteps);
-                calStage = CAL_BACKOFF;
-            }
-
-              break;
-          
-          case CAL_BACKOFF:
-              // Wait until AZ motor stops moving before starting homing
-              if (!azMotor->isRunning()) {
-                  Serial.println("[CAL] AZ backoff complete, starting homing...");
-                  WEB_LOG_INFO("[CAL]","AZ backoff complete, starting homing...");
-                  homeAzimuth();      // your existing homing routine
-                  calStage = CAL_IDLE; // calibration sequence complete
-              }
-              break;
-
-
-
-        case CAL_IDLE:
-        default:
-            break;
+    TASK_BEGIN();
+
+    if (_lsm) _lsm->setSampleHook(&Calibration::onSample, this);
+    _sweepStartMs = millis();
+    _azSweepStartDeg = stepsToAz(azMotor->getCurrentPosition());
+    setSweepSpeed(CAL_SWEEP_SPEED_HZ);
+
+    if (_mode == CAL_MODE_CONCURRENT) {
+        calStage = CAL_SWEEP_BOTH;
+        moveElevationDeg(MAX_EL);
+        moveAzimuthDeg(MAX_AZ);
+        TASK_AWAIT(sweepFinished());
+    } else {
+        calStage = CAL_AZ_SWEEP;
+        // Move to start of AZ sweep
+        moveAzimuthDeg(MAX_AZ);
+        TASK_AWAIT(sweepFinished());
+        Serial.println("[CAL] AZ sweep complete");
+        WEB_LOG_INFO("[CAL]", "AZ Sweep Complete");
+
+        calStage = CAL_EL_SWEEP;
+        moveElevationDeg(MAX_EL);
+        TASK_AWAIT(sweepFinished());
+        Serial.println("[CAL] EL sweep complete");
+        WEB_LOG_INFO("[CAL]", "EL Sweep Complete");
+    }
+
+    _sweepMs = millis() - _sweepStartMs;
+    setSweepSpeed(MOTOR_SPEED_HZ);
+    reportSweep();
+
+    if (_lsm) {
+        _lsm->setSampleHook(nullptr, nullptr);
+        _lsm->stopCalibration();
+        // Compute offset to zero EL at horizontal
+        float measuredZeroEl = elMin;  // the lowest EL measured during calibration
+        _lsm->setElHomeOffset(-measuredZeroEl);
+
+        Serial.printf("[CAL] EL offset applied: %.2f (raw=%.2f → corrected=%.2f)\n",
+                        -measuredZeroEl,
+                        _lsm->getElevation(),
+                        _lsm->getElCorrected());
+
+        WEB_LOG_INFOF("[CAL]", "EL offset applied: %.2f (raw=%.2f → corrected=%.2f)",
+                        -measuredZeroEl,
+                        _lsm->getElevation(),
+                        _lsm->getElCorrected());
+
+        Serial.printf("[CAL] Done. AZ: %.2f–%.2f  EL: %.2f–%.2f  EL offset: %.2f\n",
+                      azMin, azMax, elMin, elMax, _lsm->getElCorrected() - _lsm->getElevation());
+        WEB_LOG_INFOF("[CAL]", "Done.  AZ: %.2f–%.2f  EL: %.2f–%.2f  EL offset: %.2f",
+                        azMin, azMax, elMin, elMax, _lsm->getElCorrected() - _lsm->getElevation());
+    }
+
+    calStage = CAL_DONE;
+    Serial.println("[CAL] Calibration complete, moving AZ off endstop for homing...");
+    WEB_LOG_INFO("[CAL]", "Calibration complete, moving AZ off endstop for homing...");
+    if (azMotor) {
+        azMotor->move((long)(-180 * stepsPerDegree));  // relative CCW move
+        calStage = CAL_BACKOFF;
+        // Wait until AZ motor stops moving before starting homing
+        TASK_AWAIT(!azMotor->isRunning());
+        Serial.println("[CAL] AZ backoff complete, starting homing...");
+        WEB_LOG_INFO("[CAL]","AZ backoff complete, starting homing...");
     }
+
+    homeAll();
+    calStage = CAL_IDLE; // calibration sequence complete
+    running = false;
+
+    TASK_END();
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include "LSM303Receiver.h"
 #include "Homing.h"
+#include "Scheduler.h"
 
 //extern float elOffset; // degrees
 
@@ -8,18 +9,42 @@ enum CalStage {
     CAL_IDLE,
     CAL_AZ_SWEEP,
     CAL_EL_SWEEP,
+    CAL_SWEEP_BOTH,
     CAL_DONE,
     CAL_BACKOFF
 };
 
-class Calibration {
+enum CalMode {
+    CAL_MODE_CONCURRENT,   // AZ and EL sweep together (default)
+    CAL_MODE_SEQUENTIAL    // AZ then EL, as the original sweep
+};
+
+// --- Sweep tuning ---
+inline constexpr uint32_t CAL_SWEEP_SPEED_HZ = 1200;
+inline constexpr uint16_t CAL_MAX_SAMPLES = 512;
+inline constexpr uint8_t CAL_AZ_BINS = 36;              // 10 deg heading bins
+inline constexpr uint8_t CAL_EL_BINS = 18;              // 10 deg bins over -90..90
+inline constexpr uint8_t CAL_MIN_SAMPLES_PER_BIN = 2;
+inline constexpr float CAL_EL_MIN_SPAN_DEG = 170.0f;    // raw EL span that counts as a full sweep
+
+// Raw sensor sample tagged with the step positions at packet arrival
+struct CalSample {
+    uint32_t tMs;
+    int32_t azSteps;
+    int32_t elSteps;
+    float rawAz;
+    float rawEl;
+};
+
+// The sweep runs as a resumable task on the tick scheduler
+class Calibration : public CoTask {
 public:
     Calibration(LSM303Receiver* lsm);
 
     void begin();
-    void start();
+    void start(CalMode mode = CAL_MODE_CONCURRENT);
     void stop();
-    void update();
+    bool step() override;
     bool isRunning() const;
     void reset();
 
@@ -28,13 +53,38 @@ public:
     float getElMin() const { return elMin; }
     float getElMax() const { return elMax; }
 
+    uint16_t getSampleCount() const { return _sampleCount; }
+    const CalSample* getSamples() const { return _samples; }
+    unsigned long getSweepMs() const { return _sweepMs; }
+    uint8_t getAzBinsCovered() const;
+    uint8_t getElBinsCovered() const;
+
 private:
+    static void onSample(float rawAz, float rawEl, void* ctx);
+    void addSample(float rawAz, float rawEl);
+    bool azCovered() const;
+    bool elCovered() const;
+    bool sweepFinished();
+    void setSweepSpeed(uint32_t hz);
+    void reportSweep();
+
     LSM303Receiver* _lsm;
 
     bool running = false;
-    int step = 0;
     CalStage calStage = CAL_IDLE;
+    CalMode _mode = CAL_MODE_CONCURRENT;
 
     float azMin = 360, azMax = 0;
     float elMin = 180, elMax = 0;
+
+    CalSample _samples[CAL_MAX_SAMPLES];
+    uint16_t _sampleCount = 0;
+    uint32_t _totalSamples = 0;          // including those past the buffer
+    uint8_t _azBins[CAL_AZ_BINS] = {};
+    uint8_t _elBins[CAL_EL_BINS] = {};
+    unsigned long _sweepStartMs = 0;
+    unsigned long _sweepMs = 0;
+    float _azSweepStartDeg = 0.0f;
+    bool _azStoppedEarly = false;
+    bool _elStoppedEarly = false;
 };
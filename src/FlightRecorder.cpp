@@ -0,0 +1,194 @@
+// FlightRecorder.cpp - telemetry ring, fault triggers and columnar capture
+#include "FlightRecorder.h"
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include "hal/Hal.h"
+#include "Homing.h"
+#include "TelemetrySnapshot.h"
+
+FlightRecorder flightRecorder;
+
+const char* const FLIGHT_TRIGGER_NAMES[FLIGHT_TRIG_COUNT] = {
+    "none", "manual", "estop", "limit", "stepLoss", "homingFailed"
+};
+
+namespace {
+struct ColumnInfo {
+    FlightColumnDesc desc;
+    size_t offset;          // into FlightRecorder::Columns
+};
+
+#define FLIGHT_COLUMN(name, type, field, scale) \
+    { { name, type, sizeof(FlightRecorder::Columns::field[0]), 0, scale }, offsetof(FlightRecorder::Columns, field) }
+
+const ColumnInfo COLUMNS[] = {
+    FLIGHT_COLUMN("t_ms",      'u', tMs,      1.0f),
+    FLIGHT_COLUMN("az_target", 'i', azTarget, 1.0f),
+    FLIGHT_COLUMN("el_target", 'i', elTarget, 1.0f),
+    FLIGHT_COLUMN("az_steps",  'i', azSteps,  1.0f),
+    FLIGHT_COLUMN("el_steps",  'i', elSteps,  1.0f),
+    FLIGHT_COLUMN("az_rate",   'i', azRate,   0.001f),
+    FLIGHT_COLUMN("el_rate",   'i', elRate,   0.001f),
+    FLIGHT_COLUMN("lsm_az",    'u', lsmAz,    0.01f),
+    FLIGHT_COLUMN("lsm_el",    'i', lsmEl,    0.01f),
+    FLIGHT_COLUMN("loop_us",   'u', loopUs,   1.0f),
+    FLIGHT_COLUMN("flags",     'x', flags,    1.0f),
+};
+#undef FLIGHT_COLUMN
+
+constexpr size_t COLUMN_COUNT = sizeof(COLUMNS) / sizeof(COLUMNS[0]);
+
+int16_t centiDeg(float deg) {
+    float v = roundf(deg * 100.0f);
+    if (v > 32767.0f) return 32767;
+    if (v < -32768.0f) return -32768;
+    return (int16_t)v;
+}
+}
+
+void FlightRecorder::arm(uint16_t rateHz) {
+    _armRateHz.store(rateHz, std::memory_order_relaxed);
+    _armPending.store(true, std::memory_order_release);
+}
+
+void FlightRecorder::applyArm() {
+    uint16_t rate = _armRateHz.load(std::memory_order_relaxed);
+    if (rate > FLIGHT_MAX_RATE_HZ) rate = FLIGHT_MAX_RATE_HZ;
+    if (rate > 0) _rateHz = rate;
+    _head.store(0, std::memory_order_relaxed);
+    _postRemaining = 0;
+    _triggerPending.store(false, std::memory_order_relaxed);
+    _trigger.store(FLIGHT_TRIG_NONE, std::memory_order_relaxed);
+    _frozen.store(false, std::memory_order_release);
+}
+
+bool FlightRecorder::trigger(FlightTrigger reason) {
+    if (frozen()) return false;
+    uint8_t none = FLIGHT_TRIG_NONE;
+    if (!_trigger.compare_exchange_strong(none, reason, std::memory_order_acq_rel)) return false;
+    _triggerMs = millis();
+    _triggerPending.store(true, std::memory_order_release);
+    return true;
+}
+
+void FlightRecorder::noteLoopTime(uint32_t elapsedUs) {
+    uint32_t peak = _loopPeakUs.load(std::memory_order_relaxed);
+    while (elapsedUs > peak && !_loopPeakUs.compare_exchange_weak(peak, elapsedUs, std::memory_order_relaxed)) {}
+}
+
+void FlightRecorder::update() {
+    if (_armPending.exchange(false, std::memory_order_acq_rel)) {
+        applyArm();
+        _lastSampleMs = millis() - 1000 / _rateHz;   // first sample right away
+    }
+    if (frozen()) return;
+
+    uint32_t now = millis();
+    if (now - _lastSampleMs < 1000u / _rateHz) return;
+    _lastSampleMs = now;
+    sample(now);
+
+    if (_triggerPending.exchange(false, std::memory_order_acq_rel)) {
+        _triggerHead = _head.load(std::memory_order_relaxed) - 1;
+        _postRemaining = FLIGHT_POST_TRIGGER;
+    } else if (_postRemaining > 0 && --_postRemaining == 0) {
+        freeze();
+    }
+}
+
+void FlightRecorder::sample(uint32_t nowMs) {
+    TelemetrySnapshot s = readTelemetrySnapshot();
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    size_t i = head % FLIGHT_CAPACITY;
+
+    _cols.tMs[i] = nowMs;
+    _cols.azTarget[i] = azMotor ? azMotor->targetPos() : 0;
+    _cols.elTarget[i] = elMotor1 ? elMotor1->targetPos() : 0;
+    _cols.azSteps[i] = s.azSteps;
+    _cols.elSteps[i] = s.elSteps;
+    _cols.azRate[i] = azMotor ? azMotor->getCurrentSpeedInMilliHz() : 0;
+    _cols.elRate[i] = elMotor1 ? elMotor1->getCurrentSpeedInMilliHz() : 0;
+    long az = lroundf(s.lsmAzTrue * 100.0f) % 36000;
+    _cols.lsmAz[i] = (uint16_t)(az < 0 ? az + 36000 : az);
+    _cols.lsmEl[i] = centiDeg(s.lsmElCorr);
+    uint32_t loopUs = _loopPeakUs.exchange(0, std::memory_order_relaxed);
+    _cols.loopUs[i] = loopUs > 0xFFFF ? 0xFFFF : (uint16_t)loopUs;
+
+    uint8_t flags = 0;
+    if (s.azLimit == LOW) flags |= FLIGHT_AZ_LIMIT;
+    if (s.elLimit == LOW) flags |= FLIGHT_EL_LIMIT;
+    if (s.lsmFresh) flags |= FLIGHT_LSM_FRESH;
+    if (s.azHomed) flags |= FLIGHT_AZ_HOMED;
+    if (s.elHomed) flags |= FLIGHT_EL_HOMED;
+    if (s.azRunning) flags |= FLIGHT_AZ_RUNNING;
+    if (s.elRunning) flags |= FLIGHT_EL_RUNNING;
+    if (homingStage == HOMING_RUNNING) flags |= FLIGHT_HOMING;
+    _cols.flags[i] = flags;
+
+    _head.store(head + 1, std::memory_order_release);
+}
+
+size_t FlightRecorder::count() const {
+    uint32_t head = _head.load(std::memory_order_acquire);
+    return head < FLIGHT_CAPACITY ? head : FLIGHT_CAPACITY;
+}
+
+uint32_t FlightRecorder::overwritten() const {
+    uint32_t head = _head.load(std::memory_order_acquire);
+    return head > FLIGHT_CAPACITY ? head - FLIGHT_CAPACITY : 0;
+}
+
+size_t FlightRecorder::captureSize() const {
+    size_t rowBytes = 0;
+    for (const ColumnInfo& c : COLUMNS) rowBytes += c.desc.size;
+    return sizeof(FlightCaptureHeader) + sizeof(COLUMNS[0].desc) * COLUMN_COUNT + count() * rowBytes;
+}
+
+size_t FlightRecorder::readCapture(uint8_t* out, size_t len, size_t offset) const {
+    uint32_t head = _head.load(std::memory_order_acquire);
+    size_t n = count();
+    uint32_t first = head - n;
+    uint32_t triggerIndex = UINT32_MAX;
+    if (triggerReason() != FLIGHT_TRIG_NONE && !_triggerPending.load(std::memory_order_acquire) &&
+        _triggerHead - first < n) {
+        triggerIndex = _triggerHead - first;
+    }
+    FlightCaptureHeader header = {FLIGHT_CAPTURE_MAGIC, FLIGHT_CAPTURE_VERSION, (uint16_t)COLUMN_COUNT,
+                                  (uint32_t)n, overwritten(), _rateHz, (uint8_t)triggerReason(),
+                                  (uint8_t)frozen(), triggerIndex, _triggerMs};
+    const size_t tableEnd = sizeof(header) + sizeof(FlightColumnDesc) * COLUMN_COUNT;
+    size_t total = captureSize();
+
+    size_t done = 0;
+    while (done < len && offset < total) {
+        const uint8_t* src;
+        size_t avail;
+        if (offset < sizeof(header)) {
+            src = (const uint8_t*)&header + offset;
+            avail = sizeof(header) - offset;
+        } else if (offset < tableEnd) {
+            size_t pos = offset - sizeof(header);
+            size_t within = pos % sizeof(FlightColumnDesc);
+            src = (const uint8_t*)&COLUMNS[pos / sizeof(FlightColumnDesc)].desc + within;
+            avail = sizeof(FlightColumnDesc) - within;
+        } else {
+            // Find the column, then copy up to the end of the ring or column
+            size_t pos = offset - tableEnd;
+            size_t c = 0;
+            while (pos >= n * COLUMNS[c].desc.size) pos -= n * COLUMNS[c++].desc.size;
+            size_t size = COLUMNS[c].desc.size;
+            size_t slot = (first + pos / size) % FLIGHT_CAPACITY;
+            size_t within = pos % size;
+            src = (const uint8_t*)&_cols + COLUMNS[c].offset + slot * size + within;
+            size_t toColumnEnd = n * size - pos;
+            size_t toRingEnd = (FLIGHT_CAPACITY - slot) * size - within;
+            avail = toColumnEnd < toRingEnd ? toColumnEnd : toRingEnd;
+        }
+        size_t k = avail < len - done ? avail : len - done;
+        memcpy(out + done, src, k);
+        done += k;
+        offset += k;
+    }
+    return done;
+}
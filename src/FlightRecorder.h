@@ -0,0 +1,147 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Telemetry flight recorder ---
+// Always-on ring of motion telemetry sampled at FLIGHT_DEFAULT_RATE_HZ
+// (configurable up to FLIGHT_MAX_RATE_HZ) from the stepper task: commanded
+// targets, step positions and rates, the LSM303 angles, limit/homing
+// state and the worst loop() pass since the previous sample.
+//
+// A fault (e-stop, a limit switch closing away from home, homing drift
+// beyond FLIGHT_STEP_LOSS_DEG, failed homing) or a manual trigger keeps
+// recording for FLIGHT_POST_TRIGGER more samples and then freezes the
+// ring, so the capture holds the seconds either side of the event until
+// it is re-armed. Only the first trigger after arming counts.
+//
+// Storage is one static array per column (no heap). The capture file is
+// columnar as well (little-endian): FlightCaptureHeader, `columns`
+// FlightColumnDesc entries, then each column's `count` values, oldest
+// first. scripts/flight_to_csv.py decodes it.
+inline constexpr size_t FLIGHT_CAPACITY = 1024;             // ~20 s at 50 Hz, 35 KB
+inline constexpr size_t FLIGHT_POST_TRIGGER = FLIGHT_CAPACITY / 4;
+inline constexpr uint16_t FLIGHT_DEFAULT_RATE_HZ = 50;
+inline constexpr uint16_t FLIGHT_MAX_RATE_HZ = 200;         // stepper task runs every ms
+inline constexpr float FLIGHT_STEP_LOSS_DEG = 0.5f;         // homing drift that counts as step loss
+inline constexpr float FLIGHT_LIMIT_MARGIN_DEG = 2.0f;      // a switch closing further out is a fault
+inline constexpr uint32_t FLIGHT_CAPTURE_MAGIC = 0x52544C46;   // "FLTR"
+inline constexpr uint16_t FLIGHT_CAPTURE_VERSION = 1;
+
+enum FlightTrigger : uint8_t {
+    FLIGHT_TRIG_NONE,
+    FLIGHT_TRIG_MANUAL,
+    FLIGHT_TRIG_ESTOP,
+    FLIGHT_TRIG_LIMIT,
+    FLIGHT_TRIG_STEP_LOSS,
+    FLIGHT_TRIG_HOMING_FAILED,
+    FLIGHT_TRIG_COUNT
+};
+
+extern const char* const FLIGHT_TRIGGER_NAMES[FLIGHT_TRIG_COUNT];
+
+// Bits of the "flags" column
+enum FlightFlag : uint8_t {
+    FLIGHT_AZ_LIMIT   = 1 << 0,     // switch closed
+    FLIGHT_EL_LIMIT   = 1 << 1,
+    FLIGHT_LSM_FRESH  = 1 << 2,
+    FLIGHT_AZ_HOMED   = 1 << 3,
+    FLIGHT_EL_HOMED   = 1 << 4,
+    FLIGHT_AZ_RUNNING = 1 << 5,
+    FLIGHT_EL_RUNNING = 1 << 6,
+    FLIGHT_HOMING     = 1 << 7,
+};
+
+struct FlightCaptureHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t columns;
+    uint32_t count;
+    uint32_t overwritten;       // older samples the ring no longer holds
+    uint16_t rateHz;
+    uint8_t trigger;            // FlightTrigger
+    uint8_t frozen;
+    uint32_t triggerIndex;      // sample index of the trigger, UINT32_MAX if none
+    uint32_t triggerMs;
+};
+static_assert(sizeof(FlightCaptureHeader) == 28, "capture format");
+
+// One entry per column: value = raw * scale. Types: 'i' signed, 'u'
+// unsigned, 'x' bit field (FlightFlag).
+struct FlightColumnDesc {
+    char name[12];
+    char type;
+    uint8_t size;
+    uint16_t reserved;
+    float scale;
+};
+static_assert(sizeof(FlightColumnDesc) == 20, "capture format");
+
+class FlightRecorder {
+public:
+    // Clears the ring and trigger and records at rateHz (clamped to
+    // 1..FLIGHT_MAX_RATE_HZ, 0 keeps the current rate). Takes effect on
+    // the next update(), so handlers never race the sampler.
+    void arm(uint16_t rateHz = 0);
+
+    // Freezes the ring FLIGHT_POST_TRIGGER samples from now. Any task or
+    // handler may call it; false if already triggered.
+    bool trigger(FlightTrigger reason);
+
+    // Freezes at once (before a download)
+    void freeze() { _frozen.store(true, std::memory_order_release); }
+
+    // From the stepper task: takes a sample when the interval is due
+    void update();
+
+    // From loop(): worst pass duration, reported with the next sample
+    void noteLoopTime(uint32_t elapsedUs);
+
+    bool frozen() const { return _frozen.load(std::memory_order_acquire); }
+    FlightTrigger triggerReason() const { return (FlightTrigger)_trigger.load(std::memory_order_acquire); }
+    uint32_t triggerMs() const { return _triggerMs; }
+    uint16_t rateHz() const { return _rateHz; }
+    size_t count() const;
+    uint32_t overwritten() const;
+    size_t capacity() const { return FLIGHT_CAPACITY; }
+
+    // Capture file, read in pieces for a streamed download. Freeze first:
+    // a sample written during the read would be torn.
+    size_t captureSize() const;
+    size_t readCapture(uint8_t* out, size_t len, size_t offset) const;
+
+    // Storage, one array per capture column
+    struct Columns {
+        uint32_t tMs[FLIGHT_CAPACITY];
+        int32_t azTarget[FLIGHT_CAPACITY];      // steps
+        int32_t elTarget[FLIGHT_CAPACITY];
+        int32_t azSteps[FLIGHT_CAPACITY];
+        int32_t elSteps[FLIGHT_CAPACITY];
+        int32_t azRate[FLIGHT_CAPACITY];        // mHz (steps/s * 1000), signed
+        int32_t elRate[FLIGHT_CAPACITY];
+        uint16_t lsmAz[FLIGHT_CAPACITY];        // true azimuth, 0.01 deg
+        int16_t lsmEl[FLIGHT_CAPACITY];         // corrected elevation, 0.01 deg
+        uint16_t loopUs[FLIGHT_CAPACITY];       // saturates at 65535
+        uint8_t flags[FLIGHT_CAPACITY];
+    };
+
+private:
+    void applyArm();
+    void sample(uint32_t nowMs);
+
+    Columns _cols;
+    uint16_t _rateHz = FLIGHT_DEFAULT_RATE_HZ;
+    uint32_t _lastSampleMs = 0;
+    std::atomic<uint32_t> _head{0};             // samples written since arm()
+    std::atomic<uint32_t> _loopPeakUs{0};
+    std::atomic<uint8_t> _trigger{FLIGHT_TRIG_NONE};
+    std::atomic<bool> _triggerPending{false};
+    std::atomic<bool> _frozen{false};
+    std::atomic<bool> _armPending{false};
+    std::atomic<uint16_t> _armRateHz{0};
+    uint32_t _triggerMs = 0;
+    uint32_t _triggerHead = 0;                  // _head when the trigger was taken
+    uint32_t _postRemaining = 0;
+};
+
+extern FlightRecorder flightRecorder;
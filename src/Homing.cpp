@@ -1,4 +1,9 @@
 #include "Homing.h"
+#include "PositionStore.h"
+#include "Scheduler.h"
+#include "Latency.h"
+#include "AllocTracker.h"
+#include "FlightRecorder.h"
 extern LSM303Receiver lsmReceiver;
 
 // --- Homing state variables ---
@@ -8,182 +13,404 @@ bool elHomed = false;
 int azHomingDir = -1; // example: CCW
 int elHomingDir = -1; // example: DOWN
 
-// --- Debounced AZ limit globals ---
-unsigned long azLimitLastChange = 0;
-const unsigned long AZ_LIMIT_DEBOUNCE_MS = 5;  // ms
-bool azLimitState = false; // debounced state
+AxisHoming azHoming = { "AZ" };
+AxisHoming elHoming = { "EL" };
 
-// --- Debounced EL limit globals ---
-unsigned long elLimitLastChange = 0;
-const unsigned long EL_LIMIT_DEBOUNCE_MS = 5;  // ms
-bool elLimitState = false; // debounced state
+bool elHomingWaitsForAz = false;
+unsigned long lastHomingDurationMs = 0;
+unsigned long homingStartMs = 0;
 
-//Homing delay globals
-unsigned long elStopStartTime = 0;
-bool elStopStarted = false;
+const unsigned long LIMIT_DEBOUNCE_MS = 5;  // ms
 
-void updateAzLimit() {
-    bool raw = digitalRead(AZ_LIMIT_PIN) == LOW;
+// True when the switch has just closed
+static bool updateLimit(AxisHoming& ax, int pin) {
+    bool raw = digitalRead(pin) == LOW;
     unsigned long now = millis();
-    if (raw != azLimitState && now - azLimitLastChange >= AZ_LIMIT_DEBOUNCE_MS) {
-        azLimitState = raw;
-        azLimitLastChange = now;
-        Serial.print("[AZ LIMIT] "); Serial.println(azLimitState ? "TRIGGERED" : "CLEAR");
+    if (raw != ax.limitState && now - ax.limitLastChange >= LIMIT_DEBOUNCE_MS) {
+        ax.limitState = raw;
+        ax.limitLastChange = now;
+        Serial.printf("[%s LIMIT] %s\n", ax.name, ax.limitState ? "TRIGGERED" : "CLEAR");
+        return raw;
     }
+    return false;
 }
 
-void updateElLimit() {
-    bool raw = digitalRead(EL_LIMIT_PIN) == LOW;
-    unsigned long now = millis();
-    if (raw != elLimitState && now - elLimitLastChange >= EL_LIMIT_DEBOUNCE_MS) {
-        elLimitState = raw;
-        elLimitLastChange = now;
-        Serial.print("[EL LIMIT] "); Serial.println(elLimitState ? "TRIGGERED" : "CLEAR");
+// ----------------------
+// Limit interrupts: latch the step count at the switch edge so home does
+// not depend on loop() latency or deceleration distance.
+// FastAccelStepper position reads are safe from interrupt context.
+// ----------------------
+static void IRAM_ATTR latchLimit(AxisHoming& ax, Stepper* motor) {
+    if (!ax.latchArmed || !motor) return;
+    ax.latchedSteps = motor->getCurrentPosition();
+    ax.latchedUs = micros();
+    ax.latched = true;
+    ax.latchArmed = false;
+}
+
+static void IRAM_ATTR azLimitISR() { latchLimit(azHoming, azMotor); }
+static void IRAM_ATTR elLimitISR() { latchLimit(elHoming, elMotor1); }
+
+void beginHoming() {
+    // Limit switches are active LOW: entering the switch is a falling edge
+    attachInterrupt(digitalPinToInterrupt(AZ_LIMIT_PIN), azLimitISR, FALLING);
+    attachInterrupt(digitalPinToInterrupt(EL_LIMIT_PIN), elLimitISR, FALLING);
+}
+
+// ----------------------
+// Axis helpers (EL drives both motors when ganged)
+// ----------------------
+static bool isAz(const AxisHoming& ax) { return &ax == &azHoming; }
+
+static bool axisLimitRaw(const AxisHoming& ax) {
+    return digitalRead(isAz(ax) ? AZ_LIMIT_PIN : EL_LIMIT_PIN) == LOW;
+}
+
+static long axisPosition(const AxisHoming& ax) {
+    return isAz(ax) ? azMotor->getCurrentPosition() : elMotor1->getCurrentPosition();
+}
+
+static bool axisRunning(const AxisHoming& ax) {
+    if (isAz(ax)) return azMotor->isRunning();
+    return elMotor1->isRunning() || (elGangedDrive && elMotor2 && elMotor2->isRunning());
+}
+
+static void axisSetSpeed(const AxisHoming& ax, uint32_t hz) {
+    if (isAz(ax)) {
+        azMotor->setSpeedInHz(hz);
+    } else {
+        elMotor1->setSpeedInHz(hz);
+        if (elGangedDrive && elMotor2) elMotor2->setSpeedInHz(hz);
     }
 }
 
-void homeAzimuth() {
-    if (!azMotor) return;
-    homingStage = HOMING_AZ_PRE_HOME;
-    azHomed = false;
-    long target = azHomingDir * MAX_HOMING_STEPS;
-    Serial.println("[HOMING] Starting azimuth homing...");
-    Serial.print("[HOMING] Moving AZ motor towards "); 
-    Serial.print(azHomingDir > 0 ? "CW" : "CCW");
-    Serial.print(" for max "); Serial.print(MAX_HOMING_STEPS); Serial.println(" steps");
-    azMotor->moveTo(target, false);
+static void axisMoveTo(const AxisHoming& ax, long target) {
+    if (isAz(ax)) {
+        azMotor->moveTo(target, false);
+    } else {
+        elMotor1->moveTo(target, false);
+        if (elGangedDrive && elMotor2) elMotor2->moveTo(target, false);
+    }
 }
 
-void homeElevation() {
-    if (!elMotor1) return;
-    homingStage = HOMING_EL_MOVING;
-    elHomed = false;
-    long target = elHomingDir * MAX_HOMING_STEPS;
-    Serial.println("[HOMING] Starting elevation homing...");
-    Serial.print("[HOMING] Moving EL motors towards "); 
-    Serial.print(elHomingDir > 0 ? "UP" : "DOWN");
-    Serial.print(" for max "); Serial.print(MAX_HOMING_STEPS); Serial.println(" steps");
-    elMotor1->moveTo(target, false);
-    if (elGangedDrive && elMotor2) elMotor2->moveTo(target, false);
+static void axisStop(const AxisHoming& ax) {
+    if (isAz(ax)) {
+        azMotor->stopMove();
+    } else {
+        elMotor1->stopMove();
+        if (elGangedDrive && elMotor2) elMotor2->stopMove();
+    }
 }
 
-void updateHoming() {
-    // --- Update limit switches ---
-    updateAzLimit();
-    updateElLimit();
-
-    switch (homingStage) {
-        case HOMING_AZ_PRE_HOME:
-        // Check if we need to move az to safe pre-home position
-        {
-            float azDeg = stepsToAz(azMotor->getCurrentPosition());
-            if (azDeg < 0 || azDeg > 360) {
-                WEB_LOG_WARNINGF("[HOMING]", "AZ out of range (%.1f°), moving to 180° before homing", azDeg);
-                moveAzimuthToPosition(180.0);  // queue movement
-            } else {
-                WEB_LOG_INFO("[HOMING]", "AZ within safe range, skipping pre-home move");
-                homingStage = HOMING_AZ_MOVING; // move on to normal az homing
-            }
+static void armLatch(AxisHoming& ax) {
+    ax.latched = false;
+    ax.latchArmed = true;
+}
+
+// Returns true once a trigger is backed by the debounced switch state
+static bool limitConfirmed(AxisHoming& ax) {
+    bool limit = ax.limitState;
+    if (ax.latched) {
+        if (limit) return true;
+        if (micros() - ax.latchedUs > HOMING_LATCH_CONFIRM_US) armLatch(ax);  // glitch, re-arm
+        return false;
+    }
+    if (limit) {
+        // Switch closed without an armed edge: fall back to the polled position
+        ax.latchArmed = false;
+        if (!ax.latched) {
+            ax.latchedSteps = axisPosition(ax);
+            ax.latched = true;
+        }
+        return true;
+    }
+    return false;
+}
+
+// The first backoff after the fast pass starts from the latch: the axis has
+// coasted past the switch by the full deceleration distance (v^2 / 2a,
+// ~1280 steps at HOMING_FAST_SPEED_HZ), more than the backoff tries cover.
+static void startBackoff(AxisHoming& ax) {
+    long from = (ax.haveFastLatch && ax.backoffTries == 0) ? ax.fastLatchSteps : axisPosition(ax);
+    axisSetSpeed(ax, MOTOR_SPEED_HZ);
+    axisMoveTo(ax, from - ax.dir * HOMING_BACKOFF_STEPS);
+    ax.backoffTries++;
+    ax.phase = AXIS_BACKOFF;
+}
+
+static void recordHomingStats(AxisHoming& ax, long latch) {
+    HomingStats& st = ax.stats;
+    st.runs++;
+    st.lastDurationMs = millis() - ax.startMs;
+    if (ax.haveFastLatch) st.lastFastSlowDelta = ax.fastLatchSteps - latch;
+
+    if (ax.wasHomed) {
+        // The old frame is still valid, so the latch position is the drift since last home
+        st.driftSamples++;
+        st.lastDriftSteps = latch;
+        if (st.driftSamples == 1 || latch < st.minDriftSteps) st.minDriftSteps = latch;
+        if (st.driftSamples == 1 || latch > st.maxDriftSteps) st.maxDriftSteps = latch;
+        float delta = latch - st.meanDriftSteps;
+        st.meanDriftSteps += delta / st.driftSamples;
+        st.m2 += delta * (latch - st.meanDriftSteps);
+        if (labs(latch) > FLIGHT_STEP_LOSS_DEG * stepsPerDegree) flightRecorder.trigger(FLIGHT_TRIG_STEP_LOSS);
+    }
+
+    Serial.printf("[HOMING] %s homed in %lu ms: drift %ld steps, sigma %.1f over %lu runs (range %ld..%ld), fast-slow %ld\n",
+                  ax.name, st.lastDurationMs, st.lastDriftSteps, st.stdDevSteps(),
+                  (unsigned long)st.driftSamples, st.minDriftSteps, st.maxDriftSteps, st.lastFastSlowDelta);
+    WEB_LOG_INFOF("[HOMING]", "%s homed in %lu ms: drift %ld steps, sigma %.1f over %lu runs (range %ld..%ld), fast-slow %ld",
+                  ax.name, st.lastDurationMs, st.lastDriftSteps, st.stdDevSteps(),
+                  (unsigned long)st.driftSamples, st.minDriftSteps, st.maxDriftSteps, st.lastFastSlowDelta);
+}
+
+// Make the latched slow-pass position the new zero
+static void applyHome(AxisHoming& ax) {
+    long latch = ax.latchedSteps;
+    if (isAz(ax)) {
+        azMotor->setCurrentPosition(azMotor->getCurrentPosition() - latch);
+    } else {
+        elMotor1->setCurrentPosition(elMotor1->getCurrentPosition() - latch);
+        if (elGangedDrive && elMotor2) elMotor2->setCurrentPosition(elMotor1->getCurrentPosition());
+    }
+    axisSetSpeed(ax, MOTOR_SPEED_HZ);
+    ax.phase = AXIS_DONE;
+    recordHomingStats(ax, latch);
+}
+
+static void failHoming(AxisHoming& ax, const char* reason) {
+    axisStop(ax);
+    axisSetSpeed(ax, MOTOR_SPEED_HZ);
+    ax.latchArmed = false;
+    ax.phase = AXIS_FAILED;
+    Serial.printf("[HOMING] %s homing failed, %s\n", ax.name, reason);
+    WEB_LOG_ERRORF("[HOMING]", "%s homing failed, %s", ax.name, reason);
+    flightRecorder.trigger(FLIGHT_TRIG_HOMING_FAILED);
+}
+
+// ----------------------
+// Per-axis homing sequence as a resumable task
+// ----------------------
+class AxisHomingTask : public CoTask {
+public:
+    explicit AxisHomingTask(AxisHoming& ax) : _ax(ax) {}
+    bool step() override;
+
+private:
+    AxisHoming& _ax;
+    bool _confirmed = false;
+};
+
+static AxisHomingTask azHomingTask(azHoming);
+static AxisHomingTask elHomingTask(elHoming);
+
+static bool axisBusy(const AxisHoming& ax) {
+    return scheduler.isActive(isAz(ax) ? &azHomingTask : &elHomingTask);
+}
+
+static bool azOutsideSafeWindow() {
+    float azDeg = stepsToAz(azMotor->getCurrentPosition());
+    return azDeg < 0 || azDeg > 360;
+}
+
+static bool elHeldByInterlock() {
+    if (axisBusy(azHoming) && azOutsideSafeWindow()) return true;
+    if (elHomingWaitsForAz && !azHomed) return true;
+    return false;
+}
+
+static void finishAzimuth() {
+    azHomed = true;
+    Serial.println("[HOMING] Azimuth limit reached, position set to 0");
+    WEB_LOG_INFO("[HOMING]", "Azimuth limit reached, position set to 0");
+}
+
+static void finishElevation() {
+    lsmReceiver.setElHomeRaw(lsmReceiver.getElevation());  // store raw home value
+    lsmReceiver.resetElSmoothing();                        // reset smoothing
+
+    elHomed = true;
+
+    Serial.printf("[HOMING] Elevation homed. Raw=%.2f, Corrected=%.2f\n",
+                    lsmReceiver.getElevation(), lsmReceiver.getElCorrected());
+    WEB_LOG_INFOF("[HOMING]", "Elevation homed. Raw=%.2f, Corrected=%.2f",
+                    lsmReceiver.getElevation(), lsmReceiver.getElCorrected());
+    Serial.println("[HOMING] Elevation limit reached, position set to 0");
+    WEB_LOG_INFO("[HOMING]", "Elevation limit reached, position set to 0");
+}
+
+bool AxisHomingTask::step() {
+    AxisHoming& ax = _ax;
+    TASK_BEGIN();
+
+    if (isAz(ax)) {
+        // Move az to the safe pre-home position first if it is on the cable wrap
+        if (azOutsideSafeWindow()) {
+            WEB_LOG_WARNINGF("[HOMING]", "AZ out of range (%.1f°), moving to 180° before homing",
+                             stepsToAz(azMotor->getCurrentPosition()));
+            moveAzimuthToPosition(180.0);
+            ax.phase = AXIS_PRE_HOME;
+            TASK_AWAIT(!azMotor->isRunning());
+            WEB_LOG_INFO("[HOMING]", "AZ pre-home move complete");
+        }
+    } else if (elHeldByInterlock()) {
+        WEB_LOG_INFO("[HOMING]", "EL homing waiting for AZ interlock");
+        ax.phase = AXIS_WAITING;
+        TASK_AWAIT(!elHeldByInterlock() || (!axisBusy(azHoming) && !azHomed));
+        if (elHeldByInterlock()) {
+            failHoming(ax, "azimuth interlock not satisfied");
+            TASK_EXIT();
         }
+    }
 
-        // Non-blocking check: only advance when az has finished moving
-        if (!azMotor->isRunning()) {
-            homingStage = HOMING_AZ_MOVING;
+    Serial.printf("[HOMING] Moving %s towards %s for max %ld steps\n", ax.name,
+                  ax.dir > 0 ? "+" : "-", MAX_HOMING_STEPS);
+    ax.backoffTries = 0;
+    ax.haveFastLatch = false;
+
+    // Fast approach (skipped when already on the switch: no edge would come)
+    if (!axisLimitRaw(ax)) {
+        axisSetSpeed(ax, HOMING_FAST_SPEED_HZ);
+        armLatch(ax);
+        axisMoveTo(ax, axisPosition(ax) + ax.dir * MAX_HOMING_STEPS);
+        ax.phase = AXIS_FAST_APPROACH;
+        TASK_AWAIT((_confirmed = limitConfirmed(ax)) || !axisRunning(ax));
+        if (!_confirmed) {
+            failHoming(ax, "limit switch not found");
+            TASK_EXIT();
         }
-        break;
-
-        case HOMING_AZ_MOVING:
-        if (azLimitState) {  // debounced limit triggered
-            azMotor->stopMove();
-            delay(800);   // allow motion to fully cease
-            azMotor->setCurrentPosition(0);  // reset home
-            azHomed = true;
-            Serial.println("[HOMING] Azimuth limit reached, position set to 0");
-            WEB_LOG_INFO("[HOMING]", "Azimuth limit reached, position set to 0");
-            homeElevation();  // move to elevation homing next
+        axisStop(ax);
+        ax.fastLatchSteps = ax.latchedSteps;
+        ax.haveFastLatch = true;
+        ax.phase = AXIS_FAST_STOPPING;
+        TASK_AWAIT(!axisRunning(ax));
+    }
+
+    // Back off until the switch is clear
+    do {
+        if (ax.backoffTries >= HOMING_MAX_BACKOFFS) {
+            failHoming(ax, "switch still active after backoff");
+            TASK_EXIT();
         }
-        break;
+        startBackoff(ax);
+        TASK_AWAIT(!axisRunning(ax));
+    } while (axisLimitRaw(ax));
 
+    // Slow re-approach, this latch defines home
+    axisSetSpeed(ax, HOMING_SLOW_SPEED_HZ);
+    armLatch(ax);
+    axisMoveTo(ax, axisPosition(ax) + ax.dir * HOMING_BACKOFF_STEPS * (ax.backoffTries + 1));
+    ax.phase = AXIS_SLOW_APPROACH;
+    TASK_AWAIT((_confirmed = limitConfirmed(ax)) || !axisRunning(ax));
+    if (!_confirmed) {
+        failHoming(ax, "limit switch not found on slow pass");
+        TASK_EXIT();
+    }
+    axisStop(ax);
+    ax.phase = AXIS_SLOW_STOPPING;
+    TASK_AWAIT(!axisRunning(ax));
 
-/*        case HOMING_EL_MOVING:
-        if (!azHomed) break; // safety: wait until azimuth is homed
-        if (elLimitState) {
-            // Stop motors
-            elMotor1->stopMove();
-            delay(800);   // allow motion to fully cease
-            elMotor1->setCurrentPosition(0);
-            if (elGangedDrive && elMotor2) elMotor2->setCurrentPosition(0);
+    applyHome(ax);
+    if (isAz(ax)) finishAzimuth();
+    else finishElevation();
 
-            // Store home reference: horizon = 0°
-            float rawEl = lsmReceiver.getElevation();  
-            lsmReceiver.setElHomeRaw(90.0f - rawEl);  
-            lsmReceiver.resetElSmoothing();          
+    TASK_END();
+}
 
-            elHomed = true;
+// ----------------------
+// Homing run control
+// ----------------------
+static void beginRun() {
+    if (homingStage == HOMING_RUNNING) return;
+    homingStage = HOMING_RUNNING;
+    homingStartMs = millis();
+    if (!axisBusy(azHoming)) azHoming.phase = AXIS_IDLE;
+    if (!axisBusy(elHoming)) elHoming.phase = AXIS_IDLE;
+}
 
-            Serial.printf("[HOMING] Elevation homed. Raw=%.2f, Corrected=%.2f\n",
-                            lsmReceiver.getElevation(), lsmReceiver.getElCorrected());
-            Serial.println("[HOMING] Elevation limit reached, position set to 0");
+static void requestAzimuth() {
+    azHoming.wasHomed = azHomed;
+    azHoming.startMs = millis();
+    azHoming.dir = azHomingDir;
+    azHomed = false;
+    positionStore.markDirty();
+    Serial.println("[HOMING] Starting azimuth homing...");
+    scheduler.start(&azHomingTask, "homeAz");
+}
 
-            homingStage = HOMING_COMPLETE;
+static void requestElevation() {
+    elHoming.wasHomed = elHomed;
+    elHoming.startMs = millis();
+    elHoming.dir = elHomingDir;
+    elHomed = false;
+    positionStore.markDirty();
+    Serial.println("[HOMING] Starting elevation homing...");
+    scheduler.start(&elHomingTask, "homeEl");
+}
 
-            // Move to 90° (zenith) after homing
-            moveElevationDeg(90.0f);
-            Serial.println("[HOMING] Elevation homed, moving to 90 degrees...");
-            Serial.println("[HOMING] Homing sequence complete!");
-        }
-        break;
-*/
-
-
-            case HOMING_EL_MOVING:
-                if (!azHomed) break; // safety: wait until azimuth is homed
-                if (elLimitState) {
-                    if (!elStopStarted) {
-                        // Stop the motor and record the time
-                        elMotor1->stopMove();
-                        if (elGangedDrive && elMotor2) elMotor2->stopMove();
-                        elStopStartTime = millis();
-                        elStopStarted = true;
-                        break;  // exit to next loop iteration
-                    }
-
-                    // Wait non-blocking for 800ms
-                    if (millis() - elStopStartTime < 800) break;
-
-                    // Now safe to reset position counters
-                    elMotor1->setCurrentPosition(0);
-                    if (elGangedDrive && elMotor2) elMotor2->setCurrentPosition(0);
-
-                    lsmReceiver.setElHomeRaw(lsmReceiver.getElevation());  // store raw home value
-                    lsmReceiver.resetElSmoothing();                        // reset smoothing
-
-                    elHomed = true;
-
-                    Serial.printf("[HOMING] Elevation homed. Raw=%.2f, Corrected=%.2f",
-                                    lsmReceiver.getElevation(), lsmReceiver.getElCorrected());
-                    WEB_LOG_INFOF("[HOMING]", "Elevation homed. Raw=%.2f, Corrected=%.2f",
-                                    lsmReceiver.getElevation(), lsmReceiver.getElCorrected());
-                    Serial.println("[HOMING] Elevation limit reached, position set to 0");
-                    WEB_LOG_INFO("[HOMING]", "Elevation limit reached, position set to 0");
-                    homingStage = HOMING_COMPLETE;
-/*
-                    moveElevationDeg(90.0f);
-                    Serial.println("[HOMING] Elevation homed, moving to 90 degrees...");
-                    Serial.println("[HOMING] Homing sequence complete!");
-*/
-                    // Reset the stop state for next homing
-                    elStopStarted = false;
-                }
-                break;
-
-
-
-        case HOMING_COMPLETE:
-            // nothing to do
-            break;
-
-        default:
-            break;
+void homeAll() {
+    if (!azMotor || !elMotor1) return;
+    beginRun();
+    if (!axisBusy(azHoming)) requestAzimuth();
+    if (!axisBusy(elHoming)) requestElevation();
+}
+
+void homeAzimuth() {
+    if (!azMotor || axisBusy(azHoming)) return;
+    beginRun();
+    requestAzimuth();
+}
+
+void homeElevation() {
+    if (!elMotor1 || axisBusy(elHoming)) return;
+    if (elHomingWaitsForAz && !azHomed && !axisBusy(azHoming)) {
+        WEB_LOG_WARNING("[HOMING]", "Elevation homing requires azimuth homed first");
+        return;
     }
+    beginRun();
+    requestElevation();
+}
+
+void abortHoming() {
+    azHoming.latchArmed = false;
+    elHoming.latchArmed = false;
+    if (axisBusy(azHoming)) azHoming.phase = AXIS_FAILED;
+    if (axisBusy(elHoming)) elHoming.phase = AXIS_FAILED;
+    scheduler.stop(&azHomingTask);
+    scheduler.stop(&elHomingTask);
+    homingStage = HOMING_IDLE;
+}
+
+// Outside homing the switch should only close near home; further out the
+// step count is wrong (lost steps) or the axis ran past its range
+static void checkLimitHit(AxisHoming& ax) {
+    if (homingStage == HOMING_RUNNING || !(isAz(ax) ? azHomed : elHomed)) return;
+    long steps = axisPosition(ax);
+    if (steps <= FLIGHT_LIMIT_MARGIN_DEG * stepsPerDegree) return;
+    Serial.printf("[%s LIMIT] Switch closed at %ld steps, expected near home\n", ax.name, steps);
+    WEB_LOG_WARNINGF("[HOMING]", "%s limit switch closed at %ld steps, expected near home", ax.name, steps);
+    flightRecorder.trigger(FLIGHT_TRIG_LIMIT);
+}
+
+void updateHoming() {
+    LATENCY_SCOPE("updateHoming");
+    ALLOC_FORBID();
+    // --- Update limit switches ---
+    if (updateLimit(azHoming, AZ_LIMIT_PIN)) checkLimitHit(azHoming);
+    if (updateLimit(elHoming, EL_LIMIT_PIN)) checkLimitHit(elHoming);
+
+    // The axis tasks run from the scheduler; only the run summary lives here
+    if (homingStage != HOMING_RUNNING) return;
+    if (axisBusy(azHoming) || axisBusy(elHoming)) return;
+
+    lastHomingDurationMs = millis() - homingStartMs;
+    bool failed = azHoming.phase == AXIS_FAILED || elHoming.phase == AXIS_FAILED;
+    homingStage = failed ? HOMING_IDLE : HOMING_COMPLETE;
+
+    Serial.printf("[HOMING] Homing %s in %lu ms (AZ %lu ms, EL %lu ms)\n",
+                  failed ? "failed" : "complete", lastHomingDurationMs,
+                  azHoming.stats.lastDurationMs, elHoming.stats.lastDurationMs);
+    WEB_LOG_INFOF("[HOMING]", "Homing %s in %lu ms (AZ %lu ms, EL %lu ms)",
+                  failed ? "failed" : "complete", lastHomingDurationMs,
+                  azHoming.stats.lastDurationMs, elHoming.stats.lastDurationMs);
 }
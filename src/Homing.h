@@ -1,6 +1,5 @@
 #pragma once
-#include <Arduino.h>
-#include "FastAccelStepper.h"
+#include "hal/Hal.h"
 #include "LSM303Receiver.h"
 #include "MotorControl.h"
 #include "WebLogger.h"
@@ -12,23 +11,80 @@ extern const int AZ_LIMIT_PIN;
 extern const int EL_LIMIT_PIN;
 
 // --- Motors ---
-extern FastAccelStepper* azMotor;
-extern FastAccelStepper* elMotor1;
-extern FastAccelStepper* elMotor2;
+extern Stepper* azMotor;
+extern Stepper* elMotor1;
+extern Stepper* elMotor2;
 extern bool elGangedDrive;
 
 // --- Homing state ---
+// Both axes home concurrently; the stage covers the whole run and each
+// axis has its own phase below.
 enum HomingStage {
     HOMING_IDLE,
-    HOMING_AZ_MOVING,
-    HOMING_AZ_PRE_HOME,
-    HOMING_EL_MOVING,
+    HOMING_RUNNING,
     HOMING_COMPLETE
 };
 
+// --- Per-axis two-speed sequence (each axis runs as its own scheduler task) ---
+enum AxisHomingPhase {
+    AXIS_IDLE,            // not part of the current homing run
+    AXIS_WAITING,         // held by the interlock (EL only)
+    AXIS_PRE_HOME,        // AZ only: returning to the safe window before homing
+    AXIS_FAST_APPROACH,   // fast move until the limit interrupt latches
+    AXIS_FAST_STOPPING,   // decelerating past the switch
+    AXIS_BACKOFF,         // moving off the switch
+    AXIS_SLOW_APPROACH,   // slow re-approach, this latch defines home
+    AXIS_SLOW_STOPPING,   // decelerating before the home offset is applied
+    AXIS_DONE,
+    AXIS_FAILED
+};
+
+// Repeatability across runs: "drift" is where the switch latched in the
+// previous home frame, so a perfectly repeatable axis reports 0.
+struct HomingStats {
+    uint32_t runs = 0;
+    uint32_t driftSamples = 0;
+    long lastDriftSteps = 0;
+    long minDriftSteps = 0;
+    long maxDriftSteps = 0;
+    float meanDriftSteps = 0.0f;
+    float m2 = 0.0f;                 // Welford running sum of squares
+    long lastFastSlowDelta = 0;      // fast latch minus slow latch (switch lag at speed)
+    unsigned long lastDurationMs = 0;
+
+    float stdDevSteps() const { return driftSamples > 1 ? sqrtf(m2 / (driftSamples - 1)) : 0.0f; }
+};
+
+struct AxisHoming {
+    const char* name = "";
+    int dir = -1;                     // +1 or -1
+    AxisHomingPhase phase = AXIS_IDLE;
+    bool limitState = false;          // debounced, active = switch closed
+    unsigned long limitLastChange = 0;
+    volatile bool latchArmed = false;
+    volatile bool latched = false;
+    volatile int32_t latchedSteps = 0;
+    volatile uint32_t latchedUs = 0;
+    long fastLatchSteps = 0;
+    bool haveFastLatch = false;
+    uint8_t backoffTries = 0;
+    bool wasHomed = false;
+    unsigned long startMs = 0;
+    HomingStats stats = {};
+};
+
 extern HomingStage homingStage;
 extern bool azHomed;
 extern bool elHomed;
+extern AxisHoming azHoming;
+extern AxisHoming elHoming;
+extern unsigned long lastHomingDurationMs;  // wall time of the last full run
+
+// --- Interlock ---
+// EL is always held while AZ unwinds from outside 0-360 deg (cable wrap).
+// Set this for installations where EL may only move once AZ is homed,
+// e.g. when the dish can foul the mast; homing is then serialized.
+extern bool elHomingWaitsForAz;
 
 // --- Homing directions ---
 extern int azHomingDir;  // +1 or -1
@@ -37,7 +93,17 @@ extern int elHomingDir;  // +1 or -1
 // --- Maximum homing distance in steps ---
 inline constexpr long MAX_HOMING_STEPS = 15000;
 
+// --- Two-speed homing profile ---
+inline constexpr uint32_t HOMING_FAST_SPEED_HZ = 1600;
+inline constexpr uint32_t HOMING_SLOW_SPEED_HZ = 150;
+inline constexpr long HOMING_BACKOFF_STEPS = 400;      // ~5 deg, must clear the switch hysteresis
+inline constexpr uint8_t HOMING_MAX_BACKOFFS = 3;
+inline constexpr uint32_t HOMING_LATCH_CONFIRM_US = 20000;  // latch must be backed by the debounced state
+
 // --- Functions ---
+void beginHoming();     // attach limit interrupts, call once motors exist
+void homeAll();         // home both axes concurrently
 void homeAzimuth();
 void homeElevation();
-void updateHoming();
+void abortHoming();
+void updateHoming();    // limit debounce and run summary, call from loop()
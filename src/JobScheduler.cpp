@@ -0,0 +1,308 @@
+// JobScheduler.cpp - persistent job queue on a timer wheel
+#include "JobScheduler.h"
+#include <stddef.h>
+#include <string.h>
+#include "Calibration.h"
+#include "Crc32.h"
+#include "Homing.h"
+#include "JsonWriter.h"
+#include "MotorControl.h"
+#include "NvsWriter.h"
+#include "ScanPattern.h"
+#include "Trajectory.h"
+#include "WallClock.h"
+#include "WebLogger.h"
+
+extern Calibration calib;
+extern bool rotctlConnected;
+
+JobScheduler jobScheduler;
+
+static const char* const JOB_KIND_NAMES[JOB_KINDS] = {"slew", "trajectory", "park", "calibrate"};
+
+// Far-off jobs are parked this many ticks out and re-hashed when reached
+static constexpr uint32_t JOB_MAX_DELAY_TICKS = 1u << 30;
+
+struct StoredJobs {
+    uint32_t magic;
+    uint32_t nextId;
+    Job jobs[JOB_MAX];
+    uint32_t crc;
+};
+
+static uint32_t jobsCrc(const StoredJobs& st) {
+    return crc32(reinterpret_cast<const uint8_t*>(&st), offsetof(StoredJobs, crc));
+}
+
+const char* jobKindName(uint8_t kind) {
+    return kind < JOB_KINDS ? JOB_KIND_NAMES[kind] : "?";
+}
+
+bool parseJobKind(const char* name, JobKind& kind) {
+    for (uint8_t k = 0; k < JOB_KINDS; k++) {
+        if (strcmp(name, JOB_KIND_NAMES[k]) == 0) {
+            kind = (JobKind)k;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobScheduler::begin() {
+    for (int8_t& h : _head) h = -1;
+    _tickMs = millis();
+    if (!_prefs.begin("jobs", false)) {
+        Serial.println("[JOBS] Failed to open NVS namespace");
+        WEB_LOG_ERROR("[JOBS]", "Failed to open NVS namespace");
+        return;
+    }
+    _ready = true;
+    _storeId = nvsWriter.add(&JobScheduler::flushQueue, this);
+
+    StoredJobs st;
+    if (_prefs.getBytes("queue", &st, sizeof(st)) == sizeof(st) &&
+        st.magic == JOB_MAGIC && st.crc == jobsCrc(st)) {
+        memcpy(_jobs, st.jobs, sizeof(_jobs));
+        _nextId = st.nextId;
+        WEB_LOG_INFOF("[JOBS]", "Loaded %u pending jobs", pending());
+    }
+    _lock.lock();
+    _clockGeneration = wallClock.generation();
+    reschedule();
+    _lock.unlock();
+}
+
+// --- Wheel, all with _lock held ---
+
+void JobScheduler::reschedule() {
+    for (int8_t& h : _head) h = -1;
+    for (bool& l : _linked) l = false;
+    if (!wallClock.valid()) return;   // held until the clock is set
+    uint64_t nowMs = wallClock.nowMs();
+    for (uint8_t i = 0; i < JOB_MAX; i++) {
+        if (!_jobs[i].id) continue;
+        int64_t delay = (int64_t)_jobs[i].atUnix * 1000 - (int64_t)nowMs;
+        schedule(i, delay > 0 ? (uint32_t)(delay < (int64_t)UINT32_MAX ? delay : UINT32_MAX) : 0);
+    }
+}
+
+void JobScheduler::schedule(uint8_t i, uint32_t delayMs) {
+    if (_linked[i]) unlink(i);
+    uint32_t ticks = (uint32_t)(((uint64_t)delayMs + JOB_TICK_MS - 1) / JOB_TICK_MS);
+    if (ticks == 0) ticks = 1;   // this tick's slot has been visited
+    if (ticks > JOB_MAX_DELAY_TICKS) ticks = JOB_MAX_DELAY_TICKS;
+    _dueTick[i] = _tick + ticks;
+    uint16_t slot = _dueTick[i] % JOB_WHEEL_SLOTS;
+    _next[i] = _head[slot];
+    _head[slot] = i;
+    _linked[i] = true;
+}
+
+void JobScheduler::unlink(uint8_t i) {
+    for (int8_t* p = &_head[_dueTick[i] % JOB_WHEEL_SLOTS]; *p >= 0; p = &_next[*p]) {
+        if (*p == i) {
+            *p = _next[i];
+            break;
+        }
+    }
+    _linked[i] = false;
+}
+
+void JobScheduler::visitSlot(uint16_t slot, uint8_t* due, uint8_t& dueCount) {
+    int8_t* p = &_head[slot];
+    while (*p >= 0) {
+        uint8_t i = *p;
+        if ((int32_t)(_tick - _dueTick[i]) < 0) {   // a later turn of the wheel
+            p = &_next[i];
+            continue;
+        }
+        *p = _next[i];
+        _linked[i] = false;
+        due[dueCount++] = i;
+    }
+}
+
+void JobScheduler::persist() {
+    if (_ready) nvsWriter.request(_storeId);
+}
+
+// --- NvsWriter task: snapshot under the lock, write outside it ---
+
+void JobScheduler::flushQueue(void* ctx) {
+    JobScheduler* self = static_cast<JobScheduler*>(ctx);
+    StoredJobs st;
+    st.magic = JOB_MAGIC;
+    self->_lock.lock();
+    st.nextId = self->_nextId;
+    memcpy(st.jobs, self->_jobs, sizeof(self->_jobs));
+    self->_lock.unlock();
+    st.crc = jobsCrc(st);
+    if (self->_prefs.putBytes("queue", &st, sizeof(st)) != sizeof(st)) {
+        WEB_LOG_ERROR("[JOBS]", "Storing the job queue failed");
+    }
+}
+
+// --- Execution ---
+
+bool JobScheduler::ready(const Job& job) const {
+    if (homingStage != HOMING_COMPLETE || calib.isRunning()) return false;
+    if (job.kind != JOB_CALIBRATE) return true;
+    return !trajectory.isRunning() && !scanRunner.isRunning() && !rotctlConnected && areMotorsReady();
+}
+
+void JobScheduler::run(const Job& job, uint32_t lateMs) {
+    switch (job.kind) {
+        case JOB_SLEW:
+        case JOB_PARK:
+            trajectory.stop();
+            scanRunner.stop();
+            moveAzimuthToPosition(job.az);
+            moveElevationToPosition(job.el);
+            break;
+        case JOB_TRAJECTORY:
+            trajectory.start(lateMs);
+            break;
+        case JOB_CALIBRATE:
+            calib.start();
+            break;
+    }
+    _executed++;
+    Serial.printf("[JOBS] #%lu %s ran %lu ms after its time\n",
+                  (unsigned long)job.id, jobKindName(job.kind), (unsigned long)lateMs);
+    WEB_LOG_INFOF("[JOBS]", "#%lu %s ran %lu ms after its time",
+                  (unsigned long)job.id, jobKindName(job.kind), (unsigned long)lateMs);
+}
+
+void JobScheduler::update() {
+    uint32_t now = millis();
+    if (now - _tickMs < JOB_TICK_MS) return;
+    uint32_t ticks = (now - _tickMs) / JOB_TICK_MS;
+    _tickMs += ticks * JOB_TICK_MS;
+    wallClock.update();
+
+    uint8_t due[JOB_MAX];
+    uint8_t dueCount = 0;
+    _lock.lock();
+    if (wallClock.generation() != _clockGeneration) {
+        _clockGeneration = wallClock.generation();
+        reschedule();
+    }
+    // After a stall longer than a turn every slot is visited once
+    uint32_t visits = ticks < JOB_WHEEL_SLOTS ? ticks : JOB_WHEEL_SLOTS;
+    _tick += ticks;
+    for (uint32_t k = visits; k-- > 0;) visitSlot((_tick - k) % JOB_WHEEL_SLOTS, due, dueCount);
+    _lock.unlock();
+    if (dueCount == 0) return;
+
+    uint64_t nowMs = wallClock.nowMs();
+    for (uint8_t d = 0; d < dueCount; d++) {
+        uint8_t i = due[d];
+        _lock.lock();
+        Job job = _jobs[i];
+        int64_t lateMs = (int64_t)nowMs - (int64_t)job.atUnix * 1000;
+        bool early = lateMs < -(int64_t)JOB_TICK_MS;   // capped delay or a clock drift
+        bool expired = (job.kind == JOB_SLEW && lateMs > (int64_t)JOB_LATE_LIMIT_S * 1000) ||
+                       (job.kind == JOB_TRAJECTORY && lateMs >= (int64_t)(trajectory.durationSec() * 1000.0f));
+        bool go = job.id && !early && !expired && ready(job);
+        if (job.id && !go && !expired) {
+            schedule(i, early ? (uint32_t)(-lateMs < (int64_t)UINT32_MAX ? -lateMs : UINT32_MAX) : JOB_RECHECK_MS);
+        } else if (job.id) {
+            _jobs[i] = Job();
+            persist();
+        }
+        _lock.unlock();
+
+        if (go) {
+            run(job, (uint32_t)(lateMs > 0 ? lateMs : 0));
+        } else if (job.id && expired) {
+            _missed++;
+            Serial.printf("[JOBS] #%lu %s missed by %lld ms, dropped\n",
+                          (unsigned long)job.id, jobKindName(job.kind), (long long)lateMs);
+            WEB_LOG_WARNINGF("[JOBS]", "#%lu %s missed by %lld ms, dropped",
+                             (unsigned long)job.id, jobKindName(job.kind), (long long)lateMs);
+        }
+    }
+}
+
+// --- Queue ---
+
+uint32_t JobScheduler::add(JobKind kind, uint32_t atUnix, float az, float el) {
+    if (kind >= JOB_KINDS || !wallClock.valid()) return 0;
+    _lock.lock();
+    uint8_t i = 0;
+    while (i < JOB_MAX && _jobs[i].id) i++;
+    if (i == JOB_MAX) {
+        _lock.unlock();
+        return 0;
+    }
+    Job& job = _jobs[i];
+    job = Job();
+    job.id = _nextId++;
+    if (_nextId == 0) _nextId = 1;
+    job.atUnix = atUnix;
+    job.kind = kind;
+    job.az = constrain(az, MIN_AZ, MAX_AZ);
+    job.el = constrain(el, MIN_EL, MAX_EL);
+    int64_t delay = (int64_t)atUnix * 1000 - (int64_t)wallClock.nowMs();
+    schedule(i, delay > 0 ? (uint32_t)(delay < (int64_t)UINT32_MAX ? delay : UINT32_MAX) : 0);
+    persist();
+    uint32_t id = job.id;
+    _lock.unlock();
+
+    WEB_LOG_INFOF("[JOBS]", "#%lu %s queued for %lu", (unsigned long)id, jobKindName(kind),
+                  (unsigned long)atUnix);
+    return id;
+}
+
+bool JobScheduler::cancel(uint32_t id) {
+    if (id == 0) return false;
+    _lock.lock();
+    bool found = false;
+    for (uint8_t i = 0; i < JOB_MAX; i++) {
+        if (_jobs[i].id != id) continue;
+        if (_linked[i]) unlink(i);
+        _jobs[i] = Job();
+        persist();
+        found = true;
+    }
+    _lock.unlock();
+    if (found) WEB_LOG_INFOF("[JOBS]", "#%lu cancelled", (unsigned long)id);
+    return found;
+}
+
+uint8_t JobScheduler::pending() const {
+    uint8_t n = 0;
+    for (const Job& job : _jobs) n += job.id ? 1 : 0;
+    return n;
+}
+
+void JobScheduler::writeJSON(JsonWriter& json) const {
+    uint32_t now = wallClock.now();
+    json.beginObject();
+    json.key("clock").beginObject();
+    json.kv("source", clockSourceName(wallClock.source()));
+    json.kv("unix", now);
+    json.endObject();
+    Job jobs[JOB_MAX];
+    _lock.lock();
+    memcpy(jobs, _jobs, sizeof(jobs));
+    _lock.unlock();
+    json.key("jobs").beginArray();
+    for (const Job& job : jobs) {
+        if (!job.id) continue;
+        json.beginObject();
+        json.kv("id", job.id);
+        json.kv("kind", jobKindName(job.kind));
+        json.kv("at", job.atUnix);
+        if (now) json.kv("inSec", (int64_t)job.atUnix - (int64_t)now);
+        if (job.kind == JOB_SLEW || job.kind == JOB_PARK) {
+            json.kv("az", job.az, 2);
+            json.kv("el", job.el, 2);
+        }
+        json.endObject();
+    }
+    json.endArray();
+    json.kv("executed", _executed);
+    json.kv("missed", _missed);
+    json.endObject();
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <stdint.h>
+#include "hal/Hal.h"
+
+class JsonWriter;
+
+// --- Timed jobs ---
+// Pre-positioning, trajectory starts, parking and calibration run from a
+// queue on the device, so a pass still starts when the PC or Wi-Fi is
+// gone. Jobs are due at a unix time (WallClock.h) and the queue is kept
+// in NVS; after a reboot, jobs are rescheduled once the clock is valid.
+//
+// Due jobs come off a hashed timer wheel: each job sits in the slot of
+// its due tick, loop() only compares millis() until the next
+// JOB_TICK_MS boundary, and each tick looks at one slot. A clock step
+// re-hashes the queue.
+//
+// A job that cannot run yet (motion jobs while homing or calibrating,
+// calibration while anything moves or a rotctl client is connected) is
+// retried every JOB_RECHECK_MS. Slews are dropped once JOB_LATE_LIMIT_S
+// late, a trajectory once its last point has passed (until then it joins
+// where it would be); parking and calibration run however late.
+//
+// Queue changes are written to NVS by the NvsWriter task, never under
+// _lock, so neither loop() nor a web handler waits on a flash erase.
+inline constexpr uint8_t JOB_MAX = 16;
+inline constexpr uint32_t JOB_TICK_MS = 100;
+inline constexpr uint16_t JOB_WHEEL_SLOTS = 64;
+inline constexpr uint32_t JOB_RECHECK_MS = 1000;
+inline constexpr uint32_t JOB_LATE_LIMIT_S = 60;
+inline constexpr float JOB_PARK_AZ_DEG = 0.0f;    // the homed position
+inline constexpr float JOB_PARK_EL_DEG = 0.0f;
+inline constexpr uint32_t JOB_MAGIC = 0x4A4F4231;  // "JOB1"
+
+enum JobKind : uint8_t { JOB_SLEW, JOB_TRAJECTORY, JOB_PARK, JOB_CALIBRATE, JOB_KINDS };
+
+struct Job {
+    uint32_t id;        // 0 = free slot
+    uint32_t atUnix;
+    uint8_t kind;
+    uint8_t reserved[3];
+    float az;           // JOB_SLEW and JOB_PARK
+    float el;
+};
+
+class JobScheduler {
+public:
+    void begin();       // loads the queue, after the motors and trajectory
+    void update();      // from loop()
+
+    // Job id, 0 when the queue is full, the clock is not set or the
+    // kind is unknown. Angles are clamped like rotctl's P.
+    uint32_t add(JobKind kind, uint32_t atUnix, float az = 0.0f, float el = 0.0f);
+    bool cancel(uint32_t id);
+
+    uint8_t pending() const;
+    uint32_t executed() const { return _executed; }
+    uint32_t missed() const { return _missed; }
+
+    // {"clock":{...},"jobs":[...],"executed":..,"missed":..}
+    void writeJSON(JsonWriter& json) const;
+
+private:
+    void reschedule();
+    void schedule(uint8_t i, uint32_t delayMs);
+    void unlink(uint8_t i);
+    void visitSlot(uint16_t slot, uint8_t* due, uint8_t& dueCount);
+    void persist();                     // with _lock held; queues the write
+    static void flushQueue(void* ctx);  // NvsWriter task
+    bool ready(const Job& job) const;
+    void run(const Job& job, uint32_t lateMs);
+
+    NvStore _prefs;
+    bool _ready = false;
+    int8_t _storeId = -1;
+    mutable hal::Mutex _lock;           // table and wheel
+    Job _jobs[JOB_MAX] = {};
+    uint32_t _nextId = 1;
+
+    // Wheel: singly linked per slot, -1 terminated
+    int8_t _head[JOB_WHEEL_SLOTS];
+    int8_t _next[JOB_MAX];
+    uint32_t _dueTick[JOB_MAX] = {};
+    bool _linked[JOB_MAX] = {};
+    uint32_t _tick = 0;
+    uint32_t _tickMs = 0;
+    uint32_t _clockGeneration = 0;
+
+    uint32_t _executed = 0;
+    uint32_t _missed = 0;
+};
+
+extern JobScheduler jobScheduler;
+
+const char* jobKindName(uint8_t kind);
+bool parseJobKind(const char* name, JobKind& kind);
@@ -0,0 +1,214 @@
+#pragma once
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+
+// Streaming JSON writer with no heap use.
+//
+// Output is staged in a small internal buffer and handed to a sink
+// callback whenever it fills, so a response of any size costs one fixed
+// buffer. Commas between members and elements are inserted automatically.
+//
+//   JsonWriter w(sink, ctx);
+//   w.beginObject();
+//   w.kv("az", azDeg, 1);
+//   w.key("stats"); w.beginArray(); w.value(3); w.endArray();
+//   w.endObject();
+//   w.flush();
+//
+// JsonBuffer is the same writer over a caller-provided char array; output
+// that does not fit is dropped and reported by overflowed().
+class JsonWriter {
+public:
+    typedef void (*Sink)(void* ctx, const char* data, size_t len);
+
+    static constexpr uint8_t MAX_DEPTH = 8;
+    static constexpr size_t STAGE_LEN = 128;
+
+    JsonWriter(Sink sink, void* ctx) : _sink(sink), _ctx(ctx) {}
+    ~JsonWriter() { flush(); }
+
+    JsonWriter& beginObject() { open('{'); return *this; }
+    JsonWriter& endObject() { close('}'); return *this; }
+    JsonWriter& beginArray() { open('['); return *this; }
+    JsonWriter& endArray() { close(']'); return *this; }
+
+    JsonWriter& key(const char* k) {
+        separate();
+        putString(k);
+        put(':');
+        _afterKey = true;
+        return *this;
+    }
+
+    JsonWriter& value(const char* s) {
+        separate();
+        if (s) putString(s); else write("null", 4);
+        return *this;
+    }
+    JsonWriter& value(bool b) {
+        separate();
+        if (b) write("true", 4); else write("false", 5);
+        return *this;
+    }
+    template <typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+    JsonWriter& value(T v) {
+        if constexpr (std::is_signed_v<T>) return number("%lld", (long long)v);
+        else return number("%llu", (unsigned long long)v);
+    }
+    // NaN and infinities are not JSON; they become null
+    JsonWriter& value(double v, uint8_t decimals = 2) {
+        if (isnan(v) || isinf(v)) {
+            separate();
+            write("null", 4);
+            return *this;
+        }
+        return number("%.*f", (int)decimals, v);
+    }
+
+    // Pre-serialized JSON (an object, array or literal) inserted as a value
+    JsonWriter& raw(const char* json) {
+        separate();
+        write(json, strlen(json));
+        return *this;
+    }
+
+    template <typename T>
+    JsonWriter& kv(const char* k, T v) { key(k); return value(v); }
+    JsonWriter& kv(const char* k, double v, uint8_t decimals) { key(k); return value(v, decimals); }
+
+    void flush() {
+        if (_staged && _sink) _sink(_ctx, _stage, _staged);
+        _staged = 0;
+    }
+
+    // Total bytes produced, including what is still staged
+    size_t bytesWritten() const { return _total; }
+
+    // Writes s with quotes and escapes; used for keys and string values
+    void putString(const char* s) {
+        put('"');
+        const char* run = s;
+        for (; *s; s++) {
+            uint8_t c = (uint8_t)*s;
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            write(run, s - run);
+            run = s + 1;
+            char esc[7];
+            size_t n = 2;
+            esc[0] = '\\';
+            switch (c) {
+                case '"':  esc[1] = '"'; break;
+                case '\\': esc[1] = '\\'; break;
+                case '\n': esc[1] = 'n'; break;
+                case '\r': esc[1] = 'r'; break;
+                case '\t': esc[1] = 't'; break;
+                default:   n = snprintf(esc, sizeof(esc), "\\u%04x", c); break;
+            }
+            write(esc, n);
+        }
+        write(run, s - run);
+        put('"');
+    }
+
+protected:
+    void write(const char* data, size_t len) {
+        _total += len;
+        while (len) {
+            size_t room = STAGE_LEN - _staged;
+            size_t n = len < room ? len : room;
+            memcpy(_stage + _staged, data, n);
+            _staged += n;
+            data += n;
+            len -= n;
+            if (_staged == STAGE_LEN) flush();
+        }
+    }
+
+private:
+    void put(char c) { write(&c, 1); }
+
+    template <typename... Args>
+    JsonWriter& number(const char* fmt, Args... args) {
+        separate();
+        char buf[32];
+        int n = snprintf(buf, sizeof(buf), fmt, args...);
+        if (n > 0) write(buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+        return *this;
+    }
+
+    // Comma before every member or element but the first
+    void separate() {
+        if (_afterKey) {
+            _afterKey = false;
+            return;
+        }
+        if (_depth == 0) return;
+        if (_hasItems & (1u << (_depth - 1))) put(',');
+        _hasItems |= (1u << (_depth - 1));
+    }
+
+    void open(char c) {
+        separate();
+        put(c);
+        if (_depth < MAX_DEPTH) {
+            _depth++;
+            _hasItems &= ~(1u << (_depth - 1));
+        }
+    }
+
+    void close(char c) {
+        if (_depth > 0) _depth--;
+        put(c);
+    }
+
+    Sink _sink;
+    void* _ctx;
+    char _stage[STAGE_LEN];
+    size_t _staged = 0;
+    size_t _total = 0;
+    uint8_t _depth = 0;
+    uint8_t _hasItems = 0;     // bit per open level
+    bool _afterKey = false;
+};
+
+class JsonBuffer : public JsonWriter {
+public:
+    JsonBuffer(char* out, size_t len) : JsonWriter(&JsonBuffer::append, &_target) {
+        _target.out = out;
+        _target.len = len;
+        if (len) out[0] = '\0';
+    }
+    ~JsonBuffer() { flush(); }
+
+    // Flushes and returns the terminated text
+    const char* c_str() {
+        flush();
+        return _target.out;
+    }
+    size_t length() { flush(); return _target.used; }
+    bool overflowed() { flush(); return _target.overflow; }
+
+private:
+    struct Target {
+        char* out;
+        size_t len;
+        size_t used = 0;
+        bool overflow = false;
+    };
+
+    static void append(void* ctx, const char* data, size_t n) {
+        Target* t = static_cast<Target*>(ctx);
+        if (t->len == 0) { t->overflow = true; return; }
+        size_t room = t->len - 1 - t->used;
+        if (n > room) { n = room; t->overflow = true; }
+        memcpy(t->out + t->used, data, n);
+        t->used += n;
+        t->out[t->used] = '\0';
+    }
+
+    Target _target;
+};
@@ -1,9 +1,11 @@
 #include "LSM303Receiver.h"
 #include <math.h>
-#include <Arduino.h>
 #include "Config.h"
 #include "MathUtils.h"
 #include "WebLogger.h"
+#include "Latency.h"
+#include "AllocTracker.h"
+#include "SensorRecorder.h"
 #define SMOOTHING_ALPHA 0.2f
 
 float magneticDeclinationDeg = MAGNETIC_DECLINATION;
@@ -52,6 +54,8 @@ void LSM303Receiver::resetCalibration() {
 }
 
 void LSM303Receiver::update() {
+    LATENCY_SCOPE("lsm.update");
+    ALLOC_SCOPE(ALLOC_SENSOR);
     if (!_ready) return;
     int packetSize = _udp.parsePacket();
     if (packetSize > 0) {
@@ -66,7 +70,17 @@ void LSM303Receiver::update() {
 
 void LSM303Receiver::processPacket(const char* packet, int len) {
     float mx,my,mz,ax,ay,az_raw;
-    if (sscanf(packet,"MAG:%f,%f,%f;ACC:%f,%f,%f",&mx,&my,&mz,&ax,&ay,&az_raw)==6) {
+    bool parsed = sscanf(packet,"MAG:%f,%f,%f;ACC:%f,%f,%f",&mx,&my,&mz,&ax,&ay,&az_raw)==6;
+    if (_recorder) {
+        if (parsed) {
+            const float mag[3] = {mx, my, mz};
+            const float acc[3] = {ax, ay, az_raw};
+            _recorder->record(micros(), mag, acc);
+        } else {
+            _recorder->recordMalformed(micros());
+        }
+    }
+    if (parsed) {
 
         // tilt compensation
         float ax_n=ax, ay_n=ay, az_n=az_raw;
@@ -84,6 +98,11 @@ void LSM303Receiver::processPacket(const char* packet, int len) {
 
         float elevation = atan2(az_raw, sqrt(ax*ax+ay*ay))*180.0f/PI;
 
+        _rawAz = heading;
+        _rawEl = elevation;
+        _packetCount++;
+        if (_sampleHook) _sampleHook(heading, elevation, _sampleHookCtx);
+
         // --- Calibration capture ---
         if(_calibrating){
             bool updated = false;
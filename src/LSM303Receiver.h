@@ -1,5 +1,10 @@
 #pragma once
-#include <WiFiUdp.h>
+#include "hal/Hal.h"
+
+class SensorRecorder;
+
+// Called for every decoded packet with the uncalibrated heading/elevation
+typedef void (*LSMSampleHook)(float rawAz, float rawEl, void* ctx);
 
 class LSM303Receiver {
 public:
@@ -11,6 +16,9 @@ public:
     float getElevation() const;
     float getElCorrected() const;
     unsigned long getLastUpdate() const;
+    float getRawAzimuth() const { return _rawAz; }    // last heading before calibration/smoothing
+    float getRawElevation() const { return _rawEl; }  // last elevation before calibration/smoothing
+    uint32_t getPacketCount() const { return _packetCount; }
 
     void setElHomeOffset(float offset);
     float getElHomeOffset() const { return _elHomeOffset; }
@@ -27,17 +35,27 @@ public:
     void stopCalibration();
     void resetCalibration();
     bool isCalibrating() const { return _calibrating; }
+    void setSampleHook(LSMSampleHook hook, void* ctx) { _sampleHook = hook; _sampleHookCtx = ctx; }
+    void setRecorder(SensorRecorder* recorder) { _recorder = recorder; }   // raw packet capture
 
-private:
+    // Decodes one NUL-terminated packet as update() does (benchmarks)
     void processPacket(const char* packet, int len);
 
+private:
+
     uint16_t _port;
-    WiFiUDP _udp;
+    UdpSocket _udp;
     bool _ready = false;
 
     float _az = 0.0f;
     float _el = 0.0f;
     unsigned long _lastUpdate = 0;
+    float _rawAz = 0.0f;
+    float _rawEl = 0.0f;
+    uint32_t _packetCount = 0;
+    LSMSampleHook _sampleHook = nullptr;
+    void* _sampleHookCtx = nullptr;
+    SensorRecorder* _recorder = nullptr;
 
     // --- Calibration ---
     bool _calibrating = false;
@@ -0,0 +1,98 @@
+// Latency.cpp - histogram registry and its REST / Prometheus output
+#include "Latency.h"
+#include "JsonWriter.h"
+
+LatencyRegistry latencyRegistry;
+
+uint32_t LatencyHistogram::percentileUs(float p) const {
+    if (count == 0) return 0;
+    uint32_t target = (uint32_t)(p * count);
+    if (target >= count) target = count - 1;
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen > target) return latencyBucketLimitUs(b) ? latencyBucketLimitUs(b) : maxUs;
+    }
+    return maxUs;
+}
+
+// A sample recorded concurrently may survive half-counted; good enough
+// for a diagnostics reset
+void LatencyHistogram::reset() {
+    memset(buckets, 0, sizeof(buckets));
+    count = 0;
+    sumUs = 0;
+    maxUs = 0;
+}
+
+LatencyHistogram* LatencyRegistry::add(const char* name) {
+    uint8_t i = _count.fetch_add(1);
+    if (i >= LATENCY_MAX_SITES) {
+        _count.store(LATENCY_MAX_SITES);
+        Serial.printf("[LAT] No free histogram for %s\n", name);
+        return nullptr;
+    }
+    if (i == 0) _cyclesPerUs = getCpuFrequencyMhz();
+    _sites[i].name = name;
+    return &_sites[i];
+}
+
+size_t LatencyRegistry::size() const {
+    uint8_t n = _count.load();
+    return n < LATENCY_MAX_SITES ? n : LATENCY_MAX_SITES;
+}
+
+const LatencyHistogram* LatencyRegistry::at(size_t i) const {
+    return _sites[i].name ? &_sites[i] : nullptr;
+}
+
+void LatencyRegistry::resetAll() {
+    for (size_t i = 0; i < size(); i++) _sites[i].reset();
+}
+
+void writeLatencyJSON(JsonWriter& json) {
+    json.beginObject();
+    json.kv("enabled", LATENCY_PROFILING != 0);
+    json.kv("cpuMHz", latencyRegistry.cyclesPerUs());
+    json.key("bucketLimitsUs").beginArray();
+    for (uint8_t b = 0; b + 1 < LATENCY_BUCKETS; b++) json.value(latencyBucketLimitUs(b));
+    json.endArray();
+
+    json.key("sites").beginArray();
+    for (size_t i = 0; i < latencyRegistry.size(); i++) {
+        const LatencyHistogram* h = latencyRegistry.at(i);
+        if (!h) continue;
+        json.beginObject();
+        json.kv("name", h->name);
+        json.kv("count", h->count);
+        json.kv("meanUs", h->count ? (double)h->sumUs / h->count : 0.0, 1);
+        json.kv("maxUs", h->maxUs);
+        json.kv("p50Us", h->percentileUs(0.50f));
+        json.kv("p99Us", h->percentileUs(0.99f));
+        json.key("buckets").beginArray();
+        for (uint8_t b = 0; b < LATENCY_BUCKETS; b++) json.value(h->buckets[b]);
+        json.endArray();
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+}
+
+void writeLatencyMetrics(Print& out) {
+    if (latencyRegistry.size() == 0) return;
+    out.print("# HELP rotator_latency_seconds Loop, task and handler run time\n"
+              "# TYPE rotator_latency_seconds histogram\n");
+    for (size_t i = 0; i < latencyRegistry.size(); i++) {
+        const LatencyHistogram* h = latencyRegistry.at(i);
+        if (!h) continue;
+        uint32_t cumulative = 0;
+        for (uint8_t b = 0; b + 1 < LATENCY_BUCKETS; b++) {
+            cumulative += h->buckets[b];
+            out.printf("rotator_latency_seconds_bucket{site=\"%s\",le=\"%g\"} %lu\n",
+                       h->name, latencyBucketLimitUs(b) / 1e6, (unsigned long)cumulative);
+        }
+        out.printf("rotator_latency_seconds_bucket{site=\"%s\",le=\"+Inf\"} %lu\n", h->name, (unsigned long)h->count);
+        out.printf("rotator_latency_seconds_sum{site=\"%s\"} %.6f\n", h->name, h->sumUs / 1e6);
+        out.printf("rotator_latency_seconds_count{site=\"%s\"} %lu\n", h->name, (unsigned long)h->count);
+    }
+}
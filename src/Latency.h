@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include "hal/Hal.h"
+
+class JsonWriter;
+class Print;
+
+// --- Latency histograms ---
+// LATENCY_SCOPE("name") at the top of a block times the rest of the block
+// with the CPU cycle counter and adds it to a fixed log-scale histogram:
+// bucket i holds durations in [2^(i-1), 2^i) us, bucket 0 is < 1 us and
+// the last bucket is open-ended. One scope per block; the histogram is
+// registered on first use and costs nothing to look up afterwards.
+//
+// Build with -D LATENCY_PROFILING=0 to compile every scope out.
+//
+// The cycle counter is per core. Sites on tasks that are not pinned can
+// occasionally record a nonsense value if the task migrates mid-scope;
+// such samples land in the open-ended bucket.
+#ifndef LATENCY_PROFILING
+#define LATENCY_PROFILING 1
+#endif
+
+inline constexpr uint8_t LATENCY_BUCKETS = 20;     // last bucket starts at 2^18 us (262 ms)
+inline constexpr uint8_t LATENCY_MAX_SITES = 48;
+
+struct LatencyHistogram {
+    const char* name = nullptr;
+    uint32_t buckets[LATENCY_BUCKETS] = {};
+    uint32_t count = 0;
+    uint64_t sumUs = 0;
+    uint32_t maxUs = 0;
+
+    void record(uint32_t us) {
+        uint8_t b = us ? 32 - __builtin_clz(us) : 0;
+        if (b >= LATENCY_BUCKETS) b = LATENCY_BUCKETS - 1;
+        buckets[b]++;
+        count++;
+        sumUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+
+    // Upper bound of the bucket that holds the p-th fraction of samples
+    uint32_t percentileUs(float p) const;
+    void reset();
+};
+
+// Upper bound of bucket b in us; the last bucket has none (returns 0)
+inline uint32_t latencyBucketLimitUs(uint8_t b) {
+    return b + 1 < LATENCY_BUCKETS ? (1u << b) : 0;
+}
+
+class LatencyRegistry {
+public:
+    // Safe from any task; nullptr once all sites are taken
+    LatencyHistogram* add(const char* name);
+
+    size_t size() const;
+    const LatencyHistogram* at(size_t i) const;   // nullptr while still registering
+    void resetAll();
+
+    uint32_t cyclesPerUs() const { return _cyclesPerUs; }
+
+private:
+    LatencyHistogram _sites[LATENCY_MAX_SITES];
+    std::atomic<uint8_t> _count{0};
+    uint32_t _cyclesPerUs = 240;
+};
+
+extern LatencyRegistry latencyRegistry;
+
+class LatencyScope {
+public:
+    explicit LatencyScope(LatencyHistogram* h) : _h(h), _start(hal::cycleCount()) {}
+    ~LatencyScope() {
+        if (_h) _h->record((hal::cycleCount() - _start) / latencyRegistry.cyclesPerUs());
+    }
+    LatencyScope(const LatencyScope&) = delete;
+    LatencyScope& operator=(const LatencyScope&) = delete;
+
+private:
+    LatencyHistogram* _h;
+    uint32_t _start;
+};
+
+#if LATENCY_PROFILING
+#define LATENCY_SCOPE(name) \
+    static LatencyHistogram* const _latencySite = latencyRegistry.add(name); \
+    LatencyScope _latencyScope(_latencySite)
+#else
+#define LATENCY_SCOPE(name) do {} while (0)
+#endif
+
+// /latency body and the /metrics histogram family
+void writeLatencyJSON(JsonWriter& json);
+void writeLatencyMetrics(Print& out);
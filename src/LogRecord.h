@@ -0,0 +1,200 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+
+// Deferred log record: the format string pointer plus raw arguments.
+//
+// Logging only copies the arguments; the text is produced by
+// formatLogRecord() when somebody reads the log. The format string must
+// therefore have static storage (the WEB_LOG_* macros only accept string
+// literals). String arguments are copied into a small per-record pool
+// because callers often pass String::c_str() temporaries.
+
+inline constexpr uint8_t LOG_MAX_ARGS = 8;
+inline constexpr size_t LOG_STR_POOL = 64;
+
+// Copies s into dst up to max characters and terminates it. The loop
+// stops at the source's own terminator, so a short source is never read
+// past its end; returns the number of characters copied.
+inline size_t copyLogString(char* dst, const char* s, size_t max) {
+    size_t n = 0;
+    for (; n < max && s[n]; n++) dst[n] = s[n];
+    dst[n] = '\0';
+    return n;
+}
+
+enum LogArgType : uint8_t {
+    LOG_ARG_INT,
+    LOG_ARG_UINT,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_STR,    // offset into pool
+    LOG_ARG_PTR
+};
+
+struct LogRecord {
+    const char* fmt;
+    bool verbatim;              // fmt is plain text, not a format
+    uint8_t argc;
+    uint8_t poolUsed;
+    uint8_t types[LOG_MAX_ARGS];
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        const void* p;
+        uint16_t str;
+    } args[LOG_MAX_ARGS];
+    char pool[LOG_STR_POOL];
+
+    void begin(const char* format, bool plain) {
+        fmt = format;
+        verbatim = plain;
+        argc = 0;
+        poolUsed = 0;
+    }
+
+    template <typename T>
+    void add(T value) {
+        if (argc >= LOG_MAX_ARGS) return;
+        uint8_t n = argc++;
+        if constexpr (std::is_floating_point_v<T>) {
+            types[n] = LOG_ARG_DOUBLE;
+            args[n].d = value;
+        } else if constexpr (std::is_enum_v<T>) {
+            types[n] = LOG_ARG_INT;
+            args[n].i = (int64_t)value;
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            types[n] = LOG_ARG_INT;
+            args[n].i = value;
+        } else if constexpr (std::is_integral_v<T>) {
+            types[n] = LOG_ARG_UINT;
+            args[n].u = value;
+        } else if constexpr (std::is_convertible_v<T, const char*>) {
+            types[n] = LOG_ARG_STR;
+            args[n].str = poolUsed;
+            copyString(value ? (const char*)value : "(null)");
+        } else {
+            types[n] = LOG_ARG_PTR;
+            args[n].p = (const void*)value;
+        }
+    }
+
+    template <typename... Args>
+    void capture(const char* format, Args... values) {
+        begin(format, false);
+        (add(values), ...);
+    }
+
+private:
+    // Truncates when the pool is full; the last byte is always a terminator
+    void copyString(const char* s) {
+        size_t room = LOG_STR_POOL - poolUsed;
+        if (room == 0) {
+            args[argc - 1].str = LOG_STR_POOL - 1;
+            return;
+        }
+        poolUsed += copyLogString(pool + poolUsed, s, room - 1) + 1;
+    }
+};
+
+// Renders a record into out (always terminated). Each conversion is
+// formatted with the type that was captured, so %ld, %lu, %d and %u all
+// work regardless of the argument width. A conversion without a matching
+// argument is copied through as text.
+inline size_t formatLogRecord(const LogRecord& r, char* out, size_t len) {
+    if (len == 0) return 0;
+    out[0] = '\0';
+    if (!r.fmt) return 0;
+    if (r.verbatim) {
+        return copyLogString(out, r.fmt, len - 1);
+    }
+
+    size_t pos = 0;
+    uint8_t next = 0;
+    const char* f = r.fmt;
+    auto emit = [&](const char* s, size_t n) {
+        if (pos + 1 >= len) return;
+        if (n > len - 1 - pos) n = len - 1 - pos;
+        memcpy(out + pos, s, n);
+        pos += n;
+        out[pos] = '\0';
+    };
+
+    while (*f && pos + 1 < len) {
+        if (*f != '%') {
+            const char* run = f;
+            while (*f && *f != '%') f++;
+            emit(run, f - run);
+            continue;
+        }
+        if (f[1] == '%') {
+            emit("%", 1);
+            f += 2;
+            continue;
+        }
+
+        // Collect flags/width/precision, drop length modifiers
+        const char* specStart = f++;
+        char spec[16];
+        size_t s = 0;
+        spec[s++] = '%';
+        while (*f && strchr("-+ #0123456789.", *f)) {
+            if (s < sizeof(spec) - 4) spec[s++] = *f;
+            f++;
+        }
+        while (*f && strchr("hlLqjzt", *f)) f++;
+        char conv = *f;
+        if (!conv) {
+            emit(specStart, f - specStart);
+            break;
+        }
+        f++;
+
+        if (next >= r.argc || strchr("diouxXcsfFeEgGaAp", conv) == nullptr) {
+            emit(specStart, f - specStart);
+            continue;
+        }
+
+        uint8_t type = r.types[next];
+        const auto& a = r.args[next++];
+        char tmp[64];
+        int n = 0;
+
+        if (strchr("fFeEgGaA", conv)) {
+            double v = type == LOG_ARG_DOUBLE ? a.d : type == LOG_ARG_INT ? (double)a.i : (double)a.u;
+            spec[s++] = conv;
+            spec[s] = '\0';
+            n = snprintf(tmp, sizeof(tmp), spec, v);
+        } else if (conv == 's') {
+            spec[s++] = 's';
+            spec[s] = '\0';
+            const char* str = type == LOG_ARG_STR ? r.pool + a.str : "?";
+            n = snprintf(tmp, sizeof(tmp), spec, str);
+        } else if (conv == 'p') {
+            n = snprintf(tmp, sizeof(tmp), "%p", type == LOG_ARG_PTR ? a.p : nullptr);
+        } else if (conv == 'c') {
+            spec[s++] = 'c';
+            spec[s] = '\0';
+            n = snprintf(tmp, sizeof(tmp), spec, (int)a.i);
+        } else {
+            spec[s++] = 'l';
+            spec[s++] = 'l';
+            spec[s++] = conv;
+            spec[s] = '\0';
+            if (conv == 'd' || conv == 'i') {
+                long long v = type == LOG_ARG_DOUBLE ? (long long)a.d : (long long)a.i;
+                n = snprintf(tmp, sizeof(tmp), spec, v);
+            } else {
+                unsigned long long v = type == LOG_ARG_DOUBLE ? (unsigned long long)a.d
+                                     : type == LOG_ARG_INT ? (unsigned long long)(unsigned long)a.i
+                                     : (unsigned long long)a.u;
+                n = snprintf(tmp, sizeof(tmp), spec, v);
+            }
+        }
+        if (n > 0) emit(tmp, (size_t)n < sizeof(tmp) ? (size_t)n : sizeof(tmp) - 1);
+    }
+    return pos;
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Fixed-capacity, multi-producer log ring with no heap use.
+//
+// append() claims a sequence number with one fetch_add and publishes its
+// slot through a per-slot state word (0 = empty, BUSY = being written,
+// otherwise seq + 1). Writers never wait: if a slot is still being written
+// by a producer that was lapped, the new entry is dropped and counted.
+// Readers copy a slot and re-check its state, so an entry overwritten
+// mid-read is skipped instead of returned torn.
+//
+// Sources are interned into a small table of fixed-size names so each
+// entry carries a one-byte id instead of a string. The payload is filled
+// in place by the caller, so the ring does not care whether it holds text
+// or a deferred record (see LogRecord.h).
+template <typename Payload, size_t Capacity, size_t MaxSources = 32, size_t SourceLen = 16>
+class LogRing {
+public:
+    static constexpr uint8_t UNKNOWN_SOURCE = 0xFF;
+
+    struct Entry {
+        uint32_t seq;
+        uint32_t timestamp;
+        uint8_t level;
+        uint8_t source;
+        Payload payload;
+    };
+
+    // fill(Payload&) runs while the slot is held, so it must not log
+    template <typename Fill>
+    bool append(uint32_t timestamp, uint8_t level, uint8_t source, Fill&& fill) {
+        uint32_t seq = _head.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = _slots[seq % Capacity];
+
+        uint32_t state = slot.state.load(std::memory_order_relaxed);
+        if (state == BUSY ||
+            !slot.state.compare_exchange_strong(state, BUSY, std::memory_order_acquire)) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.entry.seq = seq;
+        slot.entry.timestamp = timestamp;
+        slot.entry.level = level;
+        slot.entry.source = source;
+        fill(slot.entry.payload);
+
+        slot.state.store(seq + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Fill>
+    bool append(uint32_t timestamp, uint8_t level, const char* source, Fill&& fill) {
+        return append(timestamp, level, intern(source), fill);
+    }
+
+    // Copies entry `seq`; false if it is not written yet or was overwritten
+    bool read(uint32_t seq, Entry& out) const {
+        const Slot& slot = _slots[seq % Capacity];
+        if (slot.state.load(std::memory_order_acquire) != seq + 1) return false;
+        memcpy(&out, &slot.entry, sizeof(Entry));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.state.load(std::memory_order_relaxed) == seq + 1;
+    }
+
+    // Sequence range currently held: [oldest(), head())
+    uint32_t head() const { return _head.load(std::memory_order_acquire); }
+    uint32_t oldest() const {
+        uint32_t h = head();
+        uint32_t lo = h > Capacity ? h - Capacity : 0;
+        uint32_t base = _base.load(std::memory_order_relaxed);
+        return base > lo ? base : lo;
+    }
+    size_t size() const { return head() - oldest(); }
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+    void clear() { _base.store(head(), std::memory_order_relaxed); }
+
+    uint8_t intern(const char* source) {
+        if (!source) source = "";
+        uint8_t id = findSource(source);
+        if (id != UNKNOWN_SOURCE) return id;
+
+        uint32_t idx = _sourceCount.fetch_add(1, std::memory_order_relaxed);
+        if (idx >= MaxSources) return UNKNOWN_SOURCE;
+        // A race may intern the same name twice; both ids resolve to it
+        size_t n = 0;
+        for (; n < SourceLen - 1 && source[n]; n++) _sources[idx].name[n] = source[n];
+        _sources[idx].name[n] = '\0';
+        _sources[idx].ready.store(true, std::memory_order_release);
+        return (uint8_t)idx;
+    }
+
+    const char* sourceName(uint8_t id) const {
+        if (id >= MaxSources || !_sources[id].ready.load(std::memory_order_acquire)) return "?";
+        return _sources[id].name;
+    }
+
+private:
+    static constexpr uint32_t BUSY = 0xFFFFFFFF;
+
+    struct Slot {
+        std::atomic<uint32_t> state{0};
+        Entry entry;
+    };
+
+    struct Source {
+        std::atomic<bool> ready{false};
+        char name[SourceLen];
+    };
+
+    uint8_t findSource(const char* source) const {
+        uint32_t n = _sourceCount.load(std::memory_order_acquire);
+        if (n > MaxSources) n = MaxSources;
+        for (uint32_t i = 0; i < n; i++) {
+            if (!_sources[i].ready.load(std::memory_order_acquire)) continue;
+            if (strncmp(_sources[i].name, source, SourceLen - 1) == 0) return (uint8_t)i;
+        }
+        return UNKNOWN_SOURCE;
+    }
+
+    Slot _slots[Capacity];
+    Source _sources[MaxSources];
+    std::atomic<uint32_t> _head{0};
+    std::atomic<uint32_t> _base{0};
+    std::atomic<uint32_t> _dropped{0};
+    std::atomic<uint32_t> _sourceCount{0};
+};
@@ -0,0 +1,127 @@
+// Metrics.cpp - Prometheus text exposition for /metrics (portable families)
+#include "Metrics.h"
+#include "MotorControl.h"
+#include "LSM303Receiver.h"
+#include "Scheduler.h"
+#include "WebLogger.h"
+#include "rotctl_server.h"
+#include "Latency.h"
+#include "AllocTracker.h"
+
+extern LSM303Receiver lsmReceiver;
+
+void metricDescribe(Print& out, const char* name, const char* type, const char* help) {
+    out.printf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// Label values may contain anything; escape \, " and newline
+static void printLabelValue(Print& out, const char* value) {
+    for (; *value; value++) {
+        char c = *value;
+        if (c == '\\') out.print("\\\\");
+        else if (c == '"') out.print("\\\"");
+        else if (c == '\n') out.print("\\n");
+        else out.write((uint8_t)c);
+    }
+}
+
+void metricLabel(Print& out, const char* name, const char* label, const char* value) {
+    out.printf("%s{%s=\"", name, label);
+    printLabelValue(out, value);
+    out.print("\"} ");
+}
+
+void metricGauge(Print& out, const char* name, const char* help, double value) {
+    metricDescribe(out, name, "gauge", help);
+    out.printf("%s %.6g\n", name, value);
+}
+
+void metricCounter(Print& out, const char* name, const char* help, uint32_t value) {
+    metricDescribe(out, name, "counter", help);
+    out.printf("%s %lu\n", name, (unsigned long)value);
+}
+
+static void writeRotctlMetrics(Print& out) {
+    metricDescribe(out, "rotator_rotctl_commands_total", "counter", "rotctl commands handled");
+    for (uint8_t k = 0; k < ROTCTL_COMMAND_KINDS; k++) {
+        metricLabel(out, "rotator_rotctl_commands_total", "cmd", ROTCTL_COMMAND_NAMES[k]);
+        out.printf("%lu\n", (unsigned long)rotctlStats[k].count);
+    }
+    metricDescribe(out, "rotator_rotctl_errors_total", "counter", "rotctl commands answered with RPRT -1");
+    for (uint8_t k = 0; k < ROTCTL_COMMAND_KINDS; k++) {
+        metricLabel(out, "rotator_rotctl_errors_total", "cmd", ROTCTL_COMMAND_NAMES[k]);
+        out.printf("%lu\n", (unsigned long)rotctlStats[k].errors);
+    }
+    metricDescribe(out, "rotator_rotctl_latency_seconds", "summary", "Time from command received to reply written");
+    for (uint8_t k = 0; k < ROTCTL_COMMAND_KINDS; k++) {
+        metricLabel(out, "rotator_rotctl_latency_seconds_sum", "cmd", ROTCTL_COMMAND_NAMES[k]);
+        out.printf("%.6f\n", rotctlStats[k].latencyUsSum / 1e6);
+        metricLabel(out, "rotator_rotctl_latency_seconds_count", "cmd", ROTCTL_COMMAND_NAMES[k]);
+        out.printf("%lu\n", (unsigned long)rotctlStats[k].count);
+    }
+    metricDescribe(out, "rotator_rotctl_latency_max_seconds", "gauge", "Slowest rotctl command since boot");
+    for (uint8_t k = 0; k < ROTCTL_COMMAND_KINDS; k++) {
+        metricLabel(out, "rotator_rotctl_latency_max_seconds", "cmd", ROTCTL_COMMAND_NAMES[k]);
+        out.printf("%.6f\n", rotctlStats[k].latencyUsMax / 1e6);
+    }
+    metricGauge(out, "rotator_rotctl_connected", "1 while a rotctl client is connected", rotctlConnected ? 1 : 0);
+}
+
+static void writeAllocMetrics(Print& out) {
+    static const struct { const char* name; const char* help; } families[] = {
+        {"rotator_alloc_total", "Heap allocations since setup() by subsystem"},
+        {"rotator_alloc_frees_total", "Heap frees since setup() by subsystem"},
+        {"rotator_alloc_bytes_total", "Bytes requested since setup() by subsystem"},
+    };
+    for (uint8_t f = 0; f < 3; f++) {
+        metricDescribe(out, families[f].name, "counter", families[f].help);
+        for (uint8_t i = 0; i < ALLOC_SUBSYSTEMS; i++) {
+            AllocCounts ac = allocTracker.counts((AllocSubsystem)i);
+            uint32_t v = f == 0 ? ac.allocs : f == 1 ? ac.frees : ac.bytes;
+            metricLabel(out, families[f].name, "subsystem", ALLOC_SUBSYSTEM_NAMES[i]);
+            out.printf("%lu\n", (unsigned long)v);
+        }
+    }
+    metricCounter(out, "rotator_alloc_violations_total", "Allocations inside ALLOC_FORBID() regions",
+            allocTracker.violations());
+}
+
+static void writeMotionMetrics(Print& out) {
+    struct { const char* axis; Stepper* motor; } motors[] = {
+        {"az", azMotor}, {"el", elMotor1}, {"el2", elGangedDrive ? elMotor2 : nullptr},
+    };
+    metricDescribe(out, "rotator_motion_queue_entries", "gauge", "Commands waiting in the stepper queue");
+    for (auto& m : motors) {
+        if (!m.motor) continue;
+        metricLabel(out, "rotator_motion_queue_entries", "axis", m.axis);
+        out.printf("%u\n", (unsigned)m.motor->queueEntries());
+    }
+    metricDescribe(out, "rotator_motion_running", "gauge", "1 while the axis is moving");
+    for (auto& m : motors) {
+        if (!m.motor) continue;
+        metricLabel(out, "rotator_motion_running", "axis", m.axis);
+        out.printf("%d\n", m.motor->isRunning() ? 1 : 0);
+    }
+}
+
+void writeMetrics(Print& out) {
+    metricGauge(out, "rotator_uptime_seconds", "Time since boot", millis() / 1000.0);
+
+    writeSystemMetrics(out);
+    writeRotctlMetrics(out);
+
+    metricCounter(out, "rotator_lsm_packets_total", "LSM303 packets received; use rate() for packets/s",
+                  lsmReceiver.getPacketCount());
+    metricGauge(out, "rotator_lsm_packet_age_seconds", "Time since the last LSM303 packet",
+                (millis() - lsmReceiver.getLastUpdate()) / 1000.0);
+
+    writeMotionMetrics(out);
+
+    metricGauge(out, "rotator_loop_max_seconds", "Slowest loop() pass since boot", scheduler.getLoopMaxUs() / 1e6);
+    metricCounter(out, "rotator_budget_overruns_total", "Loop and task step budget overruns", scheduler.getOverruns());
+    metricCounter(out, "rotator_log_dropped_total", "Log entries dropped because the ring was full",
+                  webLogger.getDroppedCount());
+
+    writeAllocMetrics(out);
+    writeLatencyMetrics(out);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "hal/Hal.h"
+
+// --- Prometheus metrics (/metrics) ---
+// Text exposition format 0.0.4, written straight into the response stream.
+// Counters are cumulative since boot; let Prometheus derive rates with
+// rate(). Task CPU share is measured between two scrapes, so a single
+// scraper gives the cleanest numbers.
+inline constexpr uint8_t METRICS_MAX_TASKS = 32;
+
+void writeMetrics(Print& out);
+
+// Heap, Wi-Fi, FreeRTOS task and socket families (MetricsSystem.cpp). The
+// host build has none of these and provides an empty one, so the host
+// tests scrape the rest of writeMetrics() as the firmware does.
+void writeSystemMetrics(Print& out);
+
+// HELP and TYPE lines; must come once, before the first sample of a metric
+void metricDescribe(Print& out, const char* name, const char* type, const char* help);
+// "name{label=\"value\"} " with the value escaped; the caller prints the sample
+void metricLabel(Print& out, const char* name, const char* label, const char* value);
+void metricGauge(Print& out, const char* name, const char* help, double value);
+void metricCounter(Print& out, const char* name, const char* help, uint32_t value);
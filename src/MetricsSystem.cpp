@@ -0,0 +1,78 @@
+// MetricsSystem.cpp - /metrics families read from the ESP32 framework
+#include "Metrics.h"
+#include <WiFi.h>
+#include "TelemetrySocket.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Run-time counters and stack margins for every FreeRTOS task. CPU share
+// is the task's run time over wall time since the previous scrape, as a
+// fraction of one core (the two idle tasks read close to 1 when idle).
+// Only called from the web server task, so the statics need no lock.
+static void writeTaskMetrics(Print& out) {
+    static TaskStatus_t tasks[METRICS_MAX_TASKS];
+    static struct { TaskHandle_t handle; uint32_t runTime; } previous[METRICS_MAX_TASKS];
+    static uint8_t previousCount = 0;
+    static uint32_t previousTotal = 0;
+
+    uint32_t total = 0;
+    UBaseType_t count = uxTaskGetSystemState(tasks, METRICS_MAX_TASKS, &total);
+    if (count == 0) {
+        out.printf("# more than %u tasks, task metrics skipped\n", (unsigned)METRICS_MAX_TASKS);
+        return;
+    }
+
+    metricGauge(out, "rotator_tasks", "Number of FreeRTOS tasks", count);
+
+    metricDescribe(out, "rotator_task_stack_free_min_bytes", "gauge", "Stack high-water mark: least free stack seen");
+    for (UBaseType_t i = 0; i < count; i++) {
+        metricLabel(out, "rotator_task_stack_free_min_bytes", "task", tasks[i].pcTaskName);
+        out.printf("%lu\n", (unsigned long)tasks[i].usStackHighWaterMark);
+    }
+
+    // Zero when the framework is built without run-time stats
+    if (total == 0) return;
+
+    metricDescribe(out, "rotator_task_runtime_ticks_total", "counter", "Task run time in run-time counter ticks (wraps at 32 bits)");
+    for (UBaseType_t i = 0; i < count; i++) {
+        metricLabel(out, "rotator_task_runtime_ticks_total", "task", tasks[i].pcTaskName);
+        out.printf("%lu\n", (unsigned long)tasks[i].ulRunTimeCounter);
+    }
+
+    uint32_t elapsed = total - previousTotal;
+    if (previousCount > 0 && elapsed > 0) {
+        metricDescribe(out, "rotator_task_cpu_ratio", "gauge", "Share of one core used by the task since the previous scrape");
+        for (UBaseType_t i = 0; i < count; i++) {
+            for (uint8_t j = 0; j < previousCount; j++) {
+                if (previous[j].handle != tasks[i].xHandle) continue;
+                uint32_t used = tasks[i].ulRunTimeCounter - previous[j].runTime;
+                metricLabel(out, "rotator_task_cpu_ratio", "task", tasks[i].pcTaskName);
+                out.printf("%.4f\n", (double)used / elapsed);
+                break;
+            }
+        }
+    }
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        previous[i].handle = tasks[i].xHandle;
+        previous[i].runTime = tasks[i].ulRunTimeCounter;
+    }
+    previousCount = count;
+    previousTotal = total;
+}
+
+void writeSystemMetrics(Print& out) {
+    metricGauge(out, "rotator_heap_free_bytes", "Free heap", ESP.getFreeHeap());
+    metricGauge(out, "rotator_heap_free_min_bytes", "Lowest free heap since boot", ESP.getMinFreeHeap());
+    metricGauge(out, "rotator_heap_largest_block_bytes", "Largest allocatable heap block", ESP.getMaxAllocHeap());
+
+    if (WiFi.status() == WL_CONNECTED) {
+        metricGauge(out, "rotator_wifi_rssi_dbm", "Wi-Fi signal strength", WiFi.RSSI());
+    }
+
+    writeTaskMetrics(out);
+
+    metricGauge(out, "rotator_ws_clients", "Connected telemetry WebSocket clients", getTelemetryClients());
+    metricCounter(out, "rotator_ws_skipped_total", "Telemetry broadcasts skipped on a full client queue",
+                  getTelemetryStats().skipped);
+}
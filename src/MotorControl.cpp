@@ -2,7 +2,10 @@
 #include "WebLogger.h"  // Ensure logging works
 #include "MotorControl.h"
 #include "Calibration.h"
-#include "WebInterface.h"
+#include "PositionStore.h"
+#include "FlightRecorder.h"
+#include "Trajectory.h"
+#include "ScanPattern.h"
 
 extern Calibration calib;
 
@@ -12,6 +15,7 @@ void moveAzimuthDeg(float deg) {
     if (!azMotor) return;
     float originalDeg = deg;
     long steps = deg * stepsPerDegree;
+    positionStore.markDirty();
     azMotor->move(steps);
     WEB_LOG_DEBUGF("Motor", "moveAzimuthDeg called: %f deg -> %ld steps", deg, steps);
 }
@@ -21,6 +25,7 @@ void moveElevationDeg(float deg) {
     if (!elMotor1 || !elMotor2) return;
     float originalDeg = deg;
     long steps = deg * stepsPerDegree;
+    positionStore.markDirty();
     elMotor1->move(steps);
     if (elGangedDrive && elMotor2) elMotor2->move(steps);
     WEB_LOG_DEBUGF("Motor", "moveElevationDeg called: %f deg -> %ld steps", deg, steps);
@@ -32,12 +37,14 @@ void moveElevationDeg(float deg) {
 void moveAzimuthToPosition(float degrees) {
     float originalDeg = degrees;
     long targetSteps = azToSteps(degrees);
+    positionStore.markDirty();
     azMotor->moveTo(targetSteps);
 }
 
 void moveElevationToPosition(float degrees) {
     float originalDeg = degrees;
     long targetSteps = elToSteps(degrees);
+    positionStore.markDirty();
     if (elGangedDrive) {
         elMotor1->moveTo(targetSteps);
         elMotor2->moveTo(targetSteps);
@@ -47,12 +54,16 @@ void moveElevationToPosition(float degrees) {
 }
 
 void emergencyStop() {
+  scanRunner.stop();   // before the force stops, so it does not command the next point
   if (azMotor) azMotor->forceStop();
   if (elMotor1) elMotor1->forceStop();
   if (elMotor2) elMotor2->forceStop();
   calib.reset();
+  trajectory.stop();
+  abortHoming();
   azHomed = false;
   elHomed = false;
+  flightRecorder.trigger(FLIGHT_TRIG_ESTOP);
 
   WEB_LOG_WARN("Motor","Emergency stop executed");
 }
@@ -1,22 +1,24 @@
 #ifndef MOTOR_CONTROL_H
 #define MOTOR_CONTROL_H
 #pragma once
-#include <FastAccelStepper.h>
-#include "config.h"
+#include "hal/Hal.h"
+#include "Config.h"
 
 long azToSteps(float az);
 float stepsToAz(long steps);
 long elToSteps(float el);
 float stepsToEl(long steps);
 
-// Declare your FastAccelStepper pointers and other functions/flags
-extern FastAccelStepper *azMotor;
-extern FastAccelStepper *elMotor1;
-extern FastAccelStepper *elMotor2;
+// Declare your stepper pointers and other functions/flags
+extern Stepper *azMotor;
+extern Stepper *elMotor1;
+extern Stepper *elMotor2;
 
 
 // Constants
 extern float stepsPerDegree;
+inline constexpr uint32_t MOTOR_SPEED_HZ = 800;
+inline constexpr int32_t MOTOR_ACCELERATION = 1000;
 extern bool elGangedDrive;
 
 // Functions
@@ -26,6 +28,7 @@ void moveAzimuthToPosition(float degrees);
 void moveElevationToPosition(float degrees);
 void azMotorStop();
 void elMotorStop();
+void emergencyStop();
 
 long azToSteps(float az);
 float stepsToAz(long steps);
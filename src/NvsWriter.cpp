@@ -0,0 +1,41 @@
+// NvsWriter.cpp - flash writes on a low-priority task
+#include "NvsWriter.h"
+#include "WebLogger.h"
+
+NvsWriter nvsWriter;
+
+int8_t NvsWriter::add(FlushFn fn, void* ctx) {
+    if (_count == NVS_WRITER_MAX) {
+        WEB_LOG_ERROR("[NVS]", "Too many deferred writers");
+        return -1;
+    }
+    _fn[_count] = fn;
+    _ctx[_count] = ctx;
+    return (int8_t)_count++;
+}
+
+void NvsWriter::begin() {
+    if (_started) return;
+    _started = hal::startTask(&NvsWriter::taskCode, "nvsWriter", NVS_WRITER_STACK, this, 1);
+    if (!_started) WEB_LOG_ERROR("[NVS]", "Writer task failed to start");
+}
+
+void NvsWriter::request(int8_t id) {
+    if (id < 0) return;
+    _pending.fetch_or(1u << id, std::memory_order_release);
+}
+
+void NvsWriter::service() {
+    uint32_t pending = _pending.exchange(0, std::memory_order_acquire);
+    for (uint8_t i = 0; pending; i++, pending >>= 1) {
+        if (pending & 1) _fn[i](_ctx[i]);
+    }
+}
+
+void NvsWriter::taskCode(void* arg) {
+    NvsWriter* self = static_cast<NvsWriter*>(arg);
+    for (;;) {
+        self->service();
+        hal::sleepMs(NVS_WRITER_POLL_MS);
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include "hal/Hal.h"
+
+// --- Deferred NVS writes ---
+// A flash erase can stall for tens of ms, too long for loop() or an HTTP
+// handler. Owners register a flush function once and request() it after
+// a change; a low-priority task calls it, and the function copies its
+// state under the owner's lock and writes NVS outside it. Requests made
+// while a flush runs queue one more pass, so the last change is stored.
+inline constexpr uint8_t NVS_WRITER_MAX = 8;
+inline constexpr uint32_t NVS_WRITER_POLL_MS = 50;
+inline constexpr uint32_t NVS_WRITER_STACK = 4096;
+
+class NvsWriter {
+public:
+    typedef void (*FlushFn)(void* ctx);
+
+    // During setup, before begin(); returns the id for request(), or -1
+    int8_t add(FlushFn fn, void* ctx);
+    void begin();                   // starts the writer task (ESP32)
+
+    void request(int8_t id);        // any task
+    void service();                 // runs the requested flushes on the caller
+
+private:
+    static void taskCode(void* arg);
+
+    FlushFn _fn[NVS_WRITER_MAX] = {};
+    void* _ctx[NVS_WRITER_MAX] = {};
+    uint8_t _count = 0;
+    std::atomic<uint32_t> _pending{0};
+    bool _started = false;
+};
+
+extern NvsWriter nvsWriter;
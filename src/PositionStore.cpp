@@ -0,0 +1,196 @@
+#include "PositionStore.h"
+#include <stddef.h>
+#include "Homing.h"
+#include "Calibration.h"
+#include "Crc32.h"
+#include "MathUtils.h"
+#include "ScanPattern.h"
+#include "WebLogger.h"
+
+extern Calibration calib;
+
+static uint32_t checkpointCrc(const PositionCheckpoint& cp) {
+    return crc32(reinterpret_cast<const uint8_t*>(&cp), offsetof(PositionCheckpoint, crc));
+}
+
+static void slotKey(uint8_t slot, char* key, size_t len) {
+    snprintf(key, len, "ck%u", slot);
+}
+
+PositionStore::PositionStore(LSM303Receiver* lsm) : _lsm(lsm) {}
+
+void PositionStore::begin() {
+    if (!_prefs.begin("rotator", false)) {
+        Serial.println("[STORE] Failed to open NVS namespace");
+        WEB_LOG_ERROR("[STORE]", "Failed to open NVS namespace");
+        return;
+    }
+    _ready = true;
+    if (loadLatest()) {
+        WEB_LOG_INFOF("[STORE]", "Checkpoint #%lu: AZ=%ld EL=%ld steps, %s",
+                      (unsigned long)_last.seq, (long)_last.azSteps, (long)_last.elSteps,
+                      _last.clean ? "clean" : "dirty");
+    } else {
+        WEB_LOG_INFO("[STORE]", "No valid checkpoint found");
+    }
+}
+
+bool PositionStore::loadLatest() {
+    _hasCheckpoint = false;
+    for (uint8_t slot = 0; slot < CHECKPOINT_SLOTS; slot++) {
+        char key[8];
+        slotKey(slot, key, sizeof(key));
+        PositionCheckpoint cp;
+        if (_prefs.getBytes(key, &cp, sizeof(cp)) != sizeof(cp)) continue;
+        if (cp.magic != CHECKPOINT_MAGIC || cp.crc != checkpointCrc(cp)) continue;
+        if (!_hasCheckpoint || cp.seq > _last.seq) {
+            _last = cp;
+            _lastSlot = slot;
+            _hasCheckpoint = true;
+        }
+    }
+    return _hasCheckpoint;
+}
+
+bool PositionStore::motionActive() const {
+    if (!azHomed || !elHomed) return true;
+    if (homingStage != HOMING_IDLE && homingStage != HOMING_COMPLETE) return true;
+    if (calib.isRunning()) return true;
+    if (scanRunner.isRunning()) return true;   // no clean checkpoint between points
+    if (azMotor && azMotor->isRunning()) return true;
+    if (elMotor1 && elMotor1->isRunning()) return true;
+    if (elMotor2 && elMotor2->isRunning()) return true;
+    return false;
+}
+
+bool PositionStore::writeCheckpoint(bool clean) {
+    if (!_ready) return false;
+    _lock.lock();
+
+    // Another task may have invalidated the checkpoint while we waited
+    if (!clean && (!_hasCheckpoint || !_last.clean)) {
+        _lock.unlock();
+        return true;
+    }
+
+    PositionCheckpoint cp = {};
+    cp.magic = CHECKPOINT_MAGIC;
+    cp.seq = _hasCheckpoint ? _last.seq + 1 : 1;
+    cp.azSteps = azMotor ? azMotor->getCurrentPosition() : 0;
+    cp.elSteps = elMotor1 ? elMotor1->getCurrentPosition() : 0;
+    cp.sensorValid = (_lsm && _lsm->getPacketCount() > 0 &&
+                      millis() - _lsm->getLastUpdate() < 2000) ? 1 : 0;
+    cp.lsmAzRaw = _lsm ? _lsm->getRawAzimuth() : 0.0f;
+    cp.lsmElRaw = _lsm ? _lsm->getRawElevation() : 0.0f;
+    cp.clean = clean ? 1 : 0;
+    cp.crc = checkpointCrc(cp);
+
+    uint8_t slot = (_lastSlot + 1) % CHECKPOINT_SLOTS;
+    char key[8];
+    slotKey(slot, key, sizeof(key));
+    bool ok = _prefs.putBytes(key, &cp, sizeof(cp)) == sizeof(cp);
+    if (ok) {
+        _last = cp;
+        _lastSlot = slot;
+        _hasCheckpoint = true;
+        _writeCount++;
+    }
+    _lock.unlock();
+
+    if (ok) {
+        WEB_LOG_DEBUGF("[STORE]", "Checkpoint #%lu (%s) slot %u: AZ=%ld EL=%ld",
+                       (unsigned long)cp.seq, clean ? "clean" : "dirty", slot,
+                       (long)cp.azSteps, (long)cp.elSteps);
+    } else {
+        WEB_LOG_ERRORF("[STORE]", "Checkpoint write to slot %u failed", slot);
+    }
+    return ok;
+}
+
+void PositionStore::markDirty() {
+    // Only the first motion after a clean checkpoint costs a flash write
+    if (!_ready || !_hasCheckpoint || !_last.clean) return;
+    writeCheckpoint(false);
+}
+
+void PositionStore::update() {
+    if (!_ready) return;
+    unsigned long now = millis();
+
+    if (motionActive()) {
+        _wasActive = true;
+        // Safety net for motion that was not routed through markDirty()
+        if (_hasCheckpoint && _last.clean) markDirty();
+        return;
+    }
+
+    if (_wasActive) {
+        _wasActive = false;
+        _idleSince = now;
+    }
+    if (now - _idleSince < CHECKPOINT_IDLE_MS) return;
+
+    long azSteps = azMotor ? azMotor->getCurrentPosition() : 0;
+    long elSteps = elMotor1 ? elMotor1->getCurrentPosition() : 0;
+    if (_hasCheckpoint && _last.clean && _last.azSteps == azSteps && _last.elSteps == elSteps) return;
+
+    if (!writeCheckpoint(true)) _idleSince = now;  // retry after another idle period
+}
+
+bool PositionStore::tryWarmStart() {
+    if (!_hasCheckpoint) {
+        WEB_LOG_INFO("[STORE]", "Warm start skipped: no checkpoint");
+        return false;
+    }
+    if (!_last.clean) {
+        WEB_LOG_WARNING("[STORE]", "Warm start skipped: rotator was moving at last checkpoint");
+        return false;
+    }
+    if (!_last.sensorValid || !_lsm) {
+        WEB_LOG_WARNING("[STORE]", "Warm start skipped: checkpoint has no sensor reference");
+        return false;
+    }
+
+    // Average a few raw LSM readings (circular mean for heading)
+    unsigned long start = millis();
+    uint32_t seen = _lsm->getPacketCount();
+    uint32_t samples = 0;
+    float sinSum = 0.0f, cosSum = 0.0f, elSum = 0.0f;
+    while (samples < WARM_START_MIN_PACKETS && millis() - start < WARM_START_SENSOR_TIMEOUT_MS) {
+        _lsm->update();
+        if (_lsm->getPacketCount() != seen) {
+            seen = _lsm->getPacketCount();
+            float a = _lsm->getRawAzimuth() * PI / 180.0f;
+            sinSum += sinf(a);
+            cosSum += cosf(a);
+            elSum += _lsm->getRawElevation();
+            samples++;
+        }
+        delay(5);
+    }
+    if (samples < WARM_START_MIN_PACKETS) {
+        WEB_LOG_WARNINGF("[STORE]", "Warm start skipped: only %lu LSM packets in %lu ms",
+                         (unsigned long)samples, WARM_START_SENSOR_TIMEOUT_MS);
+        return false;
+    }
+
+    float az = normalizeDeg(atan2f(sinSum, cosSum) * 180.0f / PI);
+    float el = elSum / samples;
+    float azErr = fabsf(normalizeDeg(az - _last.lsmAzRaw + 180.0f) - 180.0f);
+    float elErr = fabsf(el - _last.lsmElRaw);
+    if (azErr > WARM_START_AZ_TOL_DEG || elErr > WARM_START_EL_TOL_DEG) {
+        WEB_LOG_WARNINGF("[STORE]", "Warm start rejected: sensor moved (dAz=%.1f dEl=%.1f)", azErr, elErr);
+        return false;
+    }
+
+    if (azMotor) azMotor->setCurrentPosition(_last.azSteps);
+    if (elMotor1) elMotor1->setCurrentPosition(_last.elSteps);
+    if (elMotor2) elMotor2->setCurrentPosition(_last.elSteps);
+    azHomed = true;
+    elHomed = true;
+    homingStage = HOMING_COMPLETE;
+
+    WEB_LOG_INFOF("[STORE]", "Warm start: AZ=%.2f EL=%.2f deg restored (dAz=%.1f dEl=%.1f)",
+                  stepsToAz(_last.azSteps), stepsToEl(_last.elSteps), azErr, elErr);
+    return true;
+}
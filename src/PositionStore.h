@@ -0,0 +1,65 @@
+#pragma once
+#include "hal/Hal.h"
+#include "LSM303Receiver.h"
+
+// --- Checkpoint ring in NVS ---
+// Each write goes to the next slot so the same flash entry is not rewritten
+// on every checkpoint; the slot with the highest valid sequence number wins.
+inline constexpr uint8_t CHECKPOINT_SLOTS = 8;
+inline constexpr uint32_t CHECKPOINT_MAGIC = 0x524F5431;  // "ROT1"
+
+// --- Checkpoint policy ---
+inline constexpr unsigned long CHECKPOINT_IDLE_MS = 10000;  // motors idle this long before a clean write
+
+// --- Warm start validation ---
+inline constexpr unsigned long WARM_START_SENSOR_TIMEOUT_MS = 4000;  // wait this long for LSM packets
+inline constexpr uint32_t WARM_START_MIN_PACKETS = 10;               // packets averaged before comparing
+inline constexpr float WARM_START_AZ_TOL_DEG = 5.0f;
+inline constexpr float WARM_START_EL_TOL_DEG = 3.0f;
+
+struct PositionCheckpoint {
+    uint32_t magic;
+    uint32_t seq;
+    int32_t azSteps;
+    int32_t elSteps;
+    float lsmAzRaw;      // uncalibrated heading at checkpoint time
+    float lsmElRaw;      // uncalibrated elevation at checkpoint time
+    uint8_t clean;       // 1 = motion idle, step counts are trustworthy
+    uint8_t sensorValid; // 1 = LSM readings above were fresh
+    uint16_t reserved;
+    uint32_t crc;
+};
+
+class PositionStore {
+public:
+    PositionStore(LSM303Receiver* lsm);
+
+    void begin();
+    void update();        // call from loop()
+    void markDirty();     // call before commanding any motion
+    bool tryWarmStart();  // call once from setup() after motors and LSM are up
+
+    bool hasCheckpoint() const { return _hasCheckpoint; }
+    const PositionCheckpoint& getCheckpoint() const { return _last; }
+    uint32_t getWriteCount() const { return _writeCount; }
+
+private:
+    bool motionActive() const;
+    bool writeCheckpoint(bool clean);
+    bool loadLatest();
+
+    LSM303Receiver* _lsm;
+    NvStore _prefs;
+    hal::Mutex _lock;
+    bool _ready = false;
+
+    PositionCheckpoint _last = {};
+    bool _hasCheckpoint = false;
+    uint8_t _lastSlot = CHECKPOINT_SLOTS - 1;
+    uint32_t _writeCount = 0;
+
+    unsigned long _idleSince = 0;
+    bool _wasActive = true;
+};
+
+extern PositionStore positionStore;
@@ -0,0 +1,63 @@
+#pragma once
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// rotctl (hamlib net) command parsing and replies, independent of the
+// socket. Everything works in caller buffers so the handler stays off the
+// heap.
+// ROTCTL_SLEW_TIME is an extension: "\\slew_time <az> <el>" answers the
+// predicted seconds to reach the position (SlewTime.h)
+enum RotctlCommand : uint8_t { ROTCTL_GET_POS, ROTCTL_SET_POS, ROTCTL_SLEW_TIME, ROTCTL_UNKNOWN, ROTCTL_COMMAND_KINDS };
+
+inline constexpr size_t ROTCTL_LINE_LEN = 64;
+inline constexpr size_t ROTCTL_REPLY_LEN = 32;
+inline constexpr const char* ROTCTL_REPLY_OK = "RPRT 0\n";
+inline constexpr const char* ROTCTL_REPLY_ERROR = "RPRT -1\n";
+
+struct RotctlRequest {
+    RotctlCommand kind;
+    bool valid;         // false: reply RPRT -1
+    float az;           // ROTCTL_SET_POS and ROTCTL_SLEW_TIME
+    float el;
+};
+
+// One command per packet; surrounding whitespace is ignored
+inline RotctlRequest parseRotctlCommand(const char* data, size_t len) {
+    RotctlRequest req = {ROTCTL_UNKNOWN, false, 0.0f, 0.0f};
+    while (len && isspace((uint8_t)data[0])) { data++; len--; }
+    while (len && isspace((uint8_t)data[len - 1])) len--;
+    if (len == 0 || len >= ROTCTL_LINE_LEN) return req;
+
+    char line[ROTCTL_LINE_LEN];
+    memcpy(line, data, len);
+    line[len] = '\0';
+
+    if (len == 1 && (line[0] == 'p' || line[0] == 'P')) {
+        req.kind = ROTCTL_GET_POS;
+        req.valid = true;
+    } else if (line[0] == 'P' && line[1] == ' ') {
+        req.kind = ROTCTL_SET_POS;
+        req.valid = sscanf(line, "P %f %f", &req.az, &req.el) == 2;
+    } else if (strncmp(line, "\\slew_time", 10) == 0 && (line[10] == ' ' || line[10] == '\0')) {
+        req.kind = ROTCTL_SLEW_TIME;
+        req.valid = sscanf(line + 10, "%f %f", &req.az, &req.el) == 2;
+    }
+    return req;
+}
+
+// Reply to "p": azimuth and elevation, one per line
+inline size_t formatRotctlPosition(char* out, size_t len, float az, float el) {
+    int n = snprintf(out, len, "%.2f\n%.2f\n", az, el);
+    if (n < 0) return 0;
+    return (size_t)n < len ? (size_t)n : len - 1;
+}
+
+// Reply to "\\slew_time": seconds on one line
+inline size_t formatRotctlSeconds(char* out, size_t len, float seconds) {
+    int n = snprintf(out, len, "%.2f\n", seconds);
+    if (n < 0) return 0;
+    return (size_t)n < len ? (size_t)n : len - 1;
+}
@@ -0,0 +1,140 @@
+// RotctlRecorder.cpp - rotctl session ring and capture text
+#include "RotctlRecorder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+RotctlRecorder rotctlRecorder;
+
+static const char EVENT_CODES[] = {'C', 'D', 'X'};
+
+size_t formatRotctlEvent(char* out, size_t len, const RotctlEvent& e) {
+    if (len == 0) return 0;
+    int n = snprintf(out, len, "%lu %u %c", (unsigned long)e.tUs, e.client, EVENT_CODES[e.kind]);
+    if (n < 0 || (size_t)n >= len) { out[0] = '\0'; return 0; }
+    size_t pos = n;
+    if (e.kind == ROTCTL_EVENT_DATA) {
+        out[pos++] = ' ';
+        for (uint8_t i = 0; i < e.len && pos + 5 < len; i++) {
+            uint8_t c = (uint8_t)e.data[i];
+            if (c == '\n') { out[pos++] = '\\'; out[pos++] = 'n'; }
+            else if (c == '\r') { out[pos++] = '\\'; out[pos++] = 'r'; }
+            else if (c == '\\') { out[pos++] = '\\'; out[pos++] = '\\'; }
+            else if (c < 0x20 || c >= 0x7f) pos += snprintf(out + pos, len - pos, "\\x%02x", c);
+            else out[pos++] = c;
+        }
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool parseRotctlEvent(const char* line, RotctlEvent& out) {
+    unsigned long tUs;
+    unsigned client;
+    char code;
+    int consumed = 0;
+    if (sscanf(line, "%lu %u %c%n", &tUs, &client, &code, &consumed) != 3 || client > 255) return false;
+    out.tUs = (uint32_t)tUs;
+    out.client = (uint8_t)client;
+    out.len = 0;
+    if (code == 'C') { out.kind = ROTCTL_EVENT_CONNECT; return true; }
+    if (code == 'X') { out.kind = ROTCTL_EVENT_DISCONNECT; return true; }
+    if (code != 'D') return false;
+
+    out.kind = ROTCTL_EVENT_DATA;
+    const char* p = line + consumed;
+    if (*p == ' ') p++;
+    for (; *p && *p != '\n' && out.len < ROTCTL_REC_DATA_LEN; p++) {
+        char c = *p;
+        if (c == '\\') {
+            p++;
+            if (*p == 'n') c = '\n';
+            else if (*p == 'r') c = '\r';
+            else if (*p == '\\') c = '\\';
+            else if (*p == 'x' && hexDigit(p[1]) >= 0 && hexDigit(p[2]) >= 0) {
+                c = (char)(hexDigit(p[1]) * 16 + hexDigit(p[2]));
+                p += 2;
+            } else {
+                return false;
+            }
+        }
+        out.data[out.len++] = c;
+    }
+    return true;
+}
+
+bool RotctlRecorder::start() {
+    if (!_events) {
+        _events = (RotctlEvent*)malloc(ROTCTL_REC_CAPACITY * sizeof(RotctlEvent));
+        if (!_events) return false;
+    }
+    _head = 0;
+    _truncated = 0;
+    _nextId = 0;
+    memset(_open, 0, sizeof(_open));
+    _recording = true;
+    return true;
+}
+
+uint8_t RotctlRecorder::clientId(const void* client) {
+    for (uint8_t i = 0; i < MAX_OPEN; i++) {
+        if (_open[i] == client) return _openIds[i];
+    }
+    // Connected before recording started, or more clients than slots
+    for (uint8_t i = 0; i < MAX_OPEN; i++) {
+        if (!_open[i]) {
+            _open[i] = client;
+            _openIds[i] = _nextId++;
+            return _openIds[i];
+        }
+    }
+    return _nextId++;
+}
+
+RotctlEvent& RotctlRecorder::push(const void* client, RotctlEventKind kind, uint32_t tUs) {
+    RotctlEvent& e = _events[_head++ % ROTCTL_REC_CAPACITY];
+    e.tUs = tUs;
+    e.client = clientId(client);
+    e.kind = kind;
+    e.len = 0;
+    return e;
+}
+
+void RotctlRecorder::connected(const void* client, uint32_t tUs) {
+    if (!_recording) return;
+    for (uint8_t i = 0; i < MAX_OPEN; i++) {
+        if (_open[i] == client) _open[i] = nullptr;   // pointer reused by a new connection
+    }
+    push(client, ROTCTL_EVENT_CONNECT, tUs);
+}
+
+void RotctlRecorder::received(const void* client, const char* data, size_t len, uint32_t tUs) {
+    if (!_recording) return;
+    RotctlEvent& e = push(client, ROTCTL_EVENT_DATA, tUs);
+    if (len > ROTCTL_REC_DATA_LEN) {
+        len = ROTCTL_REC_DATA_LEN;
+        _truncated++;
+    }
+    memcpy(e.data, data, len);
+    e.len = (uint8_t)len;
+}
+
+void RotctlRecorder::disconnected(const void* client, uint32_t tUs) {
+    if (!_recording) return;
+    push(client, ROTCTL_EVENT_DISCONNECT, tUs);
+    for (uint8_t i = 0; i < MAX_OPEN; i++) {
+        if (_open[i] == client) _open[i] = nullptr;
+    }
+}
+
+const RotctlEvent& RotctlRecorder::event(size_t i) const {
+    uint32_t first = _head - count();
+    return _events[(first + i) % ROTCTL_REC_CAPACITY];
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// --- rotctl session recorder ---
+// While recording, the server keeps every connect, received packet and
+// disconnect with its arrival time, so client behaviour that broke the
+// server (bursts, "p" storms, reconnects) can be downloaded and replayed
+// on the host against the simulator (src/sim/RotctlReplay.h).
+//
+// The capture is text, one event per line, so sessions can also be
+// written by hand:
+//   <tUs> <client> C              connect
+//   <tUs> <client> D <data>       packet, \n \r \\ and \xHH escaped
+//   <tUs> <client> X              disconnect
+// Client ids count connections since start(). Packets longer than
+// ROTCTL_REC_DATA_LEN are cut and counted in truncated().
+//
+// Written and read on the AsyncTCP task only, like rotctlStats. The ring
+// is allocated on the first start().
+inline constexpr size_t ROTCTL_REC_CAPACITY = 512;      // 32 KB
+inline constexpr size_t ROTCTL_REC_DATA_LEN = 56;
+inline constexpr size_t ROTCTL_REC_LINE_LEN = 32 + 4 * ROTCTL_REC_DATA_LEN;   // worst-case escaping
+
+enum RotctlEventKind : uint8_t { ROTCTL_EVENT_CONNECT, ROTCTL_EVENT_DATA, ROTCTL_EVENT_DISCONNECT };
+
+struct RotctlEvent {
+    uint32_t tUs;
+    uint8_t client;
+    RotctlEventKind kind;
+    uint8_t len;
+    char data[ROTCTL_REC_DATA_LEN];
+};
+
+// One capture line without the newline; false for anything malformed
+size_t formatRotctlEvent(char* out, size_t len, const RotctlEvent& e);
+bool parseRotctlEvent(const char* line, RotctlEvent& out);
+
+class RotctlRecorder {
+public:
+    bool start();       // clears; false if the ring could not be allocated
+    void stop() { _recording = false; }
+    bool recording() const { return _recording; }
+
+    // From the server callbacks; the pointer identifies the connection
+    void connected(const void* client, uint32_t tUs);
+    void received(const void* client, const char* data, size_t len, uint32_t tUs);
+    void disconnected(const void* client, uint32_t tUs);
+
+    size_t count() const { return _head < ROTCTL_REC_CAPACITY ? _head : ROTCTL_REC_CAPACITY; }
+    uint32_t overwritten() const { return _head > ROTCTL_REC_CAPACITY ? _head - ROTCTL_REC_CAPACITY : 0; }
+    uint32_t truncated() const { return _truncated; }
+    const RotctlEvent& event(size_t i) const;   // 0 = oldest
+
+private:
+    static constexpr uint8_t MAX_OPEN = 4;
+
+    uint8_t clientId(const void* client);
+    RotctlEvent& push(const void* client, RotctlEventKind kind, uint32_t tUs);
+
+    RotctlEvent* _events = nullptr;
+    uint32_t _head = 0;
+    uint32_t _truncated = 0;
+    bool _recording = false;
+    const void* _open[MAX_OPEN] = {};
+    uint8_t _openIds[MAX_OPEN] = {};
+    uint8_t _nextId = 0;
+};
+
+extern RotctlRecorder rotctlRecorder;
@@ -0,0 +1,281 @@
+// ScanPattern.cpp - scan point generation and the on-point runner
+#include "ScanPattern.h"
+#include <math.h>
+#include <string.h>
+#include "JsonWriter.h"
+#include "MotorControl.h"
+#include "PositionStore.h"
+#include "Trajectory.h"
+#include "WallClock.h"
+#include "WebLogger.h"
+
+extern bool azHomed;
+extern bool elHomed;
+
+ScanRunner scanRunner;
+
+static const char* const SCAN_KIND_NAMES[SCAN_KINDS] = {"raster", "boustrophedon", "spiral", "cross", "onoff"};
+
+const char* scanKindName(uint8_t kind) {
+    return kind < SCAN_KINDS ? SCAN_KIND_NAMES[kind] : "?";
+}
+
+bool parseScanKind(const char* name, ScanKind& kind) {
+    for (uint8_t k = 0; k < SCAN_KINDS; k++) {
+        if (strcmp(name, SCAN_KIND_NAMES[k]) == 0) {
+            kind = (ScanKind)k;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ----------------------
+// Generation
+// ----------------------
+
+// Points along one centered grid axis, whole steps only
+static uint32_t gridCount(float extent, float step) {
+    return extent > 0.0f ? (uint32_t)floorf(extent / step + 1e-3f) + 1 : 1;
+}
+
+static float gridOffset(uint32_t i, uint32_t n, float step) {
+    return ((float)i - (n - 1) / 2.0f) * step;
+}
+
+static float spiralRadius(const ScanParams& p) {
+    return (p.width > p.height ? p.width : p.height) / 2.0f;
+}
+
+static uint32_t basePointCount(const ScanParams& p) {
+    uint32_t nx = gridCount(p.width, p.step);
+    uint32_t ny = gridCount(p.height, p.step);
+    switch (p.kind) {
+        case SCAN_RASTER:
+        case SCAN_BOUSTROPHEDON: return nx * ny;
+        case SCAN_CROSS:         return nx + ny;
+        case SCAN_ONOFF:         return 2;
+        case SCAN_SPIRAL: {
+            // Point i sits at r = step * sqrt(i / pi), see scanPoint()
+            float k = spiralRadius(p) / p.step;
+            return (uint32_t)floorf((float)M_PI * k * k + 1e-3f) + 1;
+        }
+        default: return 0;
+    }
+}
+
+uint32_t scanPointCount(const ScanParams& p) {
+    if (!(p.step > 0.0f) || p.width < 0.0f || p.height < 0.0f) return 0;
+    uint64_t n = (uint64_t)basePointCount(p) * (p.cycles ? p.cycles : 1);
+    return n > SCAN_MAX_POINTS ? SCAN_MAX_POINTS + 1 : (uint32_t)n;
+}
+
+bool scanPoint(const ScanParams& p, uint32_t index, ScanPoint& out) {
+    uint32_t base = basePointCount(p);
+    if (base == 0 || index >= scanPointCount(p)) return false;
+    uint32_t i = index % base;
+    uint32_t nx = gridCount(p.width, p.step);
+    uint32_t ny = gridCount(p.height, p.step);
+    float x = 0.0f, y = 0.0f;
+    out.on = true;
+
+    switch (p.kind) {
+        case SCAN_RASTER:
+        case SCAN_BOUSTROPHEDON: {
+            uint32_t row = i / nx;
+            uint32_t col = i % nx;
+            if (p.kind == SCAN_BOUSTROPHEDON && (row & 1)) col = nx - 1 - col;
+            x = gridOffset(col, nx, p.step);
+            y = gridOffset(row, ny, p.step);
+            break;
+        }
+        case SCAN_SPIRAL: {
+            // r = b * theta with b = step / 2pi keeps the arms step apart;
+            // arc length ~ b * theta^2 / 2 = i * step spaces the points
+            float theta = sqrtf(4.0f * (float)M_PI * i);
+            float r = p.step * theta / (2.0f * (float)M_PI);
+            x = r * cosf(theta);
+            y = r * sinf(theta);
+            break;
+        }
+        case SCAN_CROSS:
+            if (i < nx) x = gridOffset(i, nx, p.step);
+            else y = gridOffset(i - nx, ny, p.step);
+            break;
+        case SCAN_ONOFF:
+            out.on = i == 0;
+            x = out.on ? 0.0f : p.width;
+            break;
+        default:
+            return false;
+    }
+
+    out.x = x;
+    out.y = y;
+    out.el = p.centerEl + y;
+    float c = cosf(out.el * (float)M_PI / 180.0f);
+    out.az = p.centerAz + x / (c > SCAN_MIN_COS_EL ? c : SCAN_MIN_COS_EL);
+    return true;
+}
+
+const char* checkScanParams(const ScanParams& p) {
+    if (p.kind >= SCAN_KINDS) return "unknown pattern";
+    if (!(p.step > 0.0f)) return "step must be > 0";
+    if (p.width < 0.0f || p.height < 0.0f) return "extent must be >= 0";
+    if (p.dwellMs > SCAN_MAX_DWELL_MS) return "dwell too long";
+    uint32_t n = scanPointCount(p);
+    if (n == 0 || n > SCAN_MAX_POINTS) return "too many points";
+    // Every cycle visits the same points, one is enough
+    ScanPoint pt;
+    for (uint32_t i = 0; i < n / (p.cycles ? p.cycles : 1); i++) {
+        scanPoint(p, i, pt);
+        if (pt.az < MIN_AZ || pt.az > MAX_AZ || pt.el < MIN_EL || pt.el > MAX_EL) return "pattern leaves the travel limits";
+    }
+    return nullptr;
+}
+
+void writeScanMarkerJSON(JsonWriter& json, const ScanMarker& m) {
+    json.beginObject();
+    json.kv("t", "scan");
+    json.kv("seq", m.seq);
+    if (m.flags & SCAN_MARK_END) {
+        json.kv("end", true);
+        json.kv("aborted", (m.flags & SCAN_MARK_ABORTED) != 0);
+        json.kv("points", m.point);
+        json.kv("of", m.points);
+    } else {
+        json.kv("point", m.point);
+        json.kv("of", m.points);
+        json.kv("ref", m.at.on ? "on" : "off");
+        json.kv("x", m.at.x, 3);
+        json.kv("y", m.at.y, 3);
+        json.kv("az", m.at.az, 3);
+        json.kv("el", m.at.el, 3);
+        json.kv("dwellMs", m.dwellMs);
+    }
+    json.kv("ms", m.ms);
+    json.kv("unixMs", m.unixMs);
+    json.endObject();
+}
+
+// ----------------------
+// Runner
+// ----------------------
+
+const char* ScanRunner::start(const ScanParams& p) {
+    const char* err = checkScanParams(p);
+    if (err) return err;
+    if (!azHomed || !elHomed) return "not homed";
+    trajectory.stop();
+    positionStore.markDirty();   // here, not on the stepper task
+    _pending.write(p);
+    _stopPending.store(false, std::memory_order_relaxed);
+    _running.store(true, std::memory_order_release);
+    _startPending.store(true, std::memory_order_release);
+    return nullptr;
+}
+
+// A start still pending is dropped here; one update() has taken already
+// sees _stopPending on the next tick
+void ScanRunner::stop() {
+    _startPending.store(false, std::memory_order_release);
+    _stopPending.store(true, std::memory_order_release);
+    _running.store(false, std::memory_order_release);
+}
+
+void ScanRunner::begin() {
+    _params = _pending.read();
+    _count.store(scanPointCount(_params), std::memory_order_relaxed);
+    _index.store(0, std::memory_order_relaxed);
+    _active = true;
+    WEB_LOG_INFOF("[SCAN]", "%s: %lu points around %.2f/%.2f, step %.3f deg, dwell %lu ms",
+                  scanKindName(_params.kind), (unsigned long)pointCount(), _params.centerAz,
+                  _params.centerEl, _params.step, (unsigned long)_params.dwellMs);
+    if (!moveToPoint()) finish(true);
+}
+
+void ScanRunner::finish(bool aborted) {
+    _active = false;
+    pushMarker(SCAN_MARK_END | (aborted ? SCAN_MARK_ABORTED : 0), millis());
+    _running.store(false, std::memory_order_release);
+    WEB_LOG_INFOF("[SCAN]", "%s after %lu of %lu points", aborted ? "Stopped" : "Finished",
+                  (unsigned long)pointIndex(), (unsigned long)pointCount());
+}
+
+// Re-checked right before every move: an e-stop or stop() may have landed
+// since this update() started
+bool ScanRunner::moveToPoint() {
+    if (!azHomed || !elHomed || _stopPending.load(std::memory_order_acquire)) return false;
+    scanPoint(_params, pointIndex(), _point);
+    moveAzimuthToPosition(_point.az);
+    moveElevationToPosition(_point.el);
+    _phase = PHASE_MOVING;
+    return true;
+}
+
+void ScanRunner::pushMarker(uint8_t flags, uint32_t nowMs) {
+    uint32_t head = _ringHead.load(std::memory_order_relaxed);
+    if (head - _ringTail.load(std::memory_order_acquire) >= SCAN_MARKER_RING) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ScanMarker& m = _ring[head % SCAN_MARKER_RING];
+    m.seq = _markerSeq++;
+    m.point = pointIndex();
+    m.points = pointCount();
+    m.flags = flags;
+    m.at = _point;
+    m.ms = nowMs;
+    m.unixMs = wallClock.nowMs();
+    m.dwellMs = _params.dwellMs;
+    _ringHead.store(head + 1, std::memory_order_release);
+}
+
+bool ScanRunner::readMarker(ScanMarker& out) {
+    uint32_t tail = _ringTail.load(std::memory_order_relaxed);
+    if (tail == _ringHead.load(std::memory_order_acquire)) return false;
+    out = _ring[tail % SCAN_MARKER_RING];
+    _ringTail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+static bool axesMoving() {
+    return (azMotor && azMotor->isRunning()) || (elMotor1 && elMotor1->isRunning()) ||
+           (elMotor2 && elMotor2->isRunning());
+}
+
+void ScanRunner::update() {
+    if (_stopPending.exchange(false, std::memory_order_acq_rel) && _active) finish(true);
+    if (_startPending.exchange(false, std::memory_order_acq_rel)) {
+        if (_active) finish(true);
+        if (azHomed && elHomed) {
+            _running.store(true, std::memory_order_release);
+            begin();
+        } else {
+            _running.store(false, std::memory_order_release);
+        }
+    }
+    if (!_active) return;
+    if (!azHomed || !elHomed) {   // emergency stop or a re-home
+        finish(true);
+        return;
+    }
+
+    uint32_t now = millis();
+    if (_phase == PHASE_MOVING) {
+        if (axesMoving()) return;
+        _onMs = now;
+        _phase = PHASE_DWELL;
+        pushMarker(0, now);
+        return;
+    }
+    if (now - _onMs < _params.dwellMs) return;
+    uint32_t next = pointIndex() + 1;
+    if (next >= pointCount()) {
+        _index.store(next, std::memory_order_relaxed);
+        finish(false);
+        return;
+    }
+    _index.store(next, std::memory_order_relaxed);
+    if (!moveToPoint()) finish(true);
+}
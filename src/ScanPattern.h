@@ -0,0 +1,133 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include "hal/Hal.h"
+#include "Seqlock.h"
+
+class JsonWriter;
+
+// --- Radio-astronomy scan patterns ---
+// Points are offsets on the sky around a center, in degrees: x along the
+// horizon (cross-elevation), y in elevation. AZ moves x / cos(EL) so a
+// grid keeps its spacing on the sky away from the horizon.
+//
+//   raster         rows of width along x, stepped by step in y over height,
+//                  every row in the same direction
+//   boustrophedon  the same grid, alternate rows reversed
+//   spiral         Archimedean, arms and points step apart, out to
+//                  max(width, height) / 2
+//   cross          a width-long arm along x, then a height-long arm along y
+//   onoff          the center (on source), then width along x (off source)
+//
+// Grids are centered and use whole steps, so an extent that is not a
+// multiple of step is rounded down. The pattern repeats cycles times.
+//
+// The runner lives on the stepper task: it commands a point, starts the
+// dwell the moment both axes have stopped, and leaves after dwellMs
+// (to the task's 1 ms tick). Each arrival is queued as an on-point marker
+// with its millis() and wall-clock time, so a receiver can line its
+// samples up with the pointing without any network jitter; the WebSocket
+// telemetry stream forwards them as {"t":"scan",...}.
+inline constexpr uint32_t SCAN_MAX_POINTS = 20000;
+inline constexpr uint32_t SCAN_MAX_DWELL_MS = 600000;
+inline constexpr float SCAN_MIN_COS_EL = 0.1f;        // AZ stretch capped near the zenith
+inline constexpr uint8_t SCAN_MARKER_RING = 32;
+
+enum ScanKind : uint8_t { SCAN_RASTER, SCAN_BOUSTROPHEDON, SCAN_SPIRAL, SCAN_CROSS, SCAN_ONOFF, SCAN_KINDS };
+
+struct ScanParams {
+    ScanKind kind = SCAN_RASTER;
+    float centerAz = 0.0f;
+    float centerEl = 0.0f;
+    float width = 0.0f;         // x extent; the off-source throw for onoff
+    float height = 0.0f;        // y extent
+    float step = 1.0f;
+    uint32_t dwellMs = 1000;
+    uint16_t cycles = 1;
+};
+
+struct ScanPoint {
+    float x;
+    float y;
+    float az;
+    float el;
+    bool on;                    // false only at the onoff reference
+};
+
+uint32_t scanPointCount(const ScanParams& p);
+bool scanPoint(const ScanParams& p, uint32_t index, ScanPoint& out);
+
+// nullptr if the parameters are usable, else why not
+const char* checkScanParams(const ScanParams& p);
+
+enum ScanMarkerFlag : uint8_t {
+    SCAN_MARK_END = 1 << 0,       // the scan is over; point = points visited
+    SCAN_MARK_ABORTED = 1 << 1,
+};
+
+struct ScanMarker {
+    uint32_t seq;
+    uint32_t point;
+    uint32_t points;
+    uint8_t flags;
+    ScanPoint at;
+    uint32_t ms;                // millis() on arrival
+    uint64_t unixMs;            // 0 while the wall clock is not set
+    uint32_t dwellMs;
+};
+
+// {"t":"scan",...} as sent on the telemetry stream
+void writeScanMarkerJSON(JsonWriter& json, const ScanMarker& m);
+
+class ScanRunner {
+public:
+    // start() checks the parameters and replaces a running scan on the next
+    // update(); one task starts scans (the web handlers). stop() may come
+    // from any task and also cancels a start update() has not taken yet.
+    const char* start(const ScanParams& p);
+    void stop();
+
+    void update();              // stepper task
+
+    // Single consumer (the telemetry socket)
+    bool readMarker(ScanMarker& out);
+
+    bool isRunning() const { return _running.load(std::memory_order_acquire); }
+    uint32_t pointIndex() const { return _index.load(std::memory_order_relaxed); }
+    uint32_t pointCount() const { return _count.load(std::memory_order_relaxed); }
+    ScanKind kind() const { return _params.kind; }
+    uint32_t droppedMarkers() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    enum Phase : uint8_t { PHASE_MOVING, PHASE_DWELL };
+
+    void begin();
+    void finish(bool aborted);
+    bool moveToPoint();
+    void pushMarker(uint8_t flags, uint32_t nowMs);
+
+    Seqlock<ScanParams> _pending;
+    std::atomic<bool> _startPending{false};
+    std::atomic<bool> _stopPending{false};
+    std::atomic<bool> _running{false};
+
+    // Stepper task only
+    ScanParams _params;
+    ScanPoint _point = {};
+    Phase _phase = PHASE_MOVING;
+    uint32_t _onMs = 0;
+    bool _active = false;
+    std::atomic<uint32_t> _index{0};
+    std::atomic<uint32_t> _count{0};
+
+    ScanMarker _ring[SCAN_MARKER_RING];
+    uint32_t _markerSeq = 0;
+    std::atomic<uint32_t> _ringHead{0};     // written by update()
+    std::atomic<uint32_t> _ringTail{0};     // written by readMarker()
+    std::atomic<uint32_t> _dropped{0};
+};
+
+extern ScanRunner scanRunner;
+
+const char* scanKindName(uint8_t kind);
+bool parseScanKind(const char* name, ScanKind& kind);
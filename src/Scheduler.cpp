@@ -0,0 +1,87 @@
+#include "Scheduler.h"
+#include "WebLogger.h"
+
+TickScheduler scheduler;
+
+void TickScheduler::start(CoTask* task, const char* name) {
+    _mux.enter();
+    Slot* free = nullptr;
+    for (auto& slot : _slots) {
+        if (slot.task == task) { free = &slot; break; }
+        if (!slot.task && !free) free = &slot;
+    }
+    if (free) {
+        free->task = task;
+        free->name = name;
+        free->restart = true;
+        free->stop = false;
+    }
+    _mux.exit();
+
+    if (!free) WEB_LOG_ERRORF("[SCHED]", "No free slot for task %s", name);
+}
+
+void TickScheduler::stop(CoTask* task) {
+    _mux.enter();
+    for (auto& slot : _slots) {
+        if (slot.task == task) slot.stop = true;
+    }
+    _mux.exit();
+}
+
+bool TickScheduler::isActive(const CoTask* task) const {
+    bool active = false;
+    _mux.enter();
+    for (const auto& slot : _slots) {
+        if (slot.task == task && !slot.stop) active = true;
+    }
+    _mux.exit();
+    return active;
+}
+
+void TickScheduler::tick() {
+    for (auto& slot : _slots) {
+        _mux.enter();
+        CoTask* task = slot.task;
+        bool restart = slot.restart;
+        bool stop = slot.stop;
+        slot.restart = false;
+        if (stop) {
+            slot.task = nullptr;
+            slot.stop = false;
+        }
+        _mux.exit();
+
+        if (!task || stop) continue;
+        if (restart) task->restart();
+
+        uint32_t t0 = micros();
+        bool running = task->step();
+        uint32_t elapsed = micros() - t0;
+
+        if (elapsed > slot.maxUs) slot.maxUs = elapsed;
+        if (elapsed > TASK_STEP_BUDGET_US) flagOverrun(slot.name, elapsed, TASK_STEP_BUDGET_US);
+
+        if (!running) {
+            // Keep the slot if the task was restarted while it was stepping
+            _mux.enter();
+            if (slot.task == task && !slot.restart) slot.task = nullptr;
+            _mux.exit();
+        }
+    }
+}
+
+void TickScheduler::noteLoopTime(uint32_t elapsedUs) {
+    if (elapsedUs > _loopMaxUs) _loopMaxUs = elapsedUs;
+    if (elapsedUs > LOOP_BUDGET_US) flagOverrun("loop", elapsedUs, LOOP_BUDGET_US);
+}
+
+void TickScheduler::flagOverrun(const char* what, uint32_t elapsedUs, uint32_t budgetUs) {
+    _overruns++;
+    unsigned long now = millis();
+    if (now - _lastBudgetLog < BUDGET_LOG_INTERVAL_MS) return;  // don't let the warning become the overrun
+    _lastBudgetLog = now;
+    WEB_LOG_WARNINGF("[SCHED]", "%s took %lu us (budget %lu us, %lu overruns)",
+                     what ? what : "?", (unsigned long)elapsedUs, (unsigned long)budgetUs,
+                     (unsigned long)_overruns);
+}
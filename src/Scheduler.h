@@ -0,0 +1,71 @@
+#pragma once
+#include "hal/Hal.h"
+
+// ----------------------
+// Cooperative resumable tasks
+// ----------------------
+// step() is re-entered on every scheduler tick and resumes right after the
+// last TASK_AWAIT / TASK_YIELD (stackless, protothread style), so a long
+// sequence never blocks loop(). Locals do not survive a suspension point:
+// keep sequence state in members. One suspension macro per source line.
+class CoTask {
+public:
+    virtual ~CoTask() = default;
+    virtual bool step() = 0;   // true = still running
+    void restart() { _line = 0; }
+
+protected:
+    int _line = 0;
+    unsigned long _waitStart = 0;
+};
+
+#define TASK_BEGIN()      switch (_line) { case 0:
+#define TASK_YIELD()      do { _line = __LINE__; return true; case __LINE__:; } while (0)
+#define TASK_AWAIT(cond)  do { _line = __LINE__; case __LINE__: if (!(cond)) return true; } while (0)
+#define TASK_SLEEP(ms)    do { _waitStart = millis(); TASK_AWAIT(millis() - _waitStart >= (ms)); } while (0)
+#define TASK_EXIT()       do { _line = 0; return false; } while (0)
+#define TASK_END()        } _line = 0; return false
+
+// --- Budgets ---
+inline constexpr uint8_t SCHEDULER_MAX_TASKS = 8;
+inline constexpr uint32_t TASK_STEP_BUDGET_US = 2000;   // one step() call
+inline constexpr uint32_t LOOP_BUDGET_US = 10000;       // one loop() pass
+inline constexpr unsigned long BUDGET_LOG_INTERVAL_MS = 1000;
+
+// ----------------------
+// Tick scheduler, driven from loop()
+// ----------------------
+// start()/stop() may be called from any task (web handlers, rotctl); they
+// only post a request, the task itself is always stepped from tick().
+class TickScheduler {
+public:
+    void start(CoTask* task, const char* name);
+    void stop(CoTask* task);
+    bool isActive(const CoTask* task) const;
+    void tick();
+
+    // Loop-time budget check, call once per loop() with the pass duration
+    void noteLoopTime(uint32_t elapsedUs);
+
+    uint32_t getOverruns() const { return _overruns; }
+    uint32_t getLoopMaxUs() const { return _loopMaxUs; }
+
+private:
+    struct Slot {
+        CoTask* task = nullptr;
+        const char* name = nullptr;
+        bool restart = false;
+        bool stop = false;
+        uint32_t maxUs = 0;
+    };
+
+    void flagOverrun(const char* what, uint32_t elapsedUs, uint32_t budgetUs);
+
+    Slot _slots[SCHEDULER_MAX_TASKS];
+    mutable hal::CriticalSection _mux;
+    uint32_t _overruns = 0;
+    uint32_t _loopMaxUs = 0;
+    unsigned long _lastBudgetLog = 0;
+};
+
+extern TickScheduler scheduler;
@@ -0,0 +1,93 @@
+// SensorRecorder.cpp - LSM303 packet ring and capture file
+#include "SensorRecorder.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+SensorRecorder sensorRecorder;
+
+bool SensorRecorder::start() {
+    if (!_samples) {
+        _samples = (SensorSample*)malloc(SENSOR_REC_CAPACITY * sizeof(SensorSample));
+        if (!_samples) return false;
+    }
+    _resetPending.store(true, std::memory_order_release);
+    _recording.store(true, std::memory_order_release);
+    return true;
+}
+
+// The receiver owns _head; start() only asks for the reset
+void SensorRecorder::push(const SensorSample& s) {
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    if (_resetPending.load(std::memory_order_acquire)) {
+        head = 0;
+        _head.store(0, std::memory_order_relaxed);
+        _resetPending.store(false, std::memory_order_release);
+    }
+    _samples[head % SENSOR_REC_CAPACITY] = s;
+    _head.store(head + 1, std::memory_order_release);
+}
+
+void SensorRecorder::record(uint32_t tUs, const float mag[3], const float acc[3]) {
+    if (!recording()) return;
+    SensorSample s;
+    s.tUs = tUs;
+    memcpy(s.mag, mag, sizeof(s.mag));
+    memcpy(s.acc, acc, sizeof(s.acc));
+    push(s);
+}
+
+void SensorRecorder::recordMalformed(uint32_t tUs) {
+    if (!recording()) return;
+    SensorSample s = {tUs, {NAN, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}};
+    push(s);
+}
+
+uint32_t SensorRecorder::written() const {
+    if (_resetPending.load(std::memory_order_acquire)) return 0;
+    return _head.load(std::memory_order_acquire);
+}
+
+size_t SensorRecorder::count() const {
+    uint32_t head = written();
+    return head < SENSOR_REC_CAPACITY ? head : SENSOR_REC_CAPACITY;
+}
+
+uint32_t SensorRecorder::overwritten() const {
+    uint32_t head = written();
+    return head > SENSOR_REC_CAPACITY ? head - SENSOR_REC_CAPACITY : 0;
+}
+
+const SensorSample& SensorRecorder::sample(size_t i) const {
+    uint32_t first = written() - count();
+    return _samples[(first + i) % SENSOR_REC_CAPACITY];
+}
+
+size_t SensorRecorder::captureSize() const {
+    return sizeof(SensorCaptureHeader) + count() * sizeof(SensorSample);
+}
+
+size_t SensorRecorder::readCapture(uint8_t* out, size_t len, size_t offset) const {
+    SensorCaptureHeader header = {SENSOR_CAPTURE_MAGIC, SENSOR_CAPTURE_VERSION,
+                                  (uint16_t)sizeof(SensorSample), (uint32_t)count(), overwritten()};
+    size_t total = captureSize();
+    size_t done = 0;
+    while (done < len && offset < total) {
+        const uint8_t* src;
+        size_t avail;
+        if (offset < sizeof(header)) {
+            src = (const uint8_t*)&header + offset;
+            avail = sizeof(header) - offset;
+        } else {
+            size_t pos = offset - sizeof(header);
+            size_t within = pos % sizeof(SensorSample);
+            src = (const uint8_t*)&sample(pos / sizeof(SensorSample)) + within;
+            avail = sizeof(SensorSample) - within;
+        }
+        size_t n = avail < len - done ? avail : len - done;
+        memcpy(out + done, src, n);
+        done += n;
+        offset += n;
+    }
+    return done;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// --- LSM303 packet recorder ---
+// While recording, every packet the receiver gets is kept with its
+// arrival time in a RAM ring, so the last SENSOR_REC_CAPACITY packets
+// before a field problem can be downloaded and replayed on the host
+// (src/sim/SensorReplay.h) through the same receiver code.
+//
+// Samples store the six values the receiver parsed, which the replay
+// formats back losslessly; a packet that did not parse is kept as a
+// sample with NaN in mag[0]. The buffer is allocated on the first
+// start() and kept, so builds that never record pay nothing.
+//
+// Capture file (little-endian): SensorCaptureHeader, then `count`
+// SensorSample records, oldest first.
+inline constexpr size_t SENSOR_REC_CAPACITY = 1024;            // ~20 s at 50 Hz, 28 KB
+inline constexpr uint32_t SENSOR_CAPTURE_MAGIC = 0x524D534C;   // "LSMR"
+inline constexpr uint16_t SENSOR_CAPTURE_VERSION = 1;
+
+struct SensorSample {
+    uint32_t tUs;       // micros() at arrival
+    float mag[3];
+    float acc[3];
+};
+static_assert(sizeof(SensorSample) == 28, "capture format");
+
+struct SensorCaptureHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t sampleSize;
+    uint32_t count;
+    uint32_t overwritten;   // older samples the ring no longer holds
+};
+static_assert(sizeof(SensorCaptureHeader) == 16, "capture format");
+
+class SensorRecorder {
+public:
+    // Clears the ring and starts recording; false if the buffer could not
+    // be allocated. The receiver applies the clear on its next packet, so
+    // a handler never races it.
+    bool start();
+    void stop() { _recording.store(false, std::memory_order_release); }
+    bool recording() const { return _recording.load(std::memory_order_relaxed); }
+
+    // From the receiver (one producer)
+    void record(uint32_t tUs, const float mag[3], const float acc[3]);
+    void recordMalformed(uint32_t tUs);
+
+    size_t count() const;
+    uint32_t overwritten() const;
+    size_t capacity() const { return SENSOR_REC_CAPACITY; }
+    const SensorSample& sample(size_t i) const;   // 0 = oldest
+
+    // Capture file, read in pieces for a streamed download. Stop first:
+    // a sample written during the read would be torn.
+    size_t captureSize() const;
+    size_t readCapture(uint8_t* out, size_t len, size_t offset) const;
+
+private:
+    void push(const SensorSample& s);
+    uint32_t written() const;           // 0 while a reset is pending
+
+    SensorSample* _samples = nullptr;
+    std::atomic<uint32_t> _head{0};     // samples written since start()
+    std::atomic<bool> _recording{false};
+    std::atomic<bool> _resetPending{false};
+};
+
+extern SensorRecorder sensorRecorder;
@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include "hal/Hal.h"
+
+// Single-writer seqlock for a small trivially copyable struct.
+//
+// The writer bumps the sequence to odd, stores the value, then bumps it to
+// even again; it never waits. Readers copy the value and retry if the
+// sequence was odd or moved meanwhile, so they never see a mix of two
+// writes and never block the writer. The payload is held as relaxed
+// atomic words, which keeps the concurrent copy free of data races.
+//
+// The odd window runs in a critical section: a higher-priority reader on
+// the writer's core (async_tcp over the stepper task) could otherwise
+// preempt it there and spin on a sequence that can never turn even.
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock payload must be trivially copyable");
+
+public:
+    Seqlock() {
+        T zero{};
+        write(zero);
+    }
+
+    // Only one thread may write
+    void write(const T& value) {
+        uint32_t buf[WORDS] = {};
+        memcpy(buf, &value, sizeof(T));
+
+        _writing.enter();
+        uint32_t s = _seq.load(std::memory_order_relaxed);
+        _seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++) _words[i].store(buf[i], std::memory_order_relaxed);
+        _seq.store(s + 2, std::memory_order_release);
+        _writing.exit();
+    }
+
+    // False if a write was in progress for every one of maxTries attempts
+    bool tryRead(T& out, uint32_t maxTries = 64) const {
+        uint32_t buf[WORDS];
+        while (maxTries--) {
+            uint32_t s1 = _seq.load(std::memory_order_acquire);
+            if (s1 & 1) continue;
+            for (size_t i = 0; i < WORDS; i++) buf[i] = _words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_seq.load(std::memory_order_relaxed) != s1) continue;
+            memcpy(&out, buf, sizeof(T));
+            return true;
+        }
+        _contended.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Blocks for a tick between bounded attempts rather than spinning, so
+    // a contended reader never starves the writer or the task watchdog
+    T read() const {
+        T out;
+        while (!tryRead(out)) hal::sleepMs(1);
+        return out;
+    }
+
+    // Number of completed writes
+    uint32_t version() const { return _seq.load(std::memory_order_acquire) / 2; }
+    // tryRead calls that ran out of attempts
+    uint32_t contended() const { return _contended.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + 3) / 4;
+
+    std::atomic<uint32_t> _seq{0};
+    std::atomic<uint32_t> _words[WORDS];
+    mutable std::atomic<uint32_t> _contended{0};
+    hal::CriticalSection _writing;
+};
@@ -0,0 +1,54 @@
+// SlewTime.cpp - trapezoidal move time per axis
+#include "SlewTime.h"
+#include <math.h>
+#include "MotorControl.h"
+
+extern const int MIN_AZ;
+extern const int MAX_AZ;
+extern const int MIN_EL;
+extern const int MAX_EL;
+
+float predictAxisSeconds(float position, float velocity, float target, float maxSpeedHz, float accel) {
+    float t = 0.0f;
+    float d = target - position;
+    float v = fabsf(velocity);
+    float dir = velocity > 0.0f ? 1.0f : velocity < 0.0f ? -1.0f : 0.0f;
+
+    // Moving away, or unable to stop in time: brake, then start over from rest
+    float stopDist = v * v / (2.0f * accel);
+    if (dir != 0.0f && (d * dir < 0.0f || stopDist > fabsf(d))) {
+        t += v / accel;
+        d -= dir * stopDist;
+        v = 0.0f;
+    }
+
+    float dist = fabsf(d);
+    if (dist < 0.5f) return t;
+    if (v > maxSpeedHz) {
+        // Above the cruise rate (the limit was lowered): slow down to it
+        t += (v - maxSpeedHz) / accel;
+        dist -= (v * v - maxSpeedHz * maxSpeedHz) / (2.0f * accel);
+        v = maxSpeedHz;
+    }
+
+    // Triangle if the peak stays below the cruise rate, else trapezoid
+    float peakSq = accel * dist + v * v / 2.0f;
+    if (peakSq <= maxSpeedHz * maxSpeedHz) {
+        float peak = sqrtf(peakSq);
+        return t + (2.0f * peak - v) / accel;
+    }
+    float rampDist = (2.0f * maxSpeedHz * maxSpeedHz - v * v) / (2.0f * accel);
+    return t + (2.0f * maxSpeedHz - v) / accel + (dist - rampDist) / maxSpeedHz;
+}
+
+SlewPrediction predictSlew(const TelemetrySnapshot& snap, float az, float el) {
+    SlewPrediction p;
+    p.az = constrain(az, MIN_AZ, MAX_AZ);
+    p.el = constrain(el, MIN_EL, MAX_EL);
+    p.azSec = predictAxisSeconds(snap.azSteps, snap.azSpeedMilliHz / 1000.0f, azToSteps(p.az),
+                                 MOTOR_SPEED_HZ, MOTOR_ACCELERATION);
+    p.elSec = predictAxisSeconds(snap.elSteps, snap.elSpeedMilliHz / 1000.0f, elToSteps(p.el),
+                                 MOTOR_SPEED_HZ, MOTOR_ACCELERATION);
+    p.seconds = p.azSec > p.elSec ? p.azSec : p.elSec;
+    return p;
+}
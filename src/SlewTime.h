@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+#include "TelemetrySnapshot.h"
+
+// --- Slew-time prediction ---
+// How long the rotator needs to reach a position from its current state,
+// using the same trapezoidal ramps as the stepper driver: an axis moving
+// away from the target, or too fast to stop before it, brakes to a
+// standstill first; then it accelerates towards the target, cruises at
+// the maximum rate if there is room, and decelerates onto it.
+//
+// Targets are clamped like rotctl's P. AZ moves straight to the commanded
+// angle (the firmware picks no wrap direction in the overlap above 360)
+// and both axes start together without a coordinated profile, so the
+// slew takes as long as the slower axis.
+
+struct SlewPrediction {
+    float az;               // targets after clamping
+    float el;
+    float azSec;
+    float elSec;
+    float seconds;          // the slower axis
+};
+
+// One axis, in steps and steps/s (velocity signed)
+float predictAxisSeconds(float position, float velocity, float target, float maxSpeedHz, float accel);
+
+// From the published state, at MOTOR_SPEED_HZ and MOTOR_ACCELERATION
+SlewPrediction predictSlew(const TelemetrySnapshot& snap, float az, float el);
@@ -0,0 +1,59 @@
+// StatusJson.cpp - the /status body
+#include "StatusJson.h"
+#include "JsonWriter.h"
+#include "Scheduler.h"
+#include "AllocTracker.h"
+#include "TrackingMetrics.h"
+
+extern bool rotctlConnected;
+extern bool warmStarted;
+extern unsigned long operationalMs;
+extern const char* HARDWARE_ID;
+extern const char* FIRMWARE_VERSION;
+
+void writeTrackingFields(JsonWriter& json) {
+    json.key("tracking").beginObject();
+    json.kv("beamwidth", trackingMetrics.beamwidth(), 2);
+    json.key("current");
+    writeTrackingPassJSON(json, trackingMetrics.current());
+    json.key("last");
+    writeTrackingPassJSON(json, trackingMetrics.last());
+    json.endObject();
+}
+
+void writeStatusFields(JsonWriter& json, const TelemetrySnapshot& snap, uint32_t nowMs) {
+    json.kv("lsmAz", snap.lsmAz, 1);
+    json.kv("lsmAzTrue", snap.lsmAzTrue, 1);
+    json.kv("lsmEl", snap.lsmEl, 1);
+    json.kv("lsmElCorr", snap.lsmElCorr, 1);
+
+    json.kv("az", snap.azDeg, 1);
+    json.kv("el", snap.elDeg, 1);
+    json.kv("azLimit", snap.azLimit);
+    json.kv("elLimit", snap.elLimit);
+    json.kv("azHomed", snap.azHomed);
+    json.kv("snapshotAgeMs", (uint32_t)(nowMs - snap.timestampMs));
+    json.key("tasks").beginArray().endArray();
+    json.kv("rotctl", rotctlConnected);
+    json.kv("warmStart", warmStarted);
+    json.kv("operationalMs", operationalMs);
+    json.kv("loopMaxUs", scheduler.getLoopMaxUs());
+    json.kv("budgetOverruns", scheduler.getOverruns());
+    writeTrackingFields(json);
+
+    // Heap calls since setup() by subsystem
+    json.key("alloc").beginObject();
+    for (uint8_t i = 0; i < ALLOC_SUBSYSTEMS; i++) {
+        AllocCounts ac = allocTracker.counts((AllocSubsystem)i);
+        json.key(ALLOC_SUBSYSTEM_NAMES[i]).beginObject();
+        json.kv("allocs", ac.allocs);
+        json.kv("frees", ac.frees);
+        json.kv("bytes", ac.bytes);
+        json.endObject();
+    }
+    json.kv("violations", allocTracker.violations());
+    json.endObject();
+
+    json.kv("hardware", HARDWARE_ID);
+    json.kv("firmware", FIRMWARE_VERSION);
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "TelemetrySnapshot.h"
+
+class JsonWriter;
+
+// Members of the /status object that come from the snapshot and the
+// firmware counters, written into an object the caller has opened. Kept
+// apart from the handler so the benchmarks and host tests can build it.
+void writeStatusFields(JsonWriter& json, const TelemetrySnapshot& snap, uint32_t nowMs);
+
+// The "tracking" member: beamwidth, the running pass and the last one
+// (TrackingMetrics.h); also the /tracking body
+void writeTrackingFields(JsonWriter& json);
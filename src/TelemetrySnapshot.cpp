@@ -0,0 +1,45 @@
+#include "TelemetrySnapshot.h"
+#include "MotorControl.h"
+#include "MathUtils.h"
+#include "Homing.h"
+#include "LSM303Receiver.h"
+#include "AllocTracker.h"
+
+extern LSM303Receiver lsmReceiver;
+extern bool useLSMforEl;
+extern const int AZ_LIMIT_PIN;
+extern const int EL_LIMIT_PIN;
+
+Seqlock<TelemetrySnapshot> telemetrySnapshot;
+
+void publishTelemetrySnapshot() {
+    ALLOC_FORBID();
+    TelemetrySnapshot s = {};
+    unsigned long now = millis();
+    s.timestampMs = now;
+
+    s.azSteps = azMotor ? azMotor->getCurrentPosition() : 0;
+    s.elSteps = elMotor1 ? elMotor1->getCurrentPosition() : 0;
+    s.azDeg = stepsToAz(s.azSteps);
+    s.elDeg = stepsToEl(s.elSteps);
+    s.azSpeedMilliHz = azMotor ? azMotor->getCurrentSpeedInMilliHz() : 0;
+    s.elSpeedMilliHz = elMotor1 ? elMotor1->getCurrentSpeedInMilliHz() : 0;
+    s.azRunning = azMotor && azMotor->isRunning();
+    s.elRunning = (elMotor1 && elMotor1->isRunning()) ||
+                  (elGangedDrive && elMotor2 && elMotor2->isRunning());
+
+    s.lsmAgeMs = now - lsmReceiver.getLastUpdate();
+    s.lsmFresh = s.lsmAgeMs < SNAPSHOT_LSM_FRESH_MS;
+    s.lsmAz = s.lsmFresh ? lsmReceiver.getAzimuth() : 0.0f;
+    s.lsmAzTrue = s.lsmFresh ? magneticToTrue(s.lsmAz) : 0.0f;
+    s.lsmEl = s.lsmFresh ? lsmReceiver.getElevation() : 0.0f;
+    s.lsmElCorr = lsmReceiver.getElCorrected();
+    s.elReported = useLSMforEl ? s.lsmElCorr : s.elDeg;
+
+    s.azLimit = (AZ_LIMIT_PIN >= 0) ? digitalRead(AZ_LIMIT_PIN) : 0;
+    s.elLimit = (EL_LIMIT_PIN >= 0) ? digitalRead(EL_LIMIT_PIN) : 0;
+    s.azHomed = azHomed;
+    s.elHomed = elHomed;
+
+    telemetrySnapshot.write(s);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "hal/Hal.h"
+#include "Seqlock.h"
+
+// One timestamped view of the rotator, published by the motion side and
+// read by the web handlers, the WebSocket channel and rotctl without locks
+// or hardware access.
+struct TelemetrySnapshot {
+    uint32_t timestampMs;
+    int32_t azSteps;
+    int32_t elSteps;
+    int32_t azSpeedMilliHz;   // step rate, signed
+    int32_t elSpeedMilliHz;
+    float azDeg;              // from step counts
+    float elDeg;
+    float elReported;         // EL source selected by useLSMforEl
+    float lsmAz;              // LSM303 values, 0 when the sensor is stale
+    float lsmAzTrue;
+    float lsmEl;
+    float lsmElCorr;          // corrected EL, always the last value received
+    uint32_t lsmAgeMs;
+    int8_t azLimit;           // raw pin level, LOW = triggered
+    int8_t elLimit;
+    bool lsmFresh;
+    bool azHomed;
+    bool elHomed;
+    bool azRunning;
+    bool elRunning;
+};
+
+inline constexpr uint32_t SNAPSHOT_PUBLISH_MS = 5;       // from the stepper task
+inline constexpr uint32_t SNAPSHOT_LSM_FRESH_MS = 2000;
+
+extern Seqlock<TelemetrySnapshot> telemetrySnapshot;
+
+// Samples motors, limit pins and the LSM303 receiver and publishes them
+void publishTelemetrySnapshot();
+
+inline TelemetrySnapshot readTelemetrySnapshot() {
+    return telemetrySnapshot.read();
+}
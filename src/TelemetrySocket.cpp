@@ -0,0 +1,402 @@
+#include "TelemetrySocket.h"
+#include "WebInterface.h"
+#include "WebLogger.h"
+#include "JsonWriter.h"
+#include "MotorControl.h"
+#include "ScanPattern.h"
+#include "Scheduler.h"
+#include "TelemetrySnapshot.h"
+#include "TrackingMetrics.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+extern bool warmStarted;
+extern unsigned long operationalMs;
+
+static AsyncWebSocket telemetrySocket("/ws");
+static TelemetryStats stats;
+static uint32_t intervalMs = TELEMETRY_DEFAULT_INTERVAL_MS;
+static unsigned long lastFrameMs = 0;
+static unsigned long lastKeyframeMs = 0;
+static unsigned long lastTasksMs = 0;
+static uint32_t lastTasksHash = 0;
+static bool tasksRequested = true;
+static volatile bool fullFrameRequested = false;
+static volatile bool connectPending = false;
+static volatile uint32_t connectHeap = 0;
+static uint32_t heapBaseline = 0;
+
+// ----------------------
+// Telemetry fields: values are quantised to their display precision so
+// sensor noise below it does not count as a change.
+// ----------------------
+enum FieldType : uint8_t { FIELD_FLOAT, FIELD_INT, FIELD_BOOL };
+
+struct TelemetryField {
+    const char* key;
+    FieldType type;
+    uint8_t decimals;
+};
+
+static const TelemetryField FIELDS[] = {
+    {"lsmAz",          FIELD_FLOAT, 1},
+    {"lsmAzTrue",      FIELD_FLOAT, 1},
+    {"lsmEl",          FIELD_FLOAT, 1},
+    {"lsmElCorr",      FIELD_FLOAT, 1},
+    {"az",             FIELD_FLOAT, 1},
+    {"el",             FIELD_FLOAT, 1},
+    {"azLimit",        FIELD_INT,   0},
+    {"elLimit",        FIELD_INT,   0},
+    {"azHomed",        FIELD_BOOL,  0},
+    {"rotctl",         FIELD_BOOL,  0},
+    {"warmStart",      FIELD_BOOL,  0},
+    {"operationalMs",  FIELD_INT,   0},
+    {"loopMaxUs",      FIELD_INT,   0},
+    {"budgetOverruns", FIELD_INT,   0},
+    {"calRunning",     FIELD_BOOL,  0},
+    {"azMin",          FIELD_FLOAT, 2},
+    {"azMax",          FIELD_FLOAT, 2},
+    {"elMin",          FIELD_FLOAT, 2},
+    {"elMax",          FIELD_FLOAT, 2},
+    {"samples",        FIELD_INT,   0},
+    {"sweepMs",        FIELD_INT,   0},
+    {"azBins",         FIELD_INT,   0},
+    {"elBins",         FIELD_INT,   0},
+    // Tracking panel: the running pass, or the last one once it ended
+    {"trkPass",        FIELD_INT,   0},
+    {"trkActive",      FIELD_BOOL,  0},
+    {"trkAzRms",       FIELD_FLOAT, 2},
+    {"trkAzSensorRms", FIELD_FLOAT, 2},
+    {"trkAzInBeam",    FIELD_INT,   0},
+    {"trkAzSettleMs",  FIELD_INT,   0},
+    {"trkElRms",       FIELD_FLOAT, 2},
+    {"trkElSensorRms", FIELD_FLOAT, 2},
+    {"trkElInBeam",    FIELD_INT,   0},
+    {"trkElSettleMs",  FIELD_INT,   0},
+};
+static constexpr size_t FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+
+static int64_t sentQuant[FIELD_COUNT];
+
+static void sampleFields(float* v) {
+    TelemetrySnapshot snap = readTelemetrySnapshot();
+    size_t i = 0;
+    v[i++] = snap.lsmAz;
+    v[i++] = snap.lsmAzTrue;
+    v[i++] = snap.lsmEl;
+    v[i++] = snap.lsmElCorr;
+    v[i++] = snap.azDeg;
+    v[i++] = snap.elDeg;
+    v[i++] = snap.azLimit;
+    v[i++] = snap.elLimit;
+    v[i++] = snap.azHomed;
+    v[i++] = rotctlConnected;
+    v[i++] = warmStarted;
+    v[i++] = operationalMs;
+    v[i++] = scheduler.getLoopMaxUs();
+    v[i++] = scheduler.getOverruns();
+    v[i++] = calib.isRunning();
+    v[i++] = lsmReceiver.getAzMin();
+    v[i++] = lsmReceiver.getAzMax();
+    v[i++] = lsmReceiver.getElMin();
+    v[i++] = lsmReceiver.getElMax();
+    v[i++] = calib.getSampleCount();
+    v[i++] = calib.getSweepMs();
+    v[i++] = calib.getAzBinsCovered();
+    v[i++] = calib.getElBinsCovered();
+
+    TrackingPass pass = trackingMetrics.current();
+    if (!pass.active) pass = trackingMetrics.last();
+    v[i++] = pass.number;
+    v[i++] = pass.active;
+    for (uint8_t a = 0; a < TRACK_AXES; a++) {
+        const AxisTracking& ax = pass.axis[a];
+        v[i++] = ax.steps.rms();
+        v[i++] = ax.sensor.rms();
+        v[i++] = ax.steps.withinPct();
+        v[i++] = ax.settleMeanMs();
+    }
+}
+
+static int64_t quantise(const TelemetryField& f, float v) {
+    if (f.type != FIELD_FLOAT) return (int64_t)v;
+    float scale = f.decimals == 1 ? 10.0f : f.decimals == 2 ? 100.0f : 1.0f;
+    return llroundf(v * scale);
+}
+
+static void broadcast(const char* msg, size_t len) {
+    // AsyncWebSocket drops messages for clients whose queue is full;
+    // skip the frame instead and let the next one carry the change
+    if (!telemetrySocket.availableForWriteAll()) {
+        stats.skipped++;
+        return;
+    }
+    telemetrySocket.textAll(msg, len);
+    stats.bytes += len;
+}
+
+static void sendFrame(bool full) {
+    float v[FIELD_COUNT];
+    sampleFields(v);
+
+    char buf[TELEMETRY_FRAME_LEN];
+    JsonBuffer json(buf, sizeof(buf));
+    json.beginObject();
+    json.kv("t", "tel");
+    size_t changed = 0;
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+        const TelemetryField& f = FIELDS[i];
+        int64_t q = quantise(f, v[i]);
+        if (!full && q == sentQuant[i]) continue;
+        changed++;
+        switch (f.type) {
+            case FIELD_FLOAT: json.kv(f.key, v[i], f.decimals); break;
+            case FIELD_INT:   json.kv(f.key, q); break;
+            case FIELD_BOOL:  json.kv(f.key, q != 0); break;
+        }
+    }
+    if (full) {
+        json.kv("hardware", HARDWARE_ID);
+        json.kv("firmware", FIRMWARE_VERSION);
+        json.kv("rate", intervalMs);
+    }
+    json.endObject();
+    if (changed == 0 && !full) return;
+    if (json.overflowed()) {
+        WEB_LOG_ERROR("[WS]", "Telemetry frame overflow");
+        return;
+    }
+
+    size_t before = stats.skipped;
+    broadcast(json.c_str(), json.length());
+    if (stats.skipped != before) return;   // keep the old values as unsent
+
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+        sentQuant[i] = quantise(FIELDS[i], v[i]);
+    }
+    stats.frames++;
+    if (full) stats.fullFrames++;
+}
+
+// FreeRTOS task list, sent only when it changed
+static void sendTasks() {
+    static char taskList[2048];
+    memset(taskList, 0, sizeof(taskList));
+    vTaskList(taskList);
+
+    uint32_t hash = 2166136261u;   // FNV-1a
+    for (const char* p = taskList; *p; p++) hash = (hash ^ (uint8_t)*p) * 16777619u;
+    if (hash == lastTasksHash) return;
+
+    static char buf[sizeof(taskList) + 256];
+    JsonBuffer json(buf, sizeof(buf));
+    json.beginObject().kv("t", "tasks").kv("list", taskList).endObject();
+    if (json.overflowed()) return;
+    size_t before = stats.skipped;
+    broadcast(json.c_str(), json.length());
+    if (stats.skipped == before) lastTasksHash = hash;
+}
+
+// ----------------------
+// Commands (text frames): "estop", "homeAz", "homeEl", "jog az|el <deg>",
+// "move <az> <el>", "autocal [seq]", "alpha <0..1>", "elsource <0|1>",
+// "rate <ms>". Each is answered with {"t":"ack","cmd":...,"ok":...}.
+// Runs in the async_tcp task, like the HTTP handlers.
+// ----------------------
+static bool runCommand(char* line, const char** name) {
+    char cmd[16] = "";
+    char arg[16] = "";
+    float a = 0, b = 0;
+    int n = sscanf(line, "%15s %15s %f", cmd, arg, &b);
+    *name = "?";
+
+    if (strcmp(cmd, "estop") == 0) {
+        *name = "estop";
+        emergencyStop();
+        WEB_LOG_WARN("WebUI", "Emergency stop requested");
+        return true;
+    }
+    if (strcmp(cmd, "homeAz") == 0) {
+        *name = "homeAz";
+        homeAzimuth();
+        WEB_LOG_INFO("WebUI", "Started homing AZ");
+        return true;
+    }
+    if (strcmp(cmd, "homeEl") == 0) {
+        *name = "homeEl";
+        homeElevation();
+        WEB_LOG_INFO("WebUI", "Started homing EL");
+        return true;
+    }
+    if (strcmp(cmd, "jog") == 0 && n == 3) {
+        *name = "jog";
+        if (strcmp(arg, "az") == 0) {
+            moveAzimuthDeg(-1 * b);
+            WEB_LOG_INFOF("WebUI", "Jog AZ %f deg", b);
+            return true;
+        }
+        if (strcmp(arg, "el") == 0) {
+            moveElevationDeg(-1 * b);
+            WEB_LOG_INFOF("WebUI", "Jog EL %f deg", b);
+            return true;
+        }
+        return false;
+    }
+    if (strcmp(cmd, "move") == 0 && n == 3) {
+        *name = "move";
+        a = strtof(arg, nullptr);
+        moveAzimuthToPosition(a);
+        moveElevationToPosition(b);
+        WEB_LOG_INFOF("WebUI", "Move to AZ %f EL %f deg", a, b);
+        return true;
+    }
+    if (strcmp(cmd, "autocal") == 0) {
+        *name = "autocal";
+        if (calib.isRunning()) return false;
+        calib.start(strcmp(arg, "seq") == 0 ? CAL_MODE_SEQUENTIAL : CAL_MODE_CONCURRENT);
+        return true;
+    }
+    if (strcmp(cmd, "alpha") == 0 && n >= 2) {
+        *name = "alpha";
+        smoothingAlpha = constrain(strtof(arg, nullptr), 0.0f, 1.0f);
+        WEB_LOG_INFOF("WebUI", "Smoothing factor updated: %.2f", smoothingAlpha);
+        return true;
+    }
+    if (strcmp(cmd, "elsource") == 0 && n >= 2) {
+        *name = "elsource";
+        useLSMforEl = atoi(arg) != 0;
+        WEB_LOG_INFOF("WebUI", "Use LSM for Elevation: %s", useLSMforEl ? "YES" : "NO");
+        return true;
+    }
+    if (strcmp(cmd, "rate") == 0 && n >= 2) {
+        *name = "rate";
+        setTelemetryInterval(strtoul(arg, nullptr, 10));
+        return true;
+    }
+    return false;
+}
+
+static void onSocketEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
+                          AwsEventType type, void* arg, uint8_t* data, size_t len) {
+    switch (type) {
+        case WS_EVT_CONNECT:
+            connectHeap = ESP.getFreeHeap();
+            connectPending = true;
+            fullFrameRequested = true;
+            stats.connects++;
+            WEB_LOG_INFOF("[WS]", "Client #%lu connected (%u clients)",
+                          (unsigned long)client->id(), (unsigned)server->count());
+            break;
+
+        case WS_EVT_DISCONNECT:
+            WEB_LOG_INFOF("[WS]", "Client #%lu disconnected", (unsigned long)client->id());
+            break;
+
+        case WS_EVT_DATA: {
+            AwsFrameInfo* info = static_cast<AwsFrameInfo*>(arg);
+            // Commands are short: only single, unfragmented text frames
+            if (!info->final || info->index != 0 || info->len != len || info->opcode != WS_TEXT) break;
+            char line[TELEMETRY_COMMAND_LEN];
+            size_t n = len < sizeof(line) - 1 ? len : sizeof(line) - 1;
+            memcpy(line, data, n);
+            line[n] = '\0';
+
+            const char* name;
+            bool ok = runCommand(line, &name);
+            stats.commands++;
+
+            char ack[96];
+            JsonBuffer json(ack, sizeof(ack));
+            json.beginObject().kv("t", "ack").kv("cmd", name).kv("ok", ok).endObject();
+            client->text(json.c_str(), json.length());
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void setupTelemetrySocket(AsyncWebServer& server) {
+    telemetrySocket.onEvent(onSocketEvent);
+    server.addHandler(&telemetrySocket);
+}
+
+// On-point markers from the scan runner, {"t":"scan",...}; drained even
+// with no client so a late connection does not get a burst of stale ones
+static void sendScanMarkers() {
+    ScanMarker m;
+    while (scanRunner.readMarker(m)) {
+        if (telemetrySocket.count() == 0) continue;
+        char buf[256];
+        JsonBuffer json(buf, sizeof(buf));
+        writeScanMarkerJSON(json, m);
+        if (!json.overflowed()) broadcast(json.c_str(), json.length());
+    }
+}
+
+void updateTelemetrySocket() {
+    ALLOC_SCOPE(ALLOC_TELEMETRY);
+    unsigned long now = millis();
+    sendScanMarkers();
+    if (telemetrySocket.count() == 0) {
+        heapBaseline = ESP.getFreeHeap();
+        return;
+    }
+    if (connectPending) {
+        connectPending = false;
+        stats.lastConnectHeap = (int32_t)connectHeap - (int32_t)heapBaseline;
+    }
+
+    bool requested = fullFrameRequested;
+    bool full = requested || now - lastKeyframeMs >= TELEMETRY_KEYFRAME_MS;
+    if (full || now - lastFrameMs >= intervalMs) {
+        if (full) {
+            fullFrameRequested = false;
+            lastKeyframeMs = now;
+        }
+        if (requested) {
+            // A new client needs the task list too; the periodic keyframe
+            // leaves it to the hash so an unchanged list is not resent
+            lastTasksHash = 0;
+            tasksRequested = true;
+        }
+        lastFrameMs = now;
+        sendFrame(full);
+    }
+
+    if (tasksRequested || now - lastTasksMs >= TELEMETRY_TASKS_MS) {
+        tasksRequested = false;
+        lastTasksMs = now;
+        sendTasks();
+    }
+
+    telemetrySocket.cleanupClients();
+    heapBaseline = ESP.getFreeHeap();
+}
+
+// Log entries go to the socket as {"t":"log","e":{...}}
+void sendTelemetryLog(const char* entryJson) {
+    if (telemetrySocket.count() == 0) return;
+    char buf[WEB_LOG_JSON_LEN + 24];
+    JsonBuffer json(buf, sizeof(buf));
+    json.beginObject().kv("t", "log").key("e").raw(entryJson).endObject();
+    if (!json.overflowed()) broadcast(json.c_str(), json.length());
+}
+
+void setTelemetryInterval(uint32_t ms) {
+    intervalMs = constrain(ms, TELEMETRY_MIN_INTERVAL_MS, TELEMETRY_MAX_INTERVAL_MS);
+    fullFrameRequested = true;   // carries the new rate to every client
+}
+
+uint32_t getTelemetryInterval() {
+    return intervalMs;
+}
+
+size_t getTelemetryClients() {
+    return telemetrySocket.count();
+}
+
+const TelemetryStats& getTelemetryStats() {
+    return stats;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+// --- WebSocket telemetry (/ws) ---
+// One socket per page replaces the /status, /cal/status, /logs and /tasks
+// pollers. Frames carry only the fields that changed since the last frame;
+// a full frame goes out when a client connects and every keyframe period
+// so a message dropped from a full client queue cannot leave stale values.
+inline constexpr uint32_t TELEMETRY_DEFAULT_INTERVAL_MS = 250;
+inline constexpr uint32_t TELEMETRY_MIN_INTERVAL_MS = 50;
+inline constexpr uint32_t TELEMETRY_MAX_INTERVAL_MS = 5000;
+inline constexpr uint32_t TELEMETRY_KEYFRAME_MS = 5000;
+inline constexpr uint32_t TELEMETRY_TASKS_MS = 5000;
+inline constexpr size_t TELEMETRY_FRAME_LEN = 1024;
+inline constexpr size_t TELEMETRY_COMMAND_LEN = 64;
+
+struct TelemetryStats {
+    uint32_t frames = 0;        // telemetry frames broadcast
+    uint32_t fullFrames = 0;
+    uint32_t bytes = 0;         // payload bytes per client, all message types
+    uint32_t skipped = 0;       // broadcasts skipped because a client queue was full
+    uint32_t commands = 0;
+    uint32_t connects = 0;
+    int32_t lastConnectHeap = 0;   // free-heap change across the last connect
+};
+
+void setupTelemetrySocket(AsyncWebServer& server);
+void updateTelemetrySocket();   // from loop() via handleWebServer()
+void sendTelemetryLog(const char* entryJson);
+
+void setTelemetryInterval(uint32_t ms);
+uint32_t getTelemetryInterval();
+size_t getTelemetryClients();
+const TelemetryStats& getTelemetryStats();
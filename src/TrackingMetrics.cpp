@@ -0,0 +1,159 @@
+// TrackingMetrics.cpp - per-pass pointing error and settle times
+#include "TrackingMetrics.h"
+#include <math.h>
+#include "hal/Hal.h"
+#include "JsonWriter.h"
+#include "MathUtils.h"
+#include "TelemetrySnapshot.h"
+#include "WebLogger.h"
+
+TrackingMetrics trackingMetrics;
+
+static const char* const TRACK_AXIS_NAMES[TRACK_AXES] = {"AZ", "EL"};
+
+void ErrorStats::add(float err, float halfBeam) {
+    float a = fabsf(err);
+    samples++;
+    sumSq += (double)err * err;
+    if (a > maxAbs) maxAbs = a;
+    if (a <= halfBeam) within++;
+}
+
+float ErrorStats::rms() const {
+    return samples ? (float)sqrt(sumSq / samples) : 0.0f;
+}
+
+void TrackingMetrics::commanded(float az, float el) {
+    _cmd.seq++;
+    _cmd.ms = millis();
+    _cmd.az = az;
+    _cmd.el = el;
+    _commands.write(_cmd);
+}
+
+void TrackingMetrics::endPass() {
+    _cmd.endSeq++;
+    _commands.write(_cmd);
+}
+
+void TrackingMetrics::startPass(uint32_t nowMs) {
+    _pass = TrackingPass();
+    _pass.active = true;
+    _pass.number = ++_passes;
+    _pass.startMs = nowMs;
+    _pass.beamwidthDeg = beamwidth();
+    for (bool& s : _settling) s = false;
+    _lastSampleMs = nowMs - TRACK_SAMPLE_MS;
+}
+
+void TrackingMetrics::newCommand(const Command& cmd) {
+    if (!_pass.active) startPass(cmd.ms);
+    uint32_t received = cmd.seq - _seenSeq;
+    _pass.commands += received;
+    for (uint8_t a = 0; a < TRACK_AXES; a++) {
+        // Commands that came and went between two updates never settled
+        _pass.axis[a].unsettled += received - 1 + (_settling[a] ? 1 : 0);
+        _settling[a] = true;
+    }
+    _pass.targetAz = cmd.az;
+    _pass.targetEl = cmd.el;
+    _lastCommandMs = cmd.ms;
+}
+
+void TrackingMetrics::finishPass(const char* why) {
+    _pass.active = false;
+    _last.write(_pass);
+    _current.write(_pass);
+
+    WEB_LOG_INFOF("[TRACK]", "Pass %lu ended (%s) after %lu ms, %lu P commands, beamwidth %.1f deg",
+                  (unsigned long)_pass.number, why, (unsigned long)_pass.durationMs,
+                  (unsigned long)_pass.commands, _pass.beamwidthDeg);
+    for (uint8_t a = 0; a < TRACK_AXES; a++) {
+        const AxisTracking& ax = _pass.axis[a];
+        WEB_LOG_INFOF("[TRACK]", "%s: steps rms %.2f max %.2f (%.1f%% in beam), sensor rms %.2f max %.2f (%.1f%%), "
+                      "settle %.0f/%lu ms, %lu unsettled",
+                      TRACK_AXIS_NAMES[a], ax.steps.rms(), ax.steps.maxAbs, ax.steps.withinPct(),
+                      ax.sensor.rms(), ax.sensor.maxAbs, ax.sensor.withinPct(),
+                      ax.settleMeanMs(), (unsigned long)ax.settleMaxMs, (unsigned long)ax.unsettled);
+    }
+}
+
+void TrackingMetrics::update() {
+    Command cmd;
+    if (!_commands.tryRead(cmd, 4)) return;   // the rotctl task is mid-write
+    uint32_t now = millis();
+
+    if (cmd.endSeq != _seenEndSeq) {
+        _seenEndSeq = cmd.endSeq;
+        if (_pass.active) finishPass("client disconnected");
+    }
+    if (cmd.seq != _seenSeq) {
+        newCommand(cmd);
+        _seenSeq = cmd.seq;
+    }
+    if (!_pass.active) return;
+    if (now - _lastCommandMs > TRACK_PASS_IDLE_MS) {
+        finishPass("idle");
+        return;
+    }
+
+    TelemetrySnapshot s = readTelemetrySnapshot();
+    float stepErr[TRACK_AXES] = {s.azDeg - _pass.targetAz, s.elDeg - _pass.targetEl};
+    bool running[TRACK_AXES] = {s.azRunning, s.elRunning};
+    for (uint8_t a = 0; a < TRACK_AXES; a++) {
+        if (!_settling[a] || running[a] || fabsf(stepErr[a]) > TRACK_SETTLE_DEG) continue;
+        AxisTracking& ax = _pass.axis[a];
+        uint32_t ms = now - _lastCommandMs;
+        ax.settled++;
+        ax.settleSumMs += ms;
+        ax.lastSettleMs = ms;
+        if (ms > ax.settleMaxMs) ax.settleMaxMs = ms;
+        _settling[a] = false;
+    }
+
+    if (now - _lastSampleMs < TRACK_SAMPLE_MS || now - _lastCommandMs > TRACK_COMMAND_GAP_MS) return;
+    _lastSampleMs = now;
+    float half = _pass.beamwidthDeg / 2.0f;
+    for (uint8_t a = 0; a < TRACK_AXES; a++) _pass.axis[a].steps.add(stepErr[a], half);
+    if (s.lsmFresh) {
+        _pass.axis[TRACK_AZ].sensor.add(normalizeDeg(s.lsmAzTrue - _pass.targetAz + 180.0f) - 180.0f, half);
+        _pass.axis[TRACK_EL].sensor.add(s.lsmElCorr - _pass.targetEl, half);
+    }
+    _pass.durationMs = now - _pass.startMs;
+    _current.write(_pass);
+}
+
+static void writeErrorStats(JsonWriter& json, const char* key, const ErrorStats& e) {
+    json.key(key).beginObject();
+    json.kv("rms", e.rms(), 3);
+    json.kv("max", e.maxAbs, 3);
+    json.kv("withinPct", e.withinPct(), 1);
+    json.kv("samples", e.samples);
+    json.endObject();
+}
+
+void writeTrackingPassJSON(JsonWriter& json, const TrackingPass& pass) {
+    json.beginObject();
+    json.kv("active", pass.active);
+    json.kv("pass", pass.number);
+    json.kv("startMs", pass.startMs);
+    json.kv("durationMs", pass.durationMs);
+    json.kv("commands", pass.commands);
+    json.kv("beamwidth", pass.beamwidthDeg, 2);
+    for (uint8_t a = 0; a < TRACK_AXES; a++) {
+        const AxisTracking& ax = pass.axis[a];
+        json.key(a == TRACK_AZ ? "az" : "el").beginObject();
+        json.kv("target", a == TRACK_AZ ? pass.targetAz : pass.targetEl, 2);
+        writeErrorStats(json, "steps", ax.steps);
+        writeErrorStats(json, "sensor", ax.sensor);
+        json.key("settle").beginObject();
+        json.kv("count", ax.settled);
+        json.kv("meanMs", ax.settleMeanMs(), 0);
+        json.kv("maxMs", ax.settleMaxMs);
+        json.kv("lastMs", ax.lastSettleMs);
+        json.kv("unsettled", ax.unsettled);
+        json.endObject();
+        json.endObject();
+    }
+    json.endObject();
+}
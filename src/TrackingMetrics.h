@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include "Seqlock.h"
+
+class JsonWriter;
+
+// --- Tracking error and pointing quality ---
+// A pass starts with the first rotctl P and ends when the client
+// disconnects or no P arrived for TRACK_PASS_IDLE_MS. While commands keep
+// coming (the last P is at most TRACK_COMMAND_GAP_MS old), the stepper
+// task compares the last commanded position with the step count
+// and with the LSM303 (fresh packets only; heading as true azimuth,
+// corrected EL) every TRACK_SAMPLE_MS, per axis: RMS, max and the share
+// of samples within half the beamwidth of the commanded position. The
+// sensor figures are only meaningful once the LSM303 is calibrated and
+// home is aligned with true north.
+//
+// Settle time is measured per axis from each P until the step count is
+// within TRACK_SETTLE_DEG of the target with the motor stopped; a P that
+// is superseded before its axis settled counts as unsettled.
+//
+// The running pass and the last finished one are published through
+// seqlocks for /status and /tracking; a finished pass is also summarised
+// in the log.
+inline constexpr uint32_t TRACK_SAMPLE_MS = 20;
+inline constexpr uint32_t TRACK_COMMAND_GAP_MS = 5000;
+inline constexpr uint32_t TRACK_PASS_IDLE_MS = 30000;
+inline constexpr float TRACK_DEFAULT_BEAMWIDTH_DEG = 3.0f;   // full width
+inline constexpr float TRACK_SETTLE_DEG = 0.1f;
+
+// One error source on one axis
+struct ErrorStats {
+    uint32_t samples = 0;
+    uint32_t within = 0;
+    double sumSq = 0.0;
+    float maxAbs = 0.0f;
+
+    void add(float err, float halfBeam);
+    float rms() const;
+    float withinPct() const { return samples ? 100.0f * within / samples : 0.0f; }
+};
+
+struct AxisTracking {
+    ErrorStats steps;           // commanded vs step count
+    ErrorStats sensor;          // commanded vs LSM303
+    uint32_t settled = 0;
+    uint32_t unsettled = 0;
+    uint32_t settleSumMs = 0;
+    uint32_t settleMaxMs = 0;
+    uint32_t lastSettleMs = 0;
+
+    float settleMeanMs() const { return settled ? (float)settleSumMs / settled : 0.0f; }
+};
+
+enum TrackAxis : uint8_t { TRACK_AZ, TRACK_EL, TRACK_AXES };
+
+struct TrackingPass {
+    bool active = false;
+    uint32_t number = 0;        // passes since boot, 1-based
+    uint32_t startMs = 0;
+    uint32_t durationMs = 0;
+    uint32_t commands = 0;
+    float beamwidthDeg = 0.0f;  // latched at the start of the pass
+    float targetAz = 0.0f;      // last P
+    float targetEl = 0.0f;
+    AxisTracking axis[TRACK_AXES];
+};
+
+class TrackingMetrics {
+public:
+    // From the rotctl server (one task): a P with the clamped target, and
+    // the client going away
+    void commanded(float az, float el);
+    void endPass();
+
+    // From the stepper task
+    void update();
+
+    // Used from the next pass on
+    void setBeamwidth(float deg) { _beamwidthDeg.store(deg, std::memory_order_relaxed); }
+    float beamwidth() const { return _beamwidthDeg.load(std::memory_order_relaxed); }
+
+    TrackingPass current() const { return _current.read(); }
+    TrackingPass last() const { return _last.read(); }
+
+private:
+    struct Command {
+        uint32_t seq;           // P commands received
+        uint32_t endSeq;        // endPass() calls
+        uint32_t ms;
+        float az;
+        float el;
+    };
+
+    void startPass(uint32_t nowMs);
+    void finishPass(const char* why);
+    void newCommand(const Command& cmd);
+
+    // Writer side of _commands, rotctl task only
+    Command _cmd = {};
+    Seqlock<Command> _commands;
+
+    // Stepper task only
+    TrackingPass _pass;
+    uint32_t _seenSeq = 0;
+    uint32_t _seenEndSeq = 0;
+    uint32_t _lastCommandMs = 0;
+    uint32_t _lastSampleMs = 0;
+    uint32_t _passes = 0;
+    bool _settling[TRACK_AXES] = {};
+    Seqlock<TrackingPass> _current;
+    Seqlock<TrackingPass> _last;
+
+    std::atomic<float> _beamwidthDeg{TRACK_DEFAULT_BEAMWIDTH_DEG};
+};
+
+extern TrackingMetrics trackingMetrics;
+
+// {"active":..,"pass":..,"durationMs":..,"az":{...},"el":{...}} for one pass
+void writeTrackingPassJSON(JsonWriter& json, const TrackingPass& pass);
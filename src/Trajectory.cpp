@@ -0,0 +1,152 @@
+// Trajectory.cpp - stored pass, followed by interpolated setpoints
+#include "Trajectory.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include "Crc32.h"
+#include "Calibration.h"
+#include "Homing.h"
+#include "MotorControl.h"
+#include "NvsWriter.h"
+#include "ScanPattern.h"
+#include "WebLogger.h"
+
+extern bool azHomed;
+extern bool elHomed;
+extern Calibration calib;
+
+Trajectory trajectory;
+
+struct StoredTrajectory {
+    uint32_t magic;
+    uint16_t count;
+    uint16_t reserved;
+    TrajPoint points[TRAJ_MAX_POINTS];
+    uint32_t crc;
+};
+
+static uint32_t trajectoryCrc(const StoredTrajectory& st) {
+    return crc32(reinterpret_cast<const uint8_t*>(&st), offsetof(StoredTrajectory, crc));
+}
+
+int parseTrajectoryPoints(const char* text, TrajPoint* out, uint16_t max) {
+    int n = 0;
+    const char* p = text;
+    while (*p) {
+        if (n == max) return -1;
+        char* end;
+        float v[3];
+        for (int i = 0; i < 3; i++) {
+            v[i] = strtof(p, &end);
+            if (end == p) return -1;
+            p = end;
+            if (i < 2 && *p++ != ',') return -1;
+        }
+        if (*p == ';') p++;
+        else if (*p) return -1;
+
+        if (v[1] < MIN_AZ || v[1] > MAX_AZ || v[2] < MIN_EL || v[2] > MAX_EL) return -1;
+        if (v[0] < 0.0f || (n > 0 && v[0] <= out[n - 1].tSec)) return -1;
+        out[n++] = {v[0], v[1], v[2]};
+    }
+    return n;
+}
+
+void Trajectory::begin() {
+    if (!_prefs.begin("trajectory", false)) {
+        WEB_LOG_ERROR("[TRAJ]", "Failed to open NVS namespace");
+        return;
+    }
+    _ready = true;
+    _storeId = nvsWriter.add(&Trajectory::flushPoints, this);
+    static StoredTrajectory st;   // too big for the loop task's stack
+    if (_prefs.getBytes("traj", &st, sizeof(st)) != sizeof(st)) return;
+    if (st.magic != TRAJ_MAGIC || st.crc != trajectoryCrc(st) || st.count > TRAJ_MAX_POINTS) {
+        WEB_LOG_WARNING("[TRAJ]", "Stored trajectory is corrupt, ignored");
+        return;
+    }
+    memcpy(_points, st.points, st.count * sizeof(TrajPoint));
+    _count = st.count;
+    WEB_LOG_INFOF("[TRAJ]", "Loaded %u points (%.0f s)", _count, durationSec());
+}
+
+bool Trajectory::store(const TrajPoint* points, uint16_t count) {
+    if (_running || count > TRAJ_MAX_POINTS) return false;
+    _lock.lock();
+    memcpy(_points, points, count * sizeof(TrajPoint));
+    _count = count;
+    _lock.unlock();
+    if (_ready) nvsWriter.request(_storeId);
+    return true;
+}
+
+void Trajectory::flushPoints(void* ctx) {
+    Trajectory* self = static_cast<Trajectory*>(ctx);
+    static StoredTrajectory st;   // NvsWriter task only
+    memset(&st, 0, sizeof(st));
+    st.magic = TRAJ_MAGIC;
+    self->_lock.lock();
+    st.count = self->_count;
+    memcpy(st.points, self->_points, st.count * sizeof(TrajPoint));
+    self->_lock.unlock();
+    st.crc = trajectoryCrc(st);
+    if (self->_prefs.putBytes("traj", &st, sizeof(st)) != sizeof(st)) {
+        WEB_LOG_ERROR("[TRAJ]", "Storing the trajectory failed");
+        return;
+    }
+    WEB_LOG_INFOF("[TRAJ]", "Stored %u points (%.0f s)", st.count,
+                  st.count ? st.points[st.count - 1].tSec : 0.0f);
+}
+
+bool Trajectory::start(uint32_t lateMs) {
+    if (_count == 0) return false;
+    // Absolute positions mean nothing without a reference
+    if (!azHomed || !elHomed || homingStage != HOMING_COMPLETE || calib.isRunning()) return false;
+    scanRunner.stop();
+    _startMs = millis() - lateMs;
+    _running = true;
+    scheduler.start(this, "trajectory");
+    Serial.printf("[TRAJ] Started, %u points over %.0f s (%lu ms late)\n",
+                  _count, durationSec(), (unsigned long)lateMs);
+    WEB_LOG_INFOF("[TRAJ]", "Started, %u points over %.0f s (%lu ms late)",
+                  _count, durationSec(), (unsigned long)lateMs);
+    return true;
+}
+
+void Trajectory::stop() {
+    if (!_running) return;
+    _running = false;
+    scheduler.stop(this);
+    WEB_LOG_INFO("[TRAJ]", "Stopped");
+}
+
+TrajPoint Trajectory::at(float tSec) const {
+    if (_count == 0) return {0.0f, 0.0f, 0.0f};
+    if (tSec <= _points[0].tSec) return _points[0];
+    for (uint16_t i = 1; i < _count; i++) {
+        const TrajPoint& b = _points[i];
+        if (tSec > b.tSec) continue;
+        const TrajPoint& a = _points[i - 1];
+        float f = (tSec - a.tSec) / (b.tSec - a.tSec);
+        return {tSec, a.az + f * (b.az - a.az), a.el + f * (b.el - a.el)};
+    }
+    return _points[_count - 1];
+}
+
+bool Trajectory::follow() {
+    float t = (millis() - _startMs) / 1000.0f;
+    TrajPoint p = at(t);
+    moveAzimuthToPosition(p.az);
+    moveElevationToPosition(p.el);
+    return t >= durationSec();
+}
+
+bool Trajectory::step() {
+    if (!_running) return false;
+
+    TASK_BEGIN();
+    while (!follow()) TASK_SLEEP(TRAJ_UPDATE_MS);
+    _running = false;
+    Serial.println("[TRAJ] Finished");
+    WEB_LOG_INFO("[TRAJ]", "Finished");
+    TASK_END();
+}
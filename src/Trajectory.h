@@ -0,0 +1,60 @@
+#pragma once
+#include <stdint.h>
+#include "hal/Hal.h"
+#include "Scheduler.h"
+
+// --- Stored trajectory ---
+// A pass uploaded ahead of time as (seconds from start, az, el) points,
+// kept in NVS so a scheduled start survives a reboot. While it runs, a
+// task on the tick scheduler commands the linearly interpolated position
+// every TRAJ_UPDATE_MS, the way a tracking client streams P commands; past
+// the last point it holds that position and stops. store() returns once
+// the points are in RAM; the NvsWriter task writes them to flash.
+inline constexpr uint16_t TRAJ_MAX_POINTS = 200;
+inline constexpr uint32_t TRAJ_UPDATE_MS = 100;
+inline constexpr uint32_t TRAJ_MAGIC = 0x544A5231;  // "TJR1"
+
+struct TrajPoint {
+    float tSec;         // from the start, strictly increasing
+    float az;
+    float el;
+};
+
+// "t,az,el;t,az,el;..." -> points; -1 on syntax errors, out of range
+// angles, decreasing time or more than max points
+int parseTrajectoryPoints(const char* text, TrajPoint* out, uint16_t max);
+
+class Trajectory : public CoTask {
+public:
+    void begin();       // loads the stored points
+
+    // Replaces the stored points; refused while running
+    bool store(const TrajPoint* points, uint16_t count);
+
+    // lateMs joins a start that was due lateMs ago where it would be now;
+    // refused without points, before homing completes or while calibrating
+    bool start(uint32_t lateMs = 0);
+    void stop();
+    bool isRunning() const { return _running; }
+    bool step() override;
+
+    uint16_t count() const { return _count; }
+    float durationSec() const { return _count ? _points[_count - 1].tSec : 0.0f; }
+    const TrajPoint& point(uint16_t i) const { return _points[i]; }
+    TrajPoint at(float tSec) const;   // interpolated, clamped to the ends
+
+private:
+    bool follow();      // true once past the last point
+    static void flushPoints(void* ctx);     // NvsWriter task
+
+    NvStore _prefs;
+    bool _ready = false;
+    int8_t _storeId = -1;
+    hal::Mutex _lock;   // _points and _count against the flash copy
+    TrajPoint _points[TRAJ_MAX_POINTS];
+    uint16_t _count = 0;
+    volatile bool _running = false;
+    uint32_t _startMs = 0;
+};
+
+extern Trajectory trajectory;
@@ -0,0 +1,72 @@
+// WallClock.cpp - unix time from NTP or a manual set
+#include "WallClock.h"
+#include "WebLogger.h"
+
+WallClock wallClock;
+
+static const char* const CLOCK_SOURCE_NAMES[] = {"none", "manual", "ntp"};
+
+const char* clockSourceName(ClockSource source) {
+    return source <= CLOCK_NTP ? CLOCK_SOURCE_NAMES[source] : "?";
+}
+
+void WallClock::begin(const char* ntpServer) {
+    hal::startNtp(ntpServer);
+}
+
+void WallClock::update() {
+    uint32_t now = millis();
+    if (_polled && now - _lastPollMs < CLOCK_NTP_POLL_MS) return;
+    uint64_t unixMs;
+    if (!hal::ntpTimeMs(unixMs)) return;   // not synced yet, try again next pass
+    _polled = true;
+    _lastPollMs = now;
+    anchor(unixMs, CLOCK_NTP);
+}
+
+bool WallClock::set(uint64_t unixMs) {
+    if (source() == CLOCK_NTP || unixMs < (uint64_t)hal::MIN_VALID_UNIX * 1000) return false;
+    anchor(unixMs, CLOCK_MANUAL);
+    return true;
+}
+
+void WallClock::anchor(uint64_t unixMs, ClockSource source) {
+    uint32_t nowMillis = millis();
+    _mux.enter();
+    ClockSource was = _source;
+    int64_t stepMs = was == CLOCK_NONE ? 0
+        : (int64_t)unixMs - (int64_t)(_anchorUnixMs + (uint32_t)(nowMillis - _anchorMillis));
+    bool stepped = was != source || stepMs > (int64_t)CLOCK_STEP_MS || stepMs < -(int64_t)CLOCK_STEP_MS;
+    _anchorUnixMs = unixMs;
+    _anchorMillis = nowMillis;
+    _source = source;
+    if (stepped) _generation++;
+    _mux.exit();
+
+    if (!stepped) return;
+    Serial.printf("[CLOCK] Set from %s: %lu (stepped %lld ms)\n", clockSourceName(source),
+                  (unsigned long)(unixMs / 1000), (long long)stepMs);
+    WEB_LOG_INFOF("[CLOCK]", "Set from %s: %lu (stepped %lld ms)", clockSourceName(source),
+                  (unsigned long)(unixMs / 1000), (long long)stepMs);
+}
+
+ClockSource WallClock::source() const {
+    _mux.enter();
+    ClockSource s = _source;
+    _mux.exit();
+    return s;
+}
+
+uint64_t WallClock::nowMs() const {
+    _mux.enter();
+    uint64_t ms = _source == CLOCK_NONE ? 0 : _anchorUnixMs + (uint32_t)(millis() - _anchorMillis);
+    _mux.exit();
+    return ms;
+}
+
+uint32_t WallClock::generation() const {
+    _mux.enter();
+    uint32_t g = _generation;
+    _mux.exit();
+    return g;
+}
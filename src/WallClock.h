@@ -0,0 +1,45 @@
+#pragma once
+#include <stdint.h>
+#include "hal/Hal.h"
+
+// --- Wall clock for scheduled jobs ---
+// Unix time as an anchor (unix ms at a millis() reading) that follows
+// millis() in between. NTP re-anchors it every CLOCK_NTP_POLL_MS once SNTP
+// has synced; until then a manual set() holds. A re-anchor that moves the
+// clock by more than CLOCK_STEP_MS bumps generation(), so the job
+// scheduler knows to recompute its due times.
+inline constexpr uint32_t CLOCK_NTP_POLL_MS = 60000;
+inline constexpr uint32_t CLOCK_STEP_MS = 1000;
+inline constexpr const char* CLOCK_NTP_SERVER = "pool.ntp.org";
+
+enum ClockSource : uint8_t { CLOCK_NONE, CLOCK_MANUAL, CLOCK_NTP };
+
+class WallClock {
+public:
+    void begin(const char* ntpServer = CLOCK_NTP_SERVER);
+    void update();                  // from loop(), polls NTP
+
+    // Manual set; ignored while NTP is the source or before hal::MIN_VALID_UNIX
+    bool set(uint64_t unixMs);
+
+    bool valid() const { return source() != CLOCK_NONE; }
+    ClockSource source() const;
+    uint64_t nowMs() const;         // unix ms, 0 while not valid
+    uint32_t now() const { return (uint32_t)(nowMs() / 1000); }
+    uint32_t generation() const;
+
+private:
+    void anchor(uint64_t unixMs, ClockSource source);
+
+    mutable hal::CriticalSection _mux;
+    uint64_t _anchorUnixMs = 0;
+    uint32_t _anchorMillis = 0;
+    ClockSource _source = CLOCK_NONE;
+    uint32_t _generation = 0;
+    uint32_t _lastPollMs = 0;
+    bool _polled = false;
+};
+
+extern WallClock wallClock;
+
+const char* clockSourceName(ClockSource source);
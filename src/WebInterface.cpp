@@ -1,4 +1,4 @@
-// WebInterface.cpp - updated UI with degree-input jogs + Emergency Stop
+// WebInterface.cpp - web endpoints; the UI itself lives in web/
 #include "WebInterface.h"
 #include "WebLogger.h"
 #include <ESPmDNS.h>
@@ -10,6 +10,26 @@
 #include <ESPAsyncWebServer.h>
 #include <AsyncTCP.h>
 #include "MathUtils.h"
+#include "JsonWriter.h"
+#include "TelemetrySocket.h"
+#include "TelemetrySnapshot.h"
+#include "SensorRecorder.h"
+#include "RotctlRecorder.h"
+#include "FlightRecorder.h"
+#include "TrackingMetrics.h"
+#include "SlewTime.h"
+#include "WallClock.h"
+#include "Trajectory.h"
+#include "JobScheduler.h"
+#include "ScanPattern.h"
+#include "StatusJson.h"
+#include "Metrics.h"
+#include "Latency.h"
+#include "AllocTracker.h"
+#if FIRMWARE_BENCH
+#include "Bench.h"
+#endif
+#include "WebAssets.h"     // generated from web/ by scripts/build_web_assets.py
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/FreeRTOSConfig.h"
@@ -20,6 +40,7 @@ extern float currentElevation;
 extern float serialAz;     // LSM303 az read (from Nano/adapter)
 extern float serialEl;     // LSM303 el read
 //extern bool useMagnetometer;
+extern bool elHomed;
 extern bool azHomed;
 extern float stepsPerRevolution;
 extern float stepsPerDegree;
@@ -41,313 +62,115 @@ extern FastAccelStepper *elMotor2;
 
 extern bool rotctlConnected;
 extern LSM303Receiver lsmReceiver;
+extern bool warmStarted;
+extern unsigned long operationalMs;
 float smoothingAlpha = 0.20f;
 AsyncWebServer webServer(80);
+AsyncEventSource logEvents("/logs/events");   // pushes new log entries as they arrive
+static uint32_t logEventSeq = 0;              // next entry to broadcast
 
 float azTrue = magneticToTrue(lsmReceiver.getAzimuth());
 
-// helper to build JSON of tasks (kept minimal)
-String getTaskInfoJSON() {
-  String json = "\"tasks\":[]"; // keep simple for now
-  return json;
+// JsonWriter sink that streams into an AsyncResponseStream
+static void responseSink(void* ctx, const char* data, size_t len) {
+  static_cast<AsyncResponseStream*>(ctx)->write((const uint8_t*)data, len);
 }
 
-void setupWebServer() {
-    // Root page - full UI
-webServer.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
-    request->send(200, "text/html", R"rawliteral(
-<!doctype html>
-<html>
-<head>
-<meta charset="utf-8">
-<title>ESP32 Rotator Control</title>
-<style>
-  body{font-family:Arial;background:#111;color:#eee;padding:20px}
-  .panel{background:#222;border-radius:8px;padding:20px;margin:10px}
-  .big-stop{background:#c62828;color:#fff;padding:16px 24px;border-radius:8px;font-size:20px;border:none;cursor:pointer}
-  .input-row{margin:8px 0}
-  input[type="number"]{width:80px;padding:4px}
-  button{padding:6px 10px;margin-left:6px}
-  .status{font-family:monospace}
-</style>
-</head>
-<body>
-<div class="panel">
-<h1>ESP32 Rotator</h1>
-<div class="input-row">
-  <strong>Hardware:</strong> <span id="hardware">--</span><br>
-  <strong>Firmware:</strong> <span id="firmware">--</span>
-</div>
-<div class="card">
-  <h3>Smoothing Factor</h3>
-  <input type="range" id="alphaSlider" min="0" max="100" value="20" step="1" 
-          oninput="updateAlpha(this.value)">
-  <span id="alphaValue">0.20</span>
-</div>
-<div class="input-row">
-  <strong>Azimuth (Mag):</strong> <span id="lsmAz">--</span>°
-  <strong>Azimuth (True):</strong> <span id="lsmAzTrue">--</span>°
-  <strong>LSM EL (raw):</strong> <span id="lsmEl">--</span>&deg; &nbsp;
-  <strong>LSM EL (corrected):</strong> <span id="lsmElCorr">--</span>&deg;
-</div>
-
-<div class="input-row">
-  <strong>Stepper AZ:</strong> <span id="az">--</span>&deg; &nbsp;
-  <strong>Stepper EL:</strong> <span id="el">--</span>&deg;
-</div>
-
-<div class="input-row">
-  <label>
-    <input type="checkbox" id="useLSM" onchange="toggleElSource()">
-    Use LSM303 for Elevation
-  </label>
-</div>
-
-<div class="input-row">
-  <strong>Azimuth Limit:</strong> <span id="azLimitStatus" style="color:gray">--</span><br>
-  <strong>Elevation Limit:</strong> <span id="elLimitStatus" style="color:gray">--</span>
-</div>
-
-<div class="input-row">
-  <strong>Rotctl:</strong> <span id="rotctlStatus">Disconnected</span>
-</div>
-
-<hr>
-
-<h3>Jog Controls (degrees)</h3>
-<div class="input-row">
-  <label>AZ step: <input type="number" id="jogAz" step="0.1" value="1.0"></label>
-  <button onclick="jogAz(1)">Left</button>
-  <button onclick="jogAz(-1)">Right</button>
-</div>
-<div class="input-row">
-  <label>EL step: <input type="number" id="jogEl" step="0.1" value="1.0"></label>
-  <button onclick="jogEl(1)">Down</button>
-  <button onclick="jogEl(-1)">Up</button>
-</div>
-
-<hr>
-
-<h3>Homing</h3>
-<div class="input-row">
-  <button onclick="homeAz()">Home Azimuth</button>
-  <button onclick="homeEl()">Home Elevation</button>
-</div>
-
-<hr>
-
-<h3>Move to absolute position</h3>
-<form id="moveForm">
-  <label>AZ &deg;: <input type="number" id="moveAz" step="0.1" value="0.0"></label>
-  <label>EL &deg;: <input type="number" id="moveEl" step="0.1" value="90.0"></label>
-  <button type="button" onclick="moveTo()">Move</button>
-</form>
-
-<hr>
-
-<div class="input-row">
-  <button id="estop" class="big-stop" onclick="emergencyStop()">Emergency Stop</button>
-  <button id="resetEsp" class="big-stop" style="background-color: orange;" onclick="resetESP()">Reset ESP32</button>
-</div>
-
-<div style="margin-top:8px;color:#ffcccb">
-  Warning: Emergency Stop will immediately stop all motor movement
-</div>
-
-<hr>
-
-<div class="input-row">
-  <button id="autoCal" class="big-stop" style="background-color: #ff9800; color: white; font-size: 18px; padding: 10px; border-radius: 10px;"
-    onclick="startAutoCalibration()">Automatic Calibration</button>
-  <button id="otaUpdate" class="big-stop" style="background-color: #4caf50; color: white; font-size: 18px; padding: 10px; border-radius: 10px;"
-    onclick="startOTA()">OTA Update</button>
-</div>
-
-<div style="margin-top:8px;color:#ffcccb">
-  Warning: Automatic Calibration will move the rotator through a full pattern. Ensure the area is clear.
-</div>
-
-<div class="input-row" style="margin-top:6px;">
-  <strong>Cal Min/Max:</strong> <span id="calValues">AZ -- / -- , EL -- / --</span>
-</div>
-
-<h3>Log</h3>
-<div id="logContainer" style="background:#111;color:#0f0;padding:8px;height:200px;overflow-y:scroll;font-family:monospace;font-size:12px"></div>
-<h2>Task List</h2>
-<pre id="taskList">Loading...</pre>
-
-<script>
-function toggleElSource() {
-  const useLSM = document.getElementById("useLSM").checked ? 1 : 0;
-  fetch(`/setElSource?value=${useLSM}`);
-}
-
-function updateAlpha(val) {
-  let alpha = (val / 100).toFixed(2);
-  document.getElementById("alphaValue").innerText = alpha;
-  fetch(`/setAlpha?value=${alpha}`);
-}
-
-function updateStatus() {
-  fetch('/status').then(r=>r.json()).then(data=>{
-    document.getElementById('hardware').innerText = data.hardware || '--';
-    document.getElementById('firmware').innerText = data.firmware || '--';
-
-    document.getElementById('lsmAz').innerText = data.lsmAz!==null? data.lsmAz.toFixed(1) : '--';
-    document.getElementById('lsmEl').innerText = data.lsmEl!==null? data.lsmEl.toFixed(1) : '--';
-    document.getElementById('lsmElCorr').innerText = data.lsmElCorr!==null? data.lsmElCorr.toFixed(1) : '--';
-    if (document.getElementById('lsmAzTrue')) {
-      document.getElementById('lsmAzTrue').innerText =
-        data.lsmAzTrue !== null ? data.lsmAzTrue.toFixed(1) : '--';
-    }
-    document.getElementById('az').innerText = data.az!==null? data.az.toFixed(1) : '--';
-    document.getElementById('el').innerText = data.el!==null? data.el.toFixed(1) : '--';
-    document.getElementById('azLimitStatus').innerText = data.azLimit===0?"TRIGGERED":"Clear";
-    document.getElementById('azLimitStatus').style.color = data.azLimit===0?"red":"green";
-    document.getElementById('elLimitStatus').innerText = data.elLimit===0?"TRIGGERED":"Clear";
-    document.getElementById('elLimitStatus').style.color = data.elLimit===0?"red":"green";
-    document.getElementById('rotctlStatus').innerText = data.rotctl?"Connected":"Disconnected";
-    document.getElementById('rotctlStatus').style.color = data.rotctl?"green":"red";
-  }).catch(e=>{});
-}
-
-function updateLogs() {
-  fetch('/logs').then(r=>r.json()).then(data=>{
-    const container = document.getElementById('logContainer');
-    container.innerHTML='';
-    data.forEach(entry=>{
-      let color="#0f0";
-      if(entry.level==1) color="#0af";
-      else if(entry.level==2) color="#ff0";
-      else if(entry.level==3) color="#f00";
-      const ts=new Date(entry.timestamp+performance.now()-performance.timing.navigationStart).toLocaleTimeString();
-      container.innerHTML+=`[${ts}] ${entry.source}: <span style="color:${color}">${entry.message}</span><br>`;
-    });
-    container.scrollTop=container.scrollHeight;
-  }).catch(e=>{});
-}
-
-function jogAz(dir) {
-  const deg=parseFloat(document.getElementById('jogAz').value)||0.0;
-  const payload=new URLSearchParams();
-  payload.append('azStep',(deg*dir).toString());
-  fetch('/jog',{method:'POST',body:payload}).then(()=>updateStatus());
-}
-
-function jogEl(dir) {
-  const deg=parseFloat(document.getElementById('jogEl').value)||0.0;
-  const payload=new URLSearchParams();
-  payload.append('elStep',(deg*dir).toString());
-  fetch('/jog',{method:'POST',body:payload}).then(()=>updateStatus());
-}
-
-function moveTo() {
-  const az=parseFloat(document.getElementById('moveAz').value)||0.0;
-  const el=parseFloat(document.getElementById('moveEl').value)||0.0;
-  const payload=new URLSearchParams();
-  payload.append('moveAz',az.toString());
-  payload.append('moveEl',el.toString());
-  fetch('/move',{method:'POST',body:payload}).then(()=>updateStatus());
-}
-
-function emergencyStop() { fetch('/estop',{method:'POST'}); }
-function homeAz() { fetch('/homeAz',{method:'POST'}); }
-function homeEl() { fetch('/homeEl',{method:'POST'}); }
-
-function startAutoCalibration() {
-  fetch('/autoCal').then(r=>r.text()).then(msg=>{}).catch(err=>{alert("Failed to start calibration.");});
+// Streams the JSON written by fill(JsonWriter&) as the response body
+template <typename Fill>
+static void sendJSON(AsyncWebServerRequest *request, Fill&& fill) {
+  ALLOC_SCOPE(ALLOC_WEB);
+  AsyncResponseStream *response = request->beginResponseStream("application/json");
+  {
+    JsonWriter json(responseSink, response);
+    fill(json);
+  }
+  request->send(response);
 }
 
-function updateCalibrationDisplay() {
-  fetch('/cal/status').then(r=>r.json()).then(data=>{
-    document.getElementById('calValues').innerText=
-      `AZ ${data.azMin.toFixed(1)} / ${data.azMax.toFixed(1)}, EL ${data.elMin.toFixed(1)} / ${data.elMax.toFixed(1)}`;
-  }).catch(e=>{});
+// Serves a gzipped asset with a strong ETag. Browsers revalidate on every
+// load (no-cache) and get an empty 304 while the firmware is unchanged.
+static void serveAsset(AsyncWebServerRequest *request, const WebAsset& asset) {
+  ALLOC_SCOPE(ALLOC_WEB);
+  if (request->hasHeader("If-None-Match") &&
+      strstr(request->getHeader("If-None-Match")->value().c_str(), asset.etag)) {
+    AsyncWebServerResponse *response = request->beginResponse(304, "text/plain", "");
+    response->addHeader("ETag", asset.etag);
+    request->send(response);
+    return;
+  }
+  AsyncWebServerResponse *response =
+      request->beginResponse(200, asset.contentType, asset.data, asset.length);
+  response->addHeader("Content-Encoding", "gzip");
+  response->addHeader("ETag", asset.etag);
+  response->addHeader("Cache-Control", "no-cache");
+  request->send(response);
 }
 
-function resetESP() {
-  fetch('/reset').then(r=>r.text()).then(msg=>{alert("ESP32 is restarting...");}).catch(err=>console.error(err));
+// helper to write JSON of per-axis homing statistics
+void writeHomingStatsJSON(JsonWriter& json, const AxisHoming& ax) {
+  const HomingStats& st = ax.stats;
+  json.beginObject();
+  json.kv("runs", st.runs);
+  json.kv("driftSamples", st.driftSamples);
+  json.kv("lastDrift", st.lastDriftSteps);
+  json.kv("minDrift", st.minDriftSteps);
+  json.kv("maxDrift", st.maxDriftSteps);
+  json.kv("meanDrift", st.meanDriftSteps, 2);
+  json.kv("sigma", st.stdDevSteps(), 2);
+  json.kv("fastSlowDelta", st.lastFastSlowDelta);
+  json.kv("durationMs", st.lastDurationMs);
+  json.endObject();
 }
 
-function updateTasks() {
-  fetch('/tasks')
-    .then(r => r.text())
-    .then(data => {
-      document.getElementById('taskList').innerText = data;
-    });
-}
-setInterval(updateTasks, 5000); // refresh every 5s
-
-function startOTA() {
-      fetch('/update')
-          .then(resp => {
-            window.open('/update', '_blank');
-          })
-          .catch(err => {
-              alert("Failed to start OTA: " + err);
-          });
-  }
-setInterval(updateCalibrationDisplay,1000);
-setInterval(updateStatus,800);
-setInterval(updateLogs,1000);
-updateStatus();
-updateLogs();
-</script>
-</div>
-</body>
-</html>
-)rawliteral");
-});
+void setupWebServer() {
+    // UI pages, scripts and styles (web/, gzipped at build time)
+    for (const WebAsset& asset : WEB_ASSETS) {
+        webServer.on(asset.path, HTTP_GET, [&asset](AsyncWebServerRequest *request) {
+            LATENCY_SCOPE("web asset");
+            serveAsset(request, asset);
+        });
+    }
 
     // --- Status endpoint ---
     webServer.on("/status", HTTP_GET, [](AsyncWebServerRequest *request) {
-        String json = "{";
-        const bool fresh = (millis() - lsmReceiver.getLastUpdate() < 2000);
-        float safeLsmAz        = fresh ? lsmReceiver.getAzimuth()   : 0.0;
-        float safeLsmElRaw     = fresh ? lsmReceiver.getElevation() : 0.0;
-        float safeLsmElCorrected = lsmReceiver.getElCorrected();
-        float safeLsmAzTrue    = fresh ? magneticToTrue(safeLsmAz) : 0.0;
-
-        json += "\"lsmAz\":"     + String(safeLsmAz, 1) + ",";
-        json += "\"lsmAzTrue\":" + String(safeLsmAzTrue, 1) + ",";   
-        json += "\"lsmEl\":"     + String(safeLsmElRaw, 1) + ",";
-        json += "\"lsmElCorr\":" + String(safeLsmElCorrected, 1) + ",";
-
-        long azSteps = azMotor ? azMotor->getCurrentPosition() : 0;
-        long elSteps = elMotor1 ? elMotor1->getCurrentPosition() : 0;
-        float azDeg = stepsToAz(azSteps);
-        float elDeg = stepsToEl(elSteps);
-
-        json += "\"az\":" + String(azDeg, 1) + ",";
-        json += "\"el\":" + String(elDeg, 1) + ",";
-        json += "\"azLimit\":" + String((AZ_LIMIT_PIN >= 0) ? digitalRead(AZ_LIMIT_PIN) : 0) + ",";
-        json += "\"elLimit\":" + String((EL_LIMIT_PIN >= 0) ? digitalRead(EL_LIMIT_PIN) : 0) + ",";
-        json += "\"azHomed\":" + String(azHomed ? "true" : "false") + ",";
-        json += "\"tasks\":[],";
-        json += "\"rotctl\":" + String(rotctlConnected ? "true" : "false") + ",";
-
-        json += "\"hardware\":\"" + String(HARDWARE_ID) + "\",";
-        json += "\"firmware\":\"" + String(FIRMWARE_VERSION) + "\"";
-
-
-        json += "}";
-
-        request->send(200, "application/json", json);
+        LATENCY_SCOPE("web /status");
+        // Published by the stepper task; no hardware access from async_tcp
+        TelemetrySnapshot snap = readTelemetrySnapshot();
+
+        sendJSON(request, [&](JsonWriter& json) {
+            json.beginObject();
+            writeStatusFields(json, snap, millis());
+
+            const TelemetryStats& ws = getTelemetryStats();
+            json.key("ws").beginObject();
+            json.kv("clients", getTelemetryClients());
+            json.kv("rateMs", getTelemetryInterval());
+            json.kv("frames", ws.frames);
+            json.kv("bytes", ws.bytes);
+            json.kv("avgFrame", ws.frames ? ws.bytes / ws.frames : 0);
+            json.kv("skipped", ws.skipped);
+            json.kv("commands", ws.commands);
+            json.kv("connectHeap", ws.lastConnectHeap);
+            json.endObject();
+            json.endObject();
+        });
     });
 
     // --- Set smoothing factor ---
     webServer.on("/setAlpha", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /setAlpha");
         if (request->hasParam("value")) {
-            String value = request->getParam("value")->value();
-            smoothingAlpha = value.toFloat();
-            smoothingAlpha = constrain(smoothingAlpha, 0.0f, 1.0f);
-            Serial.printf("[WebUI] Smoothing factor updated: %.2f\n", smoothingAlpha);
+            float alpha = request->getParam("value")->value().toFloat();
+            smoothingAlpha = constrain(alpha, 0.0f, 1.0f);
+            WEB_LOG_INFOF("WebUI", "Smoothing factor updated: %.2f", smoothingAlpha);
         }
         request->send(200, "text/plain", "OK");
     });
 
     // --- Use LSM for Elevation ---
     webServer.on("/setElSource", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /setElSource");
         if (request->hasParam("value")) {
             int val = request->getParam("value")->value().toInt();
             useLSMforEl = (val != 0);
@@ -358,6 +181,7 @@ updateLogs();
 
     // --- Jog (POST) ---
     webServer.on("/jog", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /jog");
         if (request->hasParam("azStep", true)) {
             float azStep = request->getParam("azStep", true)->value().toFloat();
             moveAzimuthDeg(-1 * azStep);
@@ -373,6 +197,7 @@ updateLogs();
 
     // --- Move to absolute position ---
     webServer.on("/move", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /move");
         if (request->hasParam("moveAz", true)) {
             float az = request->getParam("moveAz", true)->value().toFloat();
             moveAzimuthToPosition(az);
@@ -388,6 +213,7 @@ updateLogs();
 
     // --- Emergency Stop ---
     webServer.on("/estop", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /estop");
         emergencyStop();
         WEB_LOG_WARN("WebUI", "Emergency stop requested");
         request->send(200, "text/plain", "Stopped");
@@ -395,26 +221,64 @@ updateLogs();
 
     // --- Home endpoints ---
     webServer.on("/homeAz", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /homeAz");
         homeAzimuth();
         WEB_LOG_INFO("WebUI","Started homing AZ");
         request->send(200, "text/plain", "Homing Azimuth started");
     });
     webServer.on("/homeEl", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /homeEl");
         homeElevation();
         WEB_LOG_INFO("WebUI","Started homing EL");
         request->send(200, "text/plain", "Homing Elevation started");
     });
 
+    // --- Homing repeatability (steps) ---
+    webServer.on("/homing/stats", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /homing/stats");
+        sendJSON(request, [](JsonWriter& json) {
+            json.beginObject();
+            json.key("az");
+            writeHomingStatsJSON(json, azHoming);
+            json.key("el");
+            writeHomingStatsJSON(json, elHoming);
+            json.kv("totalMs", lastHomingDurationMs);
+            json.endObject();
+        });
+    });
+
     // --- Logs ---
+    // /logs?since=N returns only entries with seq >= N
     webServer.on("/logs", HTTP_GET, [](AsyncWebServerRequest *request) {
-        String logsJson = webLogger.getLogsAsJSON();
-        request->send(200, "application/json", logsJson);
+        LATENCY_SCOPE("web /logs");
+        uint32_t since = 0;
+        if (request->hasParam("since")) {
+            since = strtoul(request->getParam("since")->value().c_str(), nullptr, 10);
+        }
+        sendJSON(request, [since](JsonWriter& json) { webLogger.writeLogsJSON(json, since); });
     });
 
+    // Replay what a (re)connecting client missed; Last-Event-ID is the seq
+    logEvents.onConnect([](AsyncEventSourceClient *client) {
+        char json[WEB_LOG_JSON_LEN];
+        uint32_t head = webLogger.getHeadSeq();
+        uint32_t seq = webLogger.getOldestSeq();
+        if (client->lastId() && (int32_t)(client->lastId() + 1 - seq) > 0) seq = client->lastId() + 1;
+        for (; (int32_t)(head - seq) > 0; seq++) {
+            if (webLogger.getEntryJSON(seq, json, sizeof(json))) client->send(json, "log", seq);
+        }
+    });
+    webServer.addHandler(&logEvents);
+
+    // --- WebSocket telemetry and commands ---
+    setupTelemetrySocket(webServer);
+
     // --- Automatic Calibration ---
     webServer.on("/autoCal", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /autoCal");
         if (!calib.isRunning()) {
-            calib.start();
+            bool sequential = request->hasParam("mode") && request->getParam("mode")->value() == "seq";
+            calib.start(sequential ? CAL_MODE_SEQUENTIAL : CAL_MODE_CONCURRENT);
             request->send(200, "text/plain", "Automatic Calibration started.");
         } else {
             request->send(200, "text/plain", "Calibration already running.");
@@ -423,23 +287,373 @@ updateLogs();
 
     // --- Calibration status ---
     webServer.on("/cal/status", HTTP_GET, [](AsyncWebServerRequest *request) {
-        String json = "{";
-        json += "\"azMin\":" + String(lsmReceiver.getAzMin()) + ",";
-        json += "\"azMax\":" + String(lsmReceiver.getAzMax()) + ",";
-        json += "\"elMin\":" + String(lsmReceiver.getElMin()) + ",";
-        json += "\"elMax\":" + String(lsmReceiver.getElMax());
-        json += "}";
-        request->send(200, "application/json", json);
+        LATENCY_SCOPE("web /cal/status");
+        sendJSON(request, [](JsonWriter& json) {
+            json.beginObject();
+            json.kv("azMin", lsmReceiver.getAzMin(), 2);
+            json.kv("azMax", lsmReceiver.getAzMax(), 2);
+            json.kv("elMin", lsmReceiver.getElMin(), 2);
+            json.kv("elMax", lsmReceiver.getElMax(), 2);
+            json.kv("samples", calib.getSampleCount());
+            json.kv("sweepMs", calib.getSweepMs());
+            json.kv("azBins", calib.getAzBinsCovered());
+            json.kv("elBins", calib.getElBinsCovered());
+            json.endObject();
+        });
+    });
+
+    // --- LSM303 packet capture (SensorRecorder.h) ---
+    webServer.on("/sensor/record", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web POST /sensor/record");
+        bool on = request->hasParam("on") && request->getParam("on")->value().toInt() != 0;
+        if (on) {
+            ALLOC_SCOPE(ALLOC_WEB);
+            if (!sensorRecorder.start()) {
+                request->send(500, "text/plain", "No memory for the capture buffer");
+                return;
+            }
+            WEB_LOG_INFO("WebUI", "Sensor recording started");
+        } else {
+            sensorRecorder.stop();
+            WEB_LOG_INFOF("WebUI", "Sensor recording stopped, %u samples", (unsigned)sensorRecorder.count());
+        }
+        request->send(200, "text/plain", on ? "Recording" : "Stopped");
+    });
+    webServer.on("/sensor/record", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /sensor/record");
+        sendJSON(request, [](JsonWriter& json) {
+            json.beginObject();
+            json.kv("recording", sensorRecorder.recording());
+            json.kv("samples", (uint32_t)sensorRecorder.count());
+            json.kv("overwritten", sensorRecorder.overwritten());
+            json.kv("capacity", (uint32_t)sensorRecorder.capacity());
+            json.endObject();
+        });
+    });
+    // Stops the recording so the file is consistent
+    webServer.on("/sensor/capture", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /sensor/capture");
+        ALLOC_SCOPE(ALLOC_WEB);
+        sensorRecorder.stop();
+        AsyncWebServerResponse *response = request->beginResponse(
+            "application/octet-stream", sensorRecorder.captureSize(),
+            [](uint8_t *buffer, size_t maxLen, size_t index) {
+                return sensorRecorder.readCapture(buffer, maxLen, index);
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=\"lsm303.cap\"");
+        request->send(response);
+    });
+
+    // --- rotctl session capture (RotctlRecorder.h) ---
+    // The rotctl callbacks and these handlers share the AsyncTCP task
+    webServer.on("/rotctl/record", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web POST /rotctl/record");
+        bool on = request->hasParam("on") && request->getParam("on")->value().toInt() != 0;
+        if (on) {
+            ALLOC_SCOPE(ALLOC_WEB);
+            if (!rotctlRecorder.start()) {
+                request->send(500, "text/plain", "No memory for the capture buffer");
+                return;
+            }
+            WEB_LOG_INFO("WebUI", "rotctl recording started");
+        } else {
+            rotctlRecorder.stop();
+            WEB_LOG_INFOF("WebUI", "rotctl recording stopped, %u events", (unsigned)rotctlRecorder.count());
+        }
+        request->send(200, "text/plain", on ? "Recording" : "Stopped");
+    });
+    webServer.on("/rotctl/record", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /rotctl/record");
+        sendJSON(request, [](JsonWriter& json) {
+            json.beginObject();
+            json.kv("recording", rotctlRecorder.recording());
+            json.kv("events", (uint32_t)rotctlRecorder.count());
+            json.kv("overwritten", rotctlRecorder.overwritten());
+            json.kv("truncated", rotctlRecorder.truncated());
+            json.kv("capacity", (uint32_t)ROTCTL_REC_CAPACITY);
+            json.endObject();
+        });
+    });
+    webServer.on("/rotctl/capture", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /rotctl/capture");
+        ALLOC_SCOPE(ALLOC_WEB);
+        AsyncResponseStream *response = request->beginResponseStream("text/plain");
+        response->addHeader("Content-Disposition", "attachment; filename=\"rotctl.txt\"");
+        char line[ROTCTL_REC_LINE_LEN];
+        for (size_t i = 0; i < rotctlRecorder.count(); i++) {
+            size_t n = formatRotctlEvent(line, sizeof(line), rotctlRecorder.event(i));
+            response->write((const uint8_t*)line, n);
+            response->write('\n');
+        }
+        request->send(response);
+    });
+
+    // --- Pointing quality per rotctl pass (TrackingMetrics.h) ---
+    webServer.on("/tracking", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /tracking");
+        sendJSON(request, [](JsonWriter& json) {
+            json.beginObject();
+            writeTrackingFields(json);
+            json.endObject();
+        });
+    });
+    // beamwidth=<deg>, full width; applies from the next pass
+    webServer.on("/tracking", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web POST /tracking");
+        float deg = request->hasParam("beamwidth") ? request->getParam("beamwidth")->value().toFloat() : 0.0f;
+        if (!(deg > 0.0f && deg <= 90.0f)) {
+            request->send(400, "text/plain", "beamwidth must be in (0, 90] deg");
+            return;
+        }
+        trackingMetrics.setBeamwidth(deg);
+        WEB_LOG_INFOF("WebUI", "Tracking beamwidth set to %.2f deg", deg);
+        request->send(200, "text/plain", "OK");
+    });
+
+    // --- Predicted time to reach az/el from the current state (SlewTime.h) ---
+    webServer.on("/slew", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /slew");
+        if (!request->hasParam("az") || !request->hasParam("el")) {
+            request->send(400, "text/plain", "az and el required");
+            return;
+        }
+        SlewPrediction slew = predictSlew(readTelemetrySnapshot(),
+                                          request->getParam("az")->value().toFloat(),
+                                          request->getParam("el")->value().toFloat());
+        sendJSON(request, [&slew](JsonWriter& json) {
+            json.beginObject();
+            json.kv("az", slew.az, 2);
+            json.kv("el", slew.el, 2);
+            json.kv("azSec", slew.azSec, 2);
+            json.kv("elSec", slew.elSec, 2);
+            json.kv("seconds", slew.seconds, 2);
+            json.endObject();
+        });
+    });
+
+    // --- Timed jobs and their clock (JobScheduler.h, WallClock.h) ---
+    webServer.on("/jobs", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /jobs");
+        sendJSON(request, [](JsonWriter& json) { jobScheduler.writeJSON(json); });
+    });
+    // kind=slew|trajectory|park|calibrate, at=<unix> or in=<seconds> (default
+    // now); az and el for slew, optional for park (default: home)
+    webServer.on("/jobs", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web POST /jobs");
+        JobKind kind;
+        if (!request->hasParam("kind") || !parseJobKind(request->getParam("kind")->value().c_str(), kind)) {
+            request->send(400, "text/plain", "kind must be slew, trajectory, park or calibrate");
+            return;
+        }
+        if (!wallClock.valid()) {
+            request->send(409, "text/plain", "clock not set");
+            return;
+        }
+        uint32_t at = wallClock.now();
+        if (request->hasParam("at")) at = strtoul(request->getParam("at")->value().c_str(), nullptr, 10);
+        else if (request->hasParam("in")) at += strtoul(request->getParam("in")->value().c_str(), nullptr, 10);
+        bool angles = request->hasParam("az") && request->hasParam("el");
+        if (kind == JOB_SLEW && !angles) {
+            request->send(400, "text/plain", "az and el required");
+            return;
+        }
+        if (kind == JOB_TRAJECTORY && trajectory.count() == 0) {
+            request->send(409, "text/plain", "no trajectory stored");
+            return;
+        }
+        float az = angles ? request->getParam("az")->value().toFloat() : JOB_PARK_AZ_DEG;
+        float el = angles ? request->getParam("el")->value().toFloat() : JOB_PARK_EL_DEG;
+        uint32_t id = jobScheduler.add(kind, at, az, el);
+        if (!id) {
+            request->send(409, "text/plain", "job queue full");
+            return;
+        }
+        sendJSON(request, [id](JsonWriter& json) {
+            json.beginObject();
+            json.kv("id", id);
+            json.endObject();
+        });
+    });
+    webServer.on("/jobs/cancel", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /jobs/cancel");
+        uint32_t id = request->hasParam("id") ? strtoul(request->getParam("id")->value().c_str(), nullptr, 10) : 0;
+        if (!jobScheduler.cancel(id)) {
+            request->send(404, "text/plain", "no such job");
+            return;
+        }
+        request->send(200, "text/plain", "OK");
+    });
+    // unix=<seconds>; refused once NTP keeps the time
+    webServer.on("/clock", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /clock");
+        uint32_t unixSec = request->hasParam("unix") ? strtoul(request->getParam("unix")->value().c_str(), nullptr, 10) : 0;
+        if (unixSec < hal::MIN_VALID_UNIX) {
+            request->send(400, "text/plain", "unix time required");
+            return;
+        }
+        if (!wallClock.set((uint64_t)unixSec * 1000)) {
+            request->send(409, "text/plain", "clock is set by NTP");
+            return;
+        }
+        request->send(200, "text/plain", "OK");
+    });
+
+    // --- Stored trajectory (Trajectory.h) ---
+    webServer.on("/trajectory", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /trajectory");
+        sendJSON(request, [](JsonWriter& json) {
+            json.beginObject();
+            json.kv("running", trajectory.isRunning());
+            json.kv("durationSec", trajectory.durationSec(), 1);
+            json.key("points").beginArray();
+            for (uint16_t i = 0; i < trajectory.count(); i++) {
+                const TrajPoint& p = trajectory.point(i);
+                json.beginArray().value(p.tSec, 1).value(p.az, 2).value(p.el, 2).endArray();
+            }
+            json.endArray();
+            json.endObject();
+        });
+    });
+    // points=t,az,el;... in the form body replaces it (t in seconds from
+    // the start); start=1 runs it now, stop=1 stops it
+    webServer.on("/trajectory", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web POST /trajectory");
+        if (request->hasParam("stop")) {
+            trajectory.stop();
+        } else if (request->hasParam("points", true)) {
+            static TrajPoint points[TRAJ_MAX_POINTS];   // web handlers share one task
+            int n = parseTrajectoryPoints(request->getParam("points", true)->value().c_str(),
+                                          points, TRAJ_MAX_POINTS);
+            if (n <= 0) {
+                request->send(400, "text/plain", "points: t,az,el;... with increasing t, in range");
+                return;
+            }
+            if (!trajectory.store(points, (uint16_t)n)) {
+                request->send(409, "text/plain", "trajectory running");
+                return;
+            }
+        } else if (request->hasParam("start")) {
+            if (trajectory.count() == 0) {
+                request->send(409, "text/plain", "no trajectory stored");
+                return;
+            }
+            if (!trajectory.start()) {
+                request->send(409, "text/plain", "not homed");
+                return;
+            }
+        }
+        request->send(200, "text/plain", "OK");
+    });
+
+    // --- Scan patterns (ScanPattern.h); markers go out on /ws ---
+    webServer.on("/scan", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /scan");
+        sendJSON(request, [](JsonWriter& json) {
+            json.beginObject();
+            json.kv("running", scanRunner.isRunning());
+            json.kv("kind", scanKindName(scanRunner.kind()));
+            json.kv("point", scanRunner.pointIndex());
+            json.kv("of", scanRunner.pointCount());
+            json.kv("droppedMarkers", scanRunner.droppedMarkers());
+            json.endObject();
+        });
+    });
+    // kind=raster|boustrophedon|spiral|cross|onoff, az, el (center), width,
+    // height, step (deg), dwellMs, cycles; stop=1 stops the running scan
+    webServer.on("/scan", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web POST /scan");
+        if (request->hasParam("stop")) {
+            scanRunner.stop();
+            request->send(200, "text/plain", "OK");
+            return;
+        }
+        ScanParams p;
+        if (!request->hasParam("kind") || !parseScanKind(request->getParam("kind")->value().c_str(), p.kind)) {
+            request->send(400, "text/plain", "kind must be raster, boustrophedon, spiral, cross or onoff");
+            return;
+        }
+        if (!request->hasParam("az") || !request->hasParam("el")) {
+            request->send(400, "text/plain", "az and el required");
+            return;
+        }
+        if (!azHomed || !elHomed) {
+            request->send(409, "text/plain", "not homed");
+            return;
+        }
+        p.centerAz = request->getParam("az")->value().toFloat();
+        p.centerEl = request->getParam("el")->value().toFloat();
+        if (request->hasParam("width")) p.width = request->getParam("width")->value().toFloat();
+        if (request->hasParam("height")) p.height = request->getParam("height")->value().toFloat();
+        if (request->hasParam("step")) p.step = request->getParam("step")->value().toFloat();
+        if (request->hasParam("dwellMs")) p.dwellMs = strtoul(request->getParam("dwellMs")->value().c_str(), nullptr, 10);
+        if (request->hasParam("cycles")) p.cycles = (uint16_t)constrain(request->getParam("cycles")->value().toInt(), 1, 65535);
+        const char* err = scanRunner.start(p);
+        if (err) {
+            request->send(400, "text/plain", err);
+            return;
+        }
+        request->send(200, "text/plain", "OK");
+    });
+
+    // --- Telemetry flight recorder (FlightRecorder.h) ---
+    // arm=1 clears and restarts it (optional rateHz), trigger=1 freezes it
+    // after the post-trigger window like a fault would
+    webServer.on("/flight", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web POST /flight");
+        if (request->hasParam("arm")) {
+            long rate = request->hasParam("rateHz") ? request->getParam("rateHz")->value().toInt() : 0;
+            if (rate < 0 || rate > FLIGHT_MAX_RATE_HZ) {
+                request->send(400, "text/plain", "rateHz out of range");
+                return;
+            }
+            flightRecorder.arm((uint16_t)rate);
+            WEB_LOG_INFOF("WebUI", "Flight recorder armed at %u Hz", (unsigned)(rate ? rate : flightRecorder.rateHz()));
+            request->send(200, "text/plain", "Armed");
+        } else if (request->hasParam("trigger")) {
+            bool taken = flightRecorder.trigger(FLIGHT_TRIG_MANUAL);
+            request->send(200, "text/plain", taken ? "Triggered" : "Already triggered");
+        } else {
+            request->send(400, "text/plain", "Expected arm or trigger");
+        }
+    });
+    webServer.on("/flight", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /flight");
+        sendJSON(request, [](JsonWriter& json) {
+            json.beginObject();
+            json.kv("frozen", flightRecorder.frozen());
+            json.kv("trigger", FLIGHT_TRIGGER_NAMES[flightRecorder.triggerReason()]);
+            json.kv("triggerMs", flightRecorder.triggerMs());
+            json.kv("rateHz", (uint32_t)flightRecorder.rateHz());
+            json.kv("samples", (uint32_t)flightRecorder.count());
+            json.kv("overwritten", flightRecorder.overwritten());
+            json.kv("capacity", (uint32_t)flightRecorder.capacity());
+            json.endObject();
+        });
+    });
+    // Freezes the ring so the columns stay consistent; re-arm afterwards
+    webServer.on("/flight/capture", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /flight/capture");
+        ALLOC_SCOPE(ALLOC_WEB);
+        flightRecorder.freeze();
+        AsyncWebServerResponse *response = request->beginResponse(
+            "application/octet-stream", flightRecorder.captureSize(),
+            [](uint8_t *buffer, size_t maxLen, size_t index) {
+                return flightRecorder.readCapture(buffer, maxLen, index);
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=\"flight.bin\"");
+        request->send(response);
     });
 
     // --- Reset ESP ---
     webServer.on("/reset", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /reset");
         request->send(200, "text/plain", "ESP32 is restarting...");
         delay(100);
         ESP.restart();
 
     });
    webServer.on("/tasks", HTTP_GET, [](AsyncWebServerRequest *request){
+       LATENCY_SCOPE("web /tasks");
         // Buffer for FreeRTOS task list
         static char taskList[2048];  
         memset(taskList, 0, sizeof(taskList));
@@ -451,6 +665,35 @@ updateLogs();
         request->send(200, "text/plain", taskList);
     });
 
+    // --- Latency histograms (Latency.h) ---
+    webServer.on("/latency", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /latency");
+        sendJSON(request, [](JsonWriter& json) { writeLatencyJSON(json); });
+    });
+    webServer.on("/latency/reset", HTTP_POST, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /latency/reset");
+        latencyRegistry.resetAll();
+        WEB_LOG_INFO("WebUI", "Latency histograms reset");
+        request->send(200, "text/plain", "Latency histograms reset");
+    });
+
+#if FIRMWARE_BENCH
+    // --- Microbenchmark results from setup() ---
+    webServer.on("/bench", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /bench");
+        sendJSON(request, [](JsonWriter& json) { writeBenchJSON(json); });
+    });
+#endif
+
+    // --- Prometheus scrape target ---
+    webServer.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LATENCY_SCOPE("web /metrics");
+        ALLOC_SCOPE(ALLOC_WEB);
+        AsyncResponseStream *response = request->beginResponseStream("text/plain; version=0.0.4");
+        writeMetrics(*response);
+        request->send(response);
+    });
+
 
     // --- OTA support ---
     ElegantOTA.begin(&webServer);  // no password
@@ -458,3 +701,24 @@ updateLogs();
     webServer.begin();
     WEB_LOG_INFO("WebServer", "Web server started on port 80");
 }
+
+// Called from loop(): pushes telemetry and the log entries added since
+// the last call to event-stream and WebSocket clients
+void handleWebServer() {
+    ALLOC_SCOPE(ALLOC_TELEMETRY);
+    updateTelemetrySocket();
+
+    uint32_t head = webLogger.getHeadSeq();
+    if (logEvents.count() == 0 && getTelemetryClients() == 0) {
+        logEventSeq = head;   // new clients get a replay on connect
+        return;
+    }
+    char json[WEB_LOG_JSON_LEN];
+    uint32_t oldest = webLogger.getOldestSeq();
+    if ((int32_t)(oldest - logEventSeq) > 0) logEventSeq = oldest;
+    for (; logEventSeq != head; logEventSeq++) {
+        if (!webLogger.getEntryJSON(logEventSeq, json, sizeof(json))) continue;
+        if (logEvents.count()) logEvents.send(json, "log", logEventSeq);
+        sendTelemetryLog(json);
+    }
+}
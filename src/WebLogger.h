@@ -2,9 +2,11 @@
 
 #ifndef WEBLOGGER_H
 #define WEBLOGGER_H
-#define WEB_LOG_WARN
-#include <Arduino.h>
-#include <vector>
+#include "hal/Hal.h"
+#include "LogRing.h"
+#include "LogRecord.h"
+#include "JsonWriter.h"
+#include "AllocTracker.h"
 
 enum LogLevel {
   LOG_DEBUG = 0,
@@ -13,90 +15,189 @@ enum LogLevel {
   LOG_ERROR = 3
 };
 
-struct LogEntry {
-  unsigned long timestamp;
-  LogLevel level;
-  String message;
-  String source;
-};
+// Compile-time level filter: calls below it compile to nothing, arguments
+// included. Set with -D WEB_LOG_MIN_LEVEL=<0..3> (0 = DEBUG ... 3 = ERROR).
+#ifndef WEB_LOG_MIN_LEVEL
+#define WEB_LOG_MIN_LEVEL 1
+#endif
 
+inline constexpr size_t WEB_LOG_CAPACITY = 100;  // Keep last 100 log entries
+inline constexpr size_t WEB_LOG_MSG_LEN = 160;   // formatted text is truncated to this
+inline constexpr size_t WEB_LOG_JSON_LEN = 384;  // one escaped entry as JSON
+inline constexpr uint32_t WEB_LOG_DRAIN_MS = 20;         // Serial drain task period
+inline constexpr uint32_t WEB_LOG_DRAIN_STACK = 3072;
+
+// Log entries live in a preallocated ring of deferred records: logging
+// copies the format pointer and arguments, and the text is only produced
+// when /logs is read or the Serial drain task prints the entry. Appending
+// never allocates and is safe from web handlers, rotctl callbacks and
+// loop() on either core.
 class WebLogger {
 private:
-  std::vector<LogEntry> logs;
-  const size_t maxLogs = 100;  // Keep last 100 log entries
-  bool serialEnabled = true;   // Can disable serial for performance
+  typedef LogRing<LogRecord, WEB_LOG_CAPACITY> Ring;
+  Ring logs;
+  volatile bool serialEnabled = true;   // Can disable serial for performance
+  uint32_t serialSeq = 0;               // next entry the drain task prints
+  uint32_t serialSkipped = 0;           // overwritten before they were printed
+  bool drainStarted = false;
 
 public:
-  void log(LogLevel level, const String& source, const String& message) {
-    LogEntry entry;
-    entry.timestamp = millis();
-    entry.level = level;
-    entry.message = message;
-    entry.source = source;
-    
-    // Add to vector
-    logs.push_back(entry);
-    
-    // Remove old entries if we exceed maxLogs
-    if (logs.size() > maxLogs) {
-      logs.erase(logs.begin());
-    }
-    
-    // Optional: still send to Serial for debugging
-    if (serialEnabled) {
-      String levelStr = getLevelString(level);
-      Serial.printf("[%lu] %s [%s]: %s\n", 
-                    entry.timestamp, levelStr.c_str(), 
-                    source.c_str(), message.c_str());
-    }
+  typedef Ring::Entry Entry;
+
+  // Starts the low-priority task that echoes entries to Serial
+  void begin() {
+    if (drainStarted) return;
+    serialSeq = logs.head();
+    drainStarted = hal::startTask(&WebLogger::drainTaskCode, "logDrain", WEB_LOG_DRAIN_STACK, this, 1);
+  }
+
+  uint8_t intern(const char* source) {
+    return logs.intern(source);
+  }
+
+  // Deferred path used by the macros: format must be a string literal
+  template <typename... Args>
+  void logf(LogLevel level, uint8_t source, const char* format, Args... args) {
+    ALLOC_FORBID();
+    logs.append(millis(), level, source, [&](LogRecord& r) { r.capture(format, args...); });
+  }
+
+  void logText(LogLevel level, uint8_t source, const char* literal) {
+    ALLOC_FORBID();
+    logs.append(millis(), level, source, [&](LogRecord& r) { r.begin(literal, true); });
+  }
+
+  // Runtime text (not necessarily static): copied into the record
+  void log(LogLevel level, const char* source, const char* message) {
+    ALLOC_FORBID();
+    logs.append(millis(), level, source, [&](LogRecord& r) { r.capture("%s", message); });
   }
-  
-  void debug(const String& source, const String& message) {
+
+  void debug(const char* source, const char* message) {
     log(LOG_DEBUG, source, message);
   }
-  
-  void info(const String& source, const String& message) {
+
+  void info(const char* source, const char* message) {
     log(LOG_INFO, source, message);
   }
-  
-  void warning(const String& source, const String& message) {
+
+  void warning(const char* source, const char* message) {
     log(LOG_WARNING, source, message);
   }
-  
-  void error(const String& source, const String& message) {
+
+  void error(const char* source, const char* message) {
     log(LOG_ERROR, source, message);
   }
-  
-  String getLogsAsJSON() {
-    String json = "[";
-    for (size_t i = 0; i < logs.size(); i++) {
-      if (i > 0) json += ",";
-      json += "{";
-      json += "\"timestamp\":" + String(logs[i].timestamp) + ",";
-      json += "\"level\":" + String(logs[i].level) + ",";
-      json += "\"levelName\":\"" + getLevelString(logs[i].level) + "\",";
-      json += "\"source\":\"" + logs[i].source + "\",";
-      json += "\"message\":\"" + logs[i].message + "\"";
-      json += "}";
+
+  uint32_t getHeadSeq() {
+    return logs.head();
+  }
+
+  uint32_t getOldestSeq() {
+    return logs.oldest();
+  }
+
+  // Writes entry `seq` as one JSON object into out; 0 if it is not held
+  // (any more). An entry whose escaped text does not fit is replaced by a
+  // placeholder rather than cut mid-string.
+  size_t getEntryJSON(uint32_t seq, char* out, size_t len) {
+    Entry e;
+    char text[WEB_LOG_MSG_LEN];
+    if (!logs.read(seq, e)) return 0;
+    formatLogRecord(e.payload, text, sizeof(text));
+    {
+      JsonBuffer json(out, len);
+      writeEntryJSON(json, e, text);
+      if (!json.overflowed()) return json.length();
+    }
+    JsonBuffer json(out, len);
+    writeEntryJSON(json, e, "(entry too long)");
+    return json.overflowed() ? 0 : json.length();
+  }
+
+  // JSON array of the entries with seq >= since, streamed through json
+  // so a poll costs one entry at a time instead of the whole log.
+  void writeLogsJSON(JsonWriter& json, uint32_t since = 0) {
+    Entry e;
+    char text[WEB_LOG_MSG_LEN];
+    uint32_t head = logs.head();
+    uint32_t seq = logs.oldest();
+    if ((int32_t)(since - seq) > 0) seq = since;
+    json.beginArray();
+    for (; (int32_t)(head - seq) > 0; seq++) {
+      if (!logs.read(seq, e)) continue;  // overwritten while reading
+      formatLogRecord(e.payload, text, sizeof(text));
+      writeEntryJSON(json, e, text);
     }
-    json += "]";
-    return json;
+    json.endArray();
   }
-  
+
   void enableSerial(bool enable) {
     serialEnabled = enable;
   }
-  
+
   void clearLogs() {
     logs.clear();
   }
-  
+
   size_t getLogCount() {
     return logs.size();
   }
 
+  uint32_t getDroppedCount() {
+    return logs.dropped();
+  }
+
+  uint32_t getSerialSkippedCount() {
+    return serialSkipped;
+  }
+
 private:
-  String getLevelString(LogLevel level) {
+  static void drainTaskCode(void* arg) {
+    WebLogger* self = static_cast<WebLogger*>(arg);
+    ALLOC_SCOPE(ALLOC_LOGGER);
+    for (;;) {
+      self->drainSerial();
+      hal::sleepMs(WEB_LOG_DRAIN_MS);
+    }
+  }
+
+  // Only the drain task touches serialSeq; Serial.write may block here
+  // without holding up the code that logged.
+  void drainSerial() {
+    Entry e;
+    char text[WEB_LOG_MSG_LEN];
+    uint32_t head = logs.head();
+    if (!serialEnabled) {
+      serialSeq = head;
+      return;
+    }
+    uint32_t oldest = logs.oldest();
+    if ((int32_t)(oldest - serialSeq) > 0) {
+      serialSkipped += oldest - serialSeq;
+      serialSeq = oldest;
+    }
+    for (; serialSeq != head; serialSeq++) {
+      if (!logs.read(serialSeq, e)) continue;
+      formatLogRecord(e.payload, text, sizeof(text));
+      Serial.printf("[%lu] %s [%s]: %s\n",
+                    (unsigned long)e.timestamp, getLevelString((LogLevel)e.level),
+                    logs.sourceName(e.source), text);
+    }
+  }
+
+  void writeEntryJSON(JsonWriter& json, const Entry& e, const char* text) {
+    json.beginObject();
+    json.kv("seq", e.seq);
+    json.kv("timestamp", e.timestamp);
+    json.kv("level", e.level);
+    json.kv("levelName", getLevelString((LogLevel)e.level));
+    json.kv("source", logs.sourceName(e.source));
+    json.kv("message", text);
+    json.endObject();
+  }
+
+  static const char* getLevelString(LogLevel level) {
     switch(level) {
       case LOG_DEBUG: return "DEBUG";
       case LOG_INFO: return "INFO";
@@ -110,35 +211,48 @@ private:
 // Global logger instance
 extern WebLogger webLogger;
 
-// Convenience macros for easy logging
-#define WEB_LOG_DEBUG(source, message) webLogger.debug(source, message)
-#define WEB_LOG_INFO(source, message) webLogger.info(source, message)
-#define WEB_LOG_WARNING(source, message) webLogger.warning(source, message)
-#define WEB_LOG_ERROR(source, message) webLogger.error(source, message)
-
-// printf-style macros
-#define WEB_LOG_DEBUGF(source, format, ...) do { \
-  char buffer[256]; \
-  snprintf(buffer, sizeof(buffer), format, ##__VA_ARGS__); \
-  webLogger.debug(source, String(buffer)); \
+// The source id is interned once per call site; "" format rejects
+// anything but a string literal, which the deferred record relies on.
+#define WEB_LOG_AT(level, source, format, ...) do { \
+  static const uint8_t _logSource = webLogger.intern(source); \
+  webLogger.logf(level, _logSource, "" format, ##__VA_ARGS__); \
 } while(0)
 
-#define WEB_LOG_INFOF(source, format, ...) do { \
-  char buffer[256]; \
-  snprintf(buffer, sizeof(buffer), format, ##__VA_ARGS__); \
-  webLogger.info(source, String(buffer)); \
+#define WEB_LOG_TEXT_AT(level, source, message) do { \
+  static const uint8_t _logSource = webLogger.intern(source); \
+  webLogger.logText(level, _logSource, "" message); \
 } while(0)
 
-#define WEB_LOG_WARNINGF(source, format, ...) do { \
-  char buffer[256]; \
-  snprintf(buffer, sizeof(buffer), format, ##__VA_ARGS__); \
-  webLogger.warning(source, String(buffer)); \
-} while(0)
+#define WEB_LOG_DISABLED(...) do {} while(0)
 
-#define WEB_LOG_ERRORF(source, format, ...) do { \
-  char buffer[256]; \
-  snprintf(buffer, sizeof(buffer), format, ##__VA_ARGS__); \
-  webLogger.error(source, String(buffer)); \
-} while(0)
+// Convenience macros for easy logging
+#if WEB_LOG_MIN_LEVEL <= 0
+#define WEB_LOG_DEBUG(source, message) WEB_LOG_TEXT_AT(LOG_DEBUG, source, message)
+#define WEB_LOG_DEBUGF(source, format, ...) WEB_LOG_AT(LOG_DEBUG, source, format, ##__VA_ARGS__)
+#else
+#define WEB_LOG_DEBUG(source, message) WEB_LOG_DISABLED()
+#define WEB_LOG_DEBUGF(source, format, ...) WEB_LOG_DISABLED()
+#endif
+
+#if WEB_LOG_MIN_LEVEL <= 1
+#define WEB_LOG_INFO(source, message) WEB_LOG_TEXT_AT(LOG_INFO, source, message)
+#define WEB_LOG_INFOF(source, format, ...) WEB_LOG_AT(LOG_INFO, source, format, ##__VA_ARGS__)
+#else
+#define WEB_LOG_INFO(source, message) WEB_LOG_DISABLED()
+#define WEB_LOG_INFOF(source, format, ...) WEB_LOG_DISABLED()
+#endif
+
+#if WEB_LOG_MIN_LEVEL <= 2
+#define WEB_LOG_WARNING(source, message) WEB_LOG_TEXT_AT(LOG_WARNING, source, message)
+#define WEB_LOG_WARNINGF(source, format, ...) WEB_LOG_AT(LOG_WARNING, source, format, ##__VA_ARGS__)
+#else
+#define WEB_LOG_WARNING(source, message) WEB_LOG_DISABLED()
+#define WEB_LOG_WARNINGF(source, format, ...) WEB_LOG_DISABLED()
+#endif
+
+#define WEB_LOG_WARN(source, message) WEB_LOG_WARNING(source, message)
+
+#define WEB_LOG_ERROR(source, message) WEB_LOG_TEXT_AT(LOG_ERROR, source, message)
+#define WEB_LOG_ERRORF(source, format, ...) WEB_LOG_AT(LOG_ERROR, source, format, ##__VA_ARGS__)
 
 #endif
@@ -0,0 +1,32 @@
+#pragma once
+
+// --- Hardware abstraction layer ---
+// Motion, homing, calibration, the LSM303 receiver and rotctl reach the
+// hardware only through this header, so the same sources build for the
+// ESP32 and for Linux (env:native, host tests and simulation).
+//
+//   clock     millis(), micros(), delay(), getCpuFrequencyMhz(), hal::cycleCount()
+//   NTP       hal::startNtp(), hal::ntpTimeMs()
+//   GPIO      pinMode(), digitalRead(), attachInterrupt() on edge pins
+//   console   Serial.print/println/printf, the log sink; Print for text writers
+//   Stepper   FastAccelStepper's move/position API
+//   UdpSocket WiFiUDP's begin/parsePacket/read
+//   NvStore   Preferences' begin/getBytes/putBytes
+//   hal::TcpServer, hal::CriticalSection, hal::Mutex, hal::startTask
+//
+// Clock, GPIO and console keep their Arduino names so the firmware reads
+// as ordinary Arduino code. On the ESP32 each piece is the Arduino/IDF
+// implementation itself or an inline wrapper around it.
+#include <stdint.h>
+
+namespace hal {
+// Unix time before this is an unset clock (the ESP32 starts at 1970);
+// the NTP backends and WallClock::set() share it
+inline constexpr uint32_t MIN_VALID_UNIX = 1700000000;
+}
+
+#if defined(ARDUINO)
+#include "esp32/HalEsp32.h"
+#else
+#include "native/HalNative.h"
+#endif
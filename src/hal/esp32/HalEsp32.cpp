@@ -0,0 +1,41 @@
+// HalEsp32.cpp - TCP listener on AsyncTCP
+#include "../Hal.h"
+#include <AsyncTCP.h>
+
+namespace hal {
+
+bool TcpServer::begin() {
+    AsyncServer* server = new AsyncServer(_port);
+    _server = server;
+
+    server->onClient([](void* arg, AsyncClient* c) {
+        TcpServer* self = static_cast<TcpServer*>(arg);
+        TcpClient* client = reinterpret_cast<TcpClient*>(c);
+        if (self->_onConnect) self->_onConnect(client, self->_ctx);
+
+        c->onData([self](void*, AsyncClient* c2, void* data, size_t len) {
+            if (self->_onData) self->_onData(reinterpret_cast<TcpClient*>(c2), (const char*)data, len, self->_ctx);
+        }, nullptr);
+
+        c->onDisconnect([self](void*, AsyncClient* c2) {
+            if (self->_onDisconnect) self->_onDisconnect(reinterpret_cast<TcpClient*>(c2), self->_ctx);
+        }, nullptr);
+
+        c->onError([self](void*, AsyncClient*, int8_t error) {
+            Serial.printf("[TCP %u] client error %d\n", self->_port, error);
+        }, nullptr);
+
+        c->onTimeout([self](void*, AsyncClient*, uint32_t) {
+            Serial.printf("[TCP %u] client timeout\n", self->_port);
+        }, nullptr);
+    }, this);
+
+    server->begin();
+    return true;
+}
+
+size_t TcpServer::write(TcpClient* client, const char* data, size_t len) {
+    return reinterpret_cast<AsyncClient*>(client)->write(data, len);
+}
+
+}  // namespace hal
@@ -0,0 +1,91 @@
+#pragma once
+#include <Arduino.h>
+#include <FastAccelStepper.h>
+#include <WiFiUdp.h>
+#include <Preferences.h>
+#include <sys/time.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// ESP32 backend of hal/Hal.h: the framework types are used as they are
+using Stepper = FastAccelStepper;
+using UdpSocket = WiFiUDP;
+using NvStore = Preferences;
+
+namespace hal {
+
+inline constexpr const char* TARGET_NAME = "esp32";
+
+inline uint32_t cycleCount() { return ESP.getCycleCount(); }
+
+// SNTP in the background; the system time counts as synced once it is
+// past MIN_VALID_UNIX (it starts at 1970 after a reset)
+inline void startNtp(const char* server) { configTime(0, 0, server); }
+
+inline bool ntpTimeMs(uint64_t& unixMs) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    if (tv.tv_sec < (time_t)MIN_VALID_UNIX) return false;
+    unixMs = (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    return true;
+}
+
+// Short sections shared with other tasks or the other core
+class CriticalSection {
+public:
+    void enter() { portENTER_CRITICAL(&_mux); }
+    void exit() { portEXIT_CRITICAL(&_mux); }
+
+private:
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+// Blocking lock for longer work such as flash writes
+class Mutex {
+public:
+    Mutex() : _handle(xSemaphoreCreateMutexStatic(&_buffer)) {}
+    void lock() { xSemaphoreTake(_handle, portMAX_DELAY); }
+    void unlock() { xSemaphoreGive(_handle); }
+
+private:
+    StaticSemaphore_t _buffer;
+    SemaphoreHandle_t _handle;
+};
+
+// priority is relative to the idle task
+inline bool startTask(void (*fn)(void*), const char* name, uint32_t stackBytes, void* arg, uint8_t priority) {
+    return xTaskCreate(fn, name, stackBytes, arg, tskIDLE_PRIORITY + priority, nullptr) == pdPASS;
+}
+
+inline void sleepMs(uint32_t ms) { vTaskDelay(pdMS_TO_TICKS(ms)); }
+
+// TCP listener with per-connection callbacks, on AsyncTCP. Callbacks run
+// on the AsyncTCP task.
+struct TcpClient;
+typedef void (*TcpEventFn)(TcpClient* client, void* ctx);
+typedef void (*TcpDataFn)(TcpClient* client, const char* data, size_t len, void* ctx);
+
+class TcpServer {
+public:
+    explicit TcpServer(uint16_t port) : _port(port) {}
+
+    void onConnect(TcpEventFn fn, void* ctx) { _onConnect = fn; _ctx = ctx; }
+    void onData(TcpDataFn fn) { _onData = fn; }
+    void onDisconnect(TcpEventFn fn) { _onDisconnect = fn; }
+
+    bool begin();
+    uint16_t port() const { return _port; }
+    static size_t write(TcpClient* client, const char* data, size_t len);
+
+private:
+    uint16_t _port;
+    void* _server = nullptr;   // AsyncServer
+    TcpEventFn _onConnect = nullptr;
+    TcpDataFn _onData = nullptr;
+    TcpEventFn _onDisconnect = nullptr;
+    void* _ctx = nullptr;
+};
+
+}  // namespace hal
@@ -0,0 +1,446 @@
+// HalNative.cpp - Linux backend of hal/Hal.h (simulated time and pins)
+#include "HalNative.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+HalConsole Serial;
+
+namespace {
+
+struct Pin {
+    int level = HIGH;
+    std::function<int()> source;
+    void (*isr)() = nullptr;
+    int mode = 0;
+    int lastLevel = HIGH;
+};
+
+uint64_t simUs = 0;
+std::map<int, Pin> pins;
+
+// Steppers may be globals in other translation units
+std::vector<Stepper*>& steppers() {
+    static std::vector<Stepper*> list;
+    return list;
+}
+std::vector<std::function<void(uint64_t)>> advanceHooks;
+std::vector<hal::TcpServer*> tcpServers;
+std::map<uint16_t, std::deque<std::string>> udpQueues;
+std::map<std::string, std::vector<uint8_t>> nvs;
+bool ntpSynced = false;
+int64_t ntpOffsetMs = 0;   // unix ms minus simulated ms
+
+int readPin(Pin& p) { return p.source ? p.source() : p.level; }
+
+// Edge interrupts, checked after every time slice
+void checkEdges() {
+    for (auto& entry : pins) {
+        Pin& p = entry.second;
+        if (!p.isr) continue;
+        int level = readPin(p);
+        bool fire = (p.mode == FALLING && p.lastLevel == HIGH && level == LOW) ||
+                    (p.mode == RISING && p.lastLevel == LOW && level == HIGH) ||
+                    (p.mode == CHANGE && p.lastLevel != level);
+        p.lastLevel = level;
+        if (fire) p.isr();
+    }
+}
+
+void setNonBlocking(int fd) { fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK); }
+
+}  // namespace
+
+// ----------------------
+// Clock and GPIO
+// ----------------------
+unsigned long millis() { return (unsigned long)(simUs / 1000); }
+unsigned long micros() { return (unsigned long)simUs; }
+void delay(unsigned long ms) { hal::sim::advance(ms * 1000); }
+
+void pinMode(int pin, int mode) {
+    Pin& p = pins[pin];
+    if (mode == INPUT_PULLUP) p.level = HIGH;
+}
+
+int digitalRead(int pin) {
+    auto it = pins.find(pin);
+    return it == pins.end() ? HIGH : readPin(it->second);
+}
+
+void attachInterrupt(int pin, void (*isr)(), int mode) {
+    Pin& p = pins[pin];
+    p.isr = isr;
+    p.mode = mode;
+    p.lastLevel = readPin(p);
+}
+
+void detachInterrupt(int pin) { pins[pin].isr = nullptr; }
+
+// ----------------------
+// Console
+// ----------------------
+size_t Print::write(const uint8_t* data, size_t len) {
+    size_t n = 0;
+    while (n < len && write(data[n])) n++;
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (n < 0) return 0;
+    if ((size_t)n >= sizeof(buf)) n = sizeof(buf) - 1;
+    return write((const uint8_t*)buf, (size_t)n);
+}
+
+size_t HalConsole::print(const char* s) {
+    if (_echo) fputs(s, stdout);
+    return strlen(s);
+}
+
+size_t HalConsole::println(const char* s) {
+    _lines++;
+    if (_echo) printf("%s\n", s);
+    return strlen(s) + 1;
+}
+
+size_t HalConsole::printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (n < 0) return 0;
+    _lines++;
+    if (_echo) fputs(buf, stdout);
+    return (size_t)n;
+}
+
+// ----------------------
+// Stepper
+// ----------------------
+Stepper::Stepper() { steppers().push_back(this); }
+
+Stepper::~Stepper() {
+    std::vector<Stepper*>& list = steppers();
+    for (auto it = list.begin(); it != list.end(); ++it) {
+        if (*it == this) { list.erase(it); break; }
+    }
+}
+
+int8_t Stepper::moveTo(int32_t position, bool) {
+    _target = position;
+    _stopping = false;
+    _running = position != getCurrentPosition() || _velocity != 0.0;
+    return 0;
+}
+
+int8_t Stepper::move(int32_t steps, bool) {
+    return moveTo((_running ? _target : getCurrentPosition()) + steps);
+}
+
+void Stepper::stopMove() {
+    if (_running) _stopping = true;
+}
+
+void Stepper::forceStop() {
+    _velocity = 0.0;
+    _running = false;
+    _stopping = false;
+    _target = getCurrentPosition();
+}
+
+void Stepper::forceStopAndNewPosition(int32_t position) {
+    forceStop();
+    _pos = position;     // the shaft stays where it is
+    _target = position;
+}
+
+int32_t Stepper::getCurrentPosition() const { return (int32_t)lround(_pos); }
+
+void Stepper::setCurrentPosition(int32_t position) {
+    int32_t delta = position - getCurrentPosition();
+    _pos += delta;
+    _target += delta;
+}
+
+void Stepper::advance(uint32_t us) {
+    if (!_running) return;
+    double dt = us * 1e-6;
+    double remaining = _target - _pos;
+    double speed = fabs(_velocity);
+    int moving = _velocity > 0 ? 1 : _velocity < 0 ? -1 : 0;
+    int wanted = remaining > 0 ? 1 : remaining < 0 ? -1 : 0;
+    double stopDistance = speed * speed / (2.0 * _accel);
+
+    bool decelerate = _stopping || speed > _speedHz ||
+                      (moving != 0 && moving != wanted) ||
+                      fabs(remaining) <= stopDistance;
+    if (decelerate) {
+        speed -= _accel * dt;
+        if (speed < 0) speed = 0;
+    } else {
+        speed += _accel * dt;
+        if (speed > _speedHz) speed = _speedHz;
+    }
+
+    int dir = moving != 0 ? moving : wanted;
+    _velocity = dir * speed;
+    double before = _pos;
+    _pos += _velocity * dt;
+    _shaft += _velocity * dt;
+
+    if (_stopping) {
+        if (speed == 0) {
+            _running = false;
+            _stopping = false;
+            _target = getCurrentPosition();
+        }
+        return;
+    }
+    // Arrived when the target is reached or crossed at the end of the ramp
+    bool crossed = (before - _target) * (_pos - _target) <= 0;
+    if ((crossed && moving == wanted) || (fabs(_target - _pos) < 0.5 && speed <= _accel * dt)) {
+        _shaft += _target - _pos;
+        _pos = _target;
+        _velocity = 0.0;
+        _running = false;
+    }
+}
+
+// ----------------------
+// UDP
+// ----------------------
+UdpSocket::~UdpSocket() { stop(); }
+
+uint8_t UdpSocket::begin(uint16_t port) {
+    stop();
+    _port = port;
+    _fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (_fd < 0) return 0;
+    int one = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(_fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        stop();
+        return 0;
+    }
+    setNonBlocking(_fd);
+    return 1;
+}
+
+void UdpSocket::stop() {
+    if (_fd >= 0) close(_fd);
+    _fd = -1;
+}
+
+int UdpSocket::parsePacket() {
+    _packetLen = 0;
+    _readPos = 0;
+    auto& queue = udpQueues[_port];
+    if (!queue.empty()) {
+        std::string& d = queue.front();
+        _packetLen = (int)(d.size() < sizeof(_packet) ? d.size() : sizeof(_packet));
+        memcpy(_packet, d.data(), _packetLen);
+        queue.pop_front();
+    } else if (_fd >= 0) {
+        ssize_t n = recv(_fd, _packet, sizeof(_packet), MSG_DONTWAIT);
+        _packetLen = n > 0 ? (int)n : 0;
+    }
+    return _packetLen;
+}
+
+int UdpSocket::read(char* buffer, size_t len) {
+    int n = _packetLen - _readPos;
+    if (n > (int)len) n = (int)len;
+    if (n <= 0) return 0;
+    memcpy(buffer, _packet + _readPos, n);
+    _readPos += n;
+    return n;
+}
+
+// ----------------------
+// Non-volatile store
+// ----------------------
+bool NvStore::begin(const char* ns, bool readOnly) {
+    snprintf(_ns, sizeof(_ns), "%s", ns);
+    _readOnly = readOnly;
+    return true;
+}
+
+size_t NvStore::getBytes(const char* key, void* buffer, size_t len) {
+    auto it = nvs.find(std::string(_ns) + "/" + key);
+    if (it == nvs.end() || it->second.size() > len) return 0;
+    memcpy(buffer, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+size_t NvStore::putBytes(const char* key, const void* value, size_t len) {
+    if (_readOnly) return 0;
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    nvs[std::string(_ns) + "/" + key].assign(bytes, bytes + len);
+    return len;
+}
+
+bool NvStore::remove(const char* key) {
+    return !_readOnly && nvs.erase(std::string(_ns) + "/" + key) > 0;
+}
+
+namespace hal {
+
+uint32_t cycleCount() {
+    auto ns = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint32_t)(std::chrono::duration_cast<std::chrono::nanoseconds>(ns).count() * 240 / 1000);
+}
+
+bool startTask(void (*fn)(void*), const char*, uint32_t, void* arg, uint8_t) {
+    std::thread(fn, arg).detach();
+    return true;
+}
+
+void sleepMs(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+bool ntpTimeMs(uint64_t& unixMs) {
+    if (!ntpSynced) return false;
+    unixMs = (uint64_t)((int64_t)(simUs / 1000) + ntpOffsetMs);
+    return true;
+}
+
+// ----------------------
+// TCP
+// ----------------------
+struct TcpClient {
+    int fd;
+};
+
+TcpServer::TcpServer(uint16_t port) : _port(port) {}
+
+TcpServer::~TcpServer() {
+    for (auto it = tcpServers.begin(); it != tcpServers.end(); ++it) {
+        if (*it == this) { tcpServers.erase(it); break; }
+    }
+    for (TcpClient*& c : _clients) {
+        if (!c) continue;
+        close(c->fd);
+        delete c;
+        c = nullptr;
+    }
+    if (_fd >= 0) close(_fd);
+}
+
+bool TcpServer::begin() {
+    _fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_fd < 0) return false;
+    int one = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(_fd, MAX_CLIENTS) != 0) {
+        close(_fd);
+        _fd = -1;
+        return false;
+    }
+    setNonBlocking(_fd);
+    tcpServers.push_back(this);
+    return true;
+}
+
+size_t TcpServer::write(TcpClient* client, const char* data, size_t len) {
+    ssize_t n = send(client->fd, data, len, MSG_NOSIGNAL);
+    return n > 0 ? (size_t)n : 0;
+}
+
+void TcpServer::poll() {
+    if (_fd < 0) return;
+    int fd;
+    while ((fd = accept(_fd, nullptr, nullptr)) >= 0) {
+        setNonBlocking(fd);
+        TcpClient** slot = nullptr;
+        for (TcpClient*& c : _clients) if (!c) { slot = &c; break; }
+        if (!slot) { close(fd); continue; }
+        *slot = new TcpClient{fd};
+        if (_onConnect) _onConnect(*slot, _ctx);
+    }
+    char buf[512];
+    for (TcpClient*& c : _clients) {
+        if (!c) continue;
+        ssize_t n;
+        while ((n = recv(c->fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+            if (_onData) _onData(c, buf, (size_t)n, _ctx);
+        }
+        if (n == 0) {
+            if (_onDisconnect) _onDisconnect(c, _ctx);
+            close(c->fd);
+            delete c;
+            c = nullptr;
+        }
+    }
+}
+
+namespace sim {
+
+void advance(uint32_t us) {
+    while (us > 0) {
+        uint32_t slice = us < STEP_US ? us : STEP_US;
+        simUs += slice;
+        us -= slice;
+        for (Stepper* s : steppers()) s->advance(slice);
+        for (auto& hook : advanceHooks) hook(simUs);
+        checkEdges();
+    }
+}
+
+uint64_t nowUs() { return simUs; }
+
+void setPin(int pin, int level) {
+    pins[pin].level = level;
+    checkEdges();
+}
+
+void setPinSource(int pin, std::function<int()> source) {
+    pins[pin].source = std::move(source);
+    checkEdges();
+}
+
+void clearPins() {
+    for (auto& entry : pins) {
+        entry.second.source = nullptr;
+        entry.second.level = HIGH;
+        entry.second.lastLevel = HIGH;
+    }
+}
+
+void onAdvance(std::function<void(uint64_t)> hook) { advanceHooks.push_back(std::move(hook)); }
+
+void injectUdp(uint16_t port, const char* data, size_t len) { udpQueues[port].emplace_back(data, len); }
+
+void pollNetwork() {
+    for (TcpServer* s : tcpServers) s->poll();
+}
+
+void clearNvs() { nvs.clear(); }
+
+void setNtpTime(uint64_t unixMs) {
+    ntpSynced = unixMs != 0;
+    ntpOffsetMs = (int64_t)unixMs - (int64_t)(simUs / 1000);
+}
+
+}  // namespace sim
+}  // namespace hal
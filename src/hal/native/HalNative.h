@@ -0,0 +1,245 @@
+#pragma once
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <functional>
+#include <mutex>
+
+// Linux backend of hal/Hal.h. Time is simulated: it only moves when
+// hal::sim::advance() (or delay()) is called, and steppers, pin levels and
+// edge interrupts are updated along the way, so host tests run the
+// firmware faster than real time and reproducibly. Network sockets are
+// real (loopback) and are serviced by hal::sim::pollNetwork().
+
+// --- Arduino core subset: clock, GPIO, console ---
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define IRAM_ATTR
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+inline void yield() {}
+inline uint32_t getCpuFrequencyMhz() { return 240; }   // matches hal::cycleCount()
+
+void pinMode(int pin, int mode);
+int digitalRead(int pin);
+inline int digitalPinToInterrupt(int pin) { return pin; }
+void attachInterrupt(int pin, void (*isr)(), int mode);
+void detachInterrupt(int pin);
+
+// Output stream, Arduino's Print: what the text writers (/metrics) need
+class Print {
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* data, size_t len);
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// Console log sink; echoes to stdout unless muted
+class HalConsole {
+public:
+    size_t print(const char* s);
+    size_t println(const char* s = "");
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    void setEcho(bool echo) { _echo = echo; }
+    uint32_t lines() const { return _lines; }
+
+private:
+    bool _echo = true;
+    uint32_t _lines = 0;
+};
+
+extern HalConsole Serial;
+
+// --- Stepper: FastAccelStepper's API on a simulated axis ---
+// Trapezoidal ramp at the configured speed and acceleration, advanced by
+// hal::sim::advance(). move() is relative to the target, as in FAS.
+class Stepper {
+public:
+    Stepper();
+    ~Stepper();
+    Stepper(const Stepper&) = delete;
+    Stepper& operator=(const Stepper&) = delete;
+
+    int8_t setSpeedInHz(uint32_t hz) { _speedHz = hz ? hz : 1; return 0; }
+    int8_t setAcceleration(int32_t stepsPerSs) { _accel = stepsPerSs > 0 ? stepsPerSs : 1; return 0; }
+    uint32_t getMaxSpeedInHz() const { return _speedHz; }
+    uint32_t getAcceleration() const { return _accel; }
+
+    int8_t moveTo(int32_t position, bool blocking = false);
+    int8_t move(int32_t steps, bool blocking = false);
+    void stopMove();
+    void forceStop();
+    void forceStopAndNewPosition(int32_t position);
+
+    int32_t getCurrentPosition() const;
+    void setCurrentPosition(int32_t position);
+    int32_t targetPos() const { return _target; }
+    int32_t getPositionAfterCommandsCompleted() const { return _target; }
+    bool isRunning() const { return _running; }
+    uint8_t queueEntries() const { return _running ? 1 : 0; }
+    bool isQueueEmpty() const { return !_running; }
+    int32_t getCurrentSpeedInMilliHz() const { return (int32_t)(_velocity * 1000.0); }
+
+    // Simulation. The shaft position is where the axis physically is; it
+    // moves with the steps but ignores setCurrentPosition(), so limit
+    // switches and sensors modelled on it see homing shift the frame.
+    void advance(uint32_t us);
+    double shaftPosition() const { return _shaft; }
+    void setShaftPosition(double steps) { _shaft = steps; }
+
+private:
+    double _pos = 0.0;        // steps, firmware frame
+    double _shaft = 0.0;
+    double _velocity = 0.0;   // steps/s, signed
+    int32_t _target = 0;
+    uint32_t _speedHz = 1000;
+    uint32_t _accel = 1000;
+    bool _running = false;
+    bool _stopping = false;
+};
+
+// --- UdpSocket: WiFiUDP's receive API ---
+// Binds a real loopback socket; hal::sim::injectUdp() queues datagrams
+// for a port without going through the network.
+class UdpSocket {
+public:
+    ~UdpSocket();
+    uint8_t begin(uint16_t port);
+    void stop();
+    int parsePacket();
+    int read(char* buffer, size_t len);
+    int read(uint8_t* buffer, size_t len) { return read((char*)buffer, len); }
+
+private:
+    int _fd = -1;
+    uint16_t _port = 0;
+    char _packet[1472];
+    int _packetLen = 0;
+    int _readPos = 0;
+};
+
+// --- NvStore: Preferences' byte API over a process-wide map ---
+// Contents survive across instances (a simulated reboot) until
+// hal::sim::clearNvs().
+class NvStore {
+public:
+    bool begin(const char* ns, bool readOnly = false);
+    void end() {}
+    size_t getBytes(const char* key, void* buffer, size_t len);
+    size_t putBytes(const char* key, const void* value, size_t len);
+    bool remove(const char* key);
+
+private:
+    char _ns[16] = "";
+    bool _readOnly = false;
+};
+
+namespace hal {
+
+inline constexpr const char* TARGET_NAME = "native";
+
+// Wall-clock based, 240 ticks per us like the ESP32 at 240 MHz
+uint32_t cycleCount();
+
+// No network time unless a test provides it with sim::setNtpTime()
+inline void startNtp(const char*) {}
+bool ntpTimeMs(uint64_t& unixMs);
+
+class CriticalSection {
+public:
+    void enter() { _mutex.lock(); }
+    void exit() { _mutex.unlock(); }
+
+private:
+    std::recursive_mutex _mutex;
+};
+
+class Mutex {
+public:
+    void lock() { _mutex.lock(); }
+    void unlock() { _mutex.unlock(); }
+
+private:
+    std::mutex _mutex;
+};
+
+// Real threads; only used for background drains
+bool startTask(void (*fn)(void*), const char* name, uint32_t stackBytes, void* arg, uint8_t priority);
+void sleepMs(uint32_t ms);
+
+struct TcpClient;
+typedef void (*TcpEventFn)(TcpClient* client, void* ctx);
+typedef void (*TcpDataFn)(TcpClient* client, const char* data, size_t len, void* ctx);
+
+// Non-blocking loopback listener, serviced by hal::sim::pollNetwork()
+class TcpServer {
+public:
+    explicit TcpServer(uint16_t port);
+    ~TcpServer();
+
+    void onConnect(TcpEventFn fn, void* ctx) { _onConnect = fn; _ctx = ctx; }
+    void onData(TcpDataFn fn) { _onData = fn; }
+    void onDisconnect(TcpEventFn fn) { _onDisconnect = fn; }
+
+    bool begin();
+    uint16_t port() const { return _port; }
+    static size_t write(TcpClient* client, const char* data, size_t len);
+
+    void poll();
+
+private:
+    static constexpr int MAX_CLIENTS = 4;
+
+    uint16_t _port;
+    int _fd = -1;
+    TcpClient* _clients[MAX_CLIENTS] = {};
+    TcpEventFn _onConnect = nullptr;
+    TcpDataFn _onData = nullptr;
+    TcpEventFn _onDisconnect = nullptr;
+    void* _ctx = nullptr;
+};
+
+namespace sim {
+
+inline constexpr uint32_t STEP_US = 100;   // stepper and pin resolution
+
+// Moves simulated time forward in STEP_US slices: steppers advance, pin
+// levels are re-read and falling/rising edges call attached interrupts
+void advance(uint32_t us);
+uint64_t nowUs();
+
+// A pin reads the level set here, or the source's value when one is set
+void setPin(int pin, int level);
+void setPinSource(int pin, std::function<int()> source);
+void clearPins();
+
+// Called once per advance() slice after the steppers moved
+void onAdvance(std::function<void(uint64_t nowUs)> hook);
+
+void injectUdp(uint16_t port, const char* data, size_t len);
+void pollNetwork();
+
+void clearNvs();
+
+// NTP reads unixMs now and follows simulated time from here; 0 = no sync
+void setNtpTime(uint64_t unixMs);
+
+}  // namespace sim
+}  // namespace hal
@@ -0,0 +1,97 @@
+// NativeBoard.cpp - firmware globals and main loop for env:native
+#include "NativeBoard.h"
+#include <stdlib.h>
+#include "WebLogger.h"
+#include "MotorControl.h"
+#include "Homing.h"
+#include "LSM303Receiver.h"
+#include "SensorRecorder.h"
+#include "FlightRecorder.h"
+#include "TrackingMetrics.h"
+#include "Calibration.h"
+#include "PositionStore.h"
+#include "Trajectory.h"
+#include "JobScheduler.h"
+#include "NvsWriter.h"
+#include "ScanPattern.h"
+#include "Scheduler.h"
+#include "TelemetrySnapshot.h"
+#include "rotctl_server.h"
+#include "AllocTracker.h"
+#include "Metrics.h"
+
+const char* HARDWARE_ID = "ESP32 Rotator (native)";
+const char* FIRMWARE_VERSION = "v1.2.0";
+
+WebLogger webLogger;
+AllocTracker allocTracker;   // tests route malloc/free to it themselves
+
+const int AZ_LIMIT_PIN = 23;
+const int EL_LIMIT_PIN = 19;
+
+int gearRatio = 72;
+int microstepsPerRevolution = 400;
+float stepsPerRevolution = microstepsPerRevolution * gearRatio;
+float stepsPerDegree = stepsPerRevolution / 360.0;
+
+bool useLSMforEl = false;
+bool elGangedDrive = true;
+bool rotctlConnected = false;
+
+LSM303Receiver lsmReceiver(NATIVE_LSM_PORT);
+Calibration calib(&lsmReceiver);
+PositionStore positionStore(&lsmReceiver);
+
+bool warmStarted = false;
+unsigned long operationalMs = 0;
+
+static Stepper azStepper, el1Stepper, el2Stepper;
+Stepper* azMotor = &azStepper;
+Stepper* elMotor1 = &el1Stepper;
+Stepper* elMotor2 = &el2Stepper;
+
+// No heap, Wi-Fi or FreeRTOS figures on the host
+void writeSystemMetrics(Print&) {}
+
+void nativeSetup(bool startRotctl) {
+    const char* echo = getenv("ROTATOR_NATIVE_ECHO");
+    Serial.setEcho(echo && *echo == '1');
+
+    pinMode(AZ_LIMIT_PIN, INPUT);
+    pinMode(EL_LIMIT_PIN, INPUT);
+    lsmReceiver.setRecorder(&sensorRecorder);
+    lsmReceiver.begin();
+
+    for (Stepper* m : {azMotor, elMotor1, elMotor2}) {
+        m->setSpeedInHz(MOTOR_SPEED_HZ);
+        m->setAcceleration(MOTOR_ACCELERATION);
+    }
+
+    beginHoming();
+    positionStore.begin();
+    trajectory.begin();
+    jobScheduler.begin();
+    if (startRotctl) startRotctlServer(NATIVE_ROTCTL_PORT);
+}
+
+void nativeLoop() {
+    updateHoming();
+    if (operationalMs == 0 && homingStage == HOMING_COMPLETE) operationalMs = millis();
+    lsmReceiver.update();
+    scheduler.tick();
+    positionStore.update();
+    jobScheduler.update();
+    publishTelemetrySnapshot();
+    flightRecorder.update();
+    trackingMetrics.update();
+    scanRunner.update();
+    nvsWriter.service();   // stands in for the writer task
+    hal::sim::pollNetwork();
+}
+
+void nativeRunFor(uint32_t ms) {
+    for (uint32_t i = 0; i < ms; i++) {
+        hal::sim::advance(1000);
+        nativeLoop();
+    }
+}
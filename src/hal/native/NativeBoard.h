@@ -0,0 +1,19 @@
+#pragma once
+#include "HalNative.h"
+
+// Linux counterpart of main.cpp: the firmware globals (motors, limit pins,
+// LSM303 receiver, calibration, position store, rotctl) and the same
+// setup/loop order, without Wi-Fi, the web server or the stepper task.
+// Host tests drive it with nativeRunFor(); hal::sim holds the world.
+
+inline constexpr uint16_t NATIVE_LSM_PORT = 4210;
+inline constexpr uint16_t NATIVE_ROTCTL_PORT = 4533;
+
+extern Stepper* azMotor;
+extern Stepper* elMotor1;
+extern Stepper* elMotor2;
+
+// Set ROTATOR_NATIVE_ECHO=1 to see the console output of a test run
+void nativeSetup(bool startRotctl = true);
+void nativeLoop();                 // one loop() pass plus the stepper task's snapshot
+void nativeRunFor(uint32_t ms);    // 1 ms of simulated time per loop() pass
@@ -11,8 +11,26 @@
 #include "Homing.h"
 #include <ArduinoOTA.h>
 #include "LSM303Receiver.h"
+#include "SensorRecorder.h"
+#include "FlightRecorder.h"
+#include "TrackingMetrics.h"
 #include "Calibration.h"
+#include "PositionStore.h"
+#include "WallClock.h"
+#include "Trajectory.h"
+#include "ScanPattern.h"
+#include "JobScheduler.h"
+#include "NvsWriter.h"
+#include "Scheduler.h"
+#include "TelemetrySnapshot.h"
+#include "Latency.h"
+#include "AllocTracker.h"
+#if FIRMWARE_BENCH
+#include "Bench.h"
+#include "JsonWriter.h"
+#endif
 #include <ElegantOTA.h>
+#include "esp_system.h"
 
 // --- Hardware and Firmware Info for ElegantOTA ---
 const char* HARDWARE_ID = "ESP32 Rotator";
@@ -62,6 +80,11 @@ LSM303Receiver lsmReceiver(4210);  // 4210 = UDP port
 
 Calibration calib(&lsmReceiver);
 
+PositionStore positionStore(&lsmReceiver);
+
+// === Boot timing ===
+bool warmStarted = false;
+unsigned long operationalMs = 0;  // millis() when position became trustworthy, 0 = not yet
 
 
 // === FastAccelStepper Setup ===
@@ -76,8 +99,17 @@ TaskHandle_t StepperTask;
 // === Stepper Core Task ===
 void stepperTaskCode(void *pvParameters) {
   esp_task_wdt_add(NULL);
+  uint32_t lastPublishMs = 0;
   for (;;) {
     esp_task_wdt_reset();
+    // Position/sensor snapshot for web, WebSocket and rotctl readers
+    if (millis() - lastPublishMs >= SNAPSHOT_PUBLISH_MS) {
+      lastPublishMs = millis();
+      publishTelemetrySnapshot();
+    }
+    flightRecorder.update();   // samples at its own rate
+    trackingMetrics.update();
+    scanRunner.update();       // dwell timing wants the 1 ms tick
     vTaskDelay(pdMS_TO_TICKS(1)); // just yield a little time
   }
 }
@@ -86,6 +118,7 @@ void stepperTaskCode(void *pvParameters) {
 void setup() {
     Serial.begin(115200);
     delay(100);
+    webLogger.begin();  // Serial echo of web log entries runs in its own task
 
     // ----------------------
     // Limit Switch Pins
@@ -105,10 +138,12 @@ void setup() {
     Serial.println();
     Serial.print("Wi-Fi connected, IP = ");
     Serial.println(WiFi.localIP());
+    wallClock.begin();   // SNTP syncs in the background
 
     // ----------------------
     // Start LSM303Receiver
     // ----------------------
+    lsmReceiver.setRecorder(&sensorRecorder);
     lsmReceiver.begin();
 
     // ----------------------
@@ -124,22 +159,22 @@ void setup() {
     azMotor = engine.stepperConnectToPin(AZ_STEP_PIN);
     if (azMotor) {
         azMotor->setDirectionPin(AZ_DIR_PIN);
-        azMotor->setSpeedInHz(800);
-        azMotor->setAcceleration(1000);
+        azMotor->setSpeedInHz(MOTOR_SPEED_HZ);
+        azMotor->setAcceleration(MOTOR_ACCELERATION);
     }
 
     elMotor1 = engine.stepperConnectToPin(EL1_STEP_PIN);
     if (elMotor1) {
         elMotor1->setDirectionPin(EL1_DIR_PIN);
-        elMotor1->setSpeedInHz(800);
-        elMotor1->setAcceleration(1000);
+        elMotor1->setSpeedInHz(MOTOR_SPEED_HZ);
+        elMotor1->setAcceleration(MOTOR_ACCELERATION);
     }
 
     elMotor2 = engine.stepperConnectToPin(EL2_STEP_PIN);
     if (elMotor2) {
         elMotor2->setDirectionPin(EL2_DIR_PIN);
-        elMotor2->setSpeedInHz(800);
-        elMotor2->setAcceleration(1000);
+        elMotor2->setSpeedInHz(MOTOR_SPEED_HZ);
+        elMotor2->setAcceleration(MOTOR_ACCELERATION);
     }
 
     // ----------------------
@@ -148,59 +183,88 @@ void setup() {
     xTaskCreatePinnedToCore(stepperTaskCode, "StepperTask", 10000, NULL, 1, &StepperTask, 0);
 
     // ----------------------
-    // Home rotator
+    // Home rotator (skipped if the flash checkpoint matches the sensor)
     // ----------------------
-    homeAzimuth();
-   // homeElevation();
+    beginHoming();
+    positionStore.begin();
+    trajectory.begin();
+    jobScheduler.begin();
+    nvsWriter.begin();     // queue and trajectory writes stay off loop()
+    warmStarted = positionStore.tryWarmStart();
+    if (!warmStarted) {
+        homeAll();
+    }
 
     // ----------------------
     // Start rotctl server
     // ----------------------
     startRotctlServer();
 
+#if FIRMWARE_BENCH
+    // Hot-path microbenchmarks (Bench.h); scripts/bench_compare.py reads this line
+    runBenchSuite();
+    Serial.print("BENCH ");
+    {
+        JsonWriter json([](void*, const char* data, size_t len) { Serial.write((const uint8_t*)data, len); }, nullptr);
+        writeBenchJSON(json);
+    }
+    Serial.println();
+#endif
+
+    // Heap use from here on is counted per subsystem (AllocTracker.h)
+    allocTracker.arm();
     Serial.println("Setup complete.");
 }
 
 void loop() {
+    LATENCY_SCOPE("loop");
+    ALLOC_SCOPE(ALLOC_LOOP);
+    uint32_t loopStartUs = micros();
+
     // ----------------------
-    // Web UI
+    // Web UI (log event stream)
     // ----------------------
-   // handleWebServer();
+    handleWebServer();
     // ----------------------
     // Homing updates
     // ----------------------
     updateHoming();
 
     // ----------------------
-    // Update stepper positions to rotctl
+    // Time-to-operational report (once per boot)
     // ----------------------
-   // --- Report current rotator position ---
-    float azPos = stepsToAz(azMotor->getCurrentPosition());  // always from stepper
-
-    float elPos;
-    if (useLSMforEl) {
-        // Use LSM-corrected elevation
-        elPos = lsmReceiver.getElCorrected();
-    } else {
-        // Use stepper position
-        elPos = stepsToEl(elMotor1->getCurrentPosition());
+    if (operationalMs == 0 && homingStage == HOMING_COMPLETE) {
+        operationalMs = millis();
+        WEB_LOG_INFOF("[BOOT]", "Operational after %lu ms (%s, reset reason %d)",
+                      operationalMs, warmStarted ? "warm start" : "homed", (int)esp_reset_reason());
     }
 
-    // Update rotctl position
-    setRotatorPosition(azPos, elPos);
-
-
     // ----------------------
     // Update LSM303Receiver
     // ----------------------
     lsmReceiver.update();
     
     // ----------------------
-    // Update LSM303Receiver
+    // Resumable tasks (homing axes, calibration)
     // ----------------------
-     if (calib.isRunning()) {
-        calib.update();
-    }
+    scheduler.tick();
+
+    // ----------------------
+    // Position checkpoint (writes only after motion has been idle)
+    // ----------------------
+    positionStore.update();
+
+    // ----------------------
+    // Timed jobs (one compare per pass between wheel ticks)
+    // ----------------------
+    jobScheduler.update();
+
+    // ----------------------
+    // Loop-time budget check
+    // ----------------------
+    uint32_t loopUs = micros() - loopStartUs;
+    scheduler.noteLoopTime(loopUs);
+    flightRecorder.noteLoopTime(loopUs);
    
 
 }
@@ -1,12 +1,11 @@
 #pragma once
-#include <WiFi.h>
-#include <AsyncTCP.h>
-#include <FastAccelStepper.h>
+#include "hal/Hal.h"
+#include "RotctlProtocol.h"
 
 // Make your motors available
-extern FastAccelStepper *azMotor;
-extern FastAccelStepper *elMotor1;
-extern FastAccelStepper *elMotor2;
+extern Stepper *azMotor;
+extern Stepper *elMotor1;
+extern Stepper *elMotor2;
 extern bool elGangedDrive;
 
 // Limits
@@ -19,8 +18,19 @@ extern const int MAX_EL;
 extern long azToSteps(float az);
 extern long elToSteps(float el);
 
-// Rotator position
-void setRotatorPosition(float az, float el);
+// Rotator position is read from the telemetry snapshot (TelemetrySnapshot.h)
 void startRotctlServer(uint16_t port = 4533);
 
 extern bool rotctlConnected;  // updated in rotctl_server.cpp
+
+// Per-command counters and handler latency, exported on /metrics.
+// Written and read on the AsyncTCP task only.
+struct RotctlCommandStats {
+    uint32_t count = 0;
+    uint32_t errors = 0;        // replied RPRT -1
+    uint64_t latencyUsSum = 0;
+    uint32_t latencyUsMax = 0;
+};
+
+extern RotctlCommandStats rotctlStats[ROTCTL_COMMAND_KINDS];
+extern const char* const ROTCTL_COMMAND_NAMES[ROTCTL_COMMAND_KINDS];
@@ -1,90 +1,102 @@
 #include "rotctl_server.h"
 #include "MotorControl.h"
 #include "Config.h"
-#include "WebInterface.h"
+#include "TelemetrySnapshot.h"
+#include "Latency.h"
+#include "AllocTracker.h"
+#include "RotctlRecorder.h"
+#include "TrackingMetrics.h"
+#include "SlewTime.h"
 
 
-// AsyncTCP server
-AsyncServer* rotctlServer = nullptr;
+extern bool useLSMforEl;
 
-// Current position reported to clients
-float currentAz = 0.0;
-float currentEl = 0.0;
+// Rotctl listener (AsyncTCP on the ESP32, loopback socket on Linux)
+hal::TcpServer* rotctlServer = nullptr;
 
-void setRotatorPosition(float az, float el) {
-    currentAz = az;
-    currentEl = el;
-}
-
-void startRotctlServer(uint16_t port) {
-    rotctlServer = new AsyncServer(port);
-
-    rotctlServer->onClient([](void *s, AsyncClient* c){
-        Serial.println("Rotctl client connected");
-        rotctlConnected = true;  // on client connect
-        c->onData([c](void *s, AsyncClient* c2, void *data, size_t len){
-            String cmd = "";
-            for(size_t i = 0; i < len; i++) cmd += ((char*)data)[i];
-            cmd.trim();
+RotctlCommandStats rotctlStats[ROTCTL_COMMAND_KINDS];
+const char* const ROTCTL_COMMAND_NAMES[ROTCTL_COMMAND_KINDS] = {"p", "P", "slew_time", "unknown"};
 
-        if (cmd.equalsIgnoreCase("p")) {
-            float azOut = currentAz;
-            float elOut;
+static void noteRotctlCommand(RotctlCommand kind, bool ok, uint32_t elapsedUs) {
+    RotctlCommandStats& st = rotctlStats[kind];
+    st.count++;
+    if (!ok) st.errors++;
+    st.latencyUsSum += elapsedUs;
+    if (elapsedUs > st.latencyUsMax) st.latencyUsMax = elapsedUs;
+}
 
-            if (useLSMforEl) {
-                // Report corrected LSM elevation
-                elOut = lsmReceiver.getElCorrected();
-                Serial.printf("[rotctl] Reporting LSM elevation: %.2f°\n", elOut);
-            } else {
-                // Report stepper elevation
-                elOut = currentEl;
-                Serial.printf("[rotctl] Reporting stepper elevation: %.2f°\n", elOut);
-            }
+static void onRotctlConnect(hal::TcpClient* client, void*) {
+    rotctlRecorder.connected(client, micros());
+    Serial.println("Rotctl client connected");
+    rotctlConnected = true;  // on client connect
+}
 
-            String msg = String(azOut, 2) + "\n" + String(elOut, 2) + "\n";
-            c2->write(msg.c_str(), msg.length());
+static void onRotctlData(hal::TcpClient* client, const char* data, size_t len, void*) {
+    LATENCY_SCOPE("rotctl.onData");
+    ALLOC_SCOPE(ALLOC_ROTCTL);
+    uint32_t startUs = micros();
+    rotctlRecorder.received(client, data, len, startUs);
+    RotctlRequest req;
+    float elOut = 0.0f;
+    char reply[ROTCTL_REPLY_LEN];
+    size_t replyLen = 0;
+    {
+        ALLOC_FORBID();
+        req = parseRotctlCommand(data, len);
+
+        if (req.kind == ROTCTL_GET_POS) {
+            // Latest published snapshot: AZ from steps, EL from the selected source
+            TelemetrySnapshot snap = readTelemetrySnapshot();
+            elOut = snap.elReported;
+            replyLen = formatRotctlPosition(reply, sizeof(reply), snap.azDeg, elOut);
+        } else if (req.kind == ROTCTL_SLEW_TIME && req.valid) {
+            SlewPrediction slew = predictSlew(readTelemetrySnapshot(), req.az, req.el);
+            replyLen = formatRotctlSeconds(reply, sizeof(reply), slew.seconds);
         }
-            else if (cmd.startsWith("P ")) {
-                float az, el;
-                if (sscanf(cmd.c_str(), "P %f %f", &az, &el) == 2) {
-                    // Constrain to min/max limits
-                    az = constrain(az, MIN_AZ, MAX_AZ);
-                    el = constrain(el, MIN_EL, MAX_EL);
-
-                    // Move motors
-                    moveAzimuthToPosition(az);
-                    moveElevationToPosition(el);
-
+    }
 
-                    // Respond success
-                    const char* ok = "RPRT 0\n";
-                    c2->write(ok, strlen(ok));
-                } else {
-                    const char* err = "RPRT -1\n";
-                    c2->write(err, strlen(err));
-                }
-            }
-            else {
-                const char* err = "RPRT -1\n";
-                c2->write(err, strlen(err));
-            }
-        }, nullptr);
-
-        c->onDisconnect([](void *s, AsyncClient* c2){
-            Serial.println("Rotctl client disconnected");
-            rotctlConnected = false; // on disconnect
-        }, nullptr);
-
-        c->onError([](void *s, AsyncClient* c2, int8_t error){
-            Serial.printf("Rotctl client error %d\n", error);
-        }, nullptr);
-
-        c->onTimeout([](void *s, AsyncClient* c2, uint32_t time){
-            Serial.println("Rotctl client timeout");
-        }, nullptr);
+    if (req.kind == ROTCTL_GET_POS) {
+        if (useLSMforEl) {
+            Serial.printf("[rotctl] Reporting LSM elevation: %.2f°\n", elOut);
+        } else {
+            Serial.printf("[rotctl] Reporting stepper elevation: %.2f°\n", elOut);
+        }
+        hal::TcpServer::write(client, reply, replyLen);
+    }
+    else if (req.kind == ROTCTL_SLEW_TIME && req.valid) {
+        hal::TcpServer::write(client, reply, replyLen);
+    }
+    else if (req.kind == ROTCTL_SET_POS && req.valid) {
+        // Constrain to min/max limits
+        float az = constrain(req.az, MIN_AZ, MAX_AZ);
+        float el = constrain(req.el, MIN_EL, MAX_EL);
+
+        // Move motors
+        moveAzimuthToPosition(az);
+        moveElevationToPosition(el);
+        trackingMetrics.commanded(az, el);
+
+        // Respond success
+        hal::TcpServer::write(client, ROTCTL_REPLY_OK, strlen(ROTCTL_REPLY_OK));
+    }
+    else {
+        hal::TcpServer::write(client, ROTCTL_REPLY_ERROR, strlen(ROTCTL_REPLY_ERROR));
+    }
+    noteRotctlCommand(req.kind, req.valid, micros() - startUs);
+}
 
-    }, nullptr);
+static void onRotctlDisconnect(hal::TcpClient* client, void*) {
+    rotctlRecorder.disconnected(client, micros());
+    trackingMetrics.endPass();
+    Serial.println("Rotctl client disconnected");
+    rotctlConnected = false; // on disconnect
+}
 
+void startRotctlServer(uint16_t port) {
+    rotctlServer = new hal::TcpServer(port);
+    rotctlServer->onConnect(onRotctlConnect, nullptr);
+    rotctlServer->onData(onRotctlData);
+    rotctlServer->onDisconnect(onRotctlDisconnect);
     rotctlServer->begin();
     Serial.printf("Rotctl server started on port %d\n", port);
 }
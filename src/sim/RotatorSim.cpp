@@ -0,0 +1,171 @@
+// RotatorSim.cpp - axis mechanics, limit switches and LSM303 packets
+#include "RotatorSim.h"
+#include <math.h>
+#include <stdio.h>
+#include "hal/native/NativeBoard.h"
+
+extern float stepsPerDegree;
+extern const int AZ_LIMIT_PIN;
+extern const int EL_LIMIT_PIN;
+
+int formatLsm303Packet(char* out, size_t len, float headingDeg, float elevationDeg) {
+    float h = headingDeg * PI / 180.0f;
+    float e = elevationDeg * PI / 180.0f;
+    // Gravity in the pitch plane; the receiver's tilt compensation then
+    // recovers a horizontal field pointing at the heading
+    float ax = cosf(e), ay = 0.0f, az = sinf(e);
+    float pitch = asinf(-ax);
+    float roll = atan2f(ay, az);
+    float mx = cosf(h) * cosf(pitch);
+    float my = sinf(h) / cosf(roll);
+    float mz = cosf(h) * sinf(pitch);
+    return snprintf(out, len, "MAG:%.5f,%.5f,%.5f;ACC:%.5f,%.5f,%.5f", mx, my, mz, ax, ay, az);
+}
+
+RotatorSim::RotatorSim(const SimAxisConfig& az, const SimAxisConfig& el, const SimSensorConfig& sensor)
+    : _sensor(sensor), _rng(sensor.seed) {
+    _axes[SIM_AZ].config = az;
+    _axes[SIM_EL].config = el;
+}
+
+void RotatorSim::attach() {
+    _axes[SIM_AZ].motors[0] = azMotor;
+    _axes[SIM_EL].motors[0] = elMotor1;
+    _axes[SIM_EL].motors[1] = elMotor2;   // ganged drive, follows motor 0
+
+    hal::sim::setPinSource(AZ_LIMIT_PIN, [this] { return _axes[SIM_AZ].switchClosed ? LOW : HIGH; });
+    hal::sim::setPinSource(EL_LIMIT_PIN, [this] { return _axes[SIM_EL].switchClosed ? LOW : HIGH; });
+    hal::sim::onAdvance([this](uint64_t nowUs) { step(nowUs); });
+    powerOn();
+}
+
+void RotatorSim::powerOn() {
+    for (Axis& ax : _axes) {
+        double start = ax.config.startDeg * stepsPerDegree;
+        for (Stepper* m : ax.motors) {
+            if (!m) continue;
+            m->forceStopAndNewPosition(0);
+            m->setShaftPosition(start);
+        }
+        ax.lastMotor = start;
+        ax.drive = start;
+        ax.output = start;
+        ax.outputVel = 0.0;
+        ax.jammed = false;
+        ax.lostSteps = 0.0;
+        ax.switchClosed = ax.config.switchFitted && start <= ax.config.switchDeg * stepsPerDegree;
+    }
+    _lastUs = hal::sim::nowUs();
+    _nextPacketUs = _lastUs;
+    _events.clear();
+}
+
+float RotatorSim::outputDeg(SimAxis a) const { return _axes[a].output / stepsPerDegree; }
+float RotatorSim::motorDeg(SimAxis a) const { return _axes[a].lastMotor / stepsPerDegree; }
+
+void RotatorSim::slip(SimAxis a, float deg) {
+    Axis& ax = _axes[a];
+    double steps = deg * stepsPerDegree;
+    for (Stepper* m : ax.motors) if (m) m->setShaftPosition(m->shaftPosition() + steps);
+    ax.lastMotor += steps;
+    ax.drive += steps;
+    ax.output += steps;
+}
+
+void RotatorSim::at(uint32_t atMs, std::function<void()> fn) {
+    _events.push_back({atMs, std::move(fn)});
+}
+
+void RotatorSim::run(uint32_t ms) {
+    runUntil([] { return false; }, ms);
+}
+
+bool RotatorSim::runUntil(const std::function<bool()>& done, uint32_t timeoutMs) {
+    for (uint32_t t = 0; t < timeoutMs; t++) {
+        for (size_t i = 0; i < _events.size();) {
+            if (millis() >= _events[i].atMs) {
+                std::function<void()> fn = std::move(_events[i].fn);
+                _events.erase(_events.begin() + i);
+                fn();
+            } else {
+                i++;
+            }
+        }
+        nativeRunFor(1);
+        if (done()) return true;
+    }
+    return false;
+}
+
+// Called after the steppers moved in every hal::sim slice
+void RotatorSim::step(uint64_t nowUs) {
+    double dt = (nowUs - _lastUs) * 1e-6;
+    _lastUs = nowUs;
+    if (dt <= 0.0) return;
+    for (Axis& ax : _axes) stepAxis(ax, dt);
+
+    if (_sensor.rateHz > 0.0f && nowUs >= _nextPacketUs) {
+        _nextPacketUs = nowUs + (uint64_t)(1e6f / _sensor.rateHz);
+        sendPacket();
+    }
+}
+
+void RotatorSim::stepAxis(Axis& ax, double dt) {
+    Stepper* motor = ax.motors[0];
+    if (!motor) return;
+    const SimAxisConfig& cfg = ax.config;
+
+    // Stall: the stepper counted the steps but the rotor did not follow
+    double moved = motor->shaftPosition() - ax.lastMotor;
+    double rateHz = fabs(motor->getCurrentSpeedInMilliHz()) / 1000.0;
+    bool stalled = ax.jammed || (cfg.pullOutHz > 0.0f && rateHz > cfg.pullOutHz);
+    if (stalled && moved != 0.0) {
+        for (Stepper* m : ax.motors) if (m) m->setShaftPosition(m->shaftPosition() - moved);
+        ax.lostSteps += fabs(moved);
+    }
+    ax.lastMotor = motor->shaftPosition();
+
+    // Backlash: the drive only follows once the motor has taken up the slack
+    double half = cfg.backlashDeg * stepsPerDegree / 2.0;
+    if (ax.lastMotor - ax.drive > half) ax.drive = ax.lastMotor - half;
+    else if (ax.drive - ax.lastMotor > half) ax.drive = ax.lastMotor + half;
+
+    // Inertia: second-order response of the output to the drive
+    if (cfg.naturalHz > 0.0f && !ax.jammed) {
+        double w = 2.0 * PI * cfg.naturalHz;
+        double acc = w * w * (ax.drive - ax.output) - 2.0 * cfg.damping * w * ax.outputVel;
+        ax.outputVel += acc * dt;
+        ax.output += ax.outputVel * dt;
+    } else if (!ax.jammed) {
+        ax.output = ax.drive;
+        ax.outputVel = 0.0;
+    }
+
+    // Limit switch with hysteresis
+    double closeAt = cfg.switchDeg * stepsPerDegree;
+    double openAt = (cfg.switchDeg + cfg.switchHysteresisDeg) * stepsPerDegree;
+    if (!cfg.switchFitted) ax.switchClosed = false;
+    else if (ax.output <= closeAt) ax.switchClosed = true;
+    else if (ax.output > openAt) ax.switchClosed = false;
+}
+
+void RotatorSim::sendPacket() {
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    if (_sensor.dropRate > 0.0f && uniform(_rng) < _sensor.dropRate) return;
+
+    float heading = outputDeg(SIM_AZ) + _sensor.headingAtAzZeroDeg;
+    float elevation = outputDeg(SIM_EL) + _sensor.elAtElZeroDeg;
+    if (_sensor.headingNoiseDeg > 0.0f) heading += std::normal_distribution<float>(0.0f, _sensor.headingNoiseDeg)(_rng);
+    if (_sensor.elNoiseDeg > 0.0f) elevation += std::normal_distribution<float>(0.0f, _sensor.elNoiseDeg)(_rng);
+
+    // Hard/soft iron distortion of the horizontal field
+    float h = heading * PI / 180.0f;
+    float fx = _sensor.softIronX * cosf(h) + _sensor.hardIronX;
+    float fy = _sensor.softIronY * sinf(h) + _sensor.hardIronY;
+    heading = atan2f(fy, fx) * 180.0f / PI;
+
+    char packet[128];
+    int n = formatLsm303Packet(packet, sizeof(packet), heading, elevation);
+    hal::sim::injectUdp(NATIVE_LSM_PORT, packet, n);
+    _packetsSent++;
+}
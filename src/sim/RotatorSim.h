@@ -0,0 +1,117 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <functional>
+#include <random>
+#include <vector>
+#include "hal/Hal.h"
+
+// --- Rotator physics and hardware simulator (env:native only) ---
+// Models the mechanics behind the native HAL's steppers. Each axis has
+// three positions:
+//   motor  - the stepper shaft; it loses steps while stalled or jammed
+//   drive  - the gear output after backlash (lost motion on reversal)
+//   output - the dish, following the drive through a spring/damper when
+//            naturalHz > 0 (inertia), rigidly otherwise
+// The limit switch closes when the output is at or below switchDeg and
+// opens again above switchDeg + hysteresis. A simulated LSM303 sends
+// packets for the output attitude, with noise and magnetic distortion, to
+// the receiver's UDP port.
+//
+// Everything runs in simulated time (hal::sim), typically 100x or more
+// faster than real time. Use one RotatorSim per test program, attached
+// once after nativeSetup().
+
+enum SimAxis : uint8_t { SIM_AZ, SIM_EL, SIM_AXES };
+
+struct SimAxisConfig {
+    float startDeg = 20.0f;             // output angle at power on
+    float switchDeg = 0.0f;
+    float switchHysteresisDeg = 0.3f;
+    bool switchFitted = true;
+    float backlashDeg = 0.0f;           // total lost motion
+    float naturalHz = 0.0f;             // output resonance, 0 = rigid
+    float damping = 0.7f;               // damping ratio
+    float pullOutHz = 0.0f;             // motor stalls above this step rate, 0 = never
+};
+
+struct SimSensorConfig {
+    float rateHz = 50.0f;               // the Nano sends at 50 Hz
+    float headingAtAzZeroDeg = 0.0f;    // magnetic heading with AZ output at 0
+    float elAtElZeroDeg = -90.0f;       // sensor elevation with EL output at 0
+    float headingNoiseDeg = 0.0f;       // 1 sigma
+    float elNoiseDeg = 0.0f;
+    float hardIronX = 0.0f;             // in units of the horizontal field
+    float hardIronY = 0.0f;
+    float softIronX = 1.0f;
+    float softIronY = 1.0f;
+    float dropRate = 0.0f;              // fraction of packets lost
+    uint32_t seed = 1;
+};
+
+// Raw LSM303 packet that LSM303Receiver decodes to the given heading and
+// elevation (level roll, pitch from the elevation)
+int formatLsm303Packet(char* out, size_t len, float headingDeg, float elevationDeg);
+
+class RotatorSim {
+public:
+    RotatorSim(const SimAxisConfig& az, const SimAxisConfig& el, const SimSensorConfig& sensor);
+
+    // Installs the limit-switch pin models and the physics/sensor hook
+    void attach();
+
+    // Power cycle: motors stop, the firmware step counters read 0 and the
+    // outputs sit at the configured startDeg
+    void powerOn();
+
+    SimAxisConfig& axis(SimAxis a) { return _axes[a].config; }
+    SimSensorConfig& sensor() { return _sensor; }
+
+    float outputDeg(SimAxis a) const;
+    float motorDeg(SimAxis a) const;
+    bool limitClosed(SimAxis a) const { return _axes[a].switchClosed; }
+    uint32_t lostSteps(SimAxis a) const { return (uint32_t)lround(_axes[a].lostSteps); }
+    uint32_t packetsSent() const { return _packetsSent; }
+
+    // Scripted faults
+    void jam(SimAxis a, bool jammed) { _axes[a].jammed = jammed; }
+    void slip(SimAxis a, float deg);    // output and motor move without steps
+
+    // Calls fn once simulated time reaches atMs (millis())
+    void at(uint32_t atMs, std::function<void()> fn);
+
+    // Firmware loop passes of 1 ms until done() or the timeout
+    void run(uint32_t ms);
+    bool runUntil(const std::function<bool()>& done, uint32_t timeoutMs);
+
+private:
+    struct Axis {
+        SimAxisConfig config;
+        Stepper* motors[2] = {};
+        double lastMotor = 0.0;         // steps
+        double drive = 0.0;
+        double output = 0.0;
+        double outputVel = 0.0;         // steps/s
+        bool switchClosed = false;
+        bool jammed = false;
+        double lostSteps = 0.0;
+    };
+
+    struct Event {
+        uint32_t atMs;
+        std::function<void()> fn;
+    };
+
+    void step(uint64_t nowUs);
+    void stepAxis(Axis& ax, double dt);
+    void sendPacket();
+
+    Axis _axes[SIM_AXES];
+    SimSensorConfig _sensor;
+    std::mt19937 _rng;
+    uint64_t _lastUs = 0;
+    uint64_t _nextPacketUs = 0;
+    uint32_t _packetsSent = 0;
+    std::vector<Event> _events;
+};
@@ -0,0 +1,196 @@
+// RotctlReplay.cpp - rotctl captures against the simulated rotator
+#include "RotctlReplay.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <math.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include "hal/native/NativeBoard.h"
+#include "sim/RotatorSim.h"
+#include "RotctlProtocol.h"
+#include "rotctl_server.h"
+
+typedef std::chrono::steady_clock Clock;
+
+bool parseRotctlSession(const char* text, RotctlSession& out) {
+    out.events.clear();
+    char line[ROTCTL_REC_LINE_LEN + 2];
+    while (*text) {
+        const char* end = strchr(text, '\n');
+        size_t n = end ? (size_t)(end - text) : strlen(text);
+        if (n >= sizeof(line)) return false;
+        memcpy(line, text, n);
+        line[n] = '\0';
+        if (n && line[n - 1] == '\r') line[n - 1] = '\0';
+        text += end ? n + 1 : n;
+
+        if (line[0] == '\0' || line[0] == '#') continue;
+        RotctlEvent e;
+        if (!parseRotctlEvent(line, e)) return false;
+        out.events.push_back(e);
+    }
+    return true;
+}
+
+bool loadRotctlSession(const char* path, RotctlSession& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    std::string text;
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) text.append(chunk, n);
+    fclose(f);
+    return parseRotctlSession(text.c_str(), out);
+}
+
+static int connectClient() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(NATIVE_ROTCTL_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Polls the firmware without moving simulated time until `lines` reply
+// lines arrived; wall-clock latency in us, or -1 on timeout
+static long awaitReply(int fd, int lines, uint32_t timeoutMs, bool& error) {
+    auto start = Clock::now();
+    char buf[128];
+    std::string reply;
+    while (true) {
+        nativeLoop();
+        ssize_t n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n > 0) {
+            reply.append(buf, n);
+            if (std::count(reply.begin(), reply.end(), '\n') >= lines) break;
+        }
+        auto elapsed = Clock::now() - start;
+        if (elapsed > std::chrono::milliseconds(timeoutMs)) return -1;
+        if (n <= 0) std::this_thread::yield();
+    }
+    error = reply.find(ROTCTL_REPLY_ERROR) != std::string::npos;
+    return (long)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+}
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, float p) {
+    if (sorted.empty()) return 0;
+    size_t i = (size_t)ceilf(p * sorted.size());
+    return sorted[i ? i - 1 : 0];
+}
+
+RotctlReplayReport replayRotctlSession(const RotctlSession& session, RotatorSim& sim,
+                                       const RotctlReplayOptions& options) {
+    RotctlReplayReport report;
+    if (session.events.empty()) return report;
+
+    auto wallStart = Clock::now();
+    uint32_t firstUs = session.events.front().tUs;
+    unsigned long simStartMs = millis();
+    std::map<uint8_t, int> clients;
+    std::vector<uint32_t> latencies;
+    bool haveTarget = false;
+    float targetAz = 0.0f, targetEl = 0.0f;
+    double sumSq = 0.0;
+
+    // Runs simulated time up to `ms` after the start, sampling the error
+    auto runTo = [&](unsigned long ms) {
+        while (millis() - simStartMs < ms) {
+            unsigned long now = millis() - simStartMs;
+            unsigned long step = options.sampleMs - now % options.sampleMs;
+            if (now + step > ms) step = ms - now;
+            sim.run(step);
+            if ((millis() - simStartMs) % options.sampleMs == 0 && haveTarget) {
+                float eAz = sim.outputDeg(SIM_AZ) - targetAz;
+                float eEl = sim.outputDeg(SIM_EL) - targetEl;
+                float err = sqrtf(eAz * eAz + eEl * eEl);
+                sumSq += err * err;
+                if (err > report.trackMaxDeg) report.trackMaxDeg = err;
+                report.trackSamples++;
+            }
+            if (options.speed > 0.0f) {
+                auto due = wallStart + std::chrono::microseconds((long long)((millis() - simStartMs) * 1000.0 / options.speed));
+                std::this_thread::sleep_until(due);
+            }
+        }
+    };
+
+    for (const RotctlEvent& e : session.events) {
+        runTo((uint32_t)(e.tUs - firstUs) / 1000);
+
+        if (e.kind == ROTCTL_EVENT_CONNECT) {
+            int fd = connectClient();
+            if (fd < 0) continue;
+            clients[e.client] = fd;
+            report.connects++;
+            for (int i = 0; i < 3; i++) nativeLoop();   // accept
+        } else if (e.kind == ROTCTL_EVENT_DISCONNECT) {
+            auto it = clients.find(e.client);
+            if (it == clients.end()) continue;
+            close(it->second);
+            clients.erase(it);
+            nativeLoop();
+        } else {
+            auto it = clients.find(e.client);
+            if (it == clients.end()) {
+                // Recording started mid-session: open the connection now
+                int fd = connectClient();
+                if (fd < 0) continue;
+                it = clients.emplace(e.client, fd).first;
+                report.connects++;
+                for (int i = 0; i < 3; i++) nativeLoop();
+            }
+            RotctlRequest req = parseRotctlCommand(e.data, e.len);
+            send(it->second, e.data, e.len, 0);
+            report.packets++;
+
+            bool error = false;
+            long us = awaitReply(it->second, req.kind == ROTCTL_GET_POS ? 2 : 1, options.replyTimeoutMs, error);
+            if (us < 0) {
+                report.missing++;
+                continue;
+            }
+            report.replies++;
+            if (error) report.errors++;
+            latencies.push_back((uint32_t)us);
+            if (req.kind == ROTCTL_SET_POS && req.valid) {
+                targetAz = constrain(req.az, MIN_AZ, MAX_AZ);
+                targetEl = constrain(req.el, MIN_EL, MAX_EL);
+                haveTarget = true;
+            }
+        }
+    }
+    for (auto& c : clients) close(c.second);
+    nativeLoop();
+
+    std::sort(latencies.begin(), latencies.end());
+    report.latencyP50Us = percentile(latencies, 0.50f);
+    report.latencyP95Us = percentile(latencies, 0.95f);
+    report.latencyP99Us = percentile(latencies, 0.99f);
+    report.latencyMaxUs = latencies.empty() ? 0 : latencies.back();
+    report.trackRmsDeg = report.trackSamples ? sqrtf(sumSq / report.trackSamples) : 0.0f;
+    report.simSeconds = (millis() - simStartMs) / 1000.0;
+    report.wallMs = std::chrono::duration<double, std::milli>(Clock::now() - wallStart).count();
+    return report;
+}
+
+int formatRotctlReport(char* out, size_t len, const RotctlReplayReport& r) {
+    return snprintf(out, len,
+                    "%u packets on %u connections: %u replies, %u missing, %u errors; "
+                    "latency p50 %u p95 %u p99 %u max %u us; "
+                    "tracking error rms %.2f max %.2f deg; %.0f s simulated in %.0f ms",
+                    r.packets, r.connects, r.replies, r.missing, r.errors,
+                    r.latencyP50Us, r.latencyP95Us, r.latencyP99Us, r.latencyMaxUs,
+                    r.trackRmsDeg, r.trackMaxDeg, r.simSeconds, r.wallMs);
+}
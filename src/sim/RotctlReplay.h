@@ -0,0 +1,56 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "RotctlRecorder.h"
+
+class RotatorSim;
+
+// --- rotctl session replay (env:native only) ---
+// Plays a RotctlRecorder capture against the firmware's rotctl server over
+// loopback TCP while RotatorSim moves the axes. Events keep their recorded
+// spacing in simulated time; `speed` only sets how fast that runs against
+// the wall clock (0 = as fast as possible, 1 = real time).
+//
+// Latency is wall-clock time from send() to the complete reply, with the
+// firmware loop polled but simulated time held, so it measures the server
+// code rather than the loop period. Tracking error is the distance of the
+// simulated output from the last position commanded with "P", sampled
+// every sampleMs of simulated time; it includes slews after large steps.
+
+struct RotctlSession {
+    std::vector<RotctlEvent> events;
+};
+
+// Blank lines and lines starting with # are skipped
+bool parseRotctlSession(const char* text, RotctlSession& out);
+bool loadRotctlSession(const char* path, RotctlSession& out);
+
+struct RotctlReplayOptions {
+    float speed = 0.0f;
+    uint32_t sampleMs = 100;
+    uint32_t replyTimeoutMs = 500;   // wall clock
+};
+
+struct RotctlReplayReport {
+    uint32_t connects = 0;
+    uint32_t packets = 0;
+    uint32_t replies = 0;
+    uint32_t missing = 0;           // no complete reply within the timeout
+    uint32_t errors = 0;            // RPRT -1
+    uint32_t latencyP50Us = 0;
+    uint32_t latencyP95Us = 0;
+    uint32_t latencyP99Us = 0;
+    uint32_t latencyMaxUs = 0;
+    float trackRmsDeg = 0.0f;
+    float trackMaxDeg = 0.0f;
+    uint32_t trackSamples = 0;
+    double simSeconds = 0.0;
+    double wallMs = 0.0;
+};
+
+RotctlReplayReport replayRotctlSession(const RotctlSession& session, RotatorSim& sim,
+                                       const RotctlReplayOptions& options = RotctlReplayOptions());
+
+// One-line summary for test output
+int formatRotctlReport(char* out, size_t len, const RotctlReplayReport& r);
@@ -0,0 +1,65 @@
+// SensorReplay.cpp - capture files into a receiver
+#include "SensorReplay.h"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "LSM303Receiver.h"
+
+bool parseSensorCapture(const uint8_t* data, size_t len, SensorCapture& out) {
+    SensorCaptureHeader header;
+    if (len < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != SENSOR_CAPTURE_MAGIC || header.version != SENSOR_CAPTURE_VERSION ||
+        header.sampleSize != sizeof(SensorSample) ||
+        len < sizeof(header) + (size_t)header.count * sizeof(SensorSample)) {
+        return false;
+    }
+    out.samples.resize(header.count);
+    memcpy(out.samples.data(), data + sizeof(header), header.count * sizeof(SensorSample));
+    out.overwritten = header.overwritten;
+    return true;
+}
+
+bool loadSensorCapture(const char* path, SensorCapture& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(f);
+    return parseSensorCapture(data.data(), data.size(), out);
+}
+
+int formatSensorPacket(char* out, size_t len, const SensorSample& s) {
+    if (isnan(s.mag[0])) return snprintf(out, len, "MAG:malformed");
+    return snprintf(out, len, "MAG:%.9g,%.9g,%.9g;ACC:%.9g,%.9g,%.9g",
+                    s.mag[0], s.mag[1], s.mag[2], s.acc[0], s.acc[1], s.acc[2]);
+}
+
+SensorReplayStats replaySensorCapture(const SensorCapture& capture, LSM303Receiver& receiver,
+                                      const SensorReplayHook& hook) {
+    SensorReplayStats stats;
+    if (capture.samples.empty()) return stats;
+    auto wallStart = std::chrono::steady_clock::now();
+
+    uint32_t firstUs = capture.samples.front().tUs;
+    uint64_t startUs = hal::sim::nowUs();
+    char packet[160];
+    for (const SensorSample& s : capture.samples) {
+        // micros() wraps on the device; differences do not
+        uint64_t at = startUs + (uint32_t)(s.tUs - firstUs);
+        if (at > hal::sim::nowUs()) hal::sim::advance((uint32_t)(at - hal::sim::nowUs()));
+
+        int n = formatSensorPacket(packet, sizeof(packet), s);
+        receiver.processPacket(packet, n);
+        stats.packets++;
+        if (isnan(s.mag[0])) stats.malformed++;
+        if (hook) hook(s, receiver);
+    }
+
+    stats.capturedSeconds = (uint32_t)(capture.samples.back().tUs - firstUs) * 1e-6;
+    stats.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+    return stats;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <vector>
+#include "SensorRecorder.h"
+
+class LSM303Receiver;
+
+// --- Sensor capture replay (env:native only) ---
+// Feeds a SensorRecorder capture through a real LSM303Receiver as fast as
+// it will go. Simulated time is advanced to each sample's arrival time so
+// millis()-based state matches the recording, and each sample is turned
+// back into the packet text the receiver parsed: %.9g round-trips a float
+// exactly, so the receiver sees the values it saw on the device.
+
+struct SensorCapture {
+    std::vector<SensorSample> samples;
+    uint32_t overwritten = 0;
+};
+
+bool parseSensorCapture(const uint8_t* data, size_t len, SensorCapture& out);
+bool loadSensorCapture(const char* path, SensorCapture& out);
+
+// Packet text for a sample; a malformed sample gives text that fails to parse
+int formatSensorPacket(char* out, size_t len, const SensorSample& s);
+
+struct SensorReplayStats {
+    uint32_t packets = 0;
+    uint32_t malformed = 0;
+    double capturedSeconds = 0.0;   // first to last arrival
+    double wallMs = 0.0;
+};
+
+// Called after the receiver processed each sample
+typedef std::function<void(const SensorSample&, const LSM303Receiver&)> SensorReplayHook;
+
+SensorReplayStats replaySensorCapture(const SensorCapture& capture, LSM303Receiver& receiver,
+                                      const SensorReplayHook& hook = nullptr);
@@ -0,0 +1,32 @@
+// SimFixture.cpp - the homed rigid rig the host tests share
+#include "SimFixture.h"
+#include "Homing.h"
+#include "MotorControl.h"
+
+SimAxisConfig rigidAxis(float startDeg) {
+    SimAxisConfig c;
+    c.startDeg = startDeg;
+    return c;
+}
+
+RotatorSim& simRig() {
+    static RotatorSim sim{rigidAxis(), rigidAxis(), SimSensorConfig()};
+    return sim;
+}
+
+bool motorsIdle() { return areMotorsReady(); }
+
+bool homeAndWait(RotatorSim& sim) {
+    homeAll();
+    if (!sim.runUntil([] { return homingStage != HOMING_RUNNING; }, SIM_HOMING_TIMEOUT_MS)) return false;
+    return homingStage == HOMING_COMPLETE;
+}
+
+bool resetHomed(RotatorSim& sim, float azStartDeg, float elStartDeg) {
+    abortHoming();
+    sim.axis(SIM_AZ) = rigidAxis(azStartDeg);
+    sim.axis(SIM_EL) = rigidAxis(elStartDeg);
+    sim.sensor() = SimSensorConfig();
+    sim.powerOn();
+    return homeAndWait(sim) && sim.runUntil(motorsIdle, SIM_IDLE_TIMEOUT_MS);
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+#include "RotatorSim.h"
+
+// --- Shared rig for the host tests (env:native only) ---
+// Most suites start every test the same way: rigid axes (no backlash,
+// inertia or stalls) a few degrees above their switches, powered on and
+// homed. The helpers return false instead of asserting so the suites keep
+// their own TEST_ASSERTs.
+inline constexpr float SIM_RIG_START_DEG = 5.0f;
+inline constexpr uint32_t SIM_HOMING_TIMEOUT_MS = 60000;
+inline constexpr uint32_t SIM_IDLE_TIMEOUT_MS = 10000;
+inline constexpr uint32_t SIM_T0_UNIX = 1767225600;   // 2026-01-01 00:00:00 UTC
+
+SimAxisConfig rigidAxis(float startDeg = SIM_RIG_START_DEG);
+
+// The test program's rig on rigidAxis(); attach() it after nativeSetup()
+RotatorSim& simRig();
+
+bool motorsIdle();
+
+// homeAll() until it finishes; true if it completed
+bool homeAndWait(RotatorSim& sim);
+
+// Aborts homing, restores rigid axes and the default sensor, power-cycles
+// and homes; true once homed with both axes at rest
+bool resetHomed(RotatorSim& sim, float azStartDeg = SIM_RIG_START_DEG,
+                float elStartDeg = SIM_RIG_START_DEG);
@@ -0,0 +1,243 @@
+// Steady-state heap test: hours of simulated rotctl and web traffic through
+// the firmware's own request paths (rotctl_sever.cpp over a loopback
+// socket, writeStatusFields, webLogger.writeLogsJSON) must not allocate
+// once warmed up. env:native builds with ALLOC_GUARD, so an allocation
+// inside any ALLOC_FORBID() region of those paths counts as a violation.
+// pio test -e native
+#include <unity.h>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "hal/native/NativeBoard.h"
+#include "AllocTracker.h"
+#include "JsonWriter.h"
+#include "RotctlProtocol.h"
+#include "StatusJson.h"
+#include "TelemetrySnapshot.h"
+#include "WebLogger.h"
+#include "rotctl_server.h"
+
+inline constexpr uint32_t SIM_HOURS = 2;
+
+// Route the C allocator through the tracker, as -Wl,--wrap does on the ESP32
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void __libc_free(void*);
+
+void* malloc(size_t n) {
+    void* p = __libc_malloc(n);
+    if (p) allocTracker.noteAlloc(n);
+    return p;
+}
+void* calloc(size_t n, size_t size) {
+    void* p = __libc_calloc(n, size);
+    if (p) allocTracker.noteAlloc(n * size);
+    return p;
+}
+void* realloc(void* ptr, size_t n) {
+    void* p = __libc_realloc(ptr, n);
+    if (n == 0) {
+        if (ptr) allocTracker.noteFree();
+    } else if (p) {
+        allocTracker.noteAlloc(n);
+    }
+    return p;
+}
+void free(void* p) {
+    if (p) allocTracker.noteFree();
+    __libc_free(p);
+}
+}
+#else
+#include <new>
+void* operator new(size_t n) {
+    void* p = std::malloc(n);
+    if (!p) throw std::bad_alloc();
+    allocTracker.noteAlloc(n);
+    return p;
+}
+void operator delete(void* p) noexcept {
+    if (p) allocTracker.noteFree();
+    std::free(p);
+}
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+#endif
+
+void setUp() {}
+void tearDown() {}
+
+static int client = -1;
+static size_t bytesOut = 0;
+
+static void countSink(void*, const char*, size_t n) { bytesOut += n; }
+
+static void connectClient() {
+    client = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(NATIVE_ROTCTL_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL(0, connect(client, (sockaddr*)&addr, sizeof(addr)));
+}
+
+// A rotctl line on the loopback socket; rotctl_sever.cpp answers it from
+// pollNetwork() in the next nativeLoop() pass
+static void rotctlRequest(const char* line) {
+    send(client, line, strlen(line), 0);
+}
+
+static void drainReplies() {
+    char buf[256];
+    ssize_t n;
+    while ((n = recv(client, buf, sizeof(buf), MSG_DONTWAIT)) > 0) bytesOut += n;
+}
+
+// The /status handler body, minus the socket stats only the ESP32 has
+static void statusRequest() {
+    ALLOC_SCOPE(ALLOC_WEB);
+    ALLOC_FORBID();
+    TelemetrySnapshot snap = readTelemetrySnapshot();
+    JsonWriter json(countSink, nullptr);
+    json.beginObject();
+    writeStatusFields(json, snap, millis());
+    json.endObject();
+}
+
+// The /logs?since=N handler body
+static uint32_t logsRequest(uint32_t since) {
+    ALLOC_SCOPE(ALLOC_WEB);
+    ALLOC_FORBID();
+    JsonWriter json(countSink, nullptr);
+    webLogger.writeLogsJSON(json, since);
+    return webLogger.getHeadSeq();
+}
+
+// The log line POST /move writes, so /logs has entries to format
+static void logMove(float az, float el) {
+    ALLOC_SCOPE(ALLOC_WEB);
+    ALLOC_FORBID();
+    WEB_LOG_INFOF("WebUI", "Move to AZ %f EL %f deg", az, el);
+}
+
+static uint32_t violationCount = 0;
+static void countViolation(AllocSubsystem, size_t) { violationCount++; }
+
+// Traffic shaped like gpredict polling a pass plus an open browser tab:
+// p every 500 ms, P every 10 s, /status every 250 ms, /logs every 2 s.
+// The firmware runs its own loop in between, 5 ms of simulated time per
+// pass so a long run stays quick.
+static void simulate(uint32_t fromMs, uint32_t toMs) {
+    static uint32_t logSince = 0;
+    char line[ROTCTL_LINE_LEN];
+    for (uint32_t now = fromMs; now < toMs; now += 5) {
+        hal::sim::advance(5000);
+        nativeLoop();
+        drainReplies();
+        if (now % 250 == 0) statusRequest();
+        if (now % 500 == 0) rotctlRequest("p\n");
+        if (now % 2000 == 0) logSince = logsRequest(logSince);
+        if (now % 10000 == 0) {
+            snprintf(line, sizeof(line), "P %.2f %.2f\n", (now / 1000) % 360 * 1.0, 10.0 + (now / 10000) % 70);
+            rotctlRequest(line);
+            logMove((now / 1000) % 360 * 1.0f, 10.0f + (now / 10000) % 70);
+        }
+        if (now % 600000 == 0) rotctlRequest("garbage\n");
+    }
+}
+
+static void test_protocol() {
+    RotctlRequest r = parseRotctlCommand("  p\r\n", 5);
+    TEST_ASSERT_EQUAL(ROTCTL_GET_POS, r.kind);
+    r = parseRotctlCommand("P 123.5 45.25\n", 14);
+    TEST_ASSERT_EQUAL(ROTCTL_SET_POS, r.kind);
+    TEST_ASSERT_TRUE(r.valid);
+    TEST_ASSERT_EQUAL_FLOAT(123.5f, r.az);
+    TEST_ASSERT_EQUAL_FLOAT(45.25f, r.el);
+    r = parseRotctlCommand("P 12\n", 5);
+    TEST_ASSERT_EQUAL(ROTCTL_SET_POS, r.kind);
+    TEST_ASSERT_FALSE(r.valid);
+    r = parseRotctlCommand("S\n", 2);
+    TEST_ASSERT_EQUAL(ROTCTL_UNKNOWN, r.kind);
+
+    char reply[ROTCTL_REPLY_LEN];
+    size_t n = formatRotctlPosition(reply, sizeof(reply), 180.0f, -1.5f);
+    TEST_ASSERT_EQUAL_STRING("180.00\n-1.50\n", reply);
+    TEST_ASSERT_EQUAL(13, n);
+}
+
+static void test_attribution_and_guard() {
+    allocTracker.reset();
+    allocTracker.setViolationHandler(countViolation);
+    violationCount = 0;
+
+    allocTracker.arm();
+    {
+        ALLOC_SCOPE(ALLOC_WEB);
+        void* volatile p = malloc(32);
+        free(p);
+        {
+            ALLOC_SCOPE(ALLOC_ROTCTL);
+            void* volatile r = realloc(nullptr, 100);
+            free(r);
+        }
+        {
+            ALLOC_FORBID();
+            void* volatile q = malloc(8);
+            free(q);
+        }
+    }
+    allocTracker.disarm();
+
+    AllocCounts web = allocTracker.counts(ALLOC_WEB);
+    AllocCounts rotctl = allocTracker.counts(ALLOC_ROTCTL);
+    TEST_ASSERT_EQUAL_UINT32(2, web.allocs);
+    TEST_ASSERT_EQUAL_UINT32(2, web.frees);
+    TEST_ASSERT_EQUAL_UINT32(40, web.bytes);
+    TEST_ASSERT_EQUAL_UINT32(1, rotctl.allocs);
+    TEST_ASSERT_EQUAL_UINT32(0, allocTracker.counts(ALLOC_OTHER).allocs);
+    TEST_ASSERT_EQUAL_UINT32(1, allocTracker.violations());
+    TEST_ASSERT_EQUAL_UINT32(1, violationCount);
+}
+
+static void test_simulated_hours_are_allocation_free() {
+    const uint32_t warmupMs = 60000;
+    const uint32_t runMs = SIM_HOURS * 3600UL * 1000;
+
+    allocTracker.reset();
+    allocTracker.setViolationHandler(countViolation);
+    violationCount = 0;
+
+    connectClient();
+    simulate(0, warmupMs);   // first-use costs (stdio, interning, the connection) are allowed here
+    allocTracker.arm();
+    simulate(warmupMs, warmupMs + runMs);
+    allocTracker.disarm();
+
+    for (uint8_t i = 0; i < ALLOC_SUBSYSTEMS; i++) {
+        AllocCounts c = allocTracker.counts((AllocSubsystem)i);
+        if (c.allocs) printf("%s: %u allocs, %u bytes\n", ALLOC_SUBSYSTEM_NAMES[i], c.allocs, c.bytes);
+    }
+    printf("[SIM] %u h: %u rotctl commands, %u log entries, %zu bytes out\n", (unsigned)SIM_HOURS,
+           (unsigned)(rotctlStats[ROTCTL_GET_POS].count + rotctlStats[ROTCTL_SET_POS].count),
+           (unsigned)webLogger.getHeadSeq(), bytesOut);
+    TEST_ASSERT_GREATER_THAN(SIM_HOURS * 7000, rotctlStats[ROTCTL_GET_POS].count);
+    TEST_ASSERT_EQUAL_UINT32(0, allocTracker.counts(ALLOC_ROTCTL).allocs);
+    TEST_ASSERT_EQUAL_UINT32(0, allocTracker.counts(ALLOC_WEB).allocs);
+    TEST_ASSERT_EQUAL_UINT32(0, allocTracker.counts(ALLOC_LOOP).allocs);
+    TEST_ASSERT_EQUAL_UINT32(0, violationCount);
+}
+
+int main() {
+    nativeSetup();
+    UNITY_BEGIN();
+    RUN_TEST(test_protocol);
+    RUN_TEST(test_attribution_and_guard);
+    RUN_TEST(test_simulated_hours_are_allocation_free);
+    return UNITY_END();
+}
@@ -0,0 +1,100 @@
+// Host run of the firmware microbenchmarks (src/Bench.h). Prints the same
+// "BENCH {...}" line as env:lolin_d32_bench, and writes the JSON to
+// $BENCH_JSON when set, for scripts/bench_compare.py.
+// pio test -e native -f native/test_bench
+#include <unity.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "hal/native/NativeBoard.h"
+#include "AllocTracker.h"
+#include "Bench.h"
+#include "JsonWriter.h"
+
+// Route the C allocator through the tracker so allocsPerOp is real
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void __libc_free(void*);
+
+void* malloc(size_t n) {
+    void* p = __libc_malloc(n);
+    if (p) allocTracker.noteAlloc(n);
+    return p;
+}
+void* calloc(size_t n, size_t size) {
+    void* p = __libc_calloc(n, size);
+    if (p) allocTracker.noteAlloc(n * size);
+    return p;
+}
+void* realloc(void* ptr, size_t n) {
+    void* p = __libc_realloc(ptr, n);
+    if (n == 0) {
+        if (ptr) allocTracker.noteFree();
+    } else if (p) {
+        allocTracker.noteAlloc(n);
+    }
+    return p;
+}
+void free(void* p) {
+    if (p) allocTracker.noteFree();
+    __libc_free(p);
+}
+}
+#endif
+
+static void fileSink(void* ctx, const char* data, size_t len) {
+    fwrite(data, 1, len, (FILE*)ctx);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_suite_runs_every_case() {
+    TEST_ASSERT_EQUAL_UINT32(BENCH_CASE_COUNT, runBenchSuite());
+    for (size_t i = 0; i < benchResultCount(); i++) {
+        const BenchResult& r = benchResult(i);
+        TEST_ASSERT_TRUE(r.iterations > 0);
+        TEST_ASSERT_TRUE(r.nsPerOp > 0.0f);
+        TEST_ASSERT_FLOAT_WITHIN(r.nsPerOp * 0.001f, r.nsPerOp * BENCH_CYCLES_PER_US / 1000.0f, r.cyclesPerOp);
+    }
+}
+
+// None of these paths may touch the heap in steady state
+static void test_hot_paths_do_not_allocate() {
+    for (size_t i = 0; i < benchResultCount(); i++) {
+        const BenchResult& r = benchResult(i);
+        TEST_ASSERT_EQUAL_FLOAT_MESSAGE(0.0f, r.allocsPerOp, r.name);
+    }
+}
+
+static void test_report() {
+    printf("BENCH ");
+    {
+        JsonWriter json(fileSink, stdout);
+        writeBenchJSON(json);
+    }
+    printf("\n");
+
+    const char* path = getenv("BENCH_JSON");
+    if (path && *path) {
+        FILE* f = fopen(path, "w");
+        TEST_ASSERT_NOT_NULL(f);
+        {
+            JsonWriter json(fileSink, f);
+            writeBenchJSON(json);
+        }
+        fclose(f);
+    }
+}
+
+int main() {
+    nativeSetup(false);
+    UNITY_BEGIN();
+    RUN_TEST(test_suite_runs_every_case);
+    RUN_TEST(test_hot_paths_do_not_allocate);
+    RUN_TEST(test_report);
+    return UNITY_END();
+}
@@ -0,0 +1,127 @@
+// Calibration.cpp on the native HAL: the sweep runs against a sensor that
+// reports the shaft angles, then re-homes. pio test -e native
+#include <unity.h>
+#include <cmath>
+#include <cstdio>
+#include "hal/native/NativeBoard.h"
+#include "Calibration.h"
+#include "Homing.h"
+#include "MathUtils.h"
+#include "MotorControl.h"
+
+extern Calibration calib;
+extern LSM303Receiver lsmReceiver;
+
+inline constexpr uint64_t SENSOR_PERIOD_US = 20000;   // 50 Hz, like the Nano
+
+// Heading follows the AZ shaft; the sensor reads -90 deg with EL at home
+static float shaftAz() { return normalizeDeg(azMotor->shaftPosition() / stepsPerDegree); }
+static float shaftEl() { return elMotor1->shaftPosition() / stepsPerDegree - 90.0f; }
+
+static void sendSensorPacket() {
+    float h = shaftAz() * PI / 180.0f;
+    float e = shaftEl() * PI / 180.0f;
+    float ax = cosf(e), ay = 0.0f, az = sinf(e);
+    float pitch = asinf(-ax);
+    float roll = atan2f(ay, az);
+    char packet[128];
+    int n = snprintf(packet, sizeof(packet), "MAG:%.5f,%.5f,%.5f;ACC:%.5f,%.5f,%.5f",
+                     cosf(h) * cosf(pitch), sinf(h) / cosf(roll), cosf(h) * sinf(pitch), ax, ay, az);
+    hal::sim::injectUdp(NATIVE_LSM_PORT, packet, n);
+}
+
+static void buildRig() {
+    hal::sim::setPinSource(AZ_LIMIT_PIN, [] { return azMotor->shaftPosition() <= 0.0 ? LOW : HIGH; });
+    hal::sim::setPinSource(EL_LIMIT_PIN, [] { return elMotor1->shaftPosition() <= 0.0 ? LOW : HIGH; });
+    hal::sim::onAdvance([](uint64_t nowUs) {
+        if (nowUs % SENSOR_PERIOD_US == 0) sendSensorPacket();
+    });
+}
+
+static bool runUntil(bool (*done)(), uint32_t limitMs) {
+    for (uint32_t t = 0; t < limitMs; t++) {
+        nativeRunFor(1);
+        if (done()) return true;
+    }
+    return false;
+}
+
+static bool homed() { return homingStage == HOMING_COMPLETE && !calib.isRunning(); }
+
+// Each test starts from a fresh boot away from the switches, then homes
+void setUp() {
+    for (Stepper* m : {azMotor, elMotor1, elMotor2}) m->forceStopAndNewPosition(0);
+    azMotor->setShaftPosition(2000);
+    elMotor1->setShaftPosition(800);
+    elMotor2->setShaftPosition(800);
+    homeAll();
+    TEST_ASSERT_TRUE(runUntil(homed, 60000));
+}
+void tearDown() {}
+
+static void checkSweep() {
+    // Full heading circle and the whole EL span were seen
+    TEST_ASSERT_EQUAL_UINT8(CAL_AZ_BINS, calib.getAzBinsCovered());
+    TEST_ASSERT_TRUE(calib.getElMax() - calib.getElMin() >= CAL_EL_MIN_SPAN_DEG);
+    TEST_ASSERT_TRUE(calib.getElBinsCovered() >= CAL_EL_BINS - 1);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, -90.0f, calib.getElMin());
+
+    // Every sample is paired with the step counts at the time it arrived
+    TEST_ASSERT_TRUE(calib.getSampleCount() > 100);
+    const CalSample* samples = calib.getSamples();
+    for (uint16_t i = 0; i < calib.getSampleCount(); i++) {
+        float azErr = normalizeDeg(stepsToAz(samples[i].azSteps) - samples[i].rawAz);
+        if (azErr > 180.0f) azErr = 360.0f - azErr;
+        float elErr = fabsf(stepsToEl(samples[i].elSteps) - 90.0f - samples[i].rawEl);
+        TEST_ASSERT_TRUE(azErr < 1.0f);
+        TEST_ASSERT_TRUE(elErr < 1.0f);
+    }
+
+    // EL offset from the lowest reading, and homing ran again afterwards
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 90.0f, lsmReceiver.getElHomeOffset());
+    TEST_ASSERT_TRUE(azHomed);
+    TEST_ASSERT_TRUE(elHomed);
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, 0.0f, azMotor->getCurrentPosition() - azMotor->shaftPosition());
+}
+
+static void test_concurrent_sweep() {
+    calib.start(CAL_MODE_CONCURRENT);
+    TEST_ASSERT_TRUE(calib.isRunning());
+    nativeRunFor(10);
+    TEST_ASSERT_TRUE(azMotor->isRunning());
+    TEST_ASSERT_TRUE(elMotor1->isRunning());
+    TEST_ASSERT_TRUE(runUntil(homed, 180000));
+    checkSweep();
+
+    // AZ stopped once the circle was covered instead of running to MAX_AZ
+    float fullSweepMs = (MAX_AZ * stepsPerDegree) / CAL_SWEEP_SPEED_HZ * 1000.0f;
+    TEST_ASSERT_TRUE(calib.getSweepMs() < fullSweepMs);
+}
+
+static void test_sequential_sweep() {
+    calib.start(CAL_MODE_SEQUENTIAL);
+    nativeRunFor(10);
+    TEST_ASSERT_TRUE(azMotor->isRunning());
+    TEST_ASSERT_FALSE(elMotor1->isRunning());
+    TEST_ASSERT_TRUE(runUntil(homed, 180000));
+    checkSweep();
+}
+
+static void test_stop_aborts_sweep() {
+    calib.start();
+    nativeRunFor(2000);
+    calib.stop();
+    TEST_ASSERT_FALSE(calib.isRunning());
+    TEST_ASSERT_FALSE(lsmReceiver.isCalibrating());
+    TEST_ASSERT_EQUAL_UINT32(MOTOR_SPEED_HZ, azMotor->getMaxSpeedInHz());
+}
+
+int main() {
+    nativeSetup(false);
+    buildRig();
+    UNITY_BEGIN();
+    RUN_TEST(test_concurrent_sweep);
+    RUN_TEST(test_sequential_sweep);
+    RUN_TEST(test_stop_aborts_sweep);
+    return UNITY_END();
+}
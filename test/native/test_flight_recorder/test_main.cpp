@@ -0,0 +1,177 @@
+// Flight recorder on the simulated rotator: sample rate, the fault
+// triggers and the columnar capture file. pio test -e native
+#include <unity.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "hal/native/NativeBoard.h"
+#include "sim/SimFixture.h"
+#include "FlightRecorder.h"
+#include "Homing.h"
+#include "MotorControl.h"
+
+static RotatorSim& sim = simRig();
+
+static bool homingDone() { return homingStage != HOMING_RUNNING; }
+
+// The capture file split into its parts
+struct Capture {
+    FlightCaptureHeader header;
+    std::vector<FlightColumnDesc> columns;
+    std::vector<std::vector<uint8_t>> data;
+
+    int64_t value(const char* name, size_t i) const {
+        for (size_t c = 0; c < columns.size(); c++) {
+            if (strcmp(columns[c].name, name) != 0) continue;
+            const uint8_t* p = &data[c][i * columns[c].size];
+            if (columns[c].size == 4) return columns[c].type == 'i' ? (int64_t)*(const int32_t*)p : *(const uint32_t*)p;
+            if (columns[c].size == 2) return columns[c].type == 'i' ? (int64_t)*(const int16_t*)p : *(const uint16_t*)p;
+            return *p;
+        }
+        TEST_FAIL_MESSAGE("no such column");
+        return 0;
+    }
+};
+
+static Capture readCapture(size_t chunk) {
+    std::vector<uint8_t> file(flightRecorder.captureSize());
+    for (size_t at = 0; at < file.size();) {
+        size_t n = flightRecorder.readCapture(file.data() + at, chunk, at);
+        TEST_ASSERT_TRUE(n > 0);
+        at += n;
+    }
+    Capture cap;
+    memcpy(&cap.header, file.data(), sizeof(cap.header));
+    size_t at = sizeof(cap.header);
+    for (uint16_t c = 0; c < cap.header.columns; c++, at += sizeof(FlightColumnDesc)) {
+        FlightColumnDesc d;
+        memcpy(&d, &file[at], sizeof(d));
+        cap.columns.push_back(d);
+    }
+    for (const FlightColumnDesc& d : cap.columns) {
+        size_t bytes = (size_t)d.size * cap.header.count;
+        cap.data.emplace_back(file.begin() + at, file.begin() + at + bytes);
+        at += bytes;
+    }
+    TEST_ASSERT_EQUAL_UINT32(file.size(), at);
+    return cap;
+}
+
+void setUp() {
+    abortHoming();
+    azHomed = false;
+    elHomed = false;
+    sim.axis(SIM_AZ) = rigidAxis(30.0f);
+    sim.axis(SIM_EL) = rigidAxis(10.0f);
+    sim.powerOn();
+    flightRecorder.arm(FLIGHT_DEFAULT_RATE_HZ);
+    sim.run(1);
+}
+void tearDown() {}
+
+static void test_samples_at_the_configured_rate() {
+    flightRecorder.arm(100);
+    sim.run(2000);
+    TEST_ASSERT_EQUAL_UINT16(100, flightRecorder.rateHz());
+    TEST_ASSERT_INT_WITHIN(2, 200, (int)flightRecorder.count());
+    TEST_ASSERT_FALSE(flightRecorder.frozen());
+
+    flightRecorder.arm(FLIGHT_MAX_RATE_HZ + 50);   // clamped
+    sim.run(100);
+    TEST_ASSERT_EQUAL_UINT16(FLIGHT_MAX_RATE_HZ, flightRecorder.rateHz());
+
+    // The ring keeps the newest samples
+    flightRecorder.arm(FLIGHT_MAX_RATE_HZ);
+    sim.run(FLIGHT_CAPACITY * 5 + 500);
+    TEST_ASSERT_EQUAL_UINT32(FLIGHT_CAPACITY, flightRecorder.count());
+    TEST_ASSERT_TRUE(flightRecorder.overwritten() >= 90);
+}
+
+static void test_estop_freezes_after_post_trigger_window() {
+    TEST_ASSERT_TRUE(homeAndWait(sim));
+    moveAzimuthToPosition(120.0f);
+    sim.run(1500);
+    uint32_t stopMs = millis();
+    emergencyStop();
+    TEST_ASSERT_EQUAL(FLIGHT_TRIG_ESTOP, flightRecorder.triggerReason());
+    TEST_ASSERT_FALSE(flightRecorder.trigger(FLIGHT_TRIG_MANUAL));   // first fault wins
+
+    sim.run((FLIGHT_POST_TRIGGER - 1) * 1000 / FLIGHT_DEFAULT_RATE_HZ);
+    TEST_ASSERT_FALSE(flightRecorder.frozen());
+    sim.run(2 * 1000 / FLIGHT_DEFAULT_RATE_HZ);
+    TEST_ASSERT_TRUE(flightRecorder.frozen());
+    size_t frozenCount = flightRecorder.count();
+    sim.run(1000);
+    TEST_ASSERT_EQUAL_UINT32(frozenCount, flightRecorder.count());
+
+    Capture cap = readCapture(4096);
+    TEST_ASSERT_EQUAL_HEX32(FLIGHT_CAPTURE_MAGIC, cap.header.magic);
+    TEST_ASSERT_EQUAL(FLIGHT_TRIG_ESTOP, cap.header.trigger);
+    TEST_ASSERT_EQUAL_UINT32(FLIGHT_POST_TRIGGER, cap.header.count - 1 - cap.header.triggerIndex);
+    uint32_t t = cap.value("t_ms", cap.header.triggerIndex);
+    TEST_ASSERT_TRUE(t >= stopMs && t - stopMs < 1000 / FLIGHT_DEFAULT_RATE_HZ + 1);
+
+    // Before the stop the axis was slewing towards the target
+    size_t before = cap.header.triggerIndex - 1;
+    TEST_ASSERT_EQUAL_INT32(azToSteps(120.0f), cap.value("az_target", before));
+    TEST_ASSERT_TRUE(cap.value("az_rate", before) > 0);
+    TEST_ASSERT_TRUE(cap.value("flags", before) & FLIGHT_AZ_RUNNING);
+    TEST_ASSERT_TRUE(cap.value("flags", before) & FLIGHT_AZ_HOMED);
+    // ...and stood still afterwards
+    TEST_ASSERT_EQUAL_INT32(0, cap.value("az_rate", cap.header.count - 1));
+    TEST_ASSERT_FALSE(cap.value("flags", cap.header.count - 1) & FLIGHT_AZ_HOMED);
+
+    // Small reads give the same file as one large read
+    Capture pieces = readCapture(7);
+    for (size_t c = 0; c < cap.data.size(); c++) TEST_ASSERT_TRUE(cap.data[c] == pieces.data[c]);
+}
+
+static void test_limit_hit_away_from_home_triggers() {
+    TEST_ASSERT_TRUE(homeAndWait(sim));
+    moveAzimuthToPosition(20.0f);
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 30000));
+    // Parking at home closes the switch without a fault
+    moveElevationToPosition(0.0f);
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 30000));
+    sim.run(100);
+    TEST_ASSERT_EQUAL(FLIGHT_TRIG_NONE, flightRecorder.triggerReason());
+
+    // The mast turns back onto the switch while the steps still say 20 deg
+    sim.slip(SIM_AZ, -20.5f);
+    sim.run(100);
+    TEST_ASSERT_EQUAL(FLIGHT_TRIG_LIMIT, flightRecorder.triggerReason());
+    sim.run(FLIGHT_POST_TRIGGER * 1000 / FLIGHT_DEFAULT_RATE_HZ + 100);
+    Capture cap = readCapture(512);
+    TEST_ASSERT_TRUE(cap.value("flags", cap.header.triggerIndex) & FLIGHT_AZ_LIMIT);
+    TEST_ASSERT_FALSE(cap.value("flags", cap.header.triggerIndex - 10) & FLIGHT_AZ_LIMIT);
+}
+
+static void test_step_loss_and_failed_homing_trigger() {
+    TEST_ASSERT_TRUE(homeAndWait(sim));
+    sim.axis(SIM_AZ).pullOutHz = MOTOR_SPEED_HZ - 100;
+    moveAzimuthToPosition(60.0f);
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 30000));
+    sim.axis(SIM_AZ).pullOutHz = 0.0f;
+    TEST_ASSERT_EQUAL(FLIGHT_TRIG_NONE, flightRecorder.triggerReason());
+    TEST_ASSERT_TRUE(homeAndWait(sim));   // finds the switch early by the lost steps
+    TEST_ASSERT_EQUAL(FLIGHT_TRIG_STEP_LOSS, flightRecorder.triggerReason());
+
+    flightRecorder.arm();
+    sim.run(1);
+    sim.jam(SIM_EL, true);
+    homeAll();
+    TEST_ASSERT_TRUE(sim.runUntil(homingDone, 60000));
+    sim.jam(SIM_EL, false);
+    TEST_ASSERT_EQUAL(FLIGHT_TRIG_HOMING_FAILED, flightRecorder.triggerReason());
+}
+
+int main() {
+    nativeSetup();
+    sim.attach();
+    UNITY_BEGIN();
+    RUN_TEST(test_samples_at_the_configured_rate);
+    RUN_TEST(test_estop_freezes_after_post_trigger_window);
+    RUN_TEST(test_limit_hit_away_from_home_triggers);
+    RUN_TEST(test_step_loss_and_failed_homing_trigger);
+    return UNITY_END();
+}
@@ -0,0 +1,152 @@
+// Homing.cpp on the native HAL: two-speed sequence, drift statistics,
+// failure handling and the EL interlock. pio test -e native
+#include <unity.h>
+#include <cmath>
+#include "hal/native/NativeBoard.h"
+#include "Homing.h"
+#include "MotorControl.h"
+#include "Scheduler.h"
+
+// Switches close (LOW) once the shaft is at or below the switch position
+static double azSwitchAt = 0.0;
+static double elSwitchAt = 0.0;
+static bool switchesFitted = true;
+
+static void fitSwitches() {
+    hal::sim::setPinSource(AZ_LIMIT_PIN, [] {
+        return switchesFitted && azMotor->shaftPosition() <= azSwitchAt ? LOW : HIGH;
+    });
+    hal::sim::setPinSource(EL_LIMIT_PIN, [] {
+        return switchesFitted && elMotor1->shaftPosition() <= elSwitchAt ? LOW : HIGH;
+    });
+}
+
+// Power-on state: the firmware counts from 0 wherever the shafts are
+static void powerOn(double azShaft, double elShaft) {
+    abortHoming();
+    nativeRunFor(10);
+    for (Stepper* m : {azMotor, elMotor1, elMotor2}) m->forceStopAndNewPosition(0);
+    azMotor->setShaftPosition(azShaft);
+    elMotor1->setShaftPosition(elShaft);
+    elMotor2->setShaftPosition(elShaft);
+    azHomed = false;
+    elHomed = false;
+    azHoming.stats = HomingStats();
+    elHoming.stats = HomingStats();
+    elHomingWaitsForAz = false;
+    switchesFitted = true;
+    nativeRunFor(10);
+}
+
+static bool runUntilHomed(uint32_t limitMs) {
+    for (uint32_t t = 0; t < limitMs; t++) {
+        nativeRunFor(1);
+        if (homingStage != HOMING_RUNNING) return homingStage == HOMING_COMPLETE;
+    }
+    return false;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_home_is_the_switch_edge() {
+    powerOn(3000, 1500);
+    homeAll();
+    TEST_ASSERT_TRUE(runUntilHomed(60000));
+    TEST_ASSERT_TRUE(azHomed);
+    TEST_ASSERT_TRUE(elHomed);
+    TEST_ASSERT_EQUAL(AXIS_DONE, azHoming.phase);
+    TEST_ASSERT_EQUAL(AXIS_DONE, elHoming.phase);
+
+    // Firmware zero lines up with the switch to within a step
+    float azError = azMotor->getCurrentPosition() - (azMotor->shaftPosition() - azSwitchAt);
+    float elError = elMotor1->getCurrentPosition() - (elMotor1->shaftPosition() - elSwitchAt);
+    TEST_ASSERT_FLOAT_WITHIN(1.5f, 0.0f, azError);
+    TEST_ASSERT_FLOAT_WITHIN(1.5f, 0.0f, elError);
+    TEST_ASSERT_EQUAL_INT32(elMotor1->getCurrentPosition(), elMotor2->getCurrentPosition());
+
+    // The fast pass overshoots the switch by the deceleration distance
+    TEST_ASSERT_EQUAL_UINT32(1, azHoming.stats.runs);
+    TEST_ASSERT_TRUE(labs(azHoming.stats.lastFastSlowDelta) < HOMING_BACKOFF_STEPS);
+    TEST_ASSERT_TRUE(lastHomingDurationMs > 0);
+}
+
+static void test_rehoming_reports_drift() {
+    // Lose 25 AZ steps (the shaft moved, the count did not), then re-home
+    azMotor->setShaftPosition(azMotor->shaftPosition() + 25);
+    homeAll();
+    TEST_ASSERT_TRUE(runUntilHomed(60000));
+    TEST_ASSERT_EQUAL_UINT32(1, azHoming.stats.driftSamples);
+    TEST_ASSERT_INT_WITHIN(2, -25, azHoming.stats.lastDriftSteps);
+    TEST_ASSERT_INT_WITHIN(2, 0, elHoming.stats.lastDriftSteps);
+
+    homeAll();
+    TEST_ASSERT_TRUE(runUntilHomed(60000));
+    TEST_ASSERT_EQUAL_UINT32(2, azHoming.stats.driftSamples);
+    TEST_ASSERT_INT_WITHIN(2, 0, azHoming.stats.lastDriftSteps);
+    TEST_ASSERT_TRUE(azHoming.stats.stdDevSteps() > 10.0f);
+}
+
+static void test_missing_switch_fails() {
+    powerOn(3000, 1500);
+    switchesFitted = false;
+    homeAll();
+    TEST_ASSERT_FALSE(runUntilHomed(60000));
+    TEST_ASSERT_EQUAL(HOMING_IDLE, homingStage);
+    TEST_ASSERT_EQUAL(AXIS_FAILED, azHoming.phase);
+    TEST_ASSERT_EQUAL(AXIS_FAILED, elHoming.phase);
+    TEST_ASSERT_FALSE(azHomed);
+    // Gave up after the maximum search distance
+    TEST_ASSERT_FLOAT_WITHIN(HOMING_BACKOFF_STEPS, 3000.0f - MAX_HOMING_STEPS, azMotor->shaftPosition());
+    TEST_ASSERT_FALSE(azMotor->isRunning());
+}
+
+static void test_el_waits_while_az_unwinds() {
+    // AZ believes it is on the cable wrap at 380 deg
+    powerOn(azToSteps(380), 1500);
+    azMotor->forceStopAndNewPosition(azToSteps(380));
+    homeAll();
+
+    bool sawWaiting = false;
+    double elStart = elMotor1->shaftPosition();
+    for (uint32_t t = 0; t < 60000 && homingStage == HOMING_RUNNING; t++) {
+        nativeRunFor(1);
+        float azDeg = stepsToAz(azMotor->getCurrentPosition());
+        if (elHoming.phase == AXIS_WAITING) {
+            sawWaiting = true;
+            TEST_ASSERT_EQUAL(AXIS_PRE_HOME, azHoming.phase);
+        }
+        if (azDeg > 360) TEST_ASSERT_TRUE(elMotor1->shaftPosition() == elStart);
+    }
+    TEST_ASSERT_TRUE(sawWaiting);
+    TEST_ASSERT_EQUAL(HOMING_COMPLETE, homingStage);
+    TEST_ASSERT_TRUE(elHomed);
+}
+
+static void test_el_waits_for_az_when_serialized() {
+    powerOn(3000, 1500);
+    elHomingWaitsForAz = true;
+    homeAll();
+    unsigned long azDoneMs = 0, elMoveMs = 0;
+    double elStart = elMotor1->shaftPosition();
+    for (uint32_t t = 0; t < 60000 && homingStage == HOMING_RUNNING; t++) {
+        nativeRunFor(1);
+        if (!azDoneMs && azHomed) azDoneMs = millis();
+        if (!elMoveMs && elMotor1->shaftPosition() != elStart) elMoveMs = millis();
+    }
+    TEST_ASSERT_EQUAL(HOMING_COMPLETE, homingStage);
+    TEST_ASSERT_TRUE(azDoneMs > 0);
+    TEST_ASSERT_TRUE(elMoveMs >= azDoneMs);
+}
+
+int main() {
+    nativeSetup(false);
+    fitSwitches();
+    UNITY_BEGIN();
+    RUN_TEST(test_home_is_the_switch_edge);
+    RUN_TEST(test_rehoming_reports_drift);
+    RUN_TEST(test_missing_switch_fails);
+    RUN_TEST(test_el_waits_while_az_unwinds);
+    RUN_TEST(test_el_waits_for_az_when_serialized);
+    return UNITY_END();
+}
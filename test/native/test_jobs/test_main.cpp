@@ -0,0 +1,191 @@
+// Timed jobs, the wall clock and stored trajectories against the
+// simulated rotator. pio test -e native
+#include <unity.h>
+#include <cstring>
+#include "hal/native/NativeBoard.h"
+#include "sim/SimFixture.h"
+#include "Calibration.h"
+#include "Homing.h"
+#include "JobScheduler.h"
+#include "JsonWriter.h"
+#include "MotorControl.h"
+#include "Trajectory.h"
+#include "WallClock.h"
+
+extern Calibration calib;
+
+static RotatorSim& sim = simRig();
+static float azTargetDeg() { return stepsToAz(azMotor->targetPos()); }
+static float elTargetDeg() { return stepsToEl(elMotor1->targetPos()); }
+
+void setUp() {
+    TEST_ASSERT_TRUE(resetHomed(sim));
+}
+void tearDown() {
+    trajectory.stop();
+    for (uint32_t id = 1; id < 64; id++) jobScheduler.cancel(id);
+}
+
+static void test_parse_trajectory_points() {
+    TrajPoint p[4];
+    TEST_ASSERT_EQUAL(3, parseTrajectoryPoints("0,10,5;30.5,12.5,8;60,15,10", p, 4));
+    TEST_ASSERT_EQUAL_FLOAT(30.5f, p[1].tSec);
+    TEST_ASSERT_EQUAL_FLOAT(12.5f, p[1].az);
+    TEST_ASSERT_EQUAL(1, parseTrajectoryPoints("0,10,5;", p, 4));
+    TEST_ASSERT_EQUAL(-1, parseTrajectoryPoints("0,10,5;0,11,5", p, 4));    // time must increase
+    TEST_ASSERT_EQUAL(-1, parseTrajectoryPoints("0,10,190", p, 4));         // EL out of range
+    TEST_ASSERT_EQUAL(-1, parseTrajectoryPoints("0,10", p, 4));
+    TEST_ASSERT_EQUAL(-1, parseTrajectoryPoints("0,1,1;1,1,1;2,1,1", p, 2));
+}
+
+static void test_jobs_need_a_clock() {
+    TEST_ASSERT_FALSE(wallClock.valid());
+    TEST_ASSERT_EQUAL_UINT32(0, jobScheduler.add(JOB_PARK, SIM_T0_UNIX));
+    TEST_ASSERT_FALSE(wallClock.set(1000));   // 1970 is an unset clock
+    TEST_ASSERT_TRUE(wallClock.set((uint64_t)SIM_T0_UNIX * 1000));
+    TEST_ASSERT_EQUAL(CLOCK_MANUAL, wallClock.source());
+    TEST_ASSERT_EQUAL_UINT32(SIM_T0_UNIX, wallClock.now());
+    sim.run(2500);
+    TEST_ASSERT_EQUAL_UINT32(SIM_T0_UNIX + 2, wallClock.now());
+}
+
+static void test_slew_and_park_on_time() {
+    uint32_t now = wallClock.now();
+    uint32_t slewId = jobScheduler.add(JOB_SLEW, now + 5, 40.0f, 20.0f);
+    uint32_t parkId = jobScheduler.add(JOB_PARK, now + 30, JOB_PARK_AZ_DEG, JOB_PARK_EL_DEG);
+    TEST_ASSERT_TRUE(slewId && parkId);
+    TEST_ASSERT_EQUAL(2, jobScheduler.pending());
+    uint32_t executed = jobScheduler.executed();
+
+    // The slew is due on the second boundary, the park several wheel turns out
+    uint64_t dueMs = (uint64_t)(now + 5) * 1000;
+    TEST_ASSERT_TRUE(sim.runUntil([&] { return wallClock.nowMs() >= dueMs - 1; }, 10000));
+    TEST_ASSERT_TRUE(motorsIdle());
+    TEST_ASSERT_TRUE(sim.runUntil([] { return !motorsIdle(); }, 200));
+    TEST_ASSERT_TRUE(wallClock.nowMs() - dueMs <= JOB_TICK_MS);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 40.0f, azTargetDeg());
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 20.0f, elTargetDeg());
+    TEST_ASSERT_EQUAL(1, jobScheduler.pending());
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 10000));
+
+    TEST_ASSERT_TRUE(sim.runUntil([] { return !motorsIdle(); }, 30000));
+    TEST_ASSERT_TRUE(wallClock.now() >= now + 30);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, JOB_PARK_AZ_DEG, azTargetDeg());
+    TEST_ASSERT_EQUAL(0, jobScheduler.pending());
+    TEST_ASSERT_EQUAL_UINT32(executed + 2, jobScheduler.executed());
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 10000));
+
+    // Cancelled jobs never run
+    uint32_t id = jobScheduler.add(JOB_SLEW, wallClock.now() + 2, 80.0f, 0.0f);
+    TEST_ASSERT_TRUE(jobScheduler.cancel(id));
+    TEST_ASSERT_FALSE(jobScheduler.cancel(id));
+    sim.run(3000);
+    TEST_ASSERT_TRUE(motorsIdle());
+}
+
+static void test_late_trajectory_joins_and_stale_slew_drops() {
+    TrajPoint points[2] = {{0.0f, 10.0f, 10.0f}, {60.0f, 70.0f, 40.0f}};
+    TEST_ASSERT_TRUE(trajectory.store(points, 2));
+    uint32_t now = wallClock.now();
+    uint32_t missed = jobScheduler.missed();
+
+    // As after a reboot in the middle of a pass
+    TEST_ASSERT_TRUE(jobScheduler.add(JOB_TRAJECTORY, now - 20));
+    TEST_ASSERT_TRUE(jobScheduler.add(JOB_SLEW, now - JOB_LATE_LIMIT_S - 5, 100.0f, 0.0f));
+    sim.run(JOB_TICK_MS + 1);
+    TEST_ASSERT_TRUE(trajectory.isRunning());
+    TEST_ASSERT_EQUAL_UINT32(missed + 1, jobScheduler.missed());
+    TEST_ASSERT_EQUAL(0, jobScheduler.pending());
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 30.0f, azTargetDeg());   // 20 s in
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 20.0f, elTargetDeg());
+
+    // Follows the interpolated track and holds the last point
+    sim.run(20000);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 50.0f, azTargetDeg());
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, azTargetDeg(), stepsToAz(azMotor->getCurrentPosition()));
+    sim.run(21000);
+    TEST_ASSERT_FALSE(trajectory.isRunning());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 70.0f, azTargetDeg());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 40.0f, elTargetDeg());
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 10000));
+}
+
+static void test_calibration_waits_for_idle() {
+    TrajPoint points[2] = {{0.0f, 10.0f, 10.0f}, {10.0f, 20.0f, 10.0f}};
+    TEST_ASSERT_TRUE(trajectory.store(points, 2));
+    TEST_ASSERT_TRUE(trajectory.start());
+    TEST_ASSERT_TRUE(jobScheduler.add(JOB_CALIBRATE, wallClock.now()));
+    sim.run(5000);
+    TEST_ASSERT_FALSE(calib.isRunning());
+    TEST_ASSERT_EQUAL(1, jobScheduler.pending());
+
+    TEST_ASSERT_TRUE(sim.runUntil([] { return !trajectory.isRunning() && motorsIdle(); }, 20000));
+    TEST_ASSERT_TRUE(sim.runUntil([] { return calib.isRunning(); }, JOB_RECHECK_MS + JOB_TICK_MS));
+    TEST_ASSERT_EQUAL(0, jobScheduler.pending());
+    calib.stop();
+    azMotor->forceStop();
+    elMotor1->forceStop();
+    elMotor2->forceStop();
+}
+
+static void test_trajectory_needs_homing() {
+    TrajPoint points[2] = {{0.0f, 10.0f, 10.0f}, {10.0f, 20.0f, 10.0f}};
+    TEST_ASSERT_TRUE(trajectory.store(points, 2));
+    emergencyStop();
+    TEST_ASSERT_FALSE(trajectory.start());
+    homeAll();
+    TEST_ASSERT_FALSE(trajectory.start());
+    TEST_ASSERT_TRUE(sim.runUntil([] { return homingStage != HOMING_RUNNING; }, 60000));
+    TEST_ASSERT_TRUE(trajectory.start());
+}
+
+static void test_queue_persists_and_ntp_takes_over() {
+    uint32_t now = wallClock.now();
+    uint32_t id = jobScheduler.add(JOB_SLEW, now + 3600, 45.0f, 30.0f);
+    TEST_ASSERT_TRUE(id);
+
+    // The flash write waits for the NvsWriter pass, then a reboot reloads it
+    JobScheduler before;
+    before.begin();
+    TEST_ASSERT_EQUAL(0, before.pending());
+    sim.run(1);
+    JobScheduler rebooted;
+    rebooted.begin();
+    TEST_ASSERT_EQUAL(1, rebooted.pending());
+    static Trajectory reloaded;   // the points from the test before, own namespace
+    reloaded.begin();
+    TEST_ASSERT_EQUAL(2, reloaded.count());
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, reloaded.point(1).az);
+    char buf[512];
+    JsonBuffer json(buf, sizeof(buf));
+    rebooted.writeJSON(json);
+    TEST_ASSERT_FALSE(json.overflowed());
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"source\":\"manual\""));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"kind\":\"slew\""));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"inSec\":3600"));
+
+    // NTP steps the clock an hour ahead: the job becomes due right away
+    uint32_t generation = wallClock.generation();
+    hal::sim::setNtpTime((uint64_t)(now + 3600) * 1000);
+    TEST_ASSERT_TRUE(sim.runUntil([] { return !motorsIdle(); }, 2 * JOB_TICK_MS));
+    TEST_ASSERT_EQUAL(CLOCK_NTP, wallClock.source());
+    TEST_ASSERT_EQUAL_UINT32(generation + 1, wallClock.generation());
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 45.0f, azTargetDeg());
+    TEST_ASSERT_FALSE(wallClock.set((uint64_t)SIM_T0_UNIX * 1000));   // NTP keeps the time
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 10000));
+}
+
+int main() {
+    hal::sim::clearNvs();
+    nativeSetup();
+    sim.attach();
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_trajectory_points);
+    RUN_TEST(test_jobs_need_a_clock);
+    RUN_TEST(test_slew_and_park_on_time);
+    RUN_TEST(test_late_trajectory_joins_and_stale_slew_drops);
+    RUN_TEST(test_calibration_waits_for_idle);
+    RUN_TEST(test_trajectory_needs_homing);
+    RUN_TEST(test_queue_persists_and_ntp_takes_over);
+    return UNITY_END();
+}
@@ -0,0 +1,155 @@
+// Host tests and allocation/time benchmark for JsonWriter: pio test -e native
+#include <unity.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include "JsonWriter.h"
+
+// Count every heap allocation made by the code under measurement
+static size_t allocCount = 0;
+static size_t allocBytes = 0;
+
+void* operator new(size_t n) {
+    allocCount++;
+    allocBytes += n;
+    if (void* p = malloc(n)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+void setUp() {}
+void tearDown() {}
+
+static void test_structure_and_commas() {
+    char out[256];
+    JsonBuffer json(out, sizeof(out));
+    json.beginObject();
+    json.kv("a", 1);
+    json.kv("b", -2L);
+    json.key("list").beginArray().value(true).value(false).value((const char*)nullptr).endArray();
+    json.key("obj").beginObject().kv("x", 1.25, 1).endObject();
+    json.key("empty").beginArray().endArray();
+    json.kv("u", 4000000000UL);
+    json.endObject();
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"a\":1,\"b\":-2,\"list\":[true,false,null],\"obj\":{\"x\":1.2},\"empty\":[],\"u\":4000000000}",
+        json.c_str());
+    TEST_ASSERT_FALSE(json.overflowed());
+}
+
+static void test_escaping_and_non_finite() {
+    char out[128];
+    JsonBuffer json(out, sizeof(out));
+    json.beginObject();
+    json.kv("s", "quote\" back\\ nl\n tab\t bell\x07 deg\xc2\xb0");
+    json.kv("nan", 0.0 / 0.0, 2);
+    json.endObject();
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"s\":\"quote\\\" back\\\\ nl\\n tab\\t bell\\u0007 deg\xc2\xb0\",\"nan\":null}",
+        json.c_str());
+}
+
+static void test_overflow_and_streaming() {
+    char small[8];
+    JsonBuffer json(small, sizeof(small));
+    json.beginObject().kv("long", "value").endObject();
+    TEST_ASSERT_TRUE(json.overflowed());
+    TEST_ASSERT_EQUAL(7, json.length());
+
+    // Output larger than the stage buffer arrives in order through the sink
+    std::string sinkOut;
+    JsonWriter w([](void* ctx, const char* d, size_t n) { static_cast<std::string*>(ctx)->append(d, n); }, &sinkOut);
+    w.beginArray();
+    for (int i = 0; i < 100; i++) w.value(i);
+    w.endArray();
+    w.flush();
+    TEST_ASSERT_EQUAL(w.bytesWritten(), sinkOut.size());
+    TEST_ASSERT_EQUAL('[', sinkOut.front());
+    TEST_ASSERT_EQUAL_STRING("98,99]", sinkOut.c_str() + sinkOut.size() - 6);
+}
+
+// The /status body as it was built before: one String concatenation per field
+static std::string statusByConcat(float az, float el, unsigned long ms) {
+    std::string json = "{";
+    json += "\"lsmAz\":" + std::to_string(az) + ",";
+    json += "\"lsmAzTrue\":" + std::to_string(az + 3.1f) + ",";
+    json += "\"lsmEl\":" + std::to_string(el) + ",";
+    json += "\"lsmElCorr\":" + std::to_string(el - 0.4f) + ",";
+    json += "\"az\":" + std::to_string(az) + ",";
+    json += "\"el\":" + std::to_string(el) + ",";
+    json += "\"azLimit\":" + std::to_string(1) + ",";
+    json += "\"elLimit\":" + std::to_string(1) + ",";
+    json += "\"azHomed\":" + std::string("true") + ",";
+    json += "\"tasks\":[],";
+    json += "\"rotctl\":" + std::string("false") + ",";
+    json += "\"warmStart\":" + std::string("true") + ",";
+    json += "\"operationalMs\":" + std::to_string(ms) + ",";
+    json += "\"loopMaxUs\":" + std::to_string(ms / 7) + ",";
+    json += "\"budgetOverruns\":" + std::to_string(3) + ",";
+    json += "\"hardware\":\"" + std::string("ESP32 Rotator") + "\",";
+    json += "\"firmware\":\"" + std::string("v1.2.0") + "\"";
+    json += "}";
+    return json;
+}
+
+static size_t statusByWriter(char* out, size_t len, float az, float el, unsigned long ms) {
+    JsonBuffer json(out, len);
+    json.beginObject();
+    json.kv("lsmAz", az, 1);
+    json.kv("lsmAzTrue", az + 3.1f, 1);
+    json.kv("lsmEl", el, 1);
+    json.kv("lsmElCorr", el - 0.4f, 1);
+    json.kv("az", az, 1);
+    json.kv("el", el, 1);
+    json.kv("azLimit", 1);
+    json.kv("elLimit", 1);
+    json.kv("azHomed", true);
+    json.key("tasks").beginArray().endArray();
+    json.kv("rotctl", false);
+    json.kv("warmStart", true);
+    json.kv("operationalMs", ms);
+    json.kv("loopMaxUs", ms / 7);
+    json.kv("budgetOverruns", 3);
+    json.kv("hardware", "ESP32 Rotator");
+    json.kv("firmware", "v1.2.0");
+    json.endObject();
+    return json.length();
+}
+
+static constexpr int BENCH_RESPONSES = 200000;
+
+static void test_benchmark_status_response() {
+    size_t sink = 0;
+
+    allocCount = allocBytes = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_RESPONSES; i++) sink += statusByConcat(i * 0.1f, 45.0f, 12345 + i).size();
+    double concatNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    size_t concatAllocs = allocCount, concatBytes = allocBytes;
+
+    char out[512];
+    allocCount = allocBytes = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_RESPONSES; i++) sink += statusByWriter(out, sizeof(out), i * 0.1f, 45.0f, 12345 + i);
+    double writerNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    size_t writerAllocs = allocCount, writerBytes = allocBytes;
+
+    printf("[BENCH] /status by concatenation: %.0f ns, %.1f allocations, %.0f bytes allocated per response\n",
+           concatNs / BENCH_RESPONSES, (double)concatAllocs / BENCH_RESPONSES, (double)concatBytes / BENCH_RESPONSES);
+    printf("[BENCH] /status by JsonWriter:    %.0f ns, %.1f allocations, %.0f bytes allocated per response\n",
+           writerNs / BENCH_RESPONSES, (double)writerAllocs / BENCH_RESPONSES, (double)writerBytes / BENCH_RESPONSES);
+    TEST_ASSERT_EQUAL(0, writerAllocs);
+    TEST_ASSERT_TRUE(sink > 0);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_structure_and_commas);
+    RUN_TEST(test_escaping_and_non_finite);
+    RUN_TEST(test_overflow_and_streaming);
+    RUN_TEST(test_benchmark_status_response);
+    return UNITY_END();
+}
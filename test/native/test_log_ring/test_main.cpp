@@ -0,0 +1,162 @@
+// Host tests and contention benchmark for LogRing: pio test -e native
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "LogRing.h"
+#include "LogRecord.h"
+
+// Plain text payload for the ring tests
+template <size_t Len>
+struct Text {
+    char message[Len];
+};
+
+template <typename Ring>
+static bool appendText(Ring& ring, uint32_t ts, uint8_t level, const char* source, const char* msg) {
+    return ring.append(ts, level, source, [msg](auto& p) {
+        size_t n = strnlen(msg, sizeof(p.message) - 1);
+        memcpy(p.message, msg, n);
+        p.message[n] = '\0';
+    });
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_order_and_wrap() {
+    static LogRing<Text<32>, 8> ring;
+    char msg[32];
+    for (uint32_t i = 0; i < 20; i++) {
+        snprintf(msg, sizeof(msg), "msg %u", (unsigned)i);
+        TEST_ASSERT_TRUE(appendText(ring, i * 10, 1, "[TEST]", msg));
+    }
+    TEST_ASSERT_EQUAL_UINT32(20, ring.head());
+    TEST_ASSERT_EQUAL_UINT32(12, ring.oldest());
+    TEST_ASSERT_EQUAL(8, ring.size());
+
+    LogRing<Text<32>, 8>::Entry e;
+    TEST_ASSERT_FALSE(ring.read(11, e));  // overwritten
+    for (uint32_t seq = ring.oldest(); seq != ring.head(); seq++) {
+        TEST_ASSERT_TRUE(ring.read(seq, e));
+        snprintf(msg, sizeof(msg), "msg %u", (unsigned)seq);
+        TEST_ASSERT_EQUAL_UINT32(seq, e.seq);
+        TEST_ASSERT_EQUAL_UINT32(seq * 10, e.timestamp);
+        TEST_ASSERT_EQUAL_STRING(msg, e.payload.message);
+    }
+
+    ring.clear();
+    TEST_ASSERT_EQUAL(0, ring.size());
+    appendText(ring, 0, 1, "[TEST]", "after clear");
+    TEST_ASSERT_EQUAL(1, ring.size());
+    TEST_ASSERT_EQUAL_UINT32(0, ring.dropped());
+}
+
+static void test_truncation_and_interning() {
+    static LogRing<Text<8>, 4, 2> ring;
+    appendText(ring, 0, 0, "[A]", "0123456789");
+    appendText(ring, 0, 0, "[B]", "x");
+    appendText(ring, 0, 0, "[A]", "y");
+    appendText(ring, 0, 0, "[C]", "z");  // source table full
+
+    LogRing<Text<8>, 4, 2>::Entry e;
+    TEST_ASSERT_TRUE(ring.read(0, e));
+    TEST_ASSERT_EQUAL_STRING("0123456", e.payload.message);
+    TEST_ASSERT_EQUAL_STRING("[A]", ring.sourceName(e.source));
+    TEST_ASSERT_TRUE(ring.read(2, e));
+    TEST_ASSERT_EQUAL_UINT8(0, e.source);
+    TEST_ASSERT_TRUE(ring.read(3, e));
+    TEST_ASSERT_EQUAL_STRING("?", ring.sourceName(e.source));
+}
+
+static void test_deferred_format() {
+    LogRecord r;
+    char out[96];
+    char temp[16] = "temporary";
+    r.capture("az=%.2f steps=%ld pos=%lu n=%d u=%u s=%s %%", 12.345f, -42L, 7UL, -3, 5u, temp);
+    temp[0] = 'X';  // record must hold its own copy
+    formatLogRecord(r, out, sizeof(out));
+    TEST_ASSERT_EQUAL_STRING("az=12.35 steps=-42 pos=7 n=-3 u=5 s=temporary %", out);
+
+    r.capture("missing %d and %s", 1);
+    formatLogRecord(r, out, sizeof(out));
+    TEST_ASSERT_EQUAL_STRING("missing 1 and %s", out);
+
+    r.begin("100% literal", true);
+    formatLogRecord(r, out, sizeof(out));
+    TEST_ASSERT_EQUAL_STRING("100% literal", out);
+
+    r.capture("%s", "this message is longer than the output buffer");
+    TEST_ASSERT_EQUAL(15, formatLogRecord(r, out, 16));
+    TEST_ASSERT_EQUAL_STRING("this message is", out);
+}
+
+// Each producer encodes its id in level and a counter in timestamp and the
+// message, so a reader can spot an entry mixed from two writers.
+typedef LogRing<Text<128>, 100> BenchRing;
+static constexpr uint32_t BENCH_APPENDS_PER_THREAD = 200000;
+
+static void runContention(int producers) {
+    static BenchRing ring;
+    ring.clear();
+    uint32_t droppedBefore = ring.dropped();
+    std::atomic<bool> done{false};
+    std::atomic<uint32_t> torn{0};
+    std::atomic<uint32_t> reads{0};
+
+    std::thread reader([&] {
+        BenchRing::Entry e;
+        char expect[128];
+        while (!done.load(std::memory_order_relaxed)) {
+            for (uint32_t seq = ring.oldest(); seq != ring.head(); seq++) {
+                if (!ring.read(seq, e)) continue;
+                snprintf(expect, sizeof(expect), "producer %u line %u",
+                         (unsigned)e.level, (unsigned)e.timestamp);
+                if (e.seq != seq || strcmp(expect, e.payload.message) != 0) torn++;
+                reads++;
+            }
+        }
+    });
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([p] {
+            char msg[128];
+            char source[16];
+            snprintf(source, sizeof(source), "[P%d]", p);
+            for (uint32_t i = 0; i < BENCH_APPENDS_PER_THREAD; i++) {
+                snprintf(msg, sizeof(msg), "producer %u line %u", (unsigned)p, (unsigned)i);
+                appendText(ring, i, (uint8_t)p, source, msg);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    done = true;
+    reader.join();
+
+    uint32_t total = producers * BENCH_APPENDS_PER_THREAD;
+    uint32_t dropped = ring.dropped() - droppedBefore;
+    printf("[BENCH] %d producer(s): %.2f M appends/s, %u dropped (%.3f%%), %u reads checked\n",
+           producers, total / secs / 1e6, (unsigned)dropped, 100.0 * dropped / total,
+           (unsigned)reads.load());
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+}
+
+static void test_contention_1() { runContention(1); }
+static void test_contention_2() { runContention(2); }
+static void test_contention_4() { runContention(4); }
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_order_and_wrap);
+    RUN_TEST(test_truncation_and_interning);
+    RUN_TEST(test_deferred_format);
+    RUN_TEST(test_contention_1);
+    RUN_TEST(test_contention_2);
+    RUN_TEST(test_contention_4);
+    return UNITY_END();
+}
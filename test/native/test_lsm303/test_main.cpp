@@ -0,0 +1,133 @@
+// LSM303Receiver.cpp on the native HAL: packet parsing, tilt-compensated
+// heading, calibration range, smoothing and the UDP socket. pio test -e native
+#include <unity.h>
+#include <arpa/inet.h>
+#include <cmath>
+#include <cstdio>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "hal/native/NativeBoard.h"
+#include "LSM303Receiver.h"
+
+extern LSM303Receiver lsmReceiver;
+
+// Field and gravity vectors that decode to the given heading and elevation
+static int formatPacket(char* out, size_t len, float headingDeg, float elevationDeg) {
+    float h = headingDeg * PI / 180.0f;
+    float e = elevationDeg * PI / 180.0f;
+    float ax = cosf(e), ay = 0.0f, az = sinf(e);
+    float pitch = asinf(-ax);
+    float roll = atan2f(ay, az);
+    float mx = cosf(h) * cosf(pitch);
+    float mz = cosf(h) * sinf(pitch);
+    float my = sinf(h) / cosf(roll);
+    return snprintf(out, len, "MAG:%.5f,%.5f,%.5f;ACC:%.5f,%.5f,%.5f", mx, my, mz, ax, ay, az);
+}
+
+static void inject(float headingDeg, float elevationDeg) {
+    char packet[128];
+    int n = formatPacket(packet, sizeof(packet), headingDeg, elevationDeg);
+    hal::sim::injectUdp(NATIVE_LSM_PORT, packet, n);
+    lsmReceiver.update();
+}
+
+void setUp() {
+    lsmReceiver.resetCalibration();
+}
+void tearDown() {}
+
+static void test_decodes_heading_and_elevation() {
+    const float cases[][2] = {{0.0f, 30.0f}, {90.0f, 45.0f}, {181.5f, 10.0f}, {270.0f, 60.0f}, {359.0f, 80.0f}};
+    for (const auto& c : cases) {
+        uint32_t before = lsmReceiver.getPacketCount();
+        inject(c[0], c[1]);
+        TEST_ASSERT_EQUAL_UINT32(before + 1, lsmReceiver.getPacketCount());
+        float az = lsmReceiver.getRawAzimuth();
+        if (c[0] > 358.0f && az < 2.0f) az += 360.0f;
+        TEST_ASSERT_FLOAT_WITHIN(0.1f, c[0], az);
+        TEST_ASSERT_FLOAT_WITHIN(0.1f, c[1], lsmReceiver.getRawElevation());
+        TEST_ASSERT_EQUAL_UINT32(millis(), lsmReceiver.getLastUpdate());
+    }
+}
+
+static void test_rejects_malformed_packets() {
+    const char* bad[] = {"", "MAG:1,2,3", "ACC:0,0,1;MAG:1,0,0", "MAG:1,x,3;ACC:0,0,1", "hello"};
+    uint32_t before = lsmReceiver.getPacketCount();
+    float az = lsmReceiver.getRawAzimuth();
+    for (const char* p : bad) {
+        hal::sim::injectUdp(NATIVE_LSM_PORT, p, strlen(p));
+        lsmReceiver.update();
+    }
+    TEST_ASSERT_EQUAL_UINT32(before, lsmReceiver.getPacketCount());
+    TEST_ASSERT_EQUAL_FLOAT(az, lsmReceiver.getRawAzimuth());
+}
+
+static void test_smoothing_converges() {
+    for (int i = 0; i < 50; i++) inject(120.0f, 20.0f);
+    float settled = lsmReceiver.getAzimuth();
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 120.0f, settled);
+
+    // One step of the exponential filter (alpha 0.2)
+    inject(130.0f, 20.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, settled + 0.2f * (130.0f - settled), lsmReceiver.getAzimuth());
+}
+
+static void test_calibration_range() {
+    lsmReceiver.startCalibration();
+    TEST_ASSERT_TRUE(lsmReceiver.isCalibrating());
+    for (float h = 10.0f; h <= 350.0f; h += 5.0f) inject(h, -60.0f + (h / 350.0f) * 140.0f);
+    lsmReceiver.stopCalibration();
+    TEST_ASSERT_FALSE(lsmReceiver.isCalibrating());
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 10.0f, lsmReceiver.getAzMin());
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 350.0f, lsmReceiver.getAzMax());
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, -56.0f, lsmReceiver.getElMin());
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 80.0f, lsmReceiver.getElMax());
+
+    // Offset is the middle of the seen range, scale stretches it to 360 deg
+    for (int i = 0; i < 60; i++) inject(180.0f, 0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 0.0f, lsmReceiver.getAzimuth());
+}
+
+static void test_sample_hook_sees_raw_values() {
+    static float hookAz = -1.0f, hookEl = -1.0f;
+    lsmReceiver.setSampleHook([](float rawAz, float rawEl, void*) { hookAz = rawAz; hookEl = rawEl; }, nullptr);
+    inject(45.0f, 15.0f);
+    lsmReceiver.setSampleHook(nullptr, nullptr);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 45.0f, hookAz);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 15.0f, hookEl);
+}
+
+// The same path over a real loopback datagram
+static void test_receives_over_udp() {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_TRUE(fd >= 0);
+    sockaddr_in to = {};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(NATIVE_LSM_PORT);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    char packet[128];
+    int n = formatPacket(packet, sizeof(packet), 200.0f, 35.0f);
+    TEST_ASSERT_EQUAL(n, sendto(fd, packet, n, 0, (sockaddr*)&to, sizeof(to)));
+    close(fd);
+
+    uint32_t before = lsmReceiver.getPacketCount();
+    for (int i = 0; i < 100 && lsmReceiver.getPacketCount() == before; i++) {
+        usleep(1000);
+        lsmReceiver.update();
+    }
+    TEST_ASSERT_EQUAL_UINT32(before + 1, lsmReceiver.getPacketCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 200.0f, lsmReceiver.getRawAzimuth());
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 35.0f, lsmReceiver.getRawElevation());
+}
+
+int main() {
+    nativeSetup(false);
+    UNITY_BEGIN();
+    RUN_TEST(test_decodes_heading_and_elevation);
+    RUN_TEST(test_rejects_malformed_packets);
+    RUN_TEST(test_smoothing_converges);
+    RUN_TEST(test_calibration_range);
+    RUN_TEST(test_sample_hook_sees_raw_values);
+    RUN_TEST(test_receives_over_udp);
+    return UNITY_END();
+}
@@ -0,0 +1,75 @@
+// /metrics scraped through writeMetrics(), as the web handler does; the
+// host build stands in an empty writeSystemMetrics() for the ESP32-only
+// families.
+// pio test -e native -f native/test_metrics
+#include <unity.h>
+#include <string>
+#include "hal/native/NativeBoard.h"
+#include "Latency.h"
+#include "Metrics.h"
+
+void setUp() {}
+void tearDown() {}
+
+class TextSink : public Print {
+public:
+    size_t write(uint8_t c) override {
+        text += (char)c;
+        return 1;
+    }
+    using Print::write;
+
+    std::string text;
+};
+
+static bool hasLine(const std::string& text, const std::string& line) {
+    return text.find("\n" + line + "\n") != std::string::npos || text.compare(0, line.size() + 1, line + "\n") == 0;
+}
+
+static std::string scrape() {
+    TextSink sink;
+    writeMetrics(sink);
+    return sink.text;
+}
+
+static void test_latency_histograms_are_exported() {
+    LatencyHistogram* h = latencyRegistry.add("test site");
+    TEST_ASSERT_NOT_NULL(h);
+    h->record(3);       // [2, 4) us
+    h->record(3);
+    h->record(1000);    // [512, 1024) us
+
+    std::string text = scrape();
+    TEST_ASSERT_TRUE(hasLine(text, "# TYPE rotator_latency_seconds histogram"));
+    TEST_ASSERT_TRUE(hasLine(text, "rotator_latency_seconds_bucket{site=\"test site\",le=\"2e-06\"} 0"));
+    TEST_ASSERT_TRUE(hasLine(text, "rotator_latency_seconds_bucket{site=\"test site\",le=\"4e-06\"} 2"));
+    TEST_ASSERT_TRUE(hasLine(text, "rotator_latency_seconds_bucket{site=\"test site\",le=\"0.001024\"} 3"));
+    TEST_ASSERT_TRUE(hasLine(text, "rotator_latency_seconds_bucket{site=\"test site\",le=\"+Inf\"} 3"));
+    TEST_ASSERT_TRUE(hasLine(text, "rotator_latency_seconds_count{site=\"test site\"} 3"));
+    TEST_ASSERT_TRUE(hasLine(text, "rotator_latency_seconds_sum{site=\"test site\"} 0.001006"));
+}
+
+// Every family the portable part writes, once each
+static void test_families_are_described_once() {
+    std::string text = scrape();
+    const char* families[] = {
+        "rotator_uptime_seconds", "rotator_rotctl_commands_total", "rotator_lsm_packets_total",
+        "rotator_motion_running", "rotator_loop_max_seconds", "rotator_log_dropped_total",
+        "rotator_alloc_total", "rotator_alloc_violations_total", "rotator_latency_seconds",
+    };
+    for (const char* f : families) {
+        std::string help = std::string("# HELP ") + f + " ";
+        size_t at = text.find(help);
+        TEST_ASSERT_TRUE_MESSAGE(at != std::string::npos, f);
+        TEST_ASSERT_TRUE_MESSAGE(text.find(help, at + 1) == std::string::npos, f);
+    }
+    TEST_ASSERT_TRUE(hasLine(text, "rotator_alloc_total{subsystem=\"web\"} 0"));
+}
+
+int main() {
+    nativeSetup(false);
+    UNITY_BEGIN();
+    RUN_TEST(test_latency_histograms_are_exported);
+    RUN_TEST(test_families_are_described_once);
+    return UNITY_END();
+}
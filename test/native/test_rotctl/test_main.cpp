@@ -0,0 +1,110 @@
+// rotctl_sever.cpp on the native HAL: a hamlib-style client on a real
+// loopback TCP connection, answered from the telemetry snapshot. pio test -e native
+#include <unity.h>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "hal/native/NativeBoard.h"
+#include "MotorControl.h"
+#include "rotctl_server.h"
+
+static int client = -1;
+
+static void connectClient() {
+    client = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(NATIVE_ROTCTL_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL(0, connect(client, (sockaddr*)&addr, sizeof(addr)));
+    nativeRunFor(5);
+}
+
+// Sends one command and collects the reply ("p" answers two lines); the
+// firmware is serviced from nativeLoop() while we wait
+static void transact(const char* command, char* reply, size_t len) {
+    TEST_ASSERT_EQUAL((ssize_t)strlen(command), send(client, command, strlen(command), 0));
+    int expectLines = command[0] == 'p' ? 2 : 1;
+    int lines = 0;
+    size_t got = 0;
+    for (int i = 0; i < 200 && lines < expectLines && got < len - 1; i++) {
+        nativeRunFor(1);
+        ssize_t n = recv(client, reply + got, len - 1 - got, MSG_DONTWAIT);
+        for (ssize_t k = 0; k < n; k++) lines += reply[got + k] == '\n';
+        if (n > 0) got += n;
+        else usleep(200);
+    }
+    reply[got] = '\0';
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_connect_sets_flag() {
+    TEST_ASSERT_FALSE(rotctlConnected);
+    connectClient();
+    TEST_ASSERT_TRUE(rotctlConnected);
+}
+
+static void test_get_position() {
+    char reply[64];
+    transact("p\n", reply, sizeof(reply));
+    TEST_ASSERT_EQUAL_STRING("0.00\n0.00\n", reply);
+    TEST_ASSERT_EQUAL_UINT32(1, rotctlStats[ROTCTL_GET_POS].count);
+}
+
+static void test_set_position_moves_motors() {
+    char reply[64];
+    transact("P 90.0 45.0\n", reply, sizeof(reply));
+    TEST_ASSERT_EQUAL_STRING(ROTCTL_REPLY_OK, reply);
+    TEST_ASSERT_EQUAL_INT32(azToSteps(90.0f), azMotor->targetPos());
+    TEST_ASSERT_EQUAL_INT32(elToSteps(45.0f), elMotor1->targetPos());
+    TEST_ASSERT_EQUAL_INT32(elToSteps(45.0f), elMotor2->targetPos());
+
+    // Run the move out and read the position back through the snapshot
+    nativeRunFor(20000);
+    TEST_ASSERT_FALSE(azMotor->isRunning());
+    transact("p\n", reply, sizeof(reply));
+    TEST_ASSERT_EQUAL_STRING("90.00\n45.00\n", reply);
+}
+
+static void test_set_position_is_clamped() {
+    char reply[64];
+    transact("P 500 -10\n", reply, sizeof(reply));
+    TEST_ASSERT_EQUAL_STRING(ROTCTL_REPLY_OK, reply);
+    TEST_ASSERT_EQUAL_INT32(azToSteps(MAX_AZ), azMotor->targetPos());
+    TEST_ASSERT_EQUAL_INT32(elToSteps(MIN_EL), elMotor1->targetPos());
+}
+
+static void test_errors_are_counted() {
+    char reply[64];
+    uint32_t setErrors = rotctlStats[ROTCTL_SET_POS].errors;
+    transact("P 12\n", reply, sizeof(reply));
+    TEST_ASSERT_EQUAL_STRING(ROTCTL_REPLY_ERROR, reply);
+    transact("S\n", reply, sizeof(reply));
+    TEST_ASSERT_EQUAL_STRING(ROTCTL_REPLY_ERROR, reply);
+    TEST_ASSERT_EQUAL_UINT32(setErrors + 1, rotctlStats[ROTCTL_SET_POS].errors);
+    TEST_ASSERT_EQUAL_UINT32(1, rotctlStats[ROTCTL_UNKNOWN].count);
+    TEST_ASSERT_EQUAL_UINT32(1, rotctlStats[ROTCTL_UNKNOWN].errors);
+    TEST_ASSERT_EQUAL_UINT32(2, rotctlStats[ROTCTL_GET_POS].count);
+}
+
+static void test_disconnect_clears_flag() {
+    close(client);
+    nativeRunFor(5);
+    TEST_ASSERT_FALSE(rotctlConnected);
+}
+
+int main() {
+    nativeSetup();
+    UNITY_BEGIN();
+    RUN_TEST(test_connect_sets_flag);
+    RUN_TEST(test_get_position);
+    RUN_TEST(test_set_position_moves_motors);
+    RUN_TEST(test_set_position_is_clamped);
+    RUN_TEST(test_errors_are_counted);
+    RUN_TEST(test_disconnect_clears_flag);
+    return UNITY_END();
+}
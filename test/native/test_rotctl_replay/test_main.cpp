@@ -0,0 +1,197 @@
+// rotctl session capture and replay against the simulator. Set
+// ROTCTL_CAPTURE=<file> (from /rotctl/capture) to replay a field session,
+// ROTCTL_REPLAY_SPEED=1 to run it in real time.
+// pio test -e native -f native/test_rotctl_replay
+#include <unity.h>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "hal/native/NativeBoard.h"
+#include "sim/RotatorSim.h"
+#include "sim/RotctlReplay.h"
+#include "Homing.h"
+#include "MathUtils.h"
+#include "MotorControl.h"
+#include "RotctlRecorder.h"
+
+static RotatorSim sim{SimAxisConfig(), SimAxisConfig(), SimSensorConfig()};
+
+static int connectClient() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(NATIVE_ROTCTL_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL(0, connect(fd, (sockaddr*)&addr, sizeof(addr)));
+    nativeRunFor(5);
+    return fd;
+}
+
+static void sendAndRun(int fd, const char* data, size_t len) {
+    send(fd, data, len, 0);
+    nativeRunFor(5);
+    char sink[64];
+    while (recv(fd, sink, sizeof(sink), MSG_DONTWAIT) > 0) {}
+}
+
+static std::string captureText() {
+    std::string text;
+    char line[ROTCTL_REC_LINE_LEN];
+    for (size_t i = 0; i < rotctlRecorder.count(); i++) {
+        formatRotctlEvent(line, sizeof(line), rotctlRecorder.event(i));
+        text += line;
+        text += '\n';
+    }
+    return text;
+}
+
+static void printReport(const char* what, const RotctlReplayReport& r) {
+    char line[384];
+    formatRotctlReport(line, sizeof(line), r);
+    printf("[ROTCTL] %s: %s\n", what, line);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_event_text_round_trip() {
+    RotctlEvent e = {123456, 7, ROTCTL_EVENT_DATA, 0, {}};
+    const char raw[] = "P 1\\2\r\n\x01";
+    memcpy(e.data, raw, sizeof(raw) - 1);
+    e.len = sizeof(raw) - 1;
+    char line[ROTCTL_REC_LINE_LEN];
+    formatRotctlEvent(line, sizeof(line), e);
+    TEST_ASSERT_EQUAL_STRING("123456 7 D P 1\\\\2\\r\\n\\x01", line);
+
+    RotctlEvent back;
+    TEST_ASSERT_TRUE(parseRotctlEvent(line, back));
+    TEST_ASSERT_EQUAL_UINT32(e.tUs, back.tUs);
+    TEST_ASSERT_EQUAL_UINT8(7, back.client);
+    TEST_ASSERT_EQUAL_UINT8(e.len, back.len);
+    TEST_ASSERT_TRUE(memcmp(e.data, back.data, e.len) == 0);
+
+    TEST_ASSERT_TRUE(parseRotctlEvent("5 0 X", back));
+    TEST_ASSERT_EQUAL(ROTCTL_EVENT_DISCONNECT, back.kind);
+    TEST_ASSERT_FALSE(parseRotctlEvent("5 0 Q", back));
+    TEST_ASSERT_FALSE(parseRotctlEvent("5 0 D bad\\q", back));
+}
+
+// The server records what real clients send, reconnects included
+static void test_server_records_sessions() {
+    TEST_ASSERT_TRUE(rotctlRecorder.start());
+    int a = connectClient();
+    sendAndRun(a, "p\n", 2);
+    sendAndRun(a, "P 10.0 20.0\n", 12);
+    close(a);
+    nativeRunFor(5);
+    int b = connectClient();
+    sendAndRun(b, "p\n", 2);
+    close(b);
+    nativeRunFor(5);
+    rotctlRecorder.stop();
+
+    RotctlSession session;
+    TEST_ASSERT_TRUE(parseRotctlSession(captureText().c_str(), session));
+    TEST_ASSERT_EQUAL_UINT32(7, session.events.size());
+    const char kinds[] = "CDDXCDX";
+    for (size_t i = 0; i < session.events.size(); i++) {
+        const RotctlEvent& e = session.events[i];
+        TEST_ASSERT_EQUAL_UINT8(kinds[i] == 'C' ? ROTCTL_EVENT_CONNECT : kinds[i] == 'D' ? ROTCTL_EVENT_DATA : ROTCTL_EVENT_DISCONNECT, e.kind);
+        TEST_ASSERT_EQUAL_UINT8(i < 4 ? 0 : 1, e.client);
+        if (i) TEST_ASSERT_TRUE(e.tUs > session.events[i - 1].tUs);
+    }
+    TEST_ASSERT_EQUAL_UINT8(12, session.events[2].len);
+    TEST_ASSERT_TRUE(memcmp("P 10.0 20.0\n", session.events[2].data, 12) == 0);
+}
+
+// A gpredict-style pass: P every second, p every 250 ms, a "p" storm,
+// a reconnect in the middle and one malformed command
+static std::string syntheticSession() {
+    std::string s = "# synthetic gpredict session\n";
+    char line[96];
+    uint32_t t = 1000000;
+    uint8_t client = 0;
+    snprintf(line, sizeof(line), "%u %u C\n", t, client);
+    s += line;
+    for (int sec = 0; sec < 300; sec++) {
+        float az = 100.0f + sec * 0.5f;
+        float el = 10.0f + 50.0f * sinf(PI * sec / 300.0f);
+        uint32_t base = t + sec * 1000000u;
+        snprintf(line, sizeof(line), "%u %u D P %.2f %.2f\\n\n", base, client, az, el);
+        s += line;
+        for (int q = 1; q < 4; q++) {
+            snprintf(line, sizeof(line), "%u %u D p\\n\n", base + q * 250000u, client);
+            s += line;
+        }
+        if (sec == 100) {
+            for (int k = 0; k < 100; k++) {
+                snprintf(line, sizeof(line), "%u %u D p\\n\n", base + 900000u + k * 500u, client);
+                s += line;
+            }
+        }
+        if (sec == 200) {
+            snprintf(line, sizeof(line), "%u %u X\n%u %u C\n", base + 800000u, client, base + 850000u, client + 1);
+            s += line;
+            client++;
+        }
+        if (sec == 250) {
+            snprintf(line, sizeof(line), "%u %u D P 12\\n\n", base + 600000u, client);
+            s += line;
+        }
+    }
+    snprintf(line, sizeof(line), "%u %u X\n", t + 300000000u, client);
+    s += line;
+    return s;
+}
+
+static void test_replay_synthetic_session() {
+    sim.powerOn();
+    homeAll();
+    TEST_ASSERT_TRUE(sim.runUntil([] { return homingStage != HOMING_RUNNING; }, 60000));
+    TEST_ASSERT_EQUAL(HOMING_COMPLETE, homingStage);
+    // Parked at the start of the pass, as gpredict leaves it before AOS
+    moveAzimuthToPosition(100.0f);
+    moveElevationToPosition(10.0f);
+    TEST_ASSERT_TRUE(sim.runUntil(areMotorsReady, 60000));
+
+    RotctlSession session;
+    TEST_ASSERT_TRUE(parseRotctlSession(syntheticSession().c_str(), session));
+    RotctlReplayReport r = replayRotctlSession(session, sim);
+    printReport("synthetic pass", r);
+
+    TEST_ASSERT_EQUAL_UINT32(2, r.connects);
+    TEST_ASSERT_EQUAL_UINT32(300 * 4 + 100 + 1, r.packets);
+    TEST_ASSERT_EQUAL_UINT32(r.packets, r.replies);
+    TEST_ASSERT_EQUAL_UINT32(0, r.missing);
+    TEST_ASSERT_EQUAL_UINT32(1, r.errors);
+    TEST_ASSERT_FLOAT_WITHIN(1.0, 300.0, r.simSeconds);
+    TEST_ASSERT_TRUE(r.trackRmsDeg < 1.0f);
+    TEST_ASSERT_TRUE(r.trackMaxDeg < 2.0f);
+    TEST_ASSERT_TRUE(r.latencyP99Us < 50000);
+}
+
+static void test_replay_field_capture() {
+    const char* path = getenv("ROTCTL_CAPTURE");
+    if (!path || !*path) return;
+    RotctlSession session;
+    TEST_ASSERT_TRUE_MESSAGE(loadRotctlSession(path, session), path);
+    RotctlReplayOptions options;
+    const char* speed = getenv("ROTCTL_REPLAY_SPEED");
+    if (speed) options.speed = atof(speed);
+    printReport(path, replayRotctlSession(session, sim, options));
+}
+
+int main() {
+    nativeSetup();
+    sim.attach();
+    UNITY_BEGIN();
+    RUN_TEST(test_event_text_round_trip);
+    RUN_TEST(test_server_records_sessions);
+    RUN_TEST(test_replay_synthetic_session);
+    RUN_TEST(test_replay_field_capture);
+    return UNITY_END();
+}
@@ -0,0 +1,244 @@
+// Scan pattern geometry and the on-point runner against the simulated
+// rotator. pio test -e native
+#include <unity.h>
+#include <math.h>
+#include <cstring>
+#include <vector>
+#include "hal/native/NativeBoard.h"
+#include "sim/SimFixture.h"
+#include "Homing.h"
+#include "JsonWriter.h"
+#include "MotorControl.h"
+#include "ScanPattern.h"
+#include "WallClock.h"
+
+static RotatorSim& sim = simRig();
+
+static ScanParams params(ScanKind kind, float width, float height, float step) {
+    ScanParams p;
+    p.kind = kind;
+    p.centerAz = 100.0f;
+    p.centerEl = 30.0f;
+    p.width = width;
+    p.height = height;
+    p.step = step;
+    return p;
+}
+
+static ScanPoint pointAt(const ScanParams& p, uint32_t i) {
+    ScanPoint pt = {};
+    TEST_ASSERT_TRUE(scanPoint(p, i, pt));
+    return pt;
+}
+
+void setUp() {
+    TEST_ASSERT_TRUE(resetHomed(sim));
+    ScanMarker m;
+    while (scanRunner.readMarker(m)) {}
+}
+void tearDown() {
+    scanRunner.stop();
+    sim.run(2);
+}
+
+static void test_grid_patterns() {
+    ScanParams p = params(SCAN_RASTER, 2.0f, 2.0f, 1.0f);
+    TEST_ASSERT_EQUAL_UINT32(9, scanPointCount(p));
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, pointAt(p, 0).x);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, pointAt(p, 0).y);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, pointAt(p, 2).x);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, pointAt(p, 3).x);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pointAt(p, 3).y);
+    ScanPoint out;
+    TEST_ASSERT_FALSE(scanPoint(p, 9, out));
+
+    // Alternate rows run back; extents round down to whole steps
+    p.kind = SCAN_BOUSTROPHEDON;
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, pointAt(p, 3).x);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, pointAt(p, 5).x);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, pointAt(p, 6).x);
+    p.width = 2.5f;
+    TEST_ASSERT_EQUAL_UINT32(9, scanPointCount(p));
+
+    p = params(SCAN_CROSS, 2.0f, 4.0f, 1.0f);
+    TEST_ASSERT_EQUAL_UINT32(8, scanPointCount(p));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, pointAt(p, 2).x);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pointAt(p, 3).x);
+    TEST_ASSERT_EQUAL_FLOAT(-2.0f, pointAt(p, 3).y);
+
+    p = params(SCAN_ONOFF, 5.0f, 0.0f, 1.0f);
+    p.cycles = 3;
+    TEST_ASSERT_EQUAL_UINT32(6, scanPointCount(p));
+    TEST_ASSERT_TRUE(pointAt(p, 2).on);
+    TEST_ASSERT_FALSE(pointAt(p, 3).on);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, pointAt(p, 3).x);
+}
+
+static void test_spiral_and_sky_spacing() {
+    ScanParams p = params(SCAN_SPIRAL, 4.0f, 4.0f, 1.0f);
+    uint32_t n = scanPointCount(p);
+    TEST_ASSERT_EQUAL_UINT32(13, n);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pointAt(p, 0).x);
+    for (uint32_t i = 1; i < n; i++) {
+        ScanPoint a = pointAt(p, i - 1), b = pointAt(p, i);
+        TEST_ASSERT_TRUE(hypotf(b.x, b.y) <= 2.0f);
+        if (i >= 2) TEST_ASSERT_FLOAT_WITHIN(0.3f, 1.0f, hypotf(b.x - a.x, b.y - a.y));
+    }
+
+    // One degree on the sky at EL 60 is two degrees of AZ
+    p = params(SCAN_CROSS, 2.0f, 0.0f, 1.0f);
+    p.centerEl = 60.0f;
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 102.0f, pointAt(p, 2).az);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 60.0f, pointAt(p, 2).el);
+}
+
+static void test_parameter_checks() {
+    TEST_ASSERT_NULL(checkScanParams(params(SCAN_RASTER, 4.0f, 4.0f, 0.5f)));
+    TEST_ASSERT_NOT_NULL(checkScanParams(params(SCAN_RASTER, 4.0f, 4.0f, 0.0f)));
+    TEST_ASSERT_NOT_NULL(checkScanParams(params(SCAN_RASTER, -1.0f, 4.0f, 1.0f)));
+    TEST_ASSERT_NOT_NULL(checkScanParams(params(SCAN_RASTER, 100.0f, 100.0f, 0.01f)));   // too many
+    ScanParams p = params(SCAN_RASTER, 4.0f, 4.0f, 1.0f);
+    p.centerEl = MAX_EL - 1;
+    TEST_ASSERT_NOT_NULL(checkScanParams(p));
+    p.centerEl = 30.0f;
+    p.dwellMs = SCAN_MAX_DWELL_MS + 1;
+    TEST_ASSERT_NOT_NULL(checkScanParams(p));
+    ScanKind kind;
+    TEST_ASSERT_TRUE(parseScanKind("boustrophedon", kind));
+    TEST_ASSERT_EQUAL(SCAN_BOUSTROPHEDON, kind);
+    TEST_ASSERT_FALSE(parseScanKind("zigzag", kind));
+}
+
+// Markers land when both axes have stopped on the point, and the next
+// move starts dwellMs later
+static void test_raster_on_point_markers() {
+    TEST_ASSERT_TRUE(wallClock.set((uint64_t)SIM_T0_UNIX * 1000));
+    ScanParams p = params(SCAN_BOUSTROPHEDON, 4.0f, 4.0f, 2.0f);
+    p.dwellMs = 500;
+    TEST_ASSERT_NULL(scanRunner.start(p));
+    TEST_ASSERT_TRUE(scanRunner.isRunning());
+
+    std::vector<ScanMarker> markers;
+    std::vector<uint32_t> departures;
+    bool wasIdle = false;
+    for (uint32_t t = 0; t < 60000 && scanRunner.isRunning(); t++) {
+        sim.run(1);
+        ScanMarker m;
+        while (scanRunner.readMarker(m)) {
+            markers.push_back(m);
+            if (m.flags & SCAN_MARK_END) continue;
+            TEST_ASSERT_TRUE(motorsIdle());
+            TEST_ASSERT_FLOAT_WITHIN(0.02f, m.at.az, stepsToAz(azMotor->getCurrentPosition()));
+            TEST_ASSERT_FLOAT_WITHIN(0.02f, m.at.el, stepsToEl(elMotor1->getCurrentPosition()));
+        }
+        bool idle = motorsIdle();
+        if (wasIdle && !idle && !markers.empty()) departures.push_back(millis());
+        wasIdle = idle;
+    }
+    TEST_ASSERT_FALSE(scanRunner.isRunning());
+    TEST_ASSERT_EQUAL(10, markers.size());
+    TEST_ASSERT_EQUAL(8, departures.size());
+    for (uint32_t i = 0; i < 9; i++) {
+        const ScanMarker& m = markers[i];
+        TEST_ASSERT_EQUAL_UINT32(i, m.point);
+        TEST_ASSERT_EQUAL_UINT32(9, m.points);
+        TEST_ASSERT_EQUAL_UINT8(0, m.flags);
+        TEST_ASSERT_TRUE(m.at.on);
+        TEST_ASSERT_EQUAL_UINT32(500, m.dwellMs);
+        if (i > 0) {
+            TEST_ASSERT_EQUAL_UINT32(markers[i - 1].seq + 1, m.seq);
+            TEST_ASSERT_TRUE(m.unixMs - markers[i - 1].unixMs == m.ms - markers[i - 1].ms);
+        }
+        if (i < 8) TEST_ASSERT_UINT32_WITHIN(1, m.ms + p.dwellMs, departures[i]);
+    }
+    TEST_ASSERT_TRUE(markers[0].unixMs >= (uint64_t)SIM_T0_UNIX * 1000);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 30.0f, markers[5].at.el);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -2.0f, markers[5].at.x);   // second row runs back
+    TEST_ASSERT_EQUAL_UINT8(SCAN_MARK_END, markers[9].flags);
+    TEST_ASSERT_EQUAL_UINT32(9, markers[9].point);
+    TEST_ASSERT_TRUE(markers[9].ms - markers[8].ms >= p.dwellMs);
+}
+
+static void test_stop_and_estop_end_the_scan() {
+    ScanParams p = params(SCAN_ONOFF, 10.0f, 0.0f, 1.0f);
+    p.dwellMs = 200;
+    p.cycles = 10;
+    TEST_ASSERT_NULL(scanRunner.start(p));
+    ScanMarker m;
+    TEST_ASSERT_TRUE(sim.runUntil([&] { return scanRunner.readMarker(m) && m.point == 1; }, 20000));
+    TEST_ASSERT_FALSE(m.at.on);
+    scanRunner.stop();
+    sim.run(2);
+    TEST_ASSERT_FALSE(scanRunner.isRunning());
+    TEST_ASSERT_TRUE(scanRunner.readMarker(m));
+    TEST_ASSERT_EQUAL_UINT8(SCAN_MARK_END | SCAN_MARK_ABORTED, m.flags);
+    TEST_ASSERT_EQUAL_UINT32(1, m.point);
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 10000));
+    sim.run(p.dwellMs * 2);
+    TEST_ASSERT_TRUE(motorsIdle());   // nothing left to command the next point
+
+    TEST_ASSERT_NULL(scanRunner.start(p));
+    sim.run(10);
+    emergencyStop();
+    sim.run(2);
+    TEST_ASSERT_FALSE(scanRunner.isRunning());
+    TEST_ASSERT_TRUE(motorsIdle());
+    TEST_ASSERT_EQUAL_STRING("not homed", scanRunner.start(p));
+}
+
+// A stop or e-stop before the stepper task has taken the start
+static void test_stop_before_the_first_tick() {
+    ScanParams p = params(SCAN_RASTER, 4.0f, 4.0f, 2.0f);
+    TEST_ASSERT_NULL(scanRunner.start(p));
+    scanRunner.stop();
+    TEST_ASSERT_FALSE(scanRunner.isRunning());
+    sim.run(5);
+    TEST_ASSERT_FALSE(scanRunner.isRunning());
+    TEST_ASSERT_TRUE(motorsIdle());
+    ScanMarker m;
+    TEST_ASSERT_FALSE(scanRunner.readMarker(m));
+
+    TEST_ASSERT_NULL(scanRunner.start(p));
+    emergencyStop();
+    sim.run(5);
+    TEST_ASSERT_FALSE(scanRunner.isRunning());
+    TEST_ASSERT_TRUE(motorsIdle());
+}
+
+static void test_marker_json() {
+    ScanMarker m = {};
+    m.seq = 7;
+    m.point = 3;
+    m.points = 9;
+    m.at = {-2.0f, 0.0f, 97.69f, 30.0f, true};
+    m.ms = 123456;
+    m.unixMs = (uint64_t)SIM_T0_UNIX * 1000 + 250;
+    m.dwellMs = 500;
+    char buf[256];
+    JsonBuffer json(buf, sizeof(buf));
+    writeScanMarkerJSON(json, m);
+    TEST_ASSERT_FALSE(json.overflowed());
+    TEST_ASSERT_EQUAL_STRING("{\"t\":\"scan\",\"seq\":7,\"point\":3,\"of\":9,\"ref\":\"on\",\"x\":-2.000,"
+                             "\"y\":0.000,\"az\":97.690,\"el\":30.000,\"dwellMs\":500,\"ms\":123456,"
+                             "\"unixMs\":1767225600250}", buf);
+
+    m.flags = SCAN_MARK_END | SCAN_MARK_ABORTED;
+    JsonBuffer end(buf, sizeof(buf));
+    writeScanMarkerJSON(end, m);
+    TEST_ASSERT_NOT_NULL(strstr(end.c_str(), "\"end\":true,\"aborted\":true,\"points\":3,\"of\":9"));
+}
+
+int main() {
+    hal::sim::clearNvs();
+    nativeSetup();
+    sim.attach();
+    UNITY_BEGIN();
+    RUN_TEST(test_grid_patterns);
+    RUN_TEST(test_spiral_and_sky_spacing);
+    RUN_TEST(test_parameter_checks);
+    RUN_TEST(test_raster_on_point_markers);
+    RUN_TEST(test_stop_and_estop_end_the_scan);
+    RUN_TEST(test_stop_before_the_first_tick);
+    RUN_TEST(test_marker_json);
+    return UNITY_END();
+}
@@ -0,0 +1,160 @@
+// LSM303 packet recorder and host replay. Set SENSOR_CAPTURE=<file> to
+// replay a capture downloaded from /sensor/capture and print its heading
+// jumps and smoothing lag. pio test -e native -f native/test_sensor_replay
+#include <unity.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "hal/native/NativeBoard.h"
+#include "sim/SensorReplay.h"
+#include "LSM303Receiver.h"
+#include "MathUtils.h"
+#include "SensorRecorder.h"
+
+extern LSM303Receiver lsmReceiver;
+
+static void sendPacket(const char* text) {
+    hal::sim::injectUdp(NATIVE_LSM_PORT, text, strlen(text));
+    nativeRunFor(20);
+}
+
+static float angleDiff(float a, float b) {
+    return normalizeDeg(a - b + 180.0f) - 180.0f;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_ring_keeps_newest_samples() {
+    SensorRecorder rec;
+    float mag[3] = {0.0f, 0.0f, 0.0f};
+    float acc[3] = {0.0f, 0.0f, 1.0f};
+    rec.record(1, mag, acc);   // not recording yet
+    TEST_ASSERT_EQUAL_UINT32(0, rec.count());
+
+    TEST_ASSERT_TRUE(rec.start());
+    for (uint32_t i = 0; i < SENSOR_REC_CAPACITY + 10; i++) {
+        mag[0] = (float)i;
+        rec.record(i * 20000, mag, acc);
+    }
+    rec.stop();
+    TEST_ASSERT_EQUAL_UINT32(SENSOR_REC_CAPACITY, rec.count());
+    TEST_ASSERT_EQUAL_UINT32(10, rec.overwritten());
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, rec.sample(0).mag[0]);
+    TEST_ASSERT_EQUAL_UINT32((SENSOR_REC_CAPACITY + 9) * 20000, rec.sample(SENSOR_REC_CAPACITY - 1).tUs);
+}
+
+// A restart reads as empty at once; the receiver clears the ring itself
+static void test_restart_clears_on_next_packet() {
+    SensorRecorder rec;
+    float mag[3] = {1.0f, 0.0f, 0.0f};
+    float acc[3] = {0.0f, 0.0f, 1.0f};
+    TEST_ASSERT_TRUE(rec.start());
+    for (uint32_t i = 0; i < 50; i++) rec.record(i, mag, acc);
+
+    TEST_ASSERT_TRUE(rec.start());
+    TEST_ASSERT_EQUAL_UINT32(0, rec.count());
+    TEST_ASSERT_EQUAL_UINT32(0, rec.overwritten());
+    mag[0] = 7.0f;
+    rec.record(900, mag, acc);
+    TEST_ASSERT_EQUAL_UINT32(1, rec.count());
+    TEST_ASSERT_EQUAL_FLOAT(7.0f, rec.sample(0).mag[0]);
+    TEST_ASSERT_EQUAL_UINT32(900, rec.sample(0).tUs);
+}
+
+// Reading the file in odd-sized pieces gives the same bytes as one read
+static void test_capture_file_round_trip() {
+    SensorRecorder rec;
+    TEST_ASSERT_TRUE(rec.start());
+    float mag[3] = {0.1f, -0.2f, 0.3f};
+    float acc[3] = {0.01f, 0.02f, 0.99f};
+    for (uint32_t i = 0; i < 100; i++) rec.record(1000 + i, mag, acc);
+    rec.recordMalformed(5000);
+    rec.stop();
+
+    std::vector<uint8_t> whole(rec.captureSize());
+    TEST_ASSERT_EQUAL_UINT32(whole.size(), rec.readCapture(whole.data(), whole.size(), 0));
+    std::vector<uint8_t> pieces;
+    uint8_t buf[37];
+    size_t n;
+    while ((n = rec.readCapture(buf, sizeof(buf), pieces.size())) > 0) pieces.insert(pieces.end(), buf, buf + n);
+    TEST_ASSERT_TRUE(whole == pieces);
+
+    SensorCapture cap;
+    TEST_ASSERT_TRUE(parseSensorCapture(whole.data(), whole.size(), cap));
+    TEST_ASSERT_EQUAL_UINT32(101, cap.samples.size());
+    TEST_ASSERT_EQUAL_FLOAT(-0.2f, cap.samples[50].mag[1]);
+    TEST_ASSERT_TRUE(std::isnan(cap.samples[100].mag[0]));
+    TEST_ASSERT_FALSE(parseSensorCapture(whole.data(), whole.size() - 1, cap));
+}
+
+// Packets through the live UDP path, then the capture replayed into a
+// fresh receiver: the smoothed output must match bit for bit
+static void test_replay_reproduces_receiver_state() {
+    TEST_ASSERT_TRUE(sensorRecorder.start());
+    char text[128];
+    for (int i = 0; i < 300; i++) {
+        float h = i * 1.7f;
+        snprintf(text, sizeof(text), "MAG:%.5f,%.5f,%.5f;ACC:%.5f,%.5f,%.5f",
+                 cosf(h * PI / 180), sinf(h * PI / 180), 0.05f * sinf(i * 0.1f), 0.02f, -0.01f, 0.98f);
+        sendPacket(i == 150 ? "MAG:garbled" : text);
+    }
+    sensorRecorder.stop();
+    TEST_ASSERT_EQUAL_UINT32(300, sensorRecorder.count());
+
+    std::vector<uint8_t> file(sensorRecorder.captureSize());
+    sensorRecorder.readCapture(file.data(), file.size(), 0);
+    SensorCapture cap;
+    TEST_ASSERT_TRUE(parseSensorCapture(file.data(), file.size(), cap));
+
+    LSM303Receiver replayed(0);
+    uint32_t hooks = 0;
+    SensorReplayStats st = replaySensorCapture(cap, replayed, [&](const SensorSample&, const LSM303Receiver&) { hooks++; });
+    TEST_ASSERT_EQUAL_UINT32(300, st.packets);
+    TEST_ASSERT_EQUAL_UINT32(1, st.malformed);
+    TEST_ASSERT_EQUAL_UINT32(300, hooks);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 299 * 0.02, st.capturedSeconds);
+    TEST_ASSERT_EQUAL_UINT32(lsmReceiver.getPacketCount(), replayed.getPacketCount());
+    TEST_ASSERT_TRUE(lsmReceiver.getAzimuth() == replayed.getAzimuth());
+    TEST_ASSERT_TRUE(lsmReceiver.getElevation() == replayed.getElevation());
+    TEST_ASSERT_TRUE(lsmReceiver.getRawAzimuth() == replayed.getRawAzimuth());
+}
+
+// Field captures: summary of what the receiver made of them
+static void test_replay_field_capture() {
+    const char* path = getenv("SENSOR_CAPTURE");
+    if (!path || !*path) return;
+
+    SensorCapture cap;
+    TEST_ASSERT_TRUE_MESSAGE(loadSensorCapture(path, cap), path);
+    LSM303Receiver receiver(0);
+    float lastRaw = NAN;
+    float maxJump = 0.0f, maxLag = 0.0f;
+    uint32_t jumps = 0;
+    SensorReplayStats st = replaySensorCapture(cap, receiver, [&](const SensorSample& s, const LSM303Receiver& r) {
+        if (std::isnan(s.mag[0])) return;
+        if (!std::isnan(lastRaw)) {
+            float jump = fabsf(angleDiff(r.getRawAzimuth(), lastRaw));
+            if (jump > maxJump) maxJump = jump;
+            if (jump > 10.0f) jumps++;
+        }
+        lastRaw = r.getRawAzimuth();
+        float lag = fabsf(angleDiff(r.getAzimuth(), r.getRawAzimuth()));
+        if (lag > maxLag) maxLag = lag;
+    });
+    printf("[REPLAY] %s: %u packets (%u malformed, %u overwritten before capture) over %.1f s, "
+           "%u heading jumps > 10 deg (max %.1f), max smoothing lag %.1f deg, replayed in %.1f ms\n",
+           path, st.packets, st.malformed, cap.overwritten, st.capturedSeconds, jumps, maxJump, maxLag, st.wallMs);
+}
+
+int main() {
+    nativeSetup(false);
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_keeps_newest_samples);
+    RUN_TEST(test_restart_clears_on_next_packet);
+    RUN_TEST(test_capture_file_round_trip);
+    RUN_TEST(test_replay_reproduces_receiver_state);
+    RUN_TEST(test_replay_field_capture);
+    return UNITY_END();
+}
@@ -0,0 +1,111 @@
+// Host concurrency test for Seqlock: pio test -e native
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "Seqlock.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Shaped like TelemetrySnapshot; every field is derived from one counter
+// so a reader can tell whether it saw a single write.
+struct Sample {
+    uint32_t timestampMs;
+    int32_t azSteps;
+    int32_t elSteps;
+    float azDeg;
+    float elDeg;
+    float lsm[5];
+    uint32_t age;
+    int8_t limits[2];
+    bool flags[5];
+};
+
+static Sample makeSample(uint32_t n) {
+    Sample s = {};
+    s.timestampMs = n;
+    s.azSteps = (int32_t)n * 3;
+    s.elSteps = -(int32_t)n;
+    s.azDeg = (float)(n % 100000) * 0.5f;
+    s.elDeg = (float)(n % 100000) * 0.25f;
+    for (int i = 0; i < 5; i++) s.lsm[i] = (float)(n % 1000) + i;
+    s.age = ~n;
+    s.limits[0] = (int8_t)(n & 1);
+    s.limits[1] = (int8_t)((n >> 1) & 1);
+    for (int i = 0; i < 5; i++) s.flags[i] = ((n >> i) & 1) != 0;
+    return s;
+}
+
+static bool consistent(const Sample& s) {
+    Sample expect = makeSample(s.timestampMs);
+    return memcmp(&expect, &s, sizeof(Sample)) == 0;
+}
+
+static void test_single_thread_round_trip() {
+    Seqlock<Sample> lock;
+    Sample out;
+    TEST_ASSERT_TRUE(lock.tryRead(out));
+    TEST_ASSERT_EQUAL_UINT32(0, out.timestampMs);
+    uint32_t v0 = lock.version();
+    lock.write(makeSample(42));
+    TEST_ASSERT_EQUAL_UINT32(v0 + 1, lock.version());
+    out = lock.read();
+    TEST_ASSERT_TRUE(consistent(out));
+    TEST_ASSERT_EQUAL_UINT32(42, out.timestampMs);
+}
+
+static void runTornReadTest(int readers, std::chrono::milliseconds duration) {
+    Seqlock<Sample> lock;
+    lock.write(makeSample(1));
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> reads{0}, torn{0}, backwards{0}, failed{0};
+
+    std::thread writer([&] {
+        uint32_t n = 1;
+        while (!done.load(std::memory_order_relaxed)) lock.write(makeSample(++n));
+    });
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; r++) {
+        threads.emplace_back([&] {
+            Sample s;
+            uint32_t last = 0;
+            uint64_t myReads = 0, myTorn = 0, myBack = 0, myFailed = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                if (!lock.tryRead(s)) { myFailed++; continue; }
+                myReads++;
+                if (!consistent(s)) myTorn++;
+                if (s.timestampMs < last) myBack++;   // single writer: never goes back
+                last = s.timestampMs;
+            }
+            reads += myReads; torn += myTorn; backwards += myBack; failed += myFailed;
+        });
+    }
+
+    std::this_thread::sleep_for(duration);
+    done = true;
+    writer.join();
+    for (auto& t : threads) t.join();
+
+    printf("[SEQLOCK] %d reader(s): %llu writes, %llu reads, %llu torn, %llu out of order, %llu gave up\n",
+           readers, (unsigned long long)lock.version(), (unsigned long long)reads.load(),
+           (unsigned long long)torn.load(), (unsigned long long)backwards.load(),
+           (unsigned long long)failed.load());
+    TEST_ASSERT_TRUE(reads.load() > 0);
+    TEST_ASSERT_EQUAL(0, torn.load());
+    TEST_ASSERT_EQUAL(0, backwards.load());
+}
+
+static void test_no_torn_reads_1_reader() { runTornReadTest(1, std::chrono::milliseconds(500)); }
+static void test_no_torn_reads_3_readers() { runTornReadTest(3, std::chrono::milliseconds(500)); }
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_thread_round_trip);
+    RUN_TEST(test_no_torn_reads_1_reader);
+    RUN_TEST(test_no_torn_reads_3_readers);
+    return UNITY_END();
+}
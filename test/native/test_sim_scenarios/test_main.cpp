@@ -0,0 +1,251 @@
+// Closed-loop scenarios on the rotator simulator: mechanics and faults,
+// then a full homing -> calibration -> tracking run with timing and error
+// figures for CI. pio test -e native
+#include <unity.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "hal/native/NativeBoard.h"
+#include "sim/RotatorSim.h"
+#include "Calibration.h"
+#include "Homing.h"
+#include "LSM303Receiver.h"
+#include "MathUtils.h"
+#include "MotorControl.h"
+
+extern Calibration calib;
+extern LSM303Receiver lsmReceiver;
+
+static SimAxisConfig azAxis() {
+    SimAxisConfig c;
+    c.startDeg = 40.0f;
+    c.backlashDeg = 0.4f;
+    c.naturalHz = 4.0f;
+    c.damping = 0.5f;
+    return c;
+}
+
+static SimAxisConfig elAxis() {
+    SimAxisConfig c;
+    c.startDeg = 15.0f;
+    c.backlashDeg = 0.2f;
+    c.naturalHz = 6.0f;
+    return c;
+}
+
+static SimSensorConfig lsmSensor() {
+    SimSensorConfig c;
+    c.headingAtAzZeroDeg = 12.0f;
+    c.headingNoiseDeg = 0.5f;
+    c.elNoiseDeg = 0.3f;
+    c.hardIronX = 0.08f;
+    c.softIronY = 0.95f;
+    c.dropRate = 0.02f;
+    return c;
+}
+
+static RotatorSim sim(azAxis(), elAxis(), lsmSensor());
+
+// Firmware reboot plus power cycle of the simulated rig
+static void reboot() {
+    abortHoming();
+    if (calib.isRunning()) calib.stop();
+    azHomed = false;
+    elHomed = false;
+    azHoming.stats = HomingStats();
+    elHoming.stats = HomingStats();
+    sim.powerOn();
+    sim.run(10);
+}
+
+static bool homingDone() { return homingStage != HOMING_RUNNING; }
+
+static bool homeAndWait(uint32_t timeoutMs = 60000) {
+    homeAll();
+    return sim.runUntil(homingDone, timeoutMs) && homingStage == HOMING_COMPLETE;
+}
+
+static bool motorsIdle() { return areMotorsReady(); }
+
+void setUp() {
+    sim.axis(SIM_AZ) = azAxis();
+    sim.axis(SIM_EL) = elAxis();
+    sim.sensor() = lsmSensor();
+    reboot();
+}
+void tearDown() {}
+
+static void test_homing_finds_switch_through_backlash() {
+    TEST_ASSERT_TRUE(homeAndWait());
+    // Home is where the output closed the switch, give or take the slack
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, sim.outputDeg(SIM_AZ) - stepsToAz(azMotor->getCurrentPosition()));
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, sim.outputDeg(SIM_EL) - stepsToEl(elMotor1->getCurrentPosition()));
+}
+
+static void test_backlash_on_reversal() {
+    TEST_ASSERT_TRUE(homeAndWait());
+    moveAzimuthToPosition(90.0f);
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 30000));
+    sim.run(1000);   // let the output ring down
+    float forward = sim.outputDeg(SIM_AZ);
+    moveAzimuthToPosition(80.0f);
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 30000));
+    sim.run(1000);
+    float back = sim.outputDeg(SIM_AZ);
+    // The reversal costs the full backlash relative to the step count
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, azAxis().backlashDeg, 10.0f - (forward - back));
+}
+
+static void test_inertia_overshoots_after_stop() {
+    TEST_ASSERT_TRUE(homeAndWait());
+    moveAzimuthToPosition(60.0f);
+    float peak = 0.0f;
+    sim.runUntil(motorsIdle, 30000);
+    for (int i = 0; i < 500; i++) {
+        sim.run(1);
+        if (sim.outputDeg(SIM_AZ) > peak) peak = sim.outputDeg(SIM_AZ);
+    }
+    TEST_ASSERT_TRUE(peak > sim.motorDeg(SIM_AZ) - azAxis().backlashDeg / 2);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, sim.motorDeg(SIM_AZ) - azAxis().backlashDeg / 2, sim.outputDeg(SIM_AZ));
+}
+
+static void test_stall_loses_steps_and_rehoming_sees_drift() {
+    TEST_ASSERT_TRUE(homeAndWait());
+    // Pull-out torque below the cruise speed: the fast part of the move slips
+    sim.axis(SIM_AZ).pullOutHz = MOTOR_SPEED_HZ - 100;
+    moveAzimuthToPosition(100.0f);
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 30000));
+    sim.axis(SIM_AZ).pullOutHz = 0.0f;
+    uint32_t lost = sim.lostSteps(SIM_AZ);
+    TEST_ASSERT_TRUE(lost > 100);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, lost / stepsPerDegree, 100.0f - sim.outputDeg(SIM_AZ));
+
+    // The firmware still believes 100 deg, so the switch latches late by the
+    // lost steps: re-homing measures exactly that drift
+    TEST_ASSERT_TRUE(homeAndWait());
+    TEST_ASSERT_INT_WITHIN(40, (long)lost, azHoming.stats.lastDriftSteps);
+}
+
+static void test_jam_fails_homing() {
+    sim.jam(SIM_AZ, true);
+    TEST_ASSERT_FALSE(homeAndWait());
+    TEST_ASSERT_EQUAL(AXIS_FAILED, azHoming.phase);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, azAxis().startDeg, sim.outputDeg(SIM_AZ));
+    TEST_ASSERT_TRUE(sim.lostSteps(SIM_AZ) >= MAX_HOMING_STEPS - 1000);
+    sim.jam(SIM_AZ, false);
+}
+
+static void test_scripted_slip_during_tracking() {
+    sim.sensor().hardIronX = 0.0f;   // uncalibrated here, so no distortion
+    sim.sensor().softIronY = 1.0f;
+    TEST_ASSERT_TRUE(homeAndWait());
+    moveAzimuthToPosition(45.0f);
+    sim.at(millis() + 1000, [] { sim.slip(SIM_AZ, 3.0f); });   // a gust turns the mast
+    TEST_ASSERT_TRUE(sim.runUntil([] { return millis() > 1500 && motorsIdle(); }, 30000));
+    sim.run(2000);
+    TEST_ASSERT_FLOAT_WITHIN(0.3f, 48.0f - azAxis().backlashDeg / 2, sim.outputDeg(SIM_AZ));
+    // The sensor sees what the step count cannot
+    float lsmAz = lsmReceiver.getRawAzimuth() - lsmSensor().headingAtAzZeroDeg;
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, sim.outputDeg(SIM_AZ), lsmAz);
+}
+
+// --- Full scenario over rotctl, as gpredict would drive it ---
+static int rotctl = -1;
+
+static void rotctlConnect() {
+    rotctl = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(NATIVE_ROTCTL_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL(0, connect(rotctl, (sockaddr*)&addr, sizeof(addr)));
+}
+
+static void rotctlSend(float az, float el) {
+    char line[48];
+    char reply[16];
+    int n = snprintf(line, sizeof(line), "P %.2f %.2f\n", az, el);
+    send(rotctl, line, n, 0);
+    sim.run(2);
+    recv(rotctl, reply, sizeof(reply), MSG_DONTWAIT);
+}
+
+// A 10 minute overhead pass: AZ 120 -> 300 deg, EL peaking at 70 deg
+static void passAt(float t, float& az, float& el) {
+    const float duration = 600.0f;
+    az = 120.0f + 180.0f * (t / duration);
+    el = 70.0f * sinf(PI * t / duration);
+}
+
+static void test_homing_calibration_tracking() {
+    auto wallStart = std::chrono::steady_clock::now();
+    unsigned long simStart = millis();
+
+    TEST_ASSERT_TRUE(homeAndWait());
+    unsigned long homingMs = millis() - simStart;
+
+    unsigned long calStart = millis();
+    calib.start();
+    TEST_ASSERT_TRUE(sim.runUntil([] { return !calib.isRunning() && homingDone(); }, 300000));
+    TEST_ASSERT_EQUAL(HOMING_COMPLETE, homingStage);
+    unsigned long calMs = millis() - calStart;
+    TEST_ASSERT_EQUAL_UINT8(CAL_AZ_BINS, calib.getAzBinsCovered());
+
+    // Tracking: a new position every second, error sampled every 100 ms
+    rotctlConnect();
+    float az, el;
+    passAt(0, az, el);
+    rotctlSend(az, el);
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 60000));
+    sim.run(1000);
+
+    double sumSq = 0.0;
+    float maxErr = 0.0f;
+    uint32_t samples = 0;
+    unsigned long passStart = millis();
+    for (uint32_t s = 0; s < 600; s++) {
+        passAt(s, az, el);
+        rotctlSend(az, el);
+        for (int k = 0; k < 10; k++) {
+            sim.run(k == 0 ? 98 : 100);
+            float tAz, tEl;
+            passAt((millis() - passStart) / 1000.0f, tAz, tEl);
+            float eAz = sim.outputDeg(SIM_AZ) - tAz;
+            float eEl = sim.outputDeg(SIM_EL) - tEl;
+            float err = sqrtf(eAz * eAz + eEl * eEl);
+            sumSq += err * err;
+            if (err > maxErr) maxErr = err;
+            samples++;
+        }
+    }
+    close(rotctl);
+    float rms = sqrtf(sumSq / samples);
+
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+    double simMs = millis() - simStart;
+    printf("[SIM] homing %lu ms, calibration %lu ms, tracking error rms %.2f max %.2f deg, "
+           "%u LSM packets, %.0f s simulated in %.0f ms (%.0fx real time)\n",
+           homingMs, calMs, rms, maxErr, sim.packetsSent(), simMs / 1000.0, wallMs, simMs / wallMs);
+
+    TEST_ASSERT_TRUE(rms < 1.0f);
+    TEST_ASSERT_TRUE(maxErr < 2.5f);
+    TEST_ASSERT_TRUE(simMs / wallMs > 10.0);
+}
+
+int main() {
+    nativeSetup();
+    sim.attach();
+    UNITY_BEGIN();
+    RUN_TEST(test_homing_finds_switch_through_backlash);
+    RUN_TEST(test_backlash_on_reversal);
+    RUN_TEST(test_inertia_overshoots_after_stop);
+    RUN_TEST(test_stall_loses_steps_and_rehoming_sees_drift);
+    RUN_TEST(test_jam_fails_homing);
+    RUN_TEST(test_scripted_slip_during_tracking);
+    RUN_TEST(test_homing_calibration_tracking);
+    return UNITY_END();
+}
@@ -0,0 +1,130 @@
+// Slew-time predictions against the simulated rotator and the rotctl
+// \slew_time extension. pio test -e native
+#include <unity.h>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "hal/native/NativeBoard.h"
+#include "sim/SimFixture.h"
+#include "Homing.h"
+#include "MotorControl.h"
+#include "SlewTime.h"
+#include "TelemetrySnapshot.h"
+
+static RotatorSim& sim = simRig();
+
+// The simulated stepper lands on the target up to a few ms early (it
+// snaps once within a step), hence a fixed tolerance rather than a ratio
+static void assertPredicts(float predictedSec, uint32_t actualMs) {
+    TEST_ASSERT_INT_WITHIN(15, (int)actualMs, (int)lroundf(predictedSec * 1000.0f));
+}
+
+// Predicts from the published state, then runs until both axes stopped
+static uint32_t moveAndTime(float az, float el, SlewPrediction& prediction) {
+    sim.run(1);   // publish the current state
+    prediction = predictSlew(readTelemetrySnapshot(), az, el);
+    uint32_t startMs = millis();
+    moveAzimuthToPosition(prediction.az);
+    moveElevationToPosition(prediction.el);
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 60000));
+    return millis() - startMs;
+}
+
+void setUp() {
+    TEST_ASSERT_TRUE(resetHomed(sim));
+}
+void tearDown() {}
+
+static void test_axis_profiles() {
+    // 400 steps at 1000 steps/s^2 never reach 800 Hz: triangle, 2*sqrt(d/a)
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 2.0f * sqrtf(0.4f), predictAxisSeconds(0, 0, 400, 800, 1000));
+    // 2400 steps: 0.8 s up, 0.8 s down, 1760 steps at 800 Hz
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.8f, predictAxisSeconds(0, 0, -2400, 800, 1000));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, predictAxisSeconds(100, 0, 100, 800, 1000));
+    // Cruising at 800 Hz with 1000 steps to go: 320 to brake, 680 at speed
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.8f + 0.85f, predictAxisSeconds(0, 800, 1000, 800, 1000));
+    // Moving away: 0.8 s and 320 steps to stop, then 1320 steps from rest
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.8f + 1.6f + 0.85f, predictAxisSeconds(0, -800, 1000, 800, 1000));
+    // Too fast to stop on the target: overshoot by 220 and come back
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.8f + 2.0f * sqrtf(0.22f), predictAxisSeconds(0, 800, 100, 800, 1000));
+}
+
+static void test_from_rest_matches_sim() {
+    SlewPrediction p;
+    uint32_t ms = moveAndTime(120.0f, 40.0f, p);
+    TEST_ASSERT_TRUE(p.azSec > p.elSec);
+    TEST_ASSERT_EQUAL_FLOAT(p.azSec, p.seconds);
+    assertPredicts(p.seconds, ms);
+
+    // A short hop is a triangle on both axes
+    ms = moveAndTime(123.0f, 38.5f, p);
+    TEST_ASSERT_TRUE(p.seconds < 1.0f);
+    assertPredicts(p.seconds, ms);
+
+    // Out of range targets are clamped like rotctl P
+    ms = moveAndTime(120.0f, 200.0f, p);
+    TEST_ASSERT_EQUAL_FLOAT((float)MAX_EL, p.el);
+    assertPredicts(p.seconds, ms);
+}
+
+static void test_mid_move_matches_sim() {
+    // Extend a move that is already cruising
+    moveAzimuthToPosition(60.0f);
+    sim.run(1500);
+    SlewPrediction p;
+    uint32_t ms = moveAndTime(90.0f, 0.0f, p);
+    assertPredicts(p.seconds, ms);
+
+    // Reverse while cruising: brake, then the full move back
+    moveAzimuthToPosition(150.0f);
+    sim.run(2000);
+    ms = moveAndTime(60.0f, 0.0f, p);
+    TEST_ASSERT_TRUE(p.azSec > 0.8f + 2.0f);
+    assertPredicts(p.seconds, ms);
+}
+
+static void test_rotctl_slew_time() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(NATIVE_ROTCTL_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL(0, connect(fd, (sockaddr*)&addr, sizeof(addr)));
+    sim.run(2);
+
+    const char line[] = "\\slew_time 30 0\n";
+    TEST_ASSERT_EQUAL((int)sizeof(line) - 1, send(fd, line, sizeof(line) - 1, 0));
+    sim.run(1);
+    char reply[32] = {};
+    TEST_ASSERT_TRUE(recv(fd, reply, sizeof(reply) - 1, MSG_DONTWAIT) > 0);
+    SlewPrediction p = predictSlew(readTelemetrySnapshot(), 30.0f, 0.0f);
+    char expected[16];
+    snprintf(expected, sizeof(expected), "%.2f\n", p.seconds);
+    TEST_ASSERT_EQUAL_STRING(expected, reply);
+    TEST_ASSERT_TRUE(motorsIdle());   // a question, not a move
+
+    const char bad[] = "\\slew_time 30\n";
+    send(fd, bad, sizeof(bad) - 1, 0);
+    sim.run(1);
+    memset(reply, 0, sizeof(reply));
+    TEST_ASSERT_TRUE(recv(fd, reply, sizeof(reply) - 1, MSG_DONTWAIT) > 0);
+    TEST_ASSERT_EQUAL_STRING("RPRT -1\n", reply);
+
+    close(fd);
+    sim.run(5);
+}
+
+int main() {
+    nativeSetup();
+    sim.attach();
+    UNITY_BEGIN();
+    RUN_TEST(test_axis_profiles);
+    RUN_TEST(test_from_rest_matches_sim);
+    RUN_TEST(test_mid_move_matches_sim);
+    RUN_TEST(test_rotctl_slew_time);
+    return UNITY_END();
+}
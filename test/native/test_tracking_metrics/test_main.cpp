@@ -0,0 +1,177 @@
+// Tracking error and settle metrics for passes driven over rotctl against
+// the simulated rotator. pio test -e native
+#include <unity.h>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "hal/native/NativeBoard.h"
+#include "sim/SimFixture.h"
+#include "Homing.h"
+#include "JsonWriter.h"
+#include "MathUtils.h"
+#include "MotorControl.h"
+#include "StatusJson.h"
+#include "TrackingMetrics.h"
+
+static RotatorSim& sim = simRig();
+static int rotctl = -1;
+
+static void connectRotctl() {
+    rotctl = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(NATIVE_ROTCTL_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL(0, connect(rotctl, (sockaddr*)&addr, sizeof(addr)));
+    sim.run(2);
+}
+
+static void disconnectRotctl() {
+    close(rotctl);
+    sim.run(5);
+}
+
+// Sends one P and lets the server handle it
+static void setPosition(float az, float el) {
+    char line[48];
+    char reply[16];
+    int n = snprintf(line, sizeof(line), "P %.2f %.2f\n", az, el);
+    TEST_ASSERT_EQUAL(n, send(rotctl, line, n, 0));
+    sim.run(1);
+    recv(rotctl, reply, sizeof(reply), MSG_DONTWAIT);
+}
+
+void setUp() {
+    trackingMetrics.setBeamwidth(TRACK_DEFAULT_BEAMWIDTH_DEG);
+    TEST_ASSERT_TRUE(resetHomed(sim));
+}
+void tearDown() {}
+
+static void test_pass_error_and_settle() {
+    // Pre-position in a pass of its own
+    connectRotctl();
+    setPosition(30.0f, 10.0f);
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 30000));
+    disconnectRotctl();
+    uint32_t before = trackingMetrics.last().number;
+
+    // One P per second along a slow arc, as gpredict would send it
+    connectRotctl();
+    for (int s = 0; s <= 60; s++) {
+        setPosition(30.0f + 0.5f * s, 10.0f + 0.3f * s);
+        sim.run(999);
+    }
+    TEST_ASSERT_TRUE(trackingMetrics.current().active);
+    disconnectRotctl();
+
+    TrackingPass pass = trackingMetrics.last();
+    TEST_ASSERT_FALSE(pass.active);
+    TEST_ASSERT_FALSE(trackingMetrics.current().active);
+    TEST_ASSERT_EQUAL_UINT32(before + 1, pass.number);
+    TEST_ASSERT_EQUAL_UINT32(61, pass.commands);
+    TEST_ASSERT_INT_WITHIN(20, 61000, (int)pass.durationMs);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 60.0f, pass.targetAz);
+
+    // Each 0.5 deg hop is a 0.4 s triangular move, well inside the beam
+    const AxisTracking& az = pass.axis[TRACK_AZ];
+    const AxisTracking& el = pass.axis[TRACK_EL];
+    TEST_ASSERT_INT_WITHIN(3, 61000 / TRACK_SAMPLE_MS, (int)az.steps.samples);
+    TEST_ASSERT_TRUE(az.steps.maxAbs <= 0.51f);
+    TEST_ASSERT_TRUE(az.steps.rms() > 0.05f && az.steps.rms() < az.steps.maxAbs);
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, az.steps.withinPct());
+    TEST_ASSERT_EQUAL_UINT32(61, az.settled);
+    TEST_ASSERT_EQUAL_UINT32(0, az.unsettled);
+    TEST_ASSERT_INT_WITHIN(30, 400, (int)az.lastSettleMs);
+    TEST_ASSERT_TRUE(az.settleMaxMs < 500);
+    TEST_ASSERT_EQUAL_UINT32(61, el.settled);
+    TEST_ASSERT_TRUE(el.lastSettleMs < az.lastSettleMs);   // 0.3 deg hops
+
+    // A rigid rotator with a clean sensor agrees with the steps, give or
+    // take the receiver's smoothing lag. (The simulated sensor's default EL
+    // mount reads 180 - EL after the receiver's correction, so only the
+    // EL sample count is checked.)
+    TEST_ASSERT_EQUAL_UINT32(az.steps.samples, az.sensor.samples);
+    TEST_ASSERT_EQUAL_UINT32(el.steps.samples, el.sensor.samples);
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, az.steps.rms(), az.sensor.rms());
+}
+
+static void test_superseded_command_is_unsettled() {
+    connectRotctl();
+    setPosition(60.0f, 0.0f);
+    sim.run(500);
+    setPosition(10.0f, 0.0f);   // before the AZ slew has finished
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 30000));
+    sim.run(20);
+    disconnectRotctl();
+
+    const AxisTracking& az = trackingMetrics.last().axis[TRACK_AZ];
+    TEST_ASSERT_EQUAL_UINT32(1, az.unsettled);
+    TEST_ASSERT_EQUAL_UINT32(1, az.settled);
+    TEST_ASSERT_TRUE(az.lastSettleMs > 500);
+}
+
+static void test_settle_time_matches_the_move() {
+    connectRotctl();
+    setPosition(35.0f, 0.0f);
+    uint32_t startMs = millis() - 1;
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 30000));
+    uint32_t moveMs = millis() - startMs;
+    sim.run(100);
+    disconnectRotctl();
+
+    const AxisTracking& az = trackingMetrics.last().axis[TRACK_AZ];
+    TEST_ASSERT_EQUAL_UINT32(1, az.settled);
+    TEST_ASSERT_TRUE(moveMs > 3000);
+    TEST_ASSERT_INT_WITHIN(10, (int)moveMs, (int)az.lastSettleMs);
+}
+
+static void test_idle_ends_pass_and_beamwidth_latches() {
+    trackingMetrics.setBeamwidth(0.2f);
+    connectRotctl();
+    setPosition(15.0f, 0.0f);
+    sim.run(1);
+    trackingMetrics.setBeamwidth(10.0f);   // from the next pass on
+    TEST_ASSERT_TRUE(sim.runUntil(motorsIdle, 30000));
+    sim.run(TRACK_COMMAND_GAP_MS);
+    TrackingPass running = trackingMetrics.current();
+    TEST_ASSERT_TRUE(running.active);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.2f, running.beamwidthDeg);
+    // Sampling stops once the last P is stale
+    uint32_t samples = running.axis[TRACK_AZ].steps.samples;
+    TEST_ASSERT_TRUE(samples > 0);
+    TEST_ASSERT_INT_WITHIN(2, (int)(TRACK_COMMAND_GAP_MS / TRACK_SAMPLE_MS), (int)samples);
+
+    sim.run(TRACK_PASS_IDLE_MS - TRACK_COMMAND_GAP_MS);
+    TEST_ASSERT_FALSE(trackingMetrics.current().active);
+    TrackingPass pass = trackingMetrics.last();
+    TEST_ASSERT_EQUAL_UINT32(samples, pass.axis[TRACK_AZ].steps.samples);
+    TEST_ASSERT_TRUE(pass.axis[TRACK_AZ].steps.withinPct() < 100.0f);
+    disconnectRotctl();   // no pass running, nothing to end
+    TEST_ASSERT_EQUAL_UINT32(pass.number, trackingMetrics.last().number);
+
+    // /status carries both passes
+    char buf[2048];
+    JsonBuffer json(buf, sizeof(buf));
+    json.beginObject();
+    writeTrackingFields(json);
+    json.endObject();
+    TEST_ASSERT_FALSE(json.overflowed());
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"tracking\":{\"beamwidth\":10.00,\"current\":{\"active\":false"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"last\":{\"active\":false,\"pass\":"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"settle\":{\"count\":1,"));
+}
+
+int main() {
+    nativeSetup();
+    sim.attach();
+    magneticDeclinationDeg = 0.0f;
+    UNITY_BEGIN();
+    RUN_TEST(test_pass_error_and_settle);
+    RUN_TEST(test_superseded_command_is_unsettled);
+    RUN_TEST(test_settle_time_matches_the_move);
+    RUN_TEST(test_idle_ends_pass_and_beamwidth_latches);
+    return UNITY_END();
+}
@@ -0,0 +1,184 @@
+function toggleElSource() {
+  const useLSM = document.getElementById("useLSM").checked ? 1 : 0;
+  sendCommand(`elsource ${useLSM}`, ()=>fetch(`/setElSource?value=${useLSM}`));
+}
+
+function updateAlpha(val) {
+  let alpha = (val / 100).toFixed(2);
+  document.getElementById("alphaValue").innerText = alpha;
+  sendCommand(`alpha ${alpha}`, ()=>fetch(`/setAlpha?value=${alpha}`));
+}
+
+const state={};
+function renderStatus(data) {
+    document.getElementById('hardware').innerText = data.hardware || '--';
+    document.getElementById('firmware').innerText = data.firmware || '--';
+
+    document.getElementById('lsmAz').innerText = data.lsmAz!==null? data.lsmAz.toFixed(1) : '--';
+    document.getElementById('lsmEl').innerText = data.lsmEl!==null? data.lsmEl.toFixed(1) : '--';
+    document.getElementById('lsmElCorr').innerText = data.lsmElCorr!==null? data.lsmElCorr.toFixed(1) : '--';
+    if (document.getElementById('lsmAzTrue')) {
+      document.getElementById('lsmAzTrue').innerText =
+        data.lsmAzTrue !== null ? data.lsmAzTrue.toFixed(1) : '--';
+    }
+    document.getElementById('az').innerText = data.az!==null? data.az.toFixed(1) : '--';
+    document.getElementById('el').innerText = data.el!==null? data.el.toFixed(1) : '--';
+    document.getElementById('azLimitStatus').innerText = data.azLimit===0?"TRIGGERED":"Clear";
+    document.getElementById('azLimitStatus').style.color = data.azLimit===0?"red":"green";
+    document.getElementById('elLimitStatus').innerText = data.elLimit===0?"TRIGGERED":"Clear";
+    document.getElementById('elLimitStatus').style.color = data.elLimit===0?"red":"green";
+    document.getElementById('rotctlStatus').innerText = data.rotctl?"Connected":"Disconnected";
+    document.getElementById('rotctlStatus').style.color = data.rotctl?"green":"red";
+    if (data.tracking) renderTracking(trackingFromStatus(data.tracking));
+    else if (data.trkPass !== undefined) renderTracking(data);
+}
+
+// /status nests the pass; flatten it to the socket's trk* fields
+function trackingFromStatus(t) {
+    const p = t.current.active ? t.current : t.last;
+    const flat = {trkPass: p.pass, trkActive: p.active};
+    for (const [k, a] of [['Az', p.az], ['El', p.el]]) {
+        flat[`trk${k}Rms`] = a.steps.rms;
+        flat[`trk${k}SensorRms`] = a.sensor.rms;
+        flat[`trk${k}InBeam`] = a.steps.withinPct;
+        flat[`trk${k}SettleMs`] = a.settle.meanMs;
+    }
+    return flat;
+}
+
+// Running pass, or the last one once it has ended
+function renderTracking(t) {
+    const el = document.getElementById('trackingStatus');
+    if (!t.trkPass) { el.innerText = '--'; return; }
+    const axis = k => `${k.toUpperCase()} rms ${t[`trk${k}Rms`].toFixed(2)}° / sensor ${t[`trk${k}SensorRms`].toFixed(2)}°, ` +
+        `${t[`trk${k}InBeam`].toFixed(0)}% in beam, settle ${t[`trk${k}SettleMs`].toFixed(0)} ms`;
+    el.innerText = `pass ${t.trkPass}${t.trkActive ? ' (running)' : ''}: ${axis('Az')}; ${axis('El')}`;
+}
+
+function updateStatus() {
+  fetch('/status').then(r=>r.json()).then(renderStatus).catch(e=>{});
+}
+
+let nextLogSeq=0;
+const MAX_LOG_LINES=200;
+function appendLog(entry) {
+  if(entry.seq<nextLogSeq) return;  // already shown
+  nextLogSeq=entry.seq+1;
+  const container=document.getElementById('logContainer');
+  let color="#0f0";
+  if(entry.level==1) color="#0af";
+  else if(entry.level==2) color="#ff0";
+  else if(entry.level==3) color="#f00";
+  const ts=new Date(entry.timestamp+performance.now()-performance.timing.navigationStart).toLocaleTimeString();
+  const line=document.createElement('div');
+  line.textContent=`[${ts}] ${entry.source}: `;
+  const msg=document.createElement('span');
+  msg.style.color=color;
+  msg.textContent=entry.message;
+  line.appendChild(msg);
+  container.appendChild(line);
+  while(container.childNodes.length>MAX_LOG_LINES) container.removeChild(container.firstChild);
+  container.scrollTop=container.scrollHeight;
+}
+
+function updateLogs() {
+  fetch('/logs?since='+nextLogSeq).then(r=>r.json()).then(data=>data.forEach(appendLog)).catch(e=>{});
+}
+
+// --- Telemetry socket: pushes status, calibration, tasks and log lines;
+// the HTTP pollers only run while it is down ---
+let ws=null;
+let pollers=[];
+function startPolling() {
+  if(pollers.length) return;
+  pollers=[setInterval(updateStatus,800), setInterval(updateCalibrationDisplay,1000),
+           setInterval(updateLogs,1000), setInterval(updateTasks,5000)];
+  updateStatus(); updateLogs(); updateTasks();
+}
+function stopPolling() {
+  pollers.forEach(clearInterval);
+  pollers=[];
+}
+function connectTelemetry() {
+  if(!window.WebSocket) { startPolling(); return; }
+  ws=new WebSocket(`ws://${location.host}/ws`);
+  ws.onopen=()=>{ stopPolling(); updateLogs(); };
+  ws.onclose=()=>{ ws=null; startPolling(); setTimeout(connectTelemetry,2000); };
+  ws.onmessage=ev=>{
+    let msg;
+    try { msg=JSON.parse(ev.data); } catch(e) { return; }
+    if(msg.t==='tel') { Object.assign(state,msg); renderStatus(state); renderCal(state); }
+    else if(msg.t==='log') appendLog(msg.e);
+    else if(msg.t==='tasks') document.getElementById('taskList').innerText=msg.list;
+  };
+}
+// Sends cmd over the socket when it is up, otherwise runs the HTTP fallback
+function sendCommand(cmd, fallback) {
+  if(ws && ws.readyState===1) { ws.send(cmd); return; }
+  fallback();
+}
+
+function jogAz(dir) {
+  const deg=parseFloat(document.getElementById('jogAz').value)||0.0;
+  const payload=new URLSearchParams();
+  payload.append('azStep',(deg*dir).toString());
+  sendCommand(`jog az ${deg*dir}`, ()=>fetch('/jog',{method:'POST',body:payload}).then(()=>updateStatus()));
+}
+
+function jogEl(dir) {
+  const deg=parseFloat(document.getElementById('jogEl').value)||0.0;
+  const payload=new URLSearchParams();
+  payload.append('elStep',(deg*dir).toString());
+  sendCommand(`jog el ${deg*dir}`, ()=>fetch('/jog',{method:'POST',body:payload}).then(()=>updateStatus()));
+}
+
+function moveTo() {
+  const az=parseFloat(document.getElementById('moveAz').value)||0.0;
+  const el=parseFloat(document.getElementById('moveEl').value)||0.0;
+  const payload=new URLSearchParams();
+  payload.append('moveAz',az.toString());
+  payload.append('moveEl',el.toString());
+  sendCommand(`move ${az} ${el}`, ()=>fetch('/move',{method:'POST',body:payload}).then(()=>updateStatus()));
+}
+
+function emergencyStop() { sendCommand('estop', ()=>fetch('/estop',{method:'POST'})); }
+function homeAz() { sendCommand('homeAz', ()=>fetch('/homeAz',{method:'POST'})); }
+function homeEl() { sendCommand('homeEl', ()=>fetch('/homeEl',{method:'POST'})); }
+
+function startAutoCalibration() {
+  fetch('/autoCal').then(r=>r.text()).then(msg=>{}).catch(err=>{alert("Failed to start calibration.");});
+}
+
+function renderCal(data) {
+  if(data.azMin===undefined) return;
+  document.getElementById('calValues').innerText=
+    `AZ ${data.azMin.toFixed(1)} / ${data.azMax.toFixed(1)}, EL ${data.elMin.toFixed(1)} / ${data.elMax.toFixed(1)}`;
+}
+
+function updateCalibrationDisplay() {
+  fetch('/cal/status').then(r=>r.json()).then(renderCal).catch(e=>{});
+}
+
+function resetESP() {
+  fetch('/reset').then(r=>r.text()).then(msg=>{alert("ESP32 is restarting...");}).catch(err=>console.error(err));
+}
+
+function updateTasks() {
+  fetch('/tasks')
+    .then(r => r.text())
+    .then(data => {
+      document.getElementById('taskList').innerText = data;
+    });
+}
+
+function startOTA() {
+      fetch('/update')
+          .then(resp => {
+            window.open('/update', '_blank');
+          })
+          .catch(err => {
+              alert("Failed to start OTA: " + err);
+          });
+  }
+updateStatus();
+connectTelemetry();